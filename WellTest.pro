@@ -53,6 +53,8 @@ HEADERS += dataeditorwidget.h \
            chartsetting1.h \
            chartsetting2.h \
            chartwidget.h \
+           curvelod.h \
+           curvestore.h \
            chartwindow.h \
            datacalculate.h \
            datacolumndialog.h \
@@ -64,7 +66,10 @@ HEADERS += dataeditorwidget.h \
            modelparameter.h \
            modelselect.h \
            modelsolver01-06.h \
+           sensitivityrunner.h \
+           curvepreviewservice.h \
            mousezoom.h \
+           plothitindex.h \
            newprojectdialog.h \
            paramselectdialog.h \
            mainwindow.h \
@@ -78,11 +83,26 @@ HEADERS += dataeditorwidget.h \
            pressurederivativecalculator.h \
            pressurederivativecalculator1.h \
            settingswidget.h \
+           tablestore.h \
+           tablejournal.h \
+           columnexpression.h \
+           tablesearchindex.h \
+           tableundocommands.h \
+           dataqualitychecker.h \
+           datafilter.h \
+           flowperiodsegmenter.h \
+           rateschedule.h \
+           reportwriter.h \
+           deconvolution.h \
+           typecurveatlas.h \
+           autosaveservice.h \
+           textdataimporter.h \
            qcustomplot.h \
            wt_fittingwidget.h \
            wt_modelwidget.h \
            wt_plottingwidget.h \
-           wt_projectwidget.h
+           wt_projectwidget.h \
+           xlsxstreamreader.h
 
 FORMS += dataeditorwidget.ui \
          chartsetting1.ui \
@@ -115,6 +135,8 @@ SOURCES += \
            chartsetting1.cpp \
            chartsetting2.cpp \
            chartwidget.cpp \
+           curvelod.cpp \
+           curvestore.cpp \
            chartwindow.cpp \
            datacalculate.cpp \
            datacolumndialog.cpp \
@@ -127,7 +149,10 @@ SOURCES += \
            modelparameter.cpp \
            modelselect.cpp \
            modelsolver01-06.cpp \
+           sensitivityrunner.cpp \
+           curvepreviewservice.cpp \
            mousezoom.cpp \
+           plothitindex.cpp \
            newprojectdialog.cpp \
            paramselectdialog.cpp \
            main.cpp \
@@ -142,11 +167,26 @@ SOURCES += \
            pressurederivativecalculator.cpp \
            pressurederivativecalculator1.cpp \
            settingswidget.cpp \
+           tablestore.cpp \
+           tablejournal.cpp \
+           columnexpression.cpp \
+           tablesearchindex.cpp \
+           tableundocommands.cpp \
+           dataqualitychecker.cpp \
+           datafilter.cpp \
+           flowperiodsegmenter.cpp \
+           rateschedule.cpp \
+           reportwriter.cpp \
+           deconvolution.cpp \
+           typecurveatlas.cpp \
+           autosaveservice.cpp \
+           textdataimporter.cpp \
            qcustomplot.cpp \
            wt_fittingwidget.cpp \
            wt_modelwidget.cpp \
            wt_plottingwidget.cpp \
-           wt_projectwidget.cpp
+           wt_projectwidget.cpp \
+           xlsxstreamreader.cpp
 
 RESOURCES += resource.qrc
 
@@ -0,0 +1,596 @@
+/*
+ * 文件名: autosaveservice.cpp
+ * 文件作用: 表格数据自动保存服务实现文件
+ * 功能描述:
+ * 1. 脏数据跟踪：dataChanged/headerDataChanged 只记录行列号，写日志时再读取文本。
+ * 2. 结构变化 (行列插入/删除) 前先把已记录的修改转换为日志记录，保证回放顺序与编辑顺序一致。
+ * 3. 后台单线程队列依次执行：日志追加 -> 日志轮换 (.journal -> .journal.compacting) -> 压缩生成 .wtd.new。
+ * 4. 压缩完成后回到主线程，由 ModelParameter 删除已合并的日志并替换 .wtd。
+ * 5. 完整保存先把 .journal 并入 .journal.compacting (新文件替换成功前不删除)，再分批复制快照；
+ *    复制期间已复制行的修改照常写入新的 .journal，替换后回放。
+ * 6. 手动保存 (saveNow) 不在界面线程写 .wtd：先写日志，再启动增量压缩或完整快照，
+ *    快照被结构变化打断时自动重新开始，最终结果通过 saveFinished 返回。
+ */
+
+#include "autosaveservice.h"
+#include "modelparameter.h"
+#include "tablestore.h"
+
+#include <QStandardItemModel>
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+// 修改的单元格超过该数量时不再逐格记录日志，改为完整快照保存
+const int kMaxTrackedCells = 200000;
+// 最后一次修改后多久写入日志
+const int kFlushDelayMs = 5000;
+// 完整快照每批复制的单元格数
+const int kSnapshotCellsPerStep = 50000;
+
+} // namespace
+
+AutoSaveService::AutoSaveService(QObject *parent)
+    : QObject(parent),
+    m_model(nullptr),
+    m_enabled(false),
+    m_needsFullSave(false),
+    m_compacting(false),
+    m_generation(0),
+    m_saveRequested(false),
+    m_saveRunning(false),
+    m_dirtyCount(0),
+    m_journalHasData(false),
+    m_backupEnabled(false),
+    m_snapshotRow(0)
+{
+    m_pool.setMaxThreadCount(1);
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(kFlushDelayMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &AutoSaveService::onFlushTimeout);
+
+    m_compactTimer.setInterval(5 * 60 * 1000);
+    connect(&m_compactTimer, &QTimer::timeout, this, &AutoSaveService::onCompactTimeout);
+
+    m_snapshotTimer.setSingleShot(true);
+    m_snapshotTimer.setInterval(0);
+    connect(&m_snapshotTimer, &QTimer::timeout, this, &AutoSaveService::onSnapshotStep);
+}
+
+AutoSaveService::~AutoSaveService()
+{
+    m_flushTimer.stop();
+    m_compactTimer.stop();
+    m_snapshotTimer.stop();
+    m_pool.waitForDone();
+}
+
+void AutoSaveService::attach(QStandardItemModel* model)
+{
+    if (m_model) disconnect(m_model, nullptr, this, nullptr);
+    m_model = model;
+    clearTracking();
+    if (!m_model) return;
+
+    connect(m_model, &QAbstractItemModel::dataChanged, this, &AutoSaveService::onDataChanged);
+    connect(m_model, &QAbstractItemModel::headerDataChanged, this, &AutoSaveService::onHeaderDataChanged);
+    connect(m_model, &QAbstractItemModel::rowsAboutToBeInserted, this, &AutoSaveService::onRowsAboutToBeInserted);
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &AutoSaveService::onRowsInserted);
+    connect(m_model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &AutoSaveService::onRowsAboutToBeRemoved);
+    connect(m_model, &QAbstractItemModel::columnsAboutToBeInserted, this, &AutoSaveService::onColumnsAboutToBeInserted);
+    connect(m_model, &QAbstractItemModel::columnsInserted, this, &AutoSaveService::onColumnsInserted);
+    connect(m_model, &QAbstractItemModel::columnsAboutToBeRemoved, this, &AutoSaveService::onColumnsAboutToBeRemoved);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &AutoSaveService::onModelReset);
+    // 排序等布局变化无法用增量记录表达，按整体重置处理
+    connect(m_model, &QAbstractItemModel::layoutChanged, this, &AutoSaveService::onModelReset);
+}
+
+void AutoSaveService::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    if (!enabled) {
+        m_flushTimer.stop();
+        m_compactTimer.stop();
+        abortSnapshot(false);
+        m_pool.waitForDone();
+        clearTracking();
+        m_records.clear();
+        m_needsFullSave = false;
+        m_journalHasData = false;
+        ++m_generation;
+        m_compacting = false;
+        if (isSaving()) {
+            m_saveRequested = m_saveRunning = false;
+            emit saveFinished(false, "项目已关闭，保存未完成");
+        }
+    } else if (m_compactTimer.interval() > 0) {
+        m_compactTimer.start();
+    }
+}
+
+void AutoSaveService::setInterval(int minutes)
+{
+    if (minutes <= 0) {
+        m_compactTimer.stop();
+        return;
+    }
+    m_compactTimer.setInterval(minutes * 60 * 1000);
+    if (m_enabled) m_compactTimer.start();
+}
+
+void AutoSaveService::setBackup(bool enabled, const QString& backupDir)
+{
+    m_backupEnabled = enabled;
+    m_backupDir = backupDir;
+}
+
+void AutoSaveService::markClean()
+{
+    clearTracking();
+    m_records.clear();
+    m_journalHasData = false;
+    // 尚无 .wtd (新建项目或旧版 JSON 项目) 时，首次自动保存需写出完整文件
+    m_needsFullSave = m_model && !ModelParameter::instance()->hasTableStore()
+                      && (m_model->rowCount() > 0 || m_model->columnCount() > 0);
+}
+
+bool AutoSaveService::isDirty() const
+{
+    return m_needsFullSave || m_dirtyCount > 0 || !m_dirtyHeaders.isEmpty()
+           || !m_records.isEmpty() || m_journalHasData || m_compacting;
+}
+
+void AutoSaveService::saveNow()
+{
+    if (!m_enabled || !m_model) {
+        QMetaObject::invokeMethod(this, [this]() { emit saveFinished(false, "没有打开的项目"); }, Qt::QueuedConnection);
+        return;
+    }
+    m_flushTimer.stop();
+    m_saveRequested = true;
+    startRequestedSave();
+}
+
+void AutoSaveService::discardChanges()
+{
+    m_flushTimer.stop();
+    abortSnapshot(false);
+    // 已提交的日志写入/压缩结束后再删除其文件；替换回调作废
+    m_pool.waitForDone();
+    ++m_generation;
+    m_compacting = false;
+    clearTracking();
+    m_records.clear();
+    m_needsFullSave = false;
+    m_journalHasData = false;
+    if (isSaving()) {
+        m_saveRequested = m_saveRunning = false;
+        emit saveFinished(false, "修改已放弃");
+    }
+
+    ModelParameter* mp = ModelParameter::instance();
+    const QString journalPath = mp->getTableJournalFilePath();
+    if (!journalPath.isEmpty()) {
+        QFile::remove(journalPath);
+        QFile::remove(journalPath + ".compacting");
+    }
+    const QString storePath = mp->getTableStoreFilePath();
+    if (!storePath.isEmpty()) QFile::remove(storePath + ".new");
+}
+
+void AutoSaveService::startRequestedSave()
+{
+    if (!m_saveRequested || m_compacting || !m_enabled || !m_model) return;
+    m_saveRequested = false;
+
+    const bool full = m_needsFullSave || !ModelParameter::instance()->hasTableStore();
+    if (!full) {
+        collectPending();
+        queueJournalWrite();
+        if (!m_journalHasData) {
+            // 没有未合并的修改，磁盘内容已是最新
+            QMetaObject::invokeMethod(this, [this]() { emit saveFinished(true, QString()); }, Qt::QueuedConnection);
+            return;
+        }
+    }
+    m_saveRunning = true;
+    if (!startCompaction(full)) {
+        m_saveRunning = false;
+        emit saveFinished(false, "项目路径无效");
+    }
+}
+
+// ================= 模型信号 =================
+
+bool AutoSaveService::tracking() const
+{
+    return m_enabled && m_model && !m_needsFullSave;
+}
+
+void AutoSaveService::clearTracking()
+{
+    m_dirtyCells.clear();
+    m_dirtyHeaders.clear();
+    m_dirtyCount = 0;
+}
+
+void AutoSaveService::onDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QList<int>& roles)
+{
+    if (!tracking()) return;
+    // 只关心文本变化 (颜色等显示角色不影响保存内容)
+    if (!roles.isEmpty() && !roles.contains(Qt::DisplayRole) && !roles.contains(Qt::EditRole)) return;
+
+    // 快照尚未复制到的行会直接取到新值，无需记录
+    const int lastRow = m_snapshot ? qMin(bottomRight.row(), m_snapshotRow - 1) : bottomRight.row();
+    if (lastRow < topLeft.row()) return;
+
+    for (int c = topLeft.column(); c <= bottomRight.column(); ++c) {
+        QSet<int>& rows = m_dirtyCells[c];
+        for (int r = topLeft.row(); r <= lastRow; ++r) rows.insert(r);
+        m_dirtyCount += lastRow - topLeft.row() + 1;
+    }
+
+    if (m_dirtyCount > kMaxTrackedCells) {
+        clearTracking();
+        abortSnapshot(false);
+        m_needsFullSave = true;
+    }
+    if (!m_flushTimer.isActive()) m_flushTimer.start();
+}
+
+void AutoSaveService::onHeaderDataChanged(Qt::Orientation orientation, int first, int last)
+{
+    if (!tracking() || orientation != Qt::Horizontal) return;
+    for (int c = first; c <= last; ++c) m_dirtyHeaders.insert(c);
+    if (!m_flushTimer.isActive()) m_flushTimer.start();
+}
+
+void AutoSaveService::onRowsAboutToBeInserted(const QModelIndex& parent, int, int)
+{
+    if (!tracking() || parent.isValid()) return;
+    // 快照复制中途的结构变化无法对齐已复制的行，重新开始完整保存
+    if (m_snapshot) {
+        abortSnapshot(true);
+        return;
+    }
+    collectPending();
+}
+
+void AutoSaveService::onRowsInserted(const QModelIndex& parent, int first, int last)
+{
+    if (!tracking() || parent.isValid()) return;
+
+    TableJournal::Record rec;
+    rec.type = TableJournal::Record_InsertRows;
+    rec.index = first;
+    rec.count = last - first + 1;
+    m_records.append(rec);
+
+    // 新行可能带有初始内容 (appendRow 不会发出 dataChanged)
+    QModelIndex tl = m_model->index(first, 0);
+    QModelIndex br = m_model->index(last, qMax(0, m_model->columnCount() - 1));
+    if (m_model->columnCount() > 0) onDataChanged(tl, br, QList<int>());
+    if (!m_flushTimer.isActive()) m_flushTimer.start();
+}
+
+void AutoSaveService::onRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (!tracking() || parent.isValid()) return;
+    if (m_snapshot) {
+        abortSnapshot(true);
+        return;
+    }
+    collectPending();
+
+    TableJournal::Record rec;
+    rec.type = TableJournal::Record_RemoveRows;
+    rec.index = first;
+    rec.count = last - first + 1;
+    m_records.append(rec);
+    if (!m_flushTimer.isActive()) m_flushTimer.start();
+}
+
+void AutoSaveService::onColumnsAboutToBeInserted(const QModelIndex& parent, int, int)
+{
+    if (!tracking() || parent.isValid()) return;
+    if (m_snapshot) {
+        abortSnapshot(true);
+        return;
+    }
+    collectPending();
+}
+
+void AutoSaveService::onColumnsInserted(const QModelIndex& parent, int first, int last)
+{
+    if (!tracking() || parent.isValid()) return;
+
+    TableJournal::Record rec;
+    rec.type = TableJournal::Record_InsertColumns;
+    rec.index = first;
+    rec.count = last - first + 1;
+    m_records.append(rec);
+
+    onHeaderDataChanged(Qt::Horizontal, first, last);
+    if (m_model->rowCount() > 0) {
+        onDataChanged(m_model->index(0, first), m_model->index(m_model->rowCount() - 1, last), QList<int>());
+    }
+}
+
+void AutoSaveService::onColumnsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (!tracking() || parent.isValid()) return;
+    if (m_snapshot) {
+        abortSnapshot(true);
+        return;
+    }
+    collectPending();
+
+    TableJournal::Record rec;
+    rec.type = TableJournal::Record_RemoveColumns;
+    rec.index = first;
+    rec.count = last - first + 1;
+    m_records.append(rec);
+    if (!m_flushTimer.isActive()) m_flushTimer.start();
+}
+
+void AutoSaveService::onModelReset()
+{
+    if (!m_enabled || !m_model) return;
+    abortSnapshot(false);
+    clearTracking();
+    m_records.clear();
+    m_needsFullSave = true;
+    if (!m_flushTimer.isActive()) m_flushTimer.start();
+}
+
+// ================= 日志与压缩 =================
+
+void AutoSaveService::collectPending()
+{
+    if (!m_model) return;
+    const int rowCount = m_model->rowCount();
+    const int colCount = m_model->columnCount();
+
+    for (int c : std::as_const(m_dirtyHeaders)) {
+        if (c >= colCount) continue;
+        TableJournal::Record rec;
+        rec.type = TableJournal::Record_Header;
+        rec.column = c;
+        rec.texts << m_model->headerData(c, Qt::Horizontal).toString();
+        m_records.append(rec);
+    }
+
+    // 每列按连续行合并为一条记录
+    for (auto it = m_dirtyCells.constBegin(); it != m_dirtyCells.constEnd(); ++it) {
+        const int c = it.key();
+        if (c >= colCount) continue;
+        QList<int> rows = it.value().values();
+        std::sort(rows.begin(), rows.end());
+
+        int i = 0;
+        while (i < rows.size()) {
+            if (rows[i] >= rowCount) break;
+            TableJournal::Record rec;
+            rec.type = TableJournal::Record_Cells;
+            rec.column = c;
+            rec.index = rows[i];
+            int r = rows[i];
+            while (i < rows.size() && rows[i] == r && r < rowCount) {
+                QStandardItem* item = m_model->item(r, c);
+                rec.texts << (item ? item->text() : QString());
+                ++i;
+                ++r;
+            }
+            m_records.append(rec);
+        }
+    }
+    clearTracking();
+}
+
+void AutoSaveService::queueJournalWrite()
+{
+    if (m_records.isEmpty()) return;
+    const QString journalPath = ModelParameter::instance()->getTableJournalFilePath();
+    if (journalPath.isEmpty()) return;
+
+    QList<TableJournal::Record> records;
+    records.swap(m_records);
+    m_journalHasData = true;
+
+    m_pool.start([records, journalPath]() {
+        QString err;
+        if (!TableJournal::append(journalPath, TableJournal::encode(records), &err)) {
+            qDebug() << "写入表格日志失败:" << journalPath << err;
+        }
+    });
+}
+
+void AutoSaveService::onFlushTimeout()
+{
+    if (!m_enabled || !m_model) return;
+    if (m_needsFullSave) {
+        if (m_compacting) m_flushTimer.start();
+        else startCompaction(true);
+        return;
+    }
+    collectPending();
+    queueJournalWrite();
+}
+
+void AutoSaveService::onCompactTimeout()
+{
+    if (!m_enabled || !m_model || m_compacting) return;
+    if (m_needsFullSave || !ModelParameter::instance()->hasTableStore()) {
+        if (isDirty()) startCompaction(true);
+        return;
+    }
+    collectPending();
+    queueJournalWrite();
+    if (m_journalHasData) startCompaction(false);
+}
+
+bool AutoSaveService::startCompaction(bool full)
+{
+    if (m_compacting || !m_model) return false;
+    ModelParameter* mp = ModelParameter::instance();
+    const QString storePath = mp->getTableStoreFilePath();
+    if (storePath.isEmpty()) return false;
+    const QString journalPath = mp->getTableJournalFilePath();
+    const QString compactingPath = journalPath + ".compacting";
+
+    m_compacting = true;
+    m_journalHasData = false;
+
+    if (full) {
+        // 日志轮换：此前的日志全部并入 .compacting，直到新文件替换成功才删除；
+        // 此后的修改写入新的 .journal，在新文件之上回放
+        auto snapshot = std::make_shared<Snapshot>();
+        m_pool.start([snapshot, journalPath, compactingPath]() {
+            TableJournal::merge(compactingPath, journalPath, &snapshot->rotateError);
+        });
+
+        const int rows = m_model->rowCount();
+        const int cols = m_model->columnCount();
+        TableJournal::Table& table = snapshot->table;
+        table.rowCount = rows;
+        table.columns.resize(cols);
+        for (int c = 0; c < cols; ++c) {
+            table.headers << m_model->headerData(c, Qt::Horizontal).toString();
+            table.columns[c].reserve(rows);
+        }
+        m_snapshot = snapshot;
+        m_snapshotRow = 0;
+        clearTracking();
+        m_records.clear();
+        m_needsFullSave = false;
+        m_snapshotTimer.start();
+        return true;
+    }
+
+    const QString newPath = storePath + ".new";
+    const quint64 generation = m_generation;
+    const QString backupDir = m_backupEnabled ? m_backupDir : QString();
+
+    m_pool.start([this, storePath, journalPath, compactingPath, newPath, generation, backupDir]() {
+        // 日志轮换：此后新的修改写入新的 .journal，不影响本次压缩
+        if (!QFile::exists(compactingPath) && QFile::exists(journalPath)) {
+            QFile::rename(journalPath, compactingPath);
+        }
+
+        QString err;
+        bool ok = false;
+        if (QFile::exists(compactingPath)) {
+            ok = TableJournal::compact(storePath, QStringList() << compactingPath, newPath, nullptr, &err);
+        } else {
+            err = "没有需要压缩的日志";
+        }
+
+        // 替换必须在主线程进行 (需先解除 ModelParameter 中的文件映射)
+        QMetaObject::invokeMethod(this, [this, ok, err, newPath, compactingPath, generation, backupDir]() {
+            finishCompaction(ok, err, false, newPath, compactingPath, generation, backupDir);
+        }, Qt::QueuedConnection);
+    });
+    return true;
+}
+
+void AutoSaveService::onSnapshotStep()
+{
+    if (!m_snapshot || !m_model) return;
+    TableJournal::Table& table = m_snapshot->table;
+    const int cols = table.columns.size();
+    const int end = qMin(table.rowCount, m_snapshotRow + qMax(1, kSnapshotCellsPerStep / qMax(1, cols)));
+
+    for (int c = 0; c < cols; ++c) {
+        QStringList& col = table.columns[c];
+        for (int r = m_snapshotRow; r < end; ++r) {
+            QStandardItem* item = m_model->item(r, c);
+            col.append(item ? item->text() : QString());
+        }
+    }
+    m_snapshotRow = end;
+
+    if (m_snapshotRow < table.rowCount) m_snapshotTimer.start();
+    else startSnapshotWrite();
+}
+
+void AutoSaveService::startSnapshotWrite()
+{
+    std::shared_ptr<Snapshot> snapshot;
+    snapshot.swap(m_snapshot);
+    ModelParameter* mp = ModelParameter::instance();
+    const QString newPath = mp->getTableStoreFilePath() + ".new";
+    const QString compactingPath = mp->getTableJournalFilePath() + ".compacting";
+    const quint64 generation = m_generation;
+    const QString backupDir = m_backupEnabled ? m_backupDir : QString();
+
+    m_pool.start([this, snapshot, newPath, compactingPath, generation, backupDir]() {
+        // 轮换失败时旧日志仍混在 .journal 中，不能用新文件替换
+        QString err = snapshot->rotateError;
+        bool ok = err.isEmpty();
+        if (ok) {
+            const TableJournal::Table& table = snapshot->table;
+            TableStore::WriteOptions options;
+            ok = TableStore::writeTable(newPath, table.headers, table.rowCount, [&table](int r, int c) {
+                return table.columns[c][r];
+            }, options, &err);
+        }
+
+        QMetaObject::invokeMethod(this, [this, ok, err, newPath, compactingPath, generation, backupDir]() {
+            finishCompaction(ok, err, true, newPath, compactingPath, generation, backupDir);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AutoSaveService::abortSnapshot(bool restart)
+{
+    if (!m_snapshot) return;
+    m_snapshotTimer.stop();
+    m_snapshot.reset();
+    m_compacting = false;
+    if (restart) {
+        clearTracking();
+        m_needsFullSave = true;
+        m_flushTimer.start();
+    }
+    // 被打断的手动保存在当前模型操作结束后重新开始
+    if (m_saveRunning) {
+        m_saveRunning = false;
+        m_saveRequested = true;
+        QTimer::singleShot(0, this, &AutoSaveService::startRequestedSave);
+    }
+}
+
+void AutoSaveService::finishCompaction(bool ok, const QString& err, bool full, const QString& newPath,
+                                       const QString& compactingPath, quint64 generation, const QString& backupDir)
+{
+    // 过期回调不得改动状态：其后可能已有新的压缩在进行
+    if (generation != m_generation) return;
+    m_compacting = false;
+    const bool manual = m_saveRunning;
+    m_saveRunning = false;
+    if (!ok) {
+        // 未合并的日志仍保留在 .compacting 中，下次压缩时继续使用
+        qDebug() << "自动保存失败:" << err;
+        if (full) m_needsFullSave = true;
+        else m_journalHasData = true;
+        if (manual) emit saveFinished(false, err);
+        startRequestedSave();
+        return;
+    }
+    ModelParameter* mp = ModelParameter::instance();
+    if (mp->replaceTableStore(newPath, compactingPath, backupDir)) {
+        mp->saveProject();
+        if (manual) emit saveFinished(true, QString());
+        else emit statusChanged("数据已自动保存");
+    } else {
+        qDebug() << "自动保存替换文件失败:" << newPath;
+        if (full) m_needsFullSave = true;
+        else m_journalHasData = true;
+        if (manual) emit saveFinished(false, "替换表格数据文件失败");
+    }
+    startRequestedSave();
+}
@@ -0,0 +1,130 @@
+/*
+ * 文件名: autosaveservice.h
+ * 文件作用: 表格数据自动保存服务头文件
+ * 功能描述:
+ * 1. 监听数据模型的修改信号，只记录被修改的单元格、表头以及行列的插入/删除 (脏数据跟踪)。
+ * 2. 修改在短暂停顿后以增量记录追加到 "_date.journal" 日志，写入在后台线程完成，不阻塞界面。
+ * 3. 按设置页的自动保存间隔，在后台把日志压缩进 "_date.wtd"，再回到主线程原子替换。
+ * 4. 模型被整体重置 (导入新文件、排序等) 时改为后台完整快照保存。
+ * 5. 程序崩溃后，下次打开项目时由 ModelParameter 回放残留日志恢复数据。
+ * 6. 完整快照在界面线程分批复制 (每批有限个单元格)，期间界面保持响应；结构变化时重新开始。
+ * 7. 手动保存同样走日志 + 后台压缩 (必要时完整快照)，不在界面线程写 .wtd，结果由 saveFinished 通知。
+ * 8. 不保存直接关闭项目时放弃未落盘的修改并删除日志，下次打开不会回放。
+ */
+
+#ifndef AUTOSAVESERVICE_H
+#define AUTOSAVESERVICE_H
+
+#include <QObject>
+#include <QMap>
+#include <QSet>
+#include <QList>
+#include <QTimer>
+#include <QThreadPool>
+#include <QModelIndex>
+#include <memory>
+#include "tablejournal.h"
+
+class QStandardItemModel;
+
+class AutoSaveService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AutoSaveService(QObject *parent = nullptr);
+    ~AutoSaveService();
+
+    // 绑定需要跟踪的数据模型
+    void attach(QStandardItemModel* model);
+
+    // 项目打开时启用，关闭时停用
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    // 自动保存 (日志压缩) 间隔，单位分钟；<= 0 表示只写日志不压缩
+    void setInterval(int minutes);
+    // 压缩替换前是否备份旧的 .wtd 文件
+    void setBackup(bool enabled, const QString& backupDir);
+
+    // 当前模型内容与磁盘一致 (如刚从项目恢复数据后)
+    void markClean();
+    // 有未落盘的修改，或后台压缩/快照尚未结束
+    bool isDirty() const;
+
+    // 手动保存：待写入的修改追加到日志后在后台压缩 (需要时完整快照)，完成后发出 saveFinished
+    void saveNow();
+    bool isSaving() const { return m_saveRequested || m_saveRunning; }
+    // 放弃上次保存后的修改：丢弃待写记录，删除日志 (关闭项目且不保存时调用)
+    void discardChanges();
+
+signals:
+    void statusChanged(const QString& message);
+    void saveFinished(bool ok, const QString& error);
+
+private slots:
+    void onDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QList<int>& roles);
+    void onHeaderDataChanged(Qt::Orientation orientation, int first, int last);
+    void onRowsAboutToBeInserted(const QModelIndex& parent, int first, int last);
+    void onRowsInserted(const QModelIndex& parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+    void onColumnsAboutToBeInserted(const QModelIndex& parent, int first, int last);
+    void onColumnsInserted(const QModelIndex& parent, int first, int last);
+    void onColumnsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+    void onModelReset();
+
+    void onFlushTimeout();
+    void onCompactTimeout();
+    void onSnapshotStep();
+    // 开始已请求的手动保存 (有压缩进行中时推迟到其结束)
+    void startRequestedSave();
+
+private:
+    // 把脏单元格/表头转换为日志记录 (须在结构变化前调用，此时行列号仍有效)
+    void collectPending();
+    // 后台追加日志
+    void queueJournalWrite();
+    // 后台压缩 (full 为 true 时先分批复制完整快照)；没有项目路径时返回 false
+    bool startCompaction(bool full);
+    // 快照复制完成后在后台写出 .wtd.new
+    void startSnapshotWrite();
+    // 压缩/快照写出结束 (主线程)：替换 .wtd
+    void finishCompaction(bool ok, const QString& err, bool full, const QString& newPath,
+                          const QString& compactingPath, quint64 generation, const QString& backupDir);
+    // 放弃正在复制的快照；restart 为 true 时稍后重新开始完整保存
+    void abortSnapshot(bool restart);
+    void clearTracking();
+    bool tracking() const;
+
+    QStandardItemModel* m_model;
+    bool m_enabled;
+    bool m_needsFullSave;
+    bool m_compacting;
+    quint64 m_generation;
+    bool m_saveRequested;                  // 手动保存已请求，等待当前压缩结束
+    bool m_saveRunning;                    // 当前压缩属于手动保存
+
+    QMap<int, QSet<int>> m_dirtyCells;     // 列 -> 修改过的行
+    QSet<int> m_dirtyHeaders;
+    int m_dirtyCount;
+    QList<TableJournal::Record> m_records; // 已生成、尚未写入日志的记录
+    bool m_journalHasData;                 // 上次压缩后日志中是否有新记录
+
+    bool m_backupEnabled;
+    QString m_backupDir;
+
+    QTimer m_flushTimer;
+    QTimer m_compactTimer;
+    QTimer m_snapshotTimer;                // 分批复制快照 (间隔 0，让出事件循环)
+
+    // 完整快照：表格在主线程分批填充，rotateError 由后台日志轮换任务写入
+    struct Snapshot {
+        TableJournal::Table table;
+        QString rotateError;
+    };
+    std::shared_ptr<Snapshot> m_snapshot;  // 正在复制的完整快照，空表示没有
+    int m_snapshotRow;                     // 已复制到的行 (之前的行修改仍需记录日志)
+    QThreadPool m_pool;                    // 单线程，保证日志写入与压缩按提交顺序执行
+};
+
+#endif // AUTOSAVESERVICE_H
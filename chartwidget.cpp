@@ -5,6 +5,9 @@
  * 1. 修复了重复连接导致的双重弹窗问题。
  * 2. 移除了不存在的右键菜单槽函数连接。
  * 3. 包含完整的交互逻辑（拖拽、标注、斜率线）。
+ * 4. 标识线与标注位于独立的缓冲层，拖动时只重绘该层，大数据曲线不随鼠标移动重绘。
+ * 5. 鼠标命中测试经 MouseZoom 的空间索引查询，不逐个遍历图元。
+ * 6. 开始拖动标注时若同时取消了曲线等主图层对象的选中，改为整图重绘，避免残留选中样式。
  */
 
 #include "chartwidget.h"
@@ -27,7 +30,8 @@ ChartWidget::ChartWidget(QWidget *parent) :
     m_interMode(Mode_None),
     m_activeLine(nullptr),
     m_activeText(nullptr),
-    m_activeArrow(nullptr)
+    m_activeArrow(nullptr),
+    m_itemLayer(nullptr)
 {
     ui->setupUi(this);
     m_plot = ui->chart; // ui->chart 是 MouseZoom 类型
@@ -59,6 +63,12 @@ void ChartWidget::initUi()
     // 基础交互设置
     m_plot->axisRect()->setRangeDrag(Qt::Horizontal | Qt::Vertical);
     m_plot->axisRect()->setRangeZoom(Qt::Horizontal | Qt::Vertical);
+
+    // 标识线、标注文字和箭头放在数据曲线之上的独立缓冲层：
+    // 拖动时只重绘该层，曲线层使用上次的缓存，与数据点数无关
+    m_plot->addLayer("annotation", m_plot->layer("main"), QCustomPlot::limAbove);
+    m_itemLayer = m_plot->layer("annotation");
+    m_itemLayer->setMode(QCPLayer::lmBuffered);
 }
 
 void ChartWidget::initConnections()
@@ -163,6 +173,7 @@ void ChartWidget::addCharacteristicLine(double slope)
     calculateLinePoints(slope, centerX, centerY, x1, y1, x2, y2, isLogX, isLogY);
 
     QCPItemLine* line = new QCPItemLine(m_plot);
+    line->setLayer(m_itemLayer);
     line->setClipAxisRect(rect);
     line->start->setCoords(x1, y1);
     line->end->setCoords(x2, y2);
@@ -175,7 +186,7 @@ void ChartWidget::addCharacteristicLine(double slope)
     line->setProperty("isLogLog", (isLogX && isLogY));
     line->setProperty("isCharacteristic", true);
 
-    m_plot->replot();
+    m_itemLayer->replot();
 }
 
 void ChartWidget::calculateLinePoints(double slope, double centerX, double centerY,
@@ -221,16 +232,6 @@ void ChartWidget::calculateLinePoints(double slope, double centerX, double cente
 
 // ---------------- 鼠标交互逻辑 ----------------
 
-double ChartWidget::distToSegment(const QPointF& p, const QPointF& s, const QPointF& e)
-{
-    double l2 = (s.x()-e.x())*(s.x()-e.x()) + (s.y()-e.y())*(s.y()-e.y());
-    if (l2 == 0) return std::sqrt((p.x()-s.x())*(p.x()-s.x()) + (p.y()-s.y())*(p.y()-s.y()));
-    double t = ((p.x()-s.x())*(e.x()-s.x()) + (p.y()-s.y())*(e.y()-s.y())) / l2;
-    t = std::max(0.0, std::min(1.0, t));
-    QPointF proj = s + t * (e - s);
-    return std::sqrt((p.x()-proj.x())*(p.x()-proj.x()) + (p.y()-proj.y())*(p.y()-proj.y()));
-}
-
 void ChartWidget::onPlotMousePress(QMouseEvent* event)
 {
     if (event->button() != Qt::LeftButton) return;
@@ -242,82 +243,36 @@ void ChartWidget::onPlotMousePress(QMouseEvent* event)
     m_lastMousePos = event->pos();
 
     double tolerance = 8.0;
+    PlotHitIndex* hitIndex = m_plot->hitIndex();
+    PlotHitIndex::LinePart part = PlotHitIndex::Part_None;
 
     // 1. 优先检查文本标注 (QCPItemText)
-    for (int i = 0; i < m_plot->itemCount(); ++i) {
-        if (auto text = qobject_cast<QCPItemText*>(m_plot->item(i))) {
-            if (text->selectTest(event->pos(), false) < tolerance) {
-                m_interMode = Mode_Dragging_Text;
-                m_activeText = text;
-                m_plot->deselectAll();
-                text->setSelected(true);
-                m_plot->setInteractions(QCP::Interaction(0));
-                m_plot->replot();
-                return;
-            }
-        }
+    if (QCPItemText* text = hitIndex->textAt(event->pos(), tolerance)) {
+        m_interMode = Mode_Dragging_Text;
+        m_activeText = text;
+        m_plot->setInteractions(QCP::Interaction(0));
+        selectItemExclusively(text);
+        return;
     }
 
-    // 2. 检查箭头 (普通 QCPItemLine)
-    for (int i = 0; i < m_plot->itemCount(); ++i) {
-        auto line = qobject_cast<QCPItemLine*>(m_plot->item(i));
-        if (line && !line->property("isCharacteristic").isValid()) {
-            double x1 = m_plot->xAxis->coordToPixel(line->start->coords().x());
-            double y1 = m_plot->yAxis->coordToPixel(line->start->coords().y());
-            double x2 = m_plot->xAxis->coordToPixel(line->end->coords().x());
-            double y2 = m_plot->yAxis->coordToPixel(line->end->coords().y());
-
-            QPointF pMouse = event->pos();
-            QPointF pStart(x1, y1);
-            QPointF pEnd(x2, y2);
-
-            if (std::sqrt(pow(pMouse.x()-pStart.x(),2) + pow(pMouse.y()-pStart.y(),2)) < tolerance) {
-                m_interMode = Mode_Dragging_ArrowStart;
-                m_activeArrow = line;
-                m_plot->setInteractions(QCP::Interaction(0));
-                return;
-            }
-            else if (std::sqrt(pow(pMouse.x()-pEnd.x(),2) + pow(pMouse.y()-pEnd.y(),2)) < tolerance) {
-                m_interMode = Mode_Dragging_ArrowEnd;
-                m_activeArrow = line;
-                m_plot->setInteractions(QCP::Interaction(0));
-                return;
-            }
-        }
+    // 2. 检查箭头端点 (普通 QCPItemLine)
+    if (QCPItemLine* arrow = hitIndex->lineAt(event->pos(), tolerance, false, &part)) {
+        m_interMode = (part == PlotHitIndex::Part_Start) ? Mode_Dragging_ArrowStart : Mode_Dragging_ArrowEnd;
+        m_activeArrow = arrow;
+        m_plot->setInteractions(QCP::Interaction(0));
+        return;
     }
 
-    // 3. 检查特征标识线
-    for (int i = 0; i < m_plot->itemCount(); ++i) {
-        QCPItemLine* line = qobject_cast<QCPItemLine*>(m_plot->item(i));
-        if (!line || !line->property("isCharacteristic").isValid()) continue;
-
-        double x1 = m_plot->xAxis->coordToPixel(line->start->coords().x());
-        double y1 = m_plot->yAxis->coordToPixel(line->start->coords().y());
-        double x2 = m_plot->xAxis->coordToPixel(line->end->coords().x());
-        double y2 = m_plot->yAxis->coordToPixel(line->end->coords().y());
-
-        QPointF pMouse = event->pos();
-        QPointF pStart(x1, y1);
-        QPointF pEnd(x2, y2);
-
-        if (std::sqrt(pow(pMouse.x()-pStart.x(),2) + pow(pMouse.y()-pStart.y(),2)) < tolerance) {
-            m_interMode = Mode_Dragging_Start;
-            m_activeLine = line;
-        } else if (std::sqrt(pow(pMouse.x()-pEnd.x(),2) + pow(pMouse.y()-pEnd.y(),2)) < tolerance) {
-            m_interMode = Mode_Dragging_End;
-            m_activeLine = line;
-        } else if (distToSegment(pMouse, pStart, pEnd) < tolerance) {
-            m_interMode = Mode_Dragging_Line;
-            m_activeLine = line;
-        }
+    // 3. 检查特征标识线 (端点拉伸优先于整体平移)
+    if (QCPItemLine* line = hitIndex->lineAt(event->pos(), tolerance, true, &part)) {
+        if (part == PlotHitIndex::Part_Start) m_interMode = Mode_Dragging_Start;
+        else if (part == PlotHitIndex::Part_End) m_interMode = Mode_Dragging_End;
+        else m_interMode = Mode_Dragging_Line;
+        m_activeLine = line;
 
-        if (m_interMode != Mode_None) {
-            m_plot->deselectAll();
-            line->setSelected(true);
-            m_plot->setInteractions(QCP::Interaction(0));
-            m_plot->replot();
-            return;
-        }
+        m_plot->setInteractions(QCP::Interaction(0));
+        selectItemExclusively(line);
+        return;
     }
 
     m_plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iSelectItems);
@@ -325,6 +280,17 @@ void ChartWidget::onPlotMousePress(QMouseEvent* event)
     m_plot->replot();
 }
 
+void ChartWidget::selectItemExclusively(QCPAbstractItem* item)
+{
+    // 曲线、坐标轴与图例不在标注层上，取消其选中须重绘对应图层
+    const bool othersSelected = !m_plot->selectedPlottables().isEmpty() || !m_plot->selectedAxes().isEmpty()
+                                || !m_plot->selectedLegends().isEmpty();
+    m_plot->deselectAll();
+    item->setSelected(true);
+    if (othersSelected) m_plot->replot();
+    else m_itemLayer->replot();
+}
+
 void ChartWidget::onPlotMouseMove(QMouseEvent* event)
 {
     if (m_interMode != Mode_None && (event->buttons() & Qt::LeftButton)) {
@@ -388,13 +354,16 @@ void ChartWidget::onPlotMouseMove(QMouseEvent* event)
         }
 
         m_lastMousePos = currentPos;
-        m_plot->replot();
+        // 拖动只改变标注层内的对象，坐标轴范围不变，曲线层无需重绘
+        m_itemLayer->replot();
     }
 }
 
 void ChartWidget::onPlotMouseRelease(QMouseEvent* event)
 {
     Q_UNUSED(event);
+    // 拖动改变了图元位置，命中索引需重建
+    if (m_interMode != Mode_None) m_plot->hitIndex()->invalidateItems();
     m_interMode = Mode_None;
     if (!m_activeLine && !m_activeText && !m_activeArrow)
         m_plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iSelectItems);
@@ -405,13 +374,8 @@ void ChartWidget::onPlotMouseDoubleClick(QMouseEvent* event)
     if (event->button() != Qt::LeftButton) return;
 
     double tolerance = 10.0;
-    for (int i = 0; i < m_plot->itemCount(); ++i) {
-        if (auto text = qobject_cast<QCPItemText*>(m_plot->item(i))) {
-            if (text->selectTest(event->pos(), false) < tolerance) {
-                onEditItemRequested(text);
-                return;
-            }
-        }
+    if (QCPItemText* text = m_plot->hitIndex()->textAt(event->pos(), tolerance)) {
+        onEditItemRequested(text);
     }
 }
 
@@ -470,6 +434,7 @@ void ChartWidget::onEditItemRequested(QCPAbstractItem* item)
         QString newContent = QInputDialog::getText(this, "修改标注", "内容:", QLineEdit::Normal, text->text(), &ok);
         if (ok && !newContent.isEmpty()) {
             text->setText(newContent);
+            m_plot->hitIndex()->invalidateItems();
             m_plot->replot();
         }
     }
@@ -499,12 +464,14 @@ void ChartWidget::addAnnotationToLine(QCPItemLine* line)
     if (!ok || text.isEmpty()) return;
 
     QCPItemText* txt = new QCPItemText(m_plot);
+    txt->setLayer(m_itemLayer);
     txt->setText(text);
     txt->position->setType(QCPItemPosition::ptPlotCoords);
     txt->setFont(QFont("Microsoft YaHei", 9));
     txt->setSelectable(true);
 
     QCPItemLine* arr = new QCPItemLine(m_plot);
+    arr->setLayer(m_itemLayer);
     arr->setHead(QCPLineEnding::esSpikeArrow);
     arr->setSelectable(true); // 允许拖动
 
@@ -83,9 +83,10 @@ private:
                              double& x1, double& y1, double& x2, double& y2,
                              bool isLogX, bool isLogY);
 
-    double distToSegment(const QPointF& p, const QPointF& s, const QPointF& e);
     void constrainLinePoint(QCPItemLine* line, bool isMovingStart, double mouseX, double mouseY);
     void updateAnnotationArrow(QCPItemLine* line);
+    // 选中单个标注/标识线：取消其余选中后重绘 (曲线、坐标轴或图例也被取消选中时整图重绘)
+    void selectItemExclusively(QCPAbstractItem* item);
 
 private:
     Ui::ChartWidget *ui;
@@ -114,6 +115,8 @@ private:
     QCPItemText* m_activeText;
     QCPItemLine* m_activeArrow;
     QPointF m_lastMousePos;
+
+    QCPLayer* m_itemLayer; // 标识线与标注所在的缓冲层
 };
 
 #endif // CHARTWIDGET_H
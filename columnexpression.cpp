@@ -0,0 +1,439 @@
+/*
+ * 文件名: columnexpression.cpp
+ * 文件作用: 计算列表达式引擎实现文件
+ * 功能描述:
+ * 1. 递归下降解析器：加减 < 乘除 < 一元负号 < 乘方 (右结合) < 函数调用/括号。
+ * 2. 生成栈式字节码，两侧均为常量的运算在编译期直接折叠。
+ * 3. 求值时每个栈槽是一整块数据 (kBlock 行)，逐条指令对整块循环，便于编译器向量化。
+ */
+
+#include "columnexpression.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+const int kBlock = 512;
+
+enum FuncId {
+    F_Sqrt, F_Ln, F_Log10, F_Exp, F_Abs, F_Sin, F_Cos, F_Tan,
+    F_Min, F_Max, F_Pow
+};
+
+struct FuncInfo {
+    const char* name;
+    int id;
+    int argc;
+};
+
+const FuncInfo kFuncs[] = {
+    {"sqrt", F_Sqrt, 1}, {"ln", F_Ln, 1}, {"log", F_Log10, 1}, {"log10", F_Log10, 1},
+    {"exp", F_Exp, 1}, {"abs", F_Abs, 1}, {"sin", F_Sin, 1}, {"cos", F_Cos, 1}, {"tan", F_Tan, 1},
+    {"min", F_Min, 2}, {"max", F_Max, 2}, {"pow", F_Pow, 2}
+};
+
+// 内置常量 (可被同名列或用户常量覆盖)
+const QMap<QString, double>& builtinConstants()
+{
+    static const QMap<QString, double> c = {
+        {"pi", 3.14159265358979323846}, {"e", 2.71828182845904523536}, {"g", 9.80665}
+    };
+    return c;
+}
+
+inline double apply1(int f, double x)
+{
+    switch (f) {
+    case F_Sqrt: return std::sqrt(x);
+    case F_Ln: return std::log(x);
+    case F_Log10: return std::log10(x);
+    case F_Exp: return std::exp(x);
+    case F_Abs: return std::fabs(x);
+    case F_Sin: return std::sin(x);
+    case F_Cos: return std::cos(x);
+    case F_Tan: return std::tan(x);
+    default: return std::nan("");
+    }
+}
+
+inline double apply2(int f, double a, double b)
+{
+    // min/max 任一侧为空时结果为空，与其他运算一致
+    switch (f) {
+    case F_Min: return (std::isnan(a) || std::isnan(b)) ? std::nan("") : std::min(a, b);
+    case F_Max: return (std::isnan(a) || std::isnan(b)) ? std::nan("") : std::max(a, b);
+    case F_Pow: return std::pow(a, b);
+    default: return std::nan("");
+    }
+}
+
+// 表头 "压力\MPa" 的名称部分
+QString headerBaseName(const QString& header)
+{
+    int pos = header.indexOf('\\');
+    return (pos < 0 ? header : header.left(pos)).trimmed();
+}
+
+} // namespace
+
+// ============================================================================
+// 解析器
+// ============================================================================
+class ColumnExpression::Parser
+{
+public:
+    Parser(ColumnExpression* owner, const QString& text) : m_owner(owner), m_s(text), m_pos(0) {}
+
+    bool parseStatement(QString* error)
+    {
+        // 可选的 "目标列 =" 前缀
+        int save = m_pos;
+        QString name;
+        if (readName(name)) {
+            skipSpace();
+            if (peek() == '=') {
+                ++m_pos;
+                m_owner->m_target = name;
+            } else {
+                m_pos = save;
+            }
+        } else {
+            m_pos = save;
+        }
+
+        if (!parseAdd()) return fail(error);
+        skipSpace();
+        if (m_pos < m_s.size()) {
+            m_error = QString("无法识别的字符 '%1'").arg(m_s[m_pos]);
+            return fail(error);
+        }
+        return true;
+    }
+
+private:
+    bool fail(QString* error)
+    {
+        if (error) *error = QString("%1 (位置 %2)").arg(m_error.isEmpty() ? "表达式语法错误" : m_error).arg(m_pos + 1);
+        return false;
+    }
+
+    void skipSpace() { while (m_pos < m_s.size() && m_s[m_pos].isSpace()) ++m_pos; }
+    QChar peek() { skipSpace(); return m_pos < m_s.size() ? m_s[m_pos] : QChar(); }
+
+    static bool isNameStart(QChar c) { return c.isLetter() || c == '_'; }
+    static bool isNameChar(QChar c) { return c.isLetterOrNumber() || c == '_'; }
+
+    // 标识符或 [任意列名]
+    bool readName(QString& name)
+    {
+        skipSpace();
+        if (m_pos >= m_s.size()) return false;
+        if (m_s[m_pos] == '[') {
+            int end = m_s.indexOf(']', m_pos + 1);
+            if (end < 0) { m_error = "缺少 ']'"; return false; }
+            name = m_s.mid(m_pos + 1, end - m_pos - 1).trimmed();
+            m_pos = end + 1;
+            return !name.isEmpty();
+        }
+        if (!isNameStart(m_s[m_pos])) return false;
+        int start = m_pos;
+        while (m_pos < m_s.size() && isNameChar(m_s[m_pos])) ++m_pos;
+        name = m_s.mid(start, m_pos - start);
+        return true;
+    }
+
+    bool parseAdd()
+    {
+        if (!parseMul()) return false;
+        for (;;) {
+            QChar c = peek();
+            if (c != '+' && c != '-') return true;
+            ++m_pos;
+            if (!parseMul()) return false;
+            m_owner->emitBinary(c == '+' ? Op_Add : Op_Sub);
+        }
+    }
+
+    bool parseMul()
+    {
+        if (!parseUnary()) return false;
+        for (;;) {
+            QChar c = peek();
+            if (c != '*' && c != '/') return true;
+            ++m_pos;
+            if (!parseUnary()) return false;
+            m_owner->emitBinary(c == '*' ? Op_Mul : Op_Div);
+        }
+    }
+
+    bool parseUnary()
+    {
+        QChar c = peek();
+        if (c == '-' || c == '+') {
+            ++m_pos;
+            if (!parseUnary()) return false;
+            if (c == '-') {
+                QVector<Instr>& code = m_owner->m_code;
+                if (!code.isEmpty() && code.last().op == Op_Const) code.last().value = -code.last().value;
+                else code.append({Op_Neg, 0, 0.0});
+            }
+            return true;
+        }
+        return parsePow();
+    }
+
+    bool parsePow()
+    {
+        if (!parsePrimary()) return false;
+        if (peek() == '^') {
+            ++m_pos;
+            if (!parseUnary()) return false; // 右结合，且允许 2^-1
+            m_owner->emitBinary(Op_Pow);
+        }
+        return true;
+    }
+
+    bool parsePrimary()
+    {
+        QChar c = peek();
+        if (c.isNull()) { m_error = "表达式不完整"; return false; }
+
+        if (c == '(') {
+            ++m_pos;
+            if (!parseAdd()) return false;
+            if (peek() != ')') { m_error = "缺少 ')'"; return false; }
+            ++m_pos;
+            return true;
+        }
+
+        if (c.isDigit() || c == '.') {
+            int start = m_pos;
+            while (m_pos < m_s.size() && (m_s[m_pos].isDigit() || m_s[m_pos] == '.')) ++m_pos;
+            if (m_pos < m_s.size() && (m_s[m_pos] == 'e' || m_s[m_pos] == 'E')) {
+                int expPos = m_pos + 1;
+                if (expPos < m_s.size() && (m_s[expPos] == '+' || m_s[expPos] == '-')) ++expPos;
+                if (expPos < m_s.size() && m_s[expPos].isDigit()) {
+                    m_pos = expPos;
+                    while (m_pos < m_s.size() && m_s[m_pos].isDigit()) ++m_pos;
+                }
+            }
+            bool ok = false;
+            double v = m_s.mid(start, m_pos - start).toDouble(&ok);
+            if (!ok) { m_pos = start; m_error = "数值格式错误"; return false; }
+            m_owner->m_code.append({Op_Const, 0, v});
+            return true;
+        }
+
+        bool bracketed = (c == '[');
+        QString name;
+        if (!readName(name)) {
+            if (m_error.isEmpty()) m_error = QString("无法识别的字符 '%1'").arg(c);
+            return false;
+        }
+
+        // 函数调用
+        if (!bracketed && peek() == '(') {
+            const FuncInfo* info = nullptr;
+            for (const FuncInfo& f : kFuncs) {
+                if (name.compare(QLatin1String(f.name), Qt::CaseInsensitive) == 0) { info = &f; break; }
+            }
+            if (!info) { m_error = QString("未知函数 '%1'").arg(name); return false; }
+            ++m_pos;
+            for (int i = 0; i < info->argc; ++i) {
+                if (i > 0) {
+                    if (peek() != ',') { m_error = QString("函数 %1 需要 %2 个参数").arg(name).arg(info->argc); return false; }
+                    ++m_pos;
+                }
+                if (!parseAdd()) return false;
+            }
+            if (peek() != ')') { m_error = QString("函数 %1 需要 %2 个参数").arg(name).arg(info->argc); return false; }
+            ++m_pos;
+            m_owner->emitFunc(info->id, info->argc);
+            return true;
+        }
+
+        int idx = m_owner->m_symbols.indexOf(name);
+        if (idx < 0) {
+            idx = m_owner->m_symbols.size();
+            m_owner->m_symbols.append(name);
+        }
+        m_owner->m_code.append({Op_Symbol, idx, 0.0});
+        return true;
+    }
+
+    ColumnExpression* m_owner;
+    QString m_s;
+    int m_pos;
+    QString m_error;
+};
+
+// ============================================================================
+// ColumnExpression
+// ============================================================================
+
+ColumnExpression::ColumnExpression()
+    : m_compiled(false), m_maxDepth(0)
+{
+}
+
+bool ColumnExpression::compile(const QString& text, QString* error)
+{
+    m_compiled = false;
+    m_text = text.trimmed();
+    m_target.clear();
+    m_symbols.clear();
+    m_code.clear();
+    m_bound.clear();
+    m_inputColumns.clear();
+
+    if (m_text.isEmpty()) {
+        if (error) *error = "表达式为空";
+        return false;
+    }
+    Parser parser(this, m_text);
+    if (!parser.parseStatement(error)) return false;
+    if (m_symbols.contains(m_target)) {
+        if (error) *error = QString("目标列 '%1' 不能引用自身").arg(m_target);
+        return false;
+    }
+    m_maxDepth = stackDepth();
+    m_compiled = true;
+    return true;
+}
+
+void ColumnExpression::emitBinary(OpCode op)
+{
+    int n = m_code.size();
+    if (n >= 2 && m_code[n - 1].op == Op_Const && m_code[n - 2].op == Op_Const) {
+        double a = m_code[n - 2].value, b = m_code[n - 1].value, r = 0.0;
+        switch (op) {
+        case Op_Add: r = a + b; break;
+        case Op_Sub: r = a - b; break;
+        case Op_Mul: r = a * b; break;
+        case Op_Div: r = a / b; break;
+        case Op_Pow: r = std::pow(a, b); break;
+        default: break;
+        }
+        m_code.removeLast();
+        m_code.last().value = r;
+        return;
+    }
+    m_code.append({op, 0, 0.0});
+}
+
+void ColumnExpression::emitFunc(int func, int argc)
+{
+    int n = m_code.size();
+    if (argc == 1 && n >= 1 && m_code[n - 1].op == Op_Const) {
+        m_code.last().value = apply1(func, m_code.last().value);
+        return;
+    }
+    if (argc == 2 && n >= 2 && m_code[n - 1].op == Op_Const && m_code[n - 2].op == Op_Const) {
+        double r = apply2(func, m_code[n - 2].value, m_code[n - 1].value);
+        m_code.removeLast();
+        m_code.last().value = r;
+        return;
+    }
+    m_code.append({argc == 1 ? Op_Func1 : Op_Func2, func, 0.0});
+}
+
+int ColumnExpression::stackDepth() const
+{
+    int depth = 0, maxDepth = 0;
+    for (const Instr& in : m_code) {
+        switch (in.op) {
+        case Op_Const: case Op_Input: case Op_Symbol: ++depth; break;
+        case Op_Neg: case Op_Func1: break;
+        default: --depth; break;
+        }
+        maxDepth = std::max(maxDepth, depth);
+    }
+    return maxDepth;
+}
+
+bool ColumnExpression::bind(const QStringList& headers, const QMap<QString, double>& variables, QString* error)
+{
+    m_bound.clear();
+    m_inputColumns.clear();
+    if (!m_compiled) {
+        if (error) *error = "表达式未编译";
+        return false;
+    }
+
+    // 每个符号解析为 (输入序号) 或 (常量)
+    QVector<int> symbolInput(m_symbols.size(), -1);
+    QVector<double> symbolValue(m_symbols.size(), 0.0);
+    for (int s = 0; s < m_symbols.size(); ++s) {
+        const QString& name = m_symbols[s];
+        int col = headers.indexOf(name);
+        if (col < 0) {
+            for (int c = 0; c < headers.size(); ++c) {
+                if (headerBaseName(headers[c]) == name) { col = c; break; }
+            }
+        }
+        if (col >= 0) {
+            symbolInput[s] = m_inputColumns.size();
+            m_inputColumns.append(col);
+        } else if (variables.contains(name)) {
+            symbolValue[s] = variables.value(name);
+        } else if (builtinConstants().contains(name)) {
+            symbolValue[s] = builtinConstants().value(name);
+        } else {
+            if (error) *error = QString("找不到列或常量 '%1'").arg(name);
+            m_inputColumns.clear();
+            return false;
+        }
+    }
+
+    m_bound = m_code;
+    for (Instr& in : m_bound) {
+        if (in.op != Op_Symbol) continue;
+        if (symbolInput[in.arg] >= 0) {
+            in.op = Op_Input;
+            in.arg = symbolInput[in.arg];
+        } else {
+            in.op = Op_Const;
+            in.value = symbolValue[in.arg];
+        }
+    }
+    return true;
+}
+
+void ColumnExpression::evaluate(const QVector<const double*>& inputs, int rowCount, double* out) const
+{
+    if (m_bound.isEmpty() || rowCount <= 0) {
+        std::fill(out, out + std::max(0, rowCount), std::nan(""));
+        return;
+    }
+
+    QVector<double> stack(std::max(1, m_maxDepth) * kBlock);
+    for (int begin = 0; begin < rowCount; begin += kBlock) {
+        const int n = std::min(kBlock, rowCount - begin);
+        int sp = 0;
+        for (const Instr& in : m_bound) {
+            double* top = stack.data() + sp * kBlock;                  // 下一个空槽
+            double* b = sp >= 1 ? top - kBlock : nullptr;               // 栈顶
+            double* a = sp >= 2 ? top - 2 * kBlock : nullptr;           // 二元运算左操作数
+            switch (in.op) {
+            case Op_Const:
+                std::fill(top, top + n, in.value);
+                ++sp;
+                break;
+            case Op_Input:
+                std::copy(inputs[in.arg] + begin, inputs[in.arg] + begin + n, top);
+                ++sp;
+                break;
+            case Op_Add: for (int i = 0; i < n; ++i) a[i] += b[i]; --sp; break;
+            case Op_Sub: for (int i = 0; i < n; ++i) a[i] -= b[i]; --sp; break;
+            case Op_Mul: for (int i = 0; i < n; ++i) a[i] *= b[i]; --sp; break;
+            case Op_Div: for (int i = 0; i < n; ++i) a[i] /= b[i]; --sp; break;
+            case Op_Pow: for (int i = 0; i < n; ++i) a[i] = std::pow(a[i], b[i]); --sp; break;
+            case Op_Neg: for (int i = 0; i < n; ++i) b[i] = -b[i]; break;
+            case Op_Func1: for (int i = 0; i < n; ++i) b[i] = apply1(in.arg, b[i]); break;
+            case Op_Func2: for (int i = 0; i < n; ++i) a[i] = apply2(in.arg, a[i], b[i]); --sp; break;
+            case Op_Symbol: break; // bind 后不会出现
+            }
+        }
+        std::copy(stack.constData(), stack.constData() + n, out + begin);
+    }
+}
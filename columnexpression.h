@@ -0,0 +1,84 @@
+/*
+ * 文件名: columnexpression.h
+ * 文件作用: 计算列表达式引擎头文件
+ * 功能描述:
+ * 1. 解析形如 "Pwf = Pc + (Hres - Lwf) * rho * g / 1e6" 的表达式 (左侧为新列名，可省略)。
+ * 2. 表达式编译为栈式字节码 (常量子表达式在编译期折叠)，按数据块批量求值，每条指令对整块数据循环执行。
+ * 3. 标识符按 "列名 -> 列名去单位 (反斜杠前部分) -> 常量" 的顺序绑定；含特殊字符的列名可写作 [压力\MPa]。
+ * 4. 支持 + - * / ^、括号、一元负号，以及 sqrt/ln/log/log10/exp/abs/sin/cos/tan/min/max/pow 函数。
+ * 5. 空单元格或非数值按 NaN 参与运算，结果为 NaN 的行输出为空。
+ */
+
+#ifndef COLUMNEXPRESSION_H
+#define COLUMNEXPRESSION_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+
+class ColumnExpression
+{
+public:
+    ColumnExpression();
+
+    /**
+     * @brief 编译表达式
+     * @param text 表达式文本，"目标列 = 表达式" 或仅表达式
+     * @param error 失败时的错误信息 (含出错位置)
+     */
+    bool compile(const QString& text, QString* error = nullptr);
+
+    /**
+     * @brief 将标识符绑定到表格列或常量
+     * @param headers 当前表头
+     * @param variables 用户定义的常量 (优先级低于列名)
+     */
+    bool bind(const QStringList& headers, const QMap<QString, double>& variables, QString* error = nullptr);
+
+    bool isCompiled() const { return m_compiled; }
+    QString text() const { return m_text; }
+    QString targetName() const { return m_target; }
+    // 表达式中出现的全部标识符 (去重，按出现顺序)
+    QStringList symbols() const { return m_symbols; }
+    // 绑定后引用的列号 (与 evaluate 的 inputs 顺序一致)
+    QVector<int> inputColumns() const { return m_inputColumns; }
+
+    /**
+     * @brief 批量求值
+     * @param inputs 与 inputColumns() 一一对应的列数据
+     * @param rowCount 行数
+     * @param out 输出 (至少 rowCount 个元素)
+     */
+    void evaluate(const QVector<const double*>& inputs, int rowCount, double* out) const;
+
+private:
+    enum OpCode {
+        Op_Const, Op_Input, Op_Symbol,
+        Op_Add, Op_Sub, Op_Mul, Op_Div, Op_Pow, Op_Neg,
+        Op_Func1, Op_Func2
+    };
+    struct Instr {
+        OpCode op;
+        int arg;        // Op_Input: 输入序号；Op_Symbol: 符号序号；Op_Func*: 函数编号
+        double value;   // Op_Const 的常量值
+    };
+
+    class Parser;
+    friend class Parser;
+
+    void emitBinary(OpCode op);
+    void emitFunc(int func, int argc);
+    int stackDepth() const;
+
+    bool m_compiled;
+    QString m_text;
+    QString m_target;
+    QStringList m_symbols;
+    QVector<Instr> m_code;      // 编译结果 (标识符未绑定)
+    QVector<Instr> m_bound;     // 绑定后的可执行字节码
+    QVector<int> m_inputColumns;
+    int m_maxDepth;
+};
+
+#endif // COLUMNEXPRESSION_H
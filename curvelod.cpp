@@ -0,0 +1,228 @@
+/*
+ * 文件名: curvelod.cpp
+ * 文件作用: 大数据量曲线的多分辨率降采样 (LOD) 实现文件
+ * 功能描述:
+ * 1. 第 0 层桶数取 2 的幂 (约每桶 4 点，上限 2^18)，上层桶宽依次翻倍，总内存约为 4 个 int / 桶。
+ * 2. 查询选取桶宽不超过一个像素的最粗层，输出点数约为像素宽度的 2~4 倍，与总点数无关。
+ * 3. 可见范围两侧各多取一个桶 (或一个原始点)，保证曲线连到视图边缘。
+ */
+
+#include "curvelod.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+const int kMaxBaseBuckets = 1 << 18;
+}
+
+CurveLodPyramid::CurveLodPyramid()
+    : m_logKey(false)
+    , m_first(0)
+    , m_uMin(0.0)
+    , m_bucketWidth(1.0)
+    , m_globalMin(-1)
+    , m_globalMax(-1)
+{
+}
+
+double CurveLodPyramid::toU(double key) const
+{
+    return m_logKey ? std::log10(key) : key;
+}
+
+void CurveLodPyramid::setData(const QVector<double>& x, const QVector<double>& y, bool logKey)
+{
+    const int n = qMin(x.size(), y.size());
+
+    // 常见情况：key 已升序且全为有限值，直接与调用方共享数组 (隐式共享，不复制)
+    bool clean = true;
+    for (int i = 0; i < n && clean; ++i) clean = std::isfinite(x[i]) && (i == 0 || x[i - 1] <= x[i]);
+    if (clean) {
+        m_x = x.size() == n ? x : x.mid(0, n);
+        m_y = y.size() == n ? y : y.mid(0, n);
+        rebuild(logKey);
+        return;
+    }
+
+    QVector<int> order;
+    order.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        if (std::isfinite(x[i])) order.append(i);
+    }
+    if (!std::is_sorted(order.begin(), order.end(), [&](int a, int b) { return x[a] < x[b]; }))
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return x[a] < x[b]; });
+
+    m_x.resize(order.size());
+    m_y.resize(order.size());
+    for (int i = 0; i < order.size(); ++i) {
+        m_x[i] = x[order[i]];
+        m_y[i] = y[order[i]];
+    }
+    rebuild(logKey);
+}
+
+void CurveLodPyramid::rebuild(bool logKey)
+{
+    m_logKey = logKey;
+    m_levels.clear();
+    m_globalMin = m_globalMax = -1;
+
+    const int n = m_x.size();
+    m_first = logKey ? int(std::upper_bound(m_x.constBegin(), m_x.constEnd(), 0.0) - m_x.constBegin()) : 0;
+    const int count = n - m_first;
+    if (count <= 0) return;
+
+    int buckets = 1;
+    while (buckets < count / 4 && buckets < kMaxBaseBuckets) buckets <<= 1;
+
+    m_uMin = toU(m_x[m_first]);
+    const double span = toU(m_x[n - 1]) - m_uMin;
+    m_bucketWidth = span > 0.0 ? span / buckets : 1.0;
+
+    // 1. 第 0 层：逐点归桶
+    QVector<int> level(2 * buckets, -1);
+    for (int i = m_first; i < n; ++i) {
+        if (!std::isfinite(m_y[i])) continue;
+        const int b = qMin(buckets - 1, int((toU(m_x[i]) - m_uMin) / m_bucketWidth));
+        int& lo = level[2 * b];
+        int& hi = level[2 * b + 1];
+        if (lo < 0 || m_y[i] < m_y[lo]) lo = i;
+        if (hi < 0 || m_y[i] > m_y[hi]) hi = i;
+    }
+    m_levels.append(level);
+
+    // 2. 逐层两两合并
+    while (m_levels.last().size() > 2) {
+        const QVector<int>& fine = m_levels.last();
+        QVector<int> coarse(fine.size() / 2, -1);
+        for (int b = 0; b < coarse.size() / 2; ++b) {
+            for (int c = 2 * b; c <= 2 * b + 1; ++c) {
+                const int lo = fine[2 * c], hi = fine[2 * c + 1];
+                if (lo < 0) continue;
+                if (coarse[2 * b] < 0 || m_y[lo] < m_y[coarse[2 * b]]) coarse[2 * b] = lo;
+                if (coarse[2 * b + 1] < 0 || m_y[hi] > m_y[coarse[2 * b + 1]]) coarse[2 * b + 1] = hi;
+            }
+        }
+        m_levels.append(coarse);
+    }
+    m_globalMin = m_levels.last()[0];
+    m_globalMax = m_levels.last()[1];
+}
+
+void CurveLodPyramid::sample(double lower, double upper, int pixels, QVector<double>& outX, QVector<double>& outY) const
+{
+    outX.clear();
+    outY.clear();
+    const int n = m_x.size();
+    if (n - m_first <= 0) return;
+    pixels = qMax(1, pixels);
+
+    // 首尾点与全局极值点：保持 rescaleAxes 的范围
+    QVector<int> picks = { m_first, n - 1 };
+    if (m_globalMin >= 0) picks << m_globalMin << m_globalMax;
+
+    if (m_logKey && lower <= 0.0) lower = m_x[m_first];
+    if (!(upper >= lower)) upper = lower;
+
+    const double* begin = m_x.constData() + m_first;
+    const double* end = m_x.constData() + n;
+    const int i0 = qMax(m_first, int(std::lower_bound(begin, end, lower) - m_x.constData()) - 1);
+    const int i1 = qMin(n - 1, int(std::upper_bound(begin, end, upper) - m_x.constData()));
+
+    if (i1 - i0 + 1 <= 4 * pixels || m_levels.isEmpty()) {
+        // 可见点不多：输出原始点
+        picks.reserve(picks.size() + i1 - i0 + 1);
+        for (int i = i0; i <= i1; ++i) picks.append(i);
+    } else {
+        // 选取桶宽不超过一个像素的最粗层
+        const double uLo = toU(lower), uHi = toU(upper);
+        const double wanted = (uHi - uLo) / pixels;
+        int L = 0;
+        while (L + 1 < m_levels.size() && m_bucketWidth * double(1 << (L + 1)) <= wanted) ++L;
+        const double width = m_bucketWidth * double(1 << L);
+        const QVector<int>& level = m_levels[L];
+        const int nb = level.size() / 2;
+        const int b0 = qBound(0, int(std::floor((uLo - m_uMin) / width)) - 1, nb - 1);
+        const int b1 = qBound(0, int(std::floor((uHi - m_uMin) / width)) + 1, nb - 1);
+
+        picks.reserve(picks.size() + 2 * (b1 - b0 + 1) + 2);
+        picks << i0 << i1;
+        for (int b = b0; b <= b1; ++b) {
+            if (level[2 * b] < 0) continue;
+            picks << level[2 * b] << level[2 * b + 1];
+        }
+    }
+
+    std::sort(picks.begin(), picks.end());
+    picks.erase(std::unique(picks.begin(), picks.end()), picks.end());
+    outX.reserve(picks.size());
+    outY.reserve(picks.size());
+    for (int i : picks) {
+        outX.append(m_x[i]);
+        outY.append(m_y[i]);
+    }
+}
+
+// ============================================================================
+// CurveLod
+// ============================================================================
+
+CurveLod::CurveLod(QCPGraph* graph)
+    : QObject(graph)
+    , m_graph(graph)
+    , m_lastLower(0.0)
+    , m_lastUpper(0.0)
+    , m_lastPixels(-1)
+{
+    connect(graph->parentPlot(), &QCustomPlot::afterLayout, this, &CurveLod::onAfterLayout);
+}
+
+void CurveLod::setGraphData(QCPGraph* graph, const QVector<double>& x, const QVector<double>& y)
+{
+    if (!graph) return;
+    CurveLod* lod = graph->findChild<CurveLod*>(QString(), Qt::FindDirectChildrenOnly);
+
+    if (qMin(x.size(), y.size()) <= PointThreshold) {
+        delete lod;
+        graph->setData(x, y);
+        return;
+    }
+
+    if (!lod) lod = new CurveLod(graph);
+    QCPAxis* keyAxis = graph->keyAxis();
+    lod->m_pyramid.setData(x, y, keyAxis && keyAxis->scaleType() == QCPAxis::stLogarithmic);
+    lod->m_lastPixels = -1;
+
+    // 数据已由金字塔抽稀，关闭 QCustomPlot 按线性 key 的自适应采样
+    graph->setAdaptiveSampling(false);
+    lod->onAfterLayout();
+}
+
+void CurveLod::onAfterLayout()
+{
+    if (!m_graph) return;
+    QCPAxis* keyAxis = m_graph->keyAxis();
+    if (!keyAxis) return;
+
+    const bool logKey = keyAxis->scaleType() == QCPAxis::stLogarithmic;
+    if (logKey != m_pyramid.isLogKey()) {
+        m_pyramid.rebuild(logKey);
+        m_lastPixels = -1;
+    }
+
+    // 布局尚未完成 (宽度为 0) 时按常见屏幕宽度取样
+    int pixels = keyAxis->orientation() == Qt::Horizontal ? keyAxis->axisRect()->width() : keyAxis->axisRect()->height();
+    if (pixels <= 0) pixels = 1920;
+
+    const QCPRange range = keyAxis->range();
+    if (range.lower == m_lastLower && range.upper == m_lastUpper && pixels == m_lastPixels) return;
+    m_lastLower = range.lower;
+    m_lastUpper = range.upper;
+    m_lastPixels = pixels;
+
+    QVector<double> x, y;
+    m_pyramid.sample(range.lower, range.upper, pixels, x, y);
+    m_graph->setData(x, y, true);
+}
@@ -0,0 +1,77 @@
+/*
+ * 文件名: curvelod.h
+ * 文件作用: 大数据量曲线的多分辨率降采样 (LOD) 头文件
+ * 功能描述:
+ * 1. CurveLodPyramid：数据按 key 排序后，在 key 空间 (对数轴取 log10) 等宽分桶，
+ *    逐层两两合并，每个桶只记录最小值点和最大值点的下标，构建一次 O(n)。
+ * 2. 查询时按可见范围和像素宽度选层，每像素约一个桶输出极值点；
+ *    可见点数不多时直接输出原始点，放大后细节完整。
+ * 3. 输出中始终包含首尾点和全局极值点，rescaleAxes 得到的范围与完整数据一致。
+ * 4. CurveLod：挂接到 QCPGraph 上，在每次重绘布局完成后按当前视图刷新图形数据，
+ *    平移、缩放、改变窗口大小或切换坐标轴类型时自动更新。
+ */
+
+#ifndef CURVELOD_H
+#define CURVELOD_H
+
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+#include "qcustomplot.h"
+
+class CurveLodPyramid
+{
+public:
+    CurveLodPyramid();
+
+    // 载入数据并按给定坐标类型建塔；key 已升序时与调用方共享数组，否则复制并稳定排序
+    void setData(const QVector<double>& x, const QVector<double>& y, bool logKey);
+    // 坐标类型改变时重建金字塔 (数据不变)
+    void rebuild(bool logKey);
+
+    bool isLogKey() const { return m_logKey; }
+    int size() const { return m_x.size(); }
+
+    // 可见 key 范围 [lower, upper] 在 pixels 像素宽度下的降采样结果 (key 升序)
+    void sample(double lower, double upper, int pixels, QVector<double>& outX, QVector<double>& outY) const;
+
+private:
+    double toU(double key) const;
+
+    QVector<double> m_x;            // 按 key 升序
+    QVector<double> m_y;
+    bool m_logKey;
+    int m_first;                    // 参与分桶的第一个点 (对数轴跳过 key <= 0)
+    double m_uMin;
+    double m_bucketWidth;           // 第 0 层桶宽 (u 空间)
+    QVector<QVector<int>> m_levels; // 每层每桶 [最小值下标, 最大值下标]，空桶为 -1
+    int m_globalMin;
+    int m_globalMax;
+};
+
+class CurveLod : public QObject
+{
+    Q_OBJECT
+public:
+    // 点数超过该值时启用 LOD
+    static const int PointThreshold = 20000;
+
+    // 替代 QCPGraph::setData：小数据直接设置，大数据挂接 LOD 按视图降采样
+    static void setGraphData(QCPGraph* graph, const QVector<double>& x, const QVector<double>& y);
+
+private slots:
+    void onAfterLayout();
+
+private:
+    explicit CurveLod(QCPGraph* graph);
+
+    QPointer<QCPGraph> m_graph;
+    CurveLodPyramid m_pyramid;
+
+    // 上一次降采样时的视图状态，未变化时跳过
+    double m_lastLower;
+    double m_lastUpper;
+    int m_lastPixels;
+};
+
+#endif // CURVELOD_H
@@ -0,0 +1,131 @@
+/*
+ * 文件名: curvepreviewservice.cpp
+ * 文件作用: 拟合界面理论曲线实时预览服务实现文件
+ * 功能描述:
+ * 1. 粗略阶段在观测时间范围内取 40 个对数均匀时间点，Stehfest 不超过 4 项；时间点本来就少时直接算最终曲线。
+ * 2. 最终阶段与原同步预览一致 (图版可用时按图版插值)。
+ * 3. 两个阶段在同一个后台任务中依次执行，结果经队列信号按代号送回界面线程。
+ */
+
+#include "curvepreviewservice.h"
+
+#include <QtConcurrent>
+#include <cmath>
+#include <limits>
+
+namespace {
+const int kDefaultDebounceMs = 120;
+const int kCoarsePoints = 40;
+const double kCoarseTerms = 4.0;
+
+// 粗略阶段的时间轴：覆盖原时间范围的对数均匀点
+QVector<double> coarseTimeSteps(const QVector<double>& time)
+{
+    if (time.size() <= kCoarsePoints) return time;
+    double tMin = std::numeric_limits<double>::infinity(), tMax = 0.0;
+    for (double t : time) {
+        if (!(t > 0.0)) continue;
+        tMin = std::min(tMin, t);
+        tMax = std::max(tMax, t);
+    }
+    if (!(tMax > tMin)) return time;
+    return ModelManager::generateLogTimeSteps(kCoarsePoints, std::log10(tMin), std::log10(tMax));
+}
+} // namespace
+
+CurvePreviewService::CurvePreviewService(QObject* parent)
+    : QObject(parent)
+    , m_modelManager(nullptr)
+    , m_generation(0)
+{
+    qRegisterMetaType<ModelCurveData>("ModelCurveData");
+    m_debounceTimer.setSingleShot(true);
+    m_debounceTimer.setInterval(kDefaultDebounceMs);
+    connect(&m_debounceTimer, &QTimer::timeout, this, &CurvePreviewService::onDebounceTimeout);
+    connect(this, &CurvePreviewService::stageReady, this, &CurvePreviewService::onStageReady, Qt::QueuedConnection);
+}
+
+CurvePreviewService::~CurvePreviewService()
+{
+    cancel();
+}
+
+void CurvePreviewService::request(ModelManager::ModelType type, const QMap<QString, double>& params,
+                                  const QVector<double>& time, const RateSchedule& schedule)
+{
+    m_pending.type = type;
+    m_pending.params = params;
+    m_pending.time = time;
+    m_pending.schedule = schedule;
+    // 旧计算立即停止，不必等到停顿结束
+    if (m_control) m_control->cancelled = true;
+    m_debounceTimer.start();
+}
+
+void CurvePreviewService::requestNow(ModelManager::ModelType type, const QMap<QString, double>& params,
+                                     const QVector<double>& time, const RateSchedule& schedule)
+{
+    m_debounceTimer.stop();
+    Request r;
+    r.type = type;
+    r.params = params;
+    r.time = time;
+    r.schedule = schedule;
+    start(r);
+}
+
+void CurvePreviewService::cancel()
+{
+    m_debounceTimer.stop();
+    stopRunning();
+}
+
+void CurvePreviewService::onDebounceTimeout()
+{
+    start(m_pending);
+}
+
+void CurvePreviewService::stopRunning()
+{
+    if (m_control) m_control->cancelled = true;
+    m_future.waitForFinished();
+    ++m_generation; // 使已排队的结果失效
+    m_control.reset();
+}
+
+void CurvePreviewService::start(const Request& request)
+{
+    stopRunning();
+    if (!m_modelManager) return;
+
+    m_control = std::make_shared<SolveControl>();
+    const quint64 generation = ++m_generation;
+    std::shared_ptr<SolveControl> control = m_control;
+    ModelManager* manager = m_modelManager;
+    m_future = QtConcurrent::run(ModelManager::solverPool(), [this, manager, request, control, generation]() {
+        // 1. 粗略曲线
+        const QVector<double> coarseTime = coarseTimeSteps(request.time);
+        if (coarseTime.size() < request.time.size()) {
+            QMap<QString, double> coarseParams = request.params;
+            coarseParams["N"] = qMin(request.params.value("N", kCoarseTerms), kCoarseTerms);
+            ModelCurveData coarse = manager->calculatePreviewCurve(request.type, coarseParams, coarseTime,
+                                                                   request.schedule, control.get());
+            if (control->cancelled) return;
+            emit stageReady(generation, request.params, coarse, false);
+        }
+
+        // 2. 最终曲线
+        ModelCurveData curve = manager->calculatePreviewCurve(request.type, request.params, request.time,
+                                                              request.schedule, control.get());
+        if (control->cancelled) return;
+        emit stageReady(generation, request.params, curve, true);
+    });
+}
+
+void CurvePreviewService::onStageReady(quint64 generation, const QMap<QString, double>& params,
+                                       const ModelCurveData& curve, bool final)
+{
+    if (generation != m_generation) return;
+    if (final) m_control.reset();
+    emit previewReady(params, curve, final);
+}
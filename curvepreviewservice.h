@@ -0,0 +1,73 @@
+/*
+ * 文件名: curvepreviewservice.h
+ * 文件作用: 拟合界面理论曲线实时预览服务头文件
+ * 功能描述:
+ * 1. 参数修改后先等待短暂停顿 (去抖)，连续修改只计算最后一次。
+ * 2. 计算在模型求解线程池中进行，新的请求到来时取消尚未完成的旧计算。
+ * 3. 渐进式显示：先用少量对数时间点 + 低阶 Stehfest 给出粗略曲线，再按完整时间轴计算最终曲线。
+ */
+
+#ifndef CURVEPREVIEWSERVICE_H
+#define CURVEPREVIEWSERVICE_H
+
+#include <QObject>
+#include <QMap>
+#include <QVector>
+#include <QFuture>
+#include <QTimer>
+#include <memory>
+#include "modelmanager.h"
+
+class CurvePreviewService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CurvePreviewService(QObject* parent = nullptr);
+    ~CurvePreviewService();
+
+    void setModelManager(ModelManager* manager) { m_modelManager = manager; }
+    // 去抖间隔 (毫秒)
+    void setDebounceInterval(int ms) { m_debounceTimer.setInterval(ms); }
+
+    // 参数修改后调用：停顿 debounce 间隔后开始计算
+    void request(ModelManager::ModelType type, const QMap<QString, double>& params,
+                 const QVector<double>& time, const RateSchedule& schedule);
+    // 立即开始计算 (按钮、切换模型等一次性操作)
+    void requestNow(ModelManager::ModelType type, const QMap<QString, double>& params,
+                    const QVector<double>& time, const RateSchedule& schedule);
+    // 取消待计算与正在计算的预览，已排队的结果不再送达
+    void cancel();
+
+signals:
+    // final 为 false 时是粗略曲线，随后还会送达最终曲线
+    void previewReady(const QMap<QString, double>& params, const ModelCurveData& curve, bool final);
+    // 工作线程发出，以队列方式送达 onStageReady
+    void stageReady(quint64 generation, const QMap<QString, double>& params, const ModelCurveData& curve, bool final);
+
+private slots:
+    void onDebounceTimeout();
+    void onStageReady(quint64 generation, const QMap<QString, double>& params, const ModelCurveData& curve, bool final);
+
+private:
+    struct Request {
+        ModelManager::ModelType type = ModelManager::Model_1;
+        QMap<QString, double> params;
+        QVector<double> time;
+        RateSchedule schedule;
+    };
+
+    void start(const Request& request);
+    // 取消并等待后台计算 (求解器逐点检查取消标记，等待时间很短)
+    void stopRunning();
+
+    ModelManager* m_modelManager;
+    QTimer m_debounceTimer;
+    Request m_pending;
+
+    QFuture<void> m_future;
+    std::shared_ptr<SolveControl> m_control;
+    quint64 m_generation;       // 每次启动/取消加一，过期结果直接丢弃
+};
+
+#endif // CURVEPREVIEWSERVICE_H
@@ -0,0 +1,164 @@
+/*
+ * 文件名: curvestore.cpp
+ * 文件作用: 绘图曲线数据二进制存储实现文件
+ * 功能描述:
+ * 1. write: 逐个数组写出名称与数据块，小端主机直接写出 QVector 内存。
+ * 2. open: 映射整个文件，依次跳过数据块记录每个数组的偏移与长度 (校验边界)。
+ * 3. array: 从映射内存整块拷贝一个数组。
+ */
+
+#include "curvestore.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+const char kMagic[4] = { 'W', 'T', 'C', 'V' };
+const int kHeaderSize = 16;
+
+int paddingTo8(qint64 offset)
+{
+    return int((8 - offset % 8) % 8);
+}
+
+} // namespace
+
+CurveStore::CurveStore() : m_data(nullptr), m_size(0) {}
+
+CurveStore::~CurveStore()
+{
+    close();
+}
+
+QString CurveStore::arrayName(const QString& curveName, const QString& field)
+{
+    return curveName + "/" + field;
+}
+
+bool CurveStore::write(const QString& path, const ArrayMap& arrays, QString* error)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = "无法写入曲线数据文件: " + file.errorString();
+        return false;
+    }
+
+    QByteArray header(kHeaderSize, '\0');
+    char* p = header.data();
+    memcpy(p, kMagic, 4);
+    qToLittleEndian<quint16>(kFormatVersion, p + 4);
+    qToLittleEndian<quint16>(0, p + 6);
+    qToLittleEndian<quint32>(quint32(arrays.size()), p + 8);
+    qToLittleEndian<quint32>(0, p + 12);
+    file.write(header);
+    qint64 offset = kHeaderSize;
+
+    for (auto it = arrays.constBegin(); it != arrays.constEnd(); ++it) {
+        const QByteArray name = it.key().toUtf8();
+        const QVector<double>& values = it.value();
+
+        QByteArray head(4, '\0');
+        qToLittleEndian<quint32>(quint32(name.size()), head.data());
+        head += name;
+        head += QByteArray(paddingTo8(offset + head.size()), '\0');
+        QByteArray count(8, '\0');
+        qToLittleEndian<quint64>(quint64(values.size()), count.data());
+        head += count;
+        file.write(head);
+        offset += head.size();
+
+        const qint64 bytes = qint64(values.size()) * qint64(sizeof(double));
+        if (QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
+            file.write(reinterpret_cast<const char*>(values.constData()), bytes);
+        } else {
+            QByteArray block(int(bytes), '\0');
+            for (int i = 0; i < values.size(); ++i) qToLittleEndian<double>(values[i], block.data() + i * sizeof(double));
+            file.write(block);
+        }
+        offset += bytes;
+    }
+
+    if (!file.commit()) {
+        if (error) *error = "曲线数据文件写入失败: " + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool CurveStore::open(const QString& path, QString* error)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = "无法打开曲线数据文件: " + m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    m_data = m_size >= kHeaderSize ? m_file.map(0, m_size) : nullptr;
+    if (!m_data || memcmp(m_data, kMagic, 4) != 0) {
+        if (error) *error = "曲线数据文件格式错误";
+        close();
+        return false;
+    }
+    if (qFromLittleEndian<quint16>(m_data + 4) > kFormatVersion) {
+        if (error) *error = "曲线数据文件版本过新";
+        close();
+        return false;
+    }
+
+    const quint32 count = qFromLittleEndian<quint32>(m_data + 8);
+    qint64 offset = kHeaderSize;
+    for (quint32 a = 0; a < count; ++a) {
+        if (offset + 4 > m_size) break;
+        const qint64 nameSize = qFromLittleEndian<quint32>(m_data + offset);
+        offset += 4;
+        if (offset + nameSize > m_size) break;
+        const QString name = QString::fromUtf8(reinterpret_cast<const char*>(m_data + offset), int(nameSize));
+        offset += nameSize;
+        offset += paddingTo8(offset);
+        if (offset + 8 > m_size) break;
+        const quint64 valueCount = qFromLittleEndian<quint64>(m_data + offset);
+        offset += 8;
+        if (valueCount > quint64(m_size - offset) / sizeof(double)) break;
+
+        Entry entry;
+        entry.offset = offset;
+        entry.count = qint64(valueCount);
+        m_index.insert(name, entry);
+        offset += entry.count * qint64(sizeof(double));
+    }
+
+    if (m_index.size() != int(count)) {
+        if (error) *error = "曲线数据文件不完整";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void CurveStore::close()
+{
+    if (m_data) m_file.unmap(const_cast<uchar*>(m_data));
+    m_data = nullptr;
+    if (m_file.isOpen()) m_file.close();
+    m_size = 0;
+    m_index.clear();
+}
+
+QVector<double> CurveStore::array(const QString& name) const
+{
+    const auto it = m_index.constFind(name);
+    if (!m_data || it == m_index.constEnd()) return QVector<double>();
+
+    QVector<double> values(static_cast<int>(it->count));
+    const uchar* src = m_data + it->offset;
+    if (QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
+        memcpy(values.data(), src, size_t(it->count) * sizeof(double));
+    } else {
+        for (int i = 0; i < values.size(); ++i) values[i] = qFromLittleEndian<double>(src + i * sizeof(double));
+    }
+    return values;
+}
@@ -0,0 +1,65 @@
+/*
+ * 文件名: curvestore.h
+ * 文件作用: 绘图曲线数据二进制存储头文件
+ * 功能描述:
+ * 1. 定义 "_chart.wtc" 文件格式：按名称存放若干 double 数组 (如 "曲线名/xData")，
+ *    _chart.json 只保留曲线配置，数据点不再逐个转换为 JSON 数值。
+ * 2. 数组以小端 double 原样写入，读取时整块拷贝到 QVector，读出的数组由曲线配置和
+ *    LOD 金字塔以隐式共享方式共用，不再各自持有副本。
+ * 3. open 只映射文件并扫描各数组的名称与位置 (不读数据)，array() 在曲线显示时才按需解码，
+ *    打开含大量曲线的项目时不加载任何数据点。
+ *
+ * 文件布局:
+ *   [文件头 16 字节] magic "WTCV" | version u16 | reserved u16 | arrayCount u32 | reserved u32
+ *   [数组 ...] nameSize u32 | name UTF-8 | 补齐到 8 字节 | valueCount u64 | values (double × valueCount)
+ */
+
+#ifndef CURVESTORE_H
+#define CURVESTORE_H
+
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+class CurveStore
+{
+public:
+    typedef QMap<QString, QVector<double>> ArrayMap;
+
+    static const quint16 kFormatVersion = 1;
+
+    CurveStore();
+    ~CurveStore();
+
+    // 写入全部数组 (QSaveFile 原子替换；目标文件正被打开时须先 close)
+    static bool write(const QString& path, const ArrayMap& arrays, QString* error = nullptr);
+
+    // 打开文件：映射文件并建立数组索引，不解码任何数据
+    bool open(const QString& path, QString* error = nullptr);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    bool contains(const QString& name) const { return m_index.contains(name); }
+    // 按需读取一个数组，不存在时返回空数组
+    QVector<double> array(const QString& name) const;
+
+    // 数组名称: "曲线名/字段名"
+    static QString arrayName(const QString& curveName, const QString& field);
+
+private:
+    struct Entry {
+        qint64 offset = 0;
+        qint64 count = 0;
+    };
+
+    QFile m_file;
+    const uchar* m_data;
+    qint64 m_size;
+    QHash<QString, Entry> m_index;
+
+    Q_DISABLE_COPY(CurveStore)
+};
+
+#endif // CURVESTORE_H
@@ -6,9 +6,13 @@
  * 2. 实现核心的时间数据解析和转换算法。
  * 3. 实现基于压力列的压降计算算法。
  * 4. 实现井底流压计算弹窗及核心算法 (基于 MATLAB 逻辑)。
+ * 5. 实现表达式计算列：编译表达式后按块并行求值，输入变化时只重算受影响的行。
+ * 6. 计算列重算只改写已有单元格的值 (屏蔽逐格信号，按变化的连续行段发出 dataChanged)，
+ *    不删除/插入列；整列替换只用于首次生成。
  */
 
 #include "datacalculate.h"
+#include "columnexpression.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
@@ -17,6 +21,9 @@
 #include <QDebug>
 #include <QDateTime>
 #include <cmath>
+#include <limits>
+#include <atomic>
+#include <QtConcurrent>
 
 // ============================================================================
 // TimeConversionDialog 实现
@@ -274,12 +281,342 @@ PwfCalculationConfig PwfCalculationDialog::getConfig() const
     return c;
 }
 
+// ============================================================================
+// ExpressionColumnDialog 实现
+// ============================================================================
+
+ExpressionColumnDialog::ExpressionColumnDialog(const QStringList& columnNames, QWidget* parent)
+    : QDialog(parent), m_columnNames(columnNames)
+{
+    setWindowTitle("表达式计算列");
+    resize(520, 520);
+    setStyleSheet("QDialog { background-color: white; color: black; font-family: \"Microsoft YaHei\", Arial; } "
+                  "QLabel { color: black; background: transparent; font-weight: normal;} "
+                  "QGroupBox { color: black; border: 1px solid #ccc; margin-top: 10px; font-weight: bold; } "
+                  "QLineEdit, QPlainTextEdit, QListWidget { background-color: white; border: 1px solid #ccc; padding: 2px; } "
+                  "QSpinBox { background-color: white; border: 1px solid #ccc; padding: 2px; } "
+                  "QPushButton { color: white; background-color: #4a90e2; border: none; border-radius: 4px; padding: 6px 12px; } "
+                  "QPushButton:hover { background-color: #357abd; }");
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    // 表达式
+    QGroupBox* exprGroup = new QGroupBox("表达式");
+    QVBoxLayout* exprLayout = new QVBoxLayout(exprGroup);
+    m_expressionEdit = new QLineEdit;
+    m_expressionEdit->setPlaceholderText("例如: Pwf = Pc + (Hres - Lwf) * rho * g / 1e6");
+    QLabel* hint = new QLabel("列名可直接引用 (含单位的列可省略 \"\\单位\"，含特殊字符时写作 [列名])；\n"
+                              "支持 + - * / ^ 及 sqrt ln log exp abs sin cos tan min max pow，内置常量 pi e g。");
+    hint->setStyleSheet("color: #666;");
+    exprLayout->addWidget(m_expressionEdit);
+    exprLayout->addWidget(hint);
+    mainLayout->addWidget(exprGroup);
+
+    // 可用列 + 常量
+    QHBoxLayout* midLayout = new QHBoxLayout;
+    QGroupBox* colGroup = new QGroupBox("数据列 (双击插入)");
+    QVBoxLayout* colLayout = new QVBoxLayout(colGroup);
+    m_columnList = new QListWidget;
+    m_columnList->addItems(m_columnNames);
+    colLayout->addWidget(m_columnList);
+    midLayout->addWidget(colGroup);
+
+    QGroupBox* varGroup = new QGroupBox("常量 (每行 名称 = 数值)");
+    QVBoxLayout* varLayout = new QVBoxLayout(varGroup);
+    m_variablesEdit = new QPlainTextEdit;
+    m_variablesEdit->setPlaceholderText("Hres = 1822\nrho = 850");
+    varLayout->addWidget(m_variablesEdit);
+    midLayout->addWidget(varGroup);
+    mainLayout->addLayout(midLayout);
+
+    // 结果设置
+    QGroupBox* resGroup = new QGroupBox("结果设置");
+    QFormLayout* formRes = new QFormLayout(resGroup);
+    m_spinDecimal = new QSpinBox;
+    m_spinDecimal->setRange(0, 10);
+    m_spinDecimal->setValue(3);
+    m_spinDecimal->setSuffix(" 位");
+    formRes->addRow("保留小数位数:", m_spinDecimal);
+    mainLayout->addWidget(resGroup);
+
+    m_statusLabel = new QLabel;
+    m_statusLabel->setWordWrap(true);
+    mainLayout->addWidget(m_statusLabel);
+
+    // 底部按钮
+    QHBoxLayout* btnLayout = new QHBoxLayout;
+    QPushButton* btnCheck = new QPushButton("检查");
+    btnLayout->addWidget(btnCheck);
+    btnLayout->addStretch();
+    QPushButton* btnOk = new QPushButton("计算");
+    QPushButton* btnCancel = new QPushButton("取消");
+    btnOk->setStyleSheet("background-color: #28a745; color: white;");
+    btnCancel->setStyleSheet("background-color: #6c757d; color: white;");
+
+    connect(btnCheck, &QPushButton::clicked, this, &ExpressionColumnDialog::onCheckClicked);
+    connect(btnOk, &QPushButton::clicked, this, &ExpressionColumnDialog::onAcceptClicked);
+    connect(btnCancel, &QPushButton::clicked, this, &QDialog::reject);
+    connect(m_columnList, &QListWidget::itemDoubleClicked, this, &ExpressionColumnDialog::onColumnDoubleClicked);
+
+    btnLayout->addWidget(btnOk);
+    btnLayout->addWidget(btnCancel);
+    mainLayout->addLayout(btnLayout);
+}
+
+ExpressionColumnConfig ExpressionColumnDialog::getConfig() const
+{
+    ExpressionColumnConfig c;
+    c.expression = m_expressionEdit->text().trimmed();
+    c.decimalPlaces = m_spinDecimal->value();
+    const QStringList lines = m_variablesEdit->toPlainText().split('\n', Qt::SkipEmptyParts);
+    for (const QString& line : lines) {
+        int eq = line.indexOf('=');
+        if (eq <= 0) continue;
+        bool ok = false;
+        double v = line.mid(eq + 1).trimmed().toDouble(&ok);
+        if (ok) c.variables[line.left(eq).trimmed()] = v;
+    }
+    return c;
+}
+
+bool ExpressionColumnDialog::validate()
+{
+    const QStringList lines = m_variablesEdit->toPlainText().split('\n', Qt::SkipEmptyParts);
+    for (const QString& line : lines) {
+        int eq = line.indexOf('=');
+        bool ok = false;
+        if (eq > 0) line.mid(eq + 1).trimmed().toDouble(&ok);
+        if (!ok && !line.trimmed().isEmpty()) {
+            m_statusLabel->setText(QString("<font color='red'>常量格式错误: %1</font>").arg(line.trimmed()));
+            return false;
+        }
+    }
+
+    ExpressionColumnConfig cfg = getConfig();
+    ColumnExpression expr;
+    QString err;
+    if (!expr.compile(cfg.expression, &err) || !expr.bind(m_columnNames, cfg.variables, &err)) {
+        m_statusLabel->setText(QString("<font color='red'>%1</font>").arg(err.toHtmlEscaped()));
+        return false;
+    }
+    QString target = expr.targetName().isEmpty() ? "计算列" : expr.targetName();
+    m_statusLabel->setText(QString("<font color='green'>表达式有效：引用 %1 列，结果写入 \"%2\"</font>")
+                               .arg(expr.inputColumns().size()).arg(target.toHtmlEscaped()));
+    return true;
+}
+
+void ExpressionColumnDialog::onCheckClicked()
+{
+    validate();
+}
+
+void ExpressionColumnDialog::onAcceptClicked()
+{
+    if (validate()) accept();
+}
+
+void ExpressionColumnDialog::onColumnDoubleClicked(QListWidgetItem* item)
+{
+    if (!item) return;
+    m_expressionEdit->insert("[" + item->text() + "]");
+    m_expressionEdit->setFocus();
+}
+
 // ============================================================================
 // DataCalculate 实现
 // ============================================================================
 
+namespace {
+
+// 采样检测得到的时间列固定格式: [yyyy{sep}M{sep}d][空格/T][h:mm[:ss[.fff]]]
+struct StampFormat {
+    bool hasDate = false;
+    QChar dateSep = QLatin1Char('-');
+    bool hasTime = false;
+};
+
+// 单个时间戳的解析结果: 距 1970-01-01 的天数 + 当日秒数 (含小数)
+struct ParsedStamp {
+    qint64 days = 0;
+    double secs = 0.0;
+    bool hasDate = false;
+};
+
+// 公历日期转换为距 1970-01-01 的天数 (不经过 QDate)
+qint64 daysFromCivil(int y, int m, int d)
+{
+    y -= (m <= 2);
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return qint64(era) * 146097 + doe - 719468;
+}
+
+bool validDate(int y, int m, int d)
+{
+    static const int kDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (m < 1 || m > 12 || d < 1) return false;
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return d <= kDays[m - 1] + ((m == 2 && leap) ? 1 : 0);
+}
+
+inline bool readInt(const QChar*& p, const QChar* end, int minDigits, int maxDigits, int& value)
+{
+    value = 0;
+    int n = 0;
+    while (p < end && n < maxDigits && p->unicode() >= '0' && p->unicode() <= '9') {
+        value = value * 10 + (p->unicode() - '0');
+        ++p;
+        ++n;
+    }
+    return n >= minDigits;
+}
+
+// 按固定格式解析，不分配内存；格式不符返回 false
+bool parseStamp(QStringView s, const StampFormat& fmt, ParsedStamp& out)
+{
+    const QChar* p = s.data();
+    const QChar* end = p + s.size();
+    while (p < end && p->isSpace()) ++p;
+    while (end > p && (end - 1)->isSpace()) --end;
+    if (p == end) return false;
+
+    out = ParsedStamp();
+    if (fmt.hasDate) {
+        int y, m, d;
+        if (!readInt(p, end, 4, 4, y) || p >= end || *p != fmt.dateSep) return false;
+        ++p;
+        if (!readInt(p, end, 1, 2, m) || p >= end || *p != fmt.dateSep) return false;
+        ++p;
+        if (!readInt(p, end, 1, 2, d) || !validDate(y, m, d)) return false;
+        out.days = daysFromCivil(y, m, d);
+        out.hasDate = true;
+        if (fmt.hasTime) {
+            if (p >= end || !(p->isSpace() || *p == QLatin1Char('T'))) return false;
+            while (p < end && (p->isSpace() || *p == QLatin1Char('T'))) ++p;
+        }
+    }
+    if (fmt.hasTime) {
+        int h, mi, sec = 0;
+        if (!readInt(p, end, 1, 2, h) || h > 23 || p >= end || *p != QLatin1Char(':')) return false;
+        ++p;
+        if (!readInt(p, end, 2, 2, mi) || mi > 59) return false;
+        double frac = 0.0;
+        if (p < end && *p == QLatin1Char(':')) {
+            ++p;
+            if (!readInt(p, end, 2, 2, sec) || sec > 59) return false;
+            if (p < end && (*p == QLatin1Char('.') || *p == QLatin1Char(','))) {
+                ++p;
+                double scale = 0.1;
+                const QChar* start = p;
+                while (p < end && p->unicode() >= '0' && p->unicode() <= '9') {
+                    frac += (p->unicode() - '0') * scale;
+                    scale *= 0.1;
+                    ++p;
+                }
+                if (p == start) return false;
+            }
+        }
+        out.secs = h * 3600.0 + mi * 60.0 + sec + frac;
+    }
+    return p == end;
+}
+
+// 在样本上检测格式：依次尝试候选格式，取样本全部 (非空) 都能解析的第一个
+bool detectStampFormat(const QVector<QString>& texts, int sampleSize, StampFormat& fmt)
+{
+    QVector<QStringView> samples;
+    for (int i = 0; i < texts.size() && samples.size() < sampleSize; ++i) {
+        if (!texts[i].trimmed().isEmpty()) samples.append(texts[i]);
+    }
+    if (samples.isEmpty()) return false;
+
+    QVector<StampFormat> candidates;
+    for (QChar sep : {QLatin1Char('-'), QLatin1Char('/'), QLatin1Char('.')}) {
+        StampFormat f; f.hasDate = true; f.dateSep = sep; f.hasTime = true;
+        candidates.append(f);
+        f.hasTime = false;
+        candidates.append(f);
+    }
+    StampFormat timeOnly; timeOnly.hasTime = true;
+    candidates.append(timeOnly);
+
+    for (const StampFormat& f : candidates) {
+        ParsedStamp ps;
+        bool all = true;
+        for (QStringView s : samples) {
+            if (!parseStamp(s, f, ps)) { all = false; break; }
+        }
+        if (all) { fmt = f; return true; }
+    }
+    return false;
+}
+
+// 按块并行执行 f(begin, end)
+template <typename F>
+void parallelRanges(int n, F f)
+{
+    const int kChunk = 65536;
+    if (n <= kChunk) { f(0, n); return; }
+    QVector<QPair<int, int>> ranges;
+    for (int b = 0; b < n; b += kChunk) ranges.append(qMakePair(b, qMin(n, b + kChunk)));
+    QtConcurrent::blockingMap(ranges, [&f](QPair<int, int>& r) { f(r.first, r.second); });
+}
+
+// 读取数值列，空单元格或非数值为 NaN
+QVector<double> numericColumn(QStandardItemModel* model, int col)
+{
+    QVector<double> values(model->rowCount(), std::numeric_limits<double>::quiet_NaN());
+    if (col < 0 || col >= model->columnCount()) return values;
+    for (int i = 0; i < values.size(); ++i) {
+        QStandardItem* item = model->item(i, col);
+        double v;
+        if (item && TextDataImporter::parseDouble(item->text(), v)) values[i] = v;
+    }
+    return values;
+}
+
+QVector<QString> columnTexts(QStandardItemModel* model, int col)
+{
+    QVector<QString> texts(model->rowCount());
+    if (col < 0 || col >= model->columnCount()) return texts;
+    for (int i = 0; i < texts.size(); ++i) {
+        QStandardItem* item = model->item(i, col);
+        if (item) texts[i] = item->text();
+    }
+    return texts;
+}
+
+// 对全部行并行求值 (expr 已绑定)
+QVector<double> evaluateAllRows(QStandardItemModel* model, const ColumnExpression& expr)
+{
+    const int rowCount = model->rowCount();
+    QVector<QVector<double>> inputs;
+    QVector<const double*> inputPtrs;
+    for (int col : expr.inputColumns()) {
+        inputs.append(numericColumn(model, col));
+        inputPtrs.append(inputs.last().constData());
+    }
+
+    // 分块并行求值
+    QVector<double> values(rowCount);
+    parallelRanges(rowCount, [&](int begin, int end) {
+        QVector<const double*> local = inputPtrs;
+        for (const double*& p : local) p += begin;
+        expr.evaluate(local, end - begin, values.data() + begin);
+    });
+    return values;
+}
+
+} // namespace
+
 DataCalculate::DataCalculate(QObject* parent) : QObject(parent) {}
 
+// 时间转换流程:
+// 1. 在前若干行样本上检测一次格式，之后逐行使用固定格式解析 (不符合的行回退到 QDate/QTime 解析)。
+// 2. 各行并行解析为 "天数 + 当日秒数"；仅时刻数据再顺序处理跨天 (时刻回退即视为进入下一天)。
+// 3. 相对首个有效行换算单位，并行生成单元格后整列追加到模型。
 TimeConversionResult DataCalculate::convertTimeColumn(QStandardItemModel* model,
                                                       QList<ColumnDefinition>& definitions,
                                                       const TimeConversionConfig& config)
@@ -299,9 +636,94 @@ TimeConversionResult DataCalculate::convertTimeColumn(QStandardItemModel* model,
         return result;
     }
 
-    // 在末尾插入新列
+    const int kSampleRows = 64;
+    const double kInvalid = std::numeric_limits<double>::quiet_NaN();
+    QVector<double> seconds(rowCount, kInvalid);
+    QVector<char> hasDay(rowCount, 0);
+
+    if (config.useDateAndTime) {
+        // 日期+时刻模式
+        const QVector<QString> dTexts = columnTexts(model, config.dateColumnIndex);
+        const QVector<QString> tTexts = columnTexts(model, config.timeColumnIndex);
+        StampFormat dFmt, tFmt;
+        bool dFast = detectStampFormat(dTexts, kSampleRows, dFmt) && dFmt.hasDate;
+        bool tFast = detectStampFormat(tTexts, kSampleRows, tFmt) && tFmt.hasTime;
+
+        parallelRanges(rowCount, [&](int begin, int end) {
+            ParsedStamp dp, tp;
+            for (int i = begin; i < end; ++i) {
+                qint64 days;
+                double secs;
+                if (dFast && parseStamp(dTexts[i], dFmt, dp)) {
+                    days = dp.days;
+                } else {
+                    QDate d = parseDateString(dTexts[i]);
+                    if (!d.isValid()) continue;
+                    days = d.toJulianDay() - 2440588; // 1970-01-01 的儒略日
+                }
+                if (tFast && parseStamp(tTexts[i], tFmt, tp)) {
+                    secs = tp.secs;
+                } else {
+                    QTime t = parseTimeString(tTexts[i]);
+                    if (!t.isValid()) continue;
+                    secs = t.msecsSinceStartOfDay() / 1000.0;
+                }
+                seconds[i] = days * 86400.0 + secs;
+            }
+        });
+    } else {
+        // 仅时间模式 (源列带日期时直接使用完整时间戳)
+        const QVector<QString> texts = columnTexts(model, config.sourceTimeColumnIndex);
+        StampFormat fmt;
+        bool fast = detectStampFormat(texts, kSampleRows, fmt);
+
+        parallelRanges(rowCount, [&](int begin, int end) {
+            ParsedStamp ps;
+            for (int i = begin; i < end; ++i) {
+                if (fast && parseStamp(texts[i], fmt, ps)) {
+                    seconds[i] = ps.days * 86400.0 + ps.secs;
+                    hasDay[i] = ps.hasDate;
+                } else {
+                    QTime t = parseTimeString(texts[i]);
+                    if (t.isValid()) seconds[i] = t.msecsSinceStartOfDay() / 1000.0;
+                }
+            }
+        });
+
+        // 跨天处理：不带日期的时刻比上一有效时刻小，则视为进入下一天
+        double dayOffset = 0.0;
+        double prev = kInvalid;
+        for (int i = 0; i < rowCount; ++i) {
+            if (std::isnan(seconds[i]) || hasDay[i]) continue;
+            if (!std::isnan(prev) && seconds[i] < prev) dayOffset += 86400.0;
+            prev = seconds[i];
+            seconds[i] += dayOffset;
+        }
+    }
+
+    double base = kInvalid;
+    for (int i = 0; i < rowCount && std::isnan(base); ++i) base = seconds[i];
+
+    double unitScale = convertTimeToUnit(1.0, config.outputUnit);
+    QList<QStandardItem*> items(rowCount, nullptr);
+    QStandardItem** out = items.data();
+    std::atomic<int> processed(0);
+    parallelRanges(rowCount, [&](int begin, int end) {
+        int n = 0;
+        for (int i = begin; i < end; ++i) {
+            if (std::isnan(seconds[i])) {
+                out[i] = new QStandardItem("");
+            } else {
+                out[i] = new QStandardItem(QString::number((seconds[i] - base) * unitScale, 'f', 3));
+                ++n;
+            }
+        }
+        processed += n;
+    });
+
+    // 在末尾追加新列 (一次插入整列)
     int newColIdx = model->columnCount();
-    model->insertColumn(newColIdx);
+    model->appendColumn(items);
 
     // 更新列定义
     ColumnDefinition newDef;
@@ -314,55 +736,7 @@ TimeConversionResult DataCalculate::convertTimeColumn(QStandardItemModel* model,
     // 设置表头
     model->setHorizontalHeaderItem(newColIdx, new QStandardItem(newDef.name));
 
-    // 计算逻辑
-    QDateTime baseTime;
-    bool baseSet = false;
-
-    for (int i = 0; i < rowCount; ++i) {
-        double val = 0.0;
-        bool valid = false;
-
-        if (config.useDateAndTime) {
-            // 日期+时刻模式
-            QString dStr = model->item(i, config.dateColumnIndex)->text();
-            QString tStr = model->item(i, config.timeColumnIndex)->text();
-            QDate d = parseDateString(dStr);
-            QTime t = parseTimeString(tStr);
-            if (d.isValid() && t.isValid()) {
-                QDateTime dt = combineDateAndTime(d, t);
-                if (!baseSet) { baseTime = dt; baseSet = true; }
-                double seconds = baseTime.secsTo(dt);
-                val = convertTimeToUnit(seconds, config.outputUnit);
-                valid = true;
-            }
-        } else {
-            // 仅时间模式
-            QString tStr = model->item(i, config.sourceTimeColumnIndex)->text();
-            QTime t = parseTimeString(tStr);
-            if (t.isValid()) {
-                // 如果没有日期，取当前日期与该时间组合
-                if (!baseSet) {
-                    baseTime = QDateTime(QDate::currentDate(), t);
-                    baseSet = true;
-                }
-                QDateTime dt(QDate::currentDate(), t);
-                // 处理跨天情况(简单处理: 如果时间比基准小很多，假设是第二天)
-                if (dt < baseTime) dt = dt.addDays(1);
-
-                double seconds = baseTime.secsTo(dt);
-                val = convertTimeToUnit(seconds, config.outputUnit);
-                valid = true;
-            }
-        }
-
-        if (valid) {
-            model->setItem(i, newColIdx, new QStandardItem(QString::number(val, 'f', 3)));
-            result.processedRows++;
-        } else {
-            model->setItem(i, newColIdx, new QStandardItem(""));
-        }
-    }
-
+    result.processedRows = processed;
     result.success = true;
     result.addedColumnIndex = newColIdx;
     result.columnName = newDef.name;
@@ -510,6 +884,144 @@ PwfCalculationResult DataCalculate::calculateBottomHolePressure(QStandardItemMod
     return result;
 }
 
+// 表达式计算列
+ExpressionColumnResult DataCalculate::calculateExpressionColumn(QStandardItemModel* model,
+                                                                QList<ColumnDefinition>& definitions,
+                                                                const ExpressionColumnConfig& config)
+{
+    ExpressionColumnResult result;
+    if (!model || model->rowCount() == 0) {
+        result.errorMessage = "数据表为空。";
+        return result;
+    }
+
+    QStringList headers;
+    for (int i = 0; i < model->columnCount(); ++i) headers << model->headerData(i, Qt::Horizontal).toString();
+
+    ColumnExpression expr;
+    if (!expr.compile(config.expression, &result.errorMessage)) return result;
+    if (!expr.bind(headers, config.variables, &result.errorMessage)) return result;
+
+    const int rowCount = model->rowCount();
+    const QVector<double> values = evaluateAllRows(model, expr);
+
+    QList<QStandardItem*> items(rowCount, nullptr);
+    QStandardItem** out = items.data();
+    std::atomic<int> processed(0);
+    const int decimals = config.decimalPlaces;
+    parallelRanges(rowCount, [&](int begin, int end) {
+        int n = 0;
+        for (int i = begin; i < end; ++i) {
+            if (std::isfinite(values[i])) {
+                out[i] = new QStandardItem(QString::number(values[i], 'f', decimals));
+                ++n;
+            } else {
+                out[i] = new QStandardItem("");
+            }
+        }
+        processed += n;
+    });
+
+    QString name = expr.targetName().isEmpty() ? QString("计算列") : expr.targetName();
+    int colIdx = headers.indexOf(name);
+    if (colIdx >= 0) {
+        // 覆盖已有列：整列替换，避免逐格 setItem
+        qDeleteAll(model->takeColumn(colIdx));
+        model->insertColumn(colIdx, items);
+        model->setHorizontalHeaderItem(colIdx, new QStandardItem(name));
+        if (colIdx < definitions.size()) definitions[colIdx].decimalPlaces = decimals;
+    } else {
+        colIdx = model->columnCount();
+        model->appendColumn(items);
+        model->setHorizontalHeaderItem(colIdx, new QStandardItem(name));
+
+        ColumnDefinition newDef;
+        newDef.name = name;
+        newDef.type = WellTestColumnType::Custom;
+        newDef.decimalPlaces = decimals;
+        definitions.append(newDef);
+    }
+
+    result.success = true;
+    result.addedColumnIndex = colIdx;
+    result.columnName = name;
+    result.processedRows = processed;
+    return result;
+}
+
+bool DataCalculate::recomputeExpressionColumn(QStandardItemModel* model, const ExpressionColumnConfig& config,
+                                              const QList<int>& rows, QVector<int>* changedRows, QString* error)
+{
+    if (!model) return false;
+    QStringList headers;
+    for (int i = 0; i < model->columnCount(); ++i) headers << model->headerData(i, Qt::Horizontal).toString();
+
+    ColumnExpression expr;
+    if (!expr.compile(config.expression, error) || !expr.bind(headers, config.variables, error)) return false;
+    QString name = expr.targetName().isEmpty() ? QString("计算列") : expr.targetName();
+    int colIdx = headers.indexOf(name);
+    if (colIdx < 0) {
+        if (error) *error = QString("找不到计算列 '%1'").arg(name);
+        return false;
+    }
+
+    if (rows.isEmpty()) {
+        // 整列重算：只改写文本变化的单元格，信号屏蔽后按连续变化段统一通知
+        const int rowCount = model->rowCount();
+        const QVector<double> values = evaluateAllRows(model, expr);
+        QVector<int> changed;
+        const bool blocked = model->blockSignals(true);
+        for (int r = 0; r < rowCount; ++r) {
+            QString text = std::isfinite(values[r]) ? QString::number(values[r], 'f', config.decimalPlaces) : QString();
+            QStandardItem* item = model->item(r, colIdx);
+            if (item) {
+                if (item->text() == text) continue;
+                item->setText(text);
+            } else {
+                model->setItem(r, colIdx, new QStandardItem(text));
+            }
+            changed.append(r);
+        }
+        model->blockSignals(blocked);
+
+        const QList<int> roles = { Qt::DisplayRole, Qt::EditRole };
+        for (int i = 0; i < changed.size();) {
+            int j = i;
+            while (j + 1 < changed.size() && changed[j + 1] == changed[j] + 1) ++j;
+            emit model->dataChanged(model->index(changed[i], colIdx), model->index(changed[j], colIdx), roles);
+            i = j + 1;
+        }
+        if (changedRows) *changedRows = changed;
+        return true;
+    }
+
+    // 只取受影响的行拼成连续的输入块
+    const int n = rows.size();
+    const QVector<int> cols = expr.inputColumns();
+    QVector<QVector<double>> inputs(cols.size(), QVector<double>(n));
+    QVector<const double*> inputPtrs;
+    for (int k = 0; k < cols.size(); ++k) {
+        for (int j = 0; j < n; ++j) {
+            QStandardItem* item = model->item(rows[j], cols[k]);
+            double v;
+            inputs[k][j] = (item && TextDataImporter::parseDouble(item->text(), v)) ? v : std::nan("");
+        }
+        inputPtrs.append(inputs[k].constData());
+    }
+    QVector<double> values(n);
+    expr.evaluate(inputPtrs, n, values.data());
+
+    for (int j = 0; j < n; ++j) {
+        QString text = std::isfinite(values[j]) ? QString::number(values[j], 'f', config.decimalPlaces) : QString();
+        QStandardItem* item = model->item(rows[j], colIdx);
+        if (item && item->text() == text) continue;
+        if (item) item->setText(text);
+        else model->setItem(rows[j], colIdx, new QStandardItem(text));
+        if (changedRows) changedRows->append(rows[j]);
+    }
+    return true;
+}
+
 // 辅助函数实现
 QTime DataCalculate::parseTimeString(const QString& timeStr) const {
     QStringList fmts = {"hh:mm:ss", "h:mm:ss", "hh:mm"};
@@ -6,6 +6,7 @@
  * 2. 包含井底流压计算配置对话框类 PwfCalculationDialog (新增)。
  * 3. 提供 DataCalculate 类，用于执行时间格式转换、压降计算和井底流压计算逻辑。
  * 4. 所有的计算操作都直接修改传入的 QStandardItemModel。
+ * 5. 包含表达式计算列对话框 ExpressionColumnDialog，由 ColumnExpression 编译并批量求值。
  */
 
 #ifndef DATACALCULATE_H
@@ -20,6 +21,8 @@
 #include <QLabel>
 #include <QDoubleSpinBox>
 #include <QSpinBox>
+#include <QPlainTextEdit>
+#include <QListWidget>
 #include "dataeditorwidget.h" // 获取相关结构体定义
 
 // 时间转换配置结构体
@@ -68,6 +71,22 @@ struct PwfCalculationResult {
     int addedColumnIndex;
 };
 
+// 表达式计算列配置结构体
+struct ExpressionColumnConfig {
+    QString expression;                 // "目标列 = 表达式"
+    QMap<QString, double> variables;    // 用户常量
+    int decimalPlaces = 3;
+};
+
+// 表达式计算列结果结构体
+struct ExpressionColumnResult {
+    bool success = false;
+    QString errorMessage;
+    int addedColumnIndex = -1;
+    QString columnName;
+    int processedRows = 0;
+};
+
 // ============================================================================
 // 时间转换设置对话框类
 // ============================================================================
@@ -120,6 +139,33 @@ private:
     QSpinBox* m_spinDecimal;       // 小数位数选择 (新增)
 };
 
+// ============================================================================
+// 表达式计算列对话框类
+// ============================================================================
+class ExpressionColumnDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit ExpressionColumnDialog(const QStringList& columnNames, QWidget* parent = nullptr);
+    ExpressionColumnConfig getConfig() const;
+
+private slots:
+    void onCheckClicked();
+    void onColumnDoubleClicked(QListWidgetItem* item);
+    void onAcceptClicked();
+
+private:
+    // 校验表达式与常量，失败时在提示标签中显示原因
+    bool validate();
+
+    QStringList m_columnNames;
+    QLineEdit* m_expressionEdit;
+    QPlainTextEdit* m_variablesEdit;   // 每行 "名称 = 数值"
+    QListWidget* m_columnList;
+    QSpinBox* m_spinDecimal;
+    QLabel* m_statusLabel;
+};
+
 // ============================================================================
 // 数据计算逻辑处理类
 // ============================================================================
@@ -143,6 +189,19 @@ public:
                                                      QList<ColumnDefinition>& definitions,
                                                      const PwfCalculationConfig& config);
 
+    // 执行表达式计算列 (目标列已存在时原位覆盖)
+    ExpressionColumnResult calculateExpressionColumn(QStandardItemModel* model,
+                                                     QList<ColumnDefinition>& definitions,
+                                                     const ExpressionColumnConfig& config);
+
+    /**
+     * @brief 输入变化后重算计算列中的指定行 (rows 为空表示整列)，只改写已有单元格的值
+     * @param changedRows 输出文本实际变化的行 (升序)；整列重算时逐格信号被屏蔽，调用方据此更新索引
+     */
+    bool recomputeExpressionColumn(QStandardItemModel* model, const ExpressionColumnConfig& config,
+                                   const QList<int>& rows, QVector<int>* changedRows = nullptr,
+                                   QString* error = nullptr);
+
 private:
     // 辅助函数：时间解析
     QTime parseTimeString(const QString& timeStr) const;
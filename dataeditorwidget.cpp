@@ -5,6 +5,10 @@
  * 1. 实现表格数据的管理、编辑、导入导出。
  * 2. 集成 QXlsx 实现无依赖的 Excel 读写及样式操作。
  * 3. 实现了公式写入、隐藏行列、排序分列等高级功能。
+ * 4. 手动保存交给自动保存服务在后台完成 (日志 + 压缩)，界面线程不重写 .wtd，完成后再提示结果。
+ * 5. 计算列整列重算只改写单元格的值 (不删除/插入列)，搜索索引按实际变化的行同步。
+ * 6. 计算列定义的增删与撤销只更新内存中的项目数据，不单独写 .pwt。
+ * 7. 数据质量检查的输入与搜索索引共用分批列快照；问题以行区间交给代理模型着色，不展开为逐格记录。
  */
 
 #include "dataeditorwidget.h"
@@ -13,6 +17,12 @@
 #include "datacalculate.h"
 #include "modelparameter.h"
 #include "dataimportdialog.h"
+#include "xlsxstreamreader.h"
+#include "autosaveservice.h"
+#include "columnexpression.h"
+#include "tableundocommands.h"
+#include "dataqualitychecker.h"
+#include "deconvolution.h"
 
 // 引入 QXlsx 头文件
 #include "xlsxdocument.h"
@@ -32,11 +42,14 @@
 #include <QEvent>
 #include <QAxObject>
 #include <QDir>
+#include <QFileInfo>
 #include <QDateTime>
 #include <QRadioButton>
 #include <QButtonGroup>
 #include <QVBoxLayout>
 #include <QGroupBox>
+#include <QtConcurrent>
+#include <algorithm>
 
 // ============================================================================
 // 内部类：InternalSplitDialog (数据分列设置对话框)
@@ -125,6 +138,18 @@ QWidget *NoContextMenuDelegate::createEditor(QWidget *parent, const QStyleOption
     return editor;
 }
 
+void NoContextMenuDelegate::setModelData(QWidget *editor, QAbstractItemModel *model,
+                                         const QModelIndex &index) const
+{
+    // 提交前换算为源模型索引 (排序代理可能在提交后重新排列行)
+    QModelIndex source = index;
+    if (auto proxy = qobject_cast<QSortFilterProxyModel*>(model)) source = proxy->mapToSource(index);
+    const QString oldText = index.data(Qt::EditRole).toString();
+    QStyledItemDelegate::setModelData(editor, model, index);
+    const QString newText = source.data(Qt::EditRole).toString();
+    if (oldText != newText) emit cellEdited(source, oldText, newText);
+}
+
 // ============================================================================
 // DataEditorWidget 实现
 // ============================================================================
@@ -133,8 +158,21 @@ DataEditorWidget::DataEditorWidget(QWidget *parent) :
     QWidget(parent),
     ui(new Ui::DataEditorWidget),
     m_dataModel(new QStandardItemModel(this)),
-    m_proxyModel(new QSortFilterProxyModel(this)),
-    m_undoStack(new QUndoStack(this))
+    m_proxyModel(new RowMaskFilterProxyModel(this)),
+    m_undoStack(new QUndoStack(this)),
+    m_loadWatcher(new QFutureWatcher<DataLoadResult>(this)),
+    m_loadGeneration(0),
+    m_autoSave(nullptr),
+    m_saveInProgress(false),
+    m_computedBindingsStale(true),
+    m_recomputingColumns(false),
+    m_indexWatcher(new QFutureWatcher<std::shared_ptr<TableSearchIndex>>(this)),
+    m_searchIndexStale(true),
+    m_indexSnapshotRow(-1),
+    m_qualityWatcher(new QFutureWatcher<QualityCheckReport>(this)),
+    m_qualityStale(false),
+    m_qualitySnapshotRow(-1),
+    m_deconvWatcher(new QFutureWatcher<DeconvolutionResult>(this))
 {
     ui->setupUi(this);
     initUI();
@@ -143,21 +181,68 @@ DataEditorWidget::DataEditorWidget(QWidget *parent) :
 
     m_searchTimer = new QTimer(this);
     m_searchTimer->setSingleShot(true);
-    m_searchTimer->setInterval(300);
-    connect(m_searchTimer, &QTimer::timeout, this, [this](){
-        m_proxyModel->setFilterWildcard(ui->searchLineEdit->text());
-    });
+    m_searchTimer->setInterval(150);
+    connect(m_searchTimer, &QTimer::timeout, this, &DataEditorWidget::applySearch);
+    connect(m_indexWatcher, &QFutureWatcher<std::shared_ptr<TableSearchIndex>>::finished,
+            this, &DataEditorWidget::onSearchIndexBuilt);
+    m_indexSnapshotTimer = new QTimer(this);
+    m_indexSnapshotTimer->setSingleShot(true);
+    m_indexSnapshotTimer->setInterval(0);
+    connect(m_indexSnapshotTimer, &QTimer::timeout, this, &DataEditorWidget::onIndexSnapshotStep);
+    m_qualitySnapshotTimer = new QTimer(this);
+    m_qualitySnapshotTimer->setSingleShot(true);
+    m_qualitySnapshotTimer->setInterval(0);
+    connect(m_qualitySnapshotTimer, &QTimer::timeout, this, &DataEditorWidget::onQualitySnapshotStep);
+
+    // 计算列：输入修改后短暂延迟再统一重算，连续编辑只触发一次
+    m_recomputeTimer = new QTimer(this);
+    m_recomputeTimer->setSingleShot(true);
+    m_recomputeTimer->setInterval(200);
+    connect(m_recomputeTimer, &QTimer::timeout, this, &DataEditorWidget::onRecomputeComputedColumns);
+
+    // 撤销/重做 (Ctrl+Z / Ctrl+Y)，命令只保存变化部分，栈深与总内存均有上限
+    m_undoStack->setUndoLimit(50);
+    m_undoAction = m_undoStack->createUndoAction(this, "撤销");
+    m_redoAction = m_undoStack->createRedoAction(this, "重做");
+    m_undoAction->setShortcut(QKeySequence::Undo);
+    m_redoAction->setShortcut(QKeySequence::Redo);
+    m_undoAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    m_redoAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    addAction(m_undoAction);
+    addAction(m_redoAction);
+    connect(m_undoAction, &QAction::triggered, this, [this]() { updateButtonsState(); emit dataChanged(); });
+    connect(m_redoAction, &QAction::triggered, this, [this]() { updateButtonsState(); emit dataChanged(); });
 }
 
 DataEditorWidget::~DataEditorWidget()
 {
+    cancelRunningLoad();
+    m_indexWatcher->waitForFinished();
+    m_qualityWatcher->waitForFinished();
+    m_deconvWatcher->waitForFinished();
     delete ui;
 }
 
 void DataEditorWidget::initUI()
 {
     ui->dataTableView->setContextMenuPolicy(Qt::CustomContextMenu);
-    ui->dataTableView->setItemDelegate(new NoContextMenuDelegate(this));
+    NoContextMenuDelegate* delegate = new NoContextMenuDelegate(this);
+    ui->dataTableView->setItemDelegate(delegate);
+    connect(delegate, &NoContextMenuDelegate::cellEdited, this, &DataEditorWidget::onCellEdited);
+
+    // 底部状态栏：加载进度条与取消按钮 (仅加载期间显示)
+    m_loadProgressBar = new QProgressBar(this);
+    m_loadProgressBar->setRange(0, 100);
+    m_loadProgressBar->setFixedWidth(180);
+    m_loadProgressBar->setVisible(false);
+    m_btnCancelLoad = new QPushButton("取消加载", this);
+    m_btnCancelLoad->setVisible(false);
+    ui->bottomLayout->addWidget(m_loadProgressBar);
+    ui->bottomLayout->addWidget(m_btnCancelLoad);
+
+    m_loadProgressTimer = new QTimer(this);
+    m_loadProgressTimer->setInterval(100);
+
     updateButtonsState();
 }
 
@@ -179,23 +264,66 @@ void DataEditorWidget::setupConnections()
     connect(ui->btnTimeConvert, &QPushButton::clicked, this, &DataEditorWidget::onTimeConvert);
     connect(ui->btnPressureDropCalc, &QPushButton::clicked, this, &DataEditorWidget::onPressureDropCalc);
     connect(ui->btnCalcPwf, &QPushButton::clicked, this, &DataEditorWidget::onCalcPwf);
+    connect(ui->btnExpressionColumn, &QPushButton::clicked, this, &DataEditorWidget::onExpressionColumn);
     connect(ui->btnErrorCheck, &QPushButton::clicked, this, &DataEditorWidget::onHighlightErrors);
 
     connect(ui->searchLineEdit, &QLineEdit::textChanged, this, &DataEditorWidget::onSearchTextChanged);
     connect(ui->dataTableView, &QTableView::customContextMenuRequested, this, &DataEditorWidget::onCustomContextMenu);
     connect(m_dataModel, &QStandardItemModel::itemChanged, this, &DataEditorWidget::onModelDataChanged);
+    // 列结构或表头变化后，计算列需重新绑定输入列
+    auto markStale = [this]() { m_computedBindingsStale = true; };
+    connect(m_dataModel, &QAbstractItemModel::columnsInserted, this, markStale);
+    connect(m_dataModel, &QAbstractItemModel::columnsRemoved, this, markStale);
+    connect(m_dataModel, &QAbstractItemModel::headerDataChanged, this, markStale);
+    connect(m_dataModel, &QAbstractItemModel::modelReset, this, markStale);
+    // 行号变化后待重算的行号失效，改为整列重算
+    auto rowsShifted = [this]() {
+        for (ComputedColumnState& s : m_computedColumns) {
+            if (!s.dirtyRows.isEmpty()) { s.dirtyRows.clear(); s.fullDirty = true; }
+        }
+    };
+    connect(m_dataModel, &QAbstractItemModel::rowsInserted, this, rowsShifted);
+    connect(m_dataModel, &QAbstractItemModel::rowsRemoved, this, rowsShifted);
+
+    // 行列结构变化后搜索索引需重建；表头修改直接同步
+    connect(m_dataModel, &QAbstractItemModel::rowsInserted, this, &DataEditorWidget::invalidateSearchIndex);
+    connect(m_dataModel, &QAbstractItemModel::rowsRemoved, this, &DataEditorWidget::invalidateSearchIndex);
+    connect(m_dataModel, &QAbstractItemModel::columnsInserted, this, &DataEditorWidget::invalidateSearchIndex);
+    connect(m_dataModel, &QAbstractItemModel::columnsRemoved, this, &DataEditorWidget::invalidateSearchIndex);
+    connect(m_dataModel, &QAbstractItemModel::modelReset, this, &DataEditorWidget::invalidateSearchIndex);
+    connect(m_dataModel, &QAbstractItemModel::headerDataChanged, this, [this](Qt::Orientation o, int first, int last) {
+        if (o != Qt::Horizontal || !m_searchIndex) return;
+        for (int c = first; c <= last; ++c) m_searchIndex->setHeader(c, m_dataModel->headerData(c, Qt::Horizontal).toString());
+    });
+
+    // 行列结构变化后质量标记的行列号失效
+    auto qualityStale = [this]() { m_qualityStale = true; m_proxyModel->clearCellBackgrounds(); };
+    connect(m_dataModel, &QAbstractItemModel::rowsInserted, this, qualityStale);
+    connect(m_dataModel, &QAbstractItemModel::rowsRemoved, this, qualityStale);
+    connect(m_dataModel, &QAbstractItemModel::columnsInserted, this, qualityStale);
+    connect(m_dataModel, &QAbstractItemModel::columnsRemoved, this, qualityStale);
+    connect(m_dataModel, &QAbstractItemModel::modelReset, this, qualityStale);
+    connect(m_qualityWatcher, &QFutureWatcher<QualityCheckReport>::finished, this, &DataEditorWidget::onQualityCheckFinished);
+    connect(ui->btnDeconvolution, &QPushButton::clicked, this, &DataEditorWidget::onDeconvolution);
+    connect(m_deconvWatcher, &QFutureWatcher<DeconvolutionResult>::finished, this, &DataEditorWidget::onDeconvolutionFinished);
+
+    connect(m_loadWatcher, &QFutureWatcher<DataLoadResult>::finished, this, &DataEditorWidget::onLoadFinished);
+    connect(m_btnCancelLoad, &QPushButton::clicked, this, &DataEditorWidget::onCancelLoad);
+    connect(m_loadProgressTimer, &QTimer::timeout, this, &DataEditorWidget::onLoadProgressTick);
 }
 
 void DataEditorWidget::updateButtonsState()
 {
     bool hasData = m_dataModel->rowCount() > 0 && m_dataModel->columnCount() > 0;
-    ui->btnSave->setEnabled(hasData);
+    ui->btnSave->setEnabled(hasData && !m_saveInProgress);
     ui->btnExport->setEnabled(hasData);
     ui->btnDefineColumns->setEnabled(hasData);
     ui->btnTimeConvert->setEnabled(hasData);
     ui->btnPressureDropCalc->setEnabled(hasData);
     ui->btnCalcPwf->setEnabled(hasData);
+    ui->btnExpressionColumn->setEnabled(hasData);
     ui->btnErrorCheck->setEnabled(hasData);
+    ui->btnDeconvolution->setEnabled(hasData && !m_deconvWatcher->isRunning());
 }
 
 QStandardItemModel* DataEditorWidget::getDataModel() const { return m_dataModel; }
@@ -204,6 +332,11 @@ bool DataEditorWidget::hasData() const { return m_dataModel->rowCount() > 0; }
 
 void DataEditorWidget::loadData(const QString& filePath, const QString& fileType)
 {
+    // .xlsx 与文本文件走后台加载，完成后再发出 fileChanged
+    if (!filePath.endsWith(".json", Qt::CaseInsensitive) && !filePath.endsWith(".xls", Qt::CaseInsensitive)) {
+        startAsyncLoad(defaultImportSettings(filePath), fileType);
+        return;
+    }
     if (loadFileInternal(filePath)) {
         emit fileChanged(filePath, fileType);
     }
@@ -223,6 +356,13 @@ void DataEditorWidget::onOpenFile()
     DataImportDialog dlg(path, this);
     if (dlg.exec() == QDialog::Accepted) {
         DataImportSettings settings = dlg.getSettings();
+
+        // .xls 依赖 Excel COM 自动化，只能在界面线程执行；其余格式后台加载
+        if (!path.endsWith(".xls", Qt::CaseInsensitive)) {
+            startAsyncLoad(settings, "text");
+            return;
+        }
+
         m_currentFilePath = path;
         ui->filePathLabel->setText("当前文件: " + path);
 
@@ -326,37 +466,23 @@ void DataEditorWidget::onExportExcel()
 }
 
 // ... 文件加载内部逻辑 (保持不变) ...
-bool DataEditorWidget::loadFileInternal(const QString& path) {
+DataImportSettings DataEditorWidget::defaultImportSettings(const QString& path) {
     DataImportSettings s; s.filePath=path; s.encoding="Auto"; s.separator="Auto"; s.startRow=1; s.useHeader=true; s.headerRow=1; s.isExcel=false;
     if(path.endsWith(".xls",Qt::CaseInsensitive)||path.endsWith(".xlsx",Qt::CaseInsensitive)) s.isExcel=true;
+    return s;
+}
+
+bool DataEditorWidget::loadFileInternal(const QString& path) {
+    DataImportSettings s = defaultImportSettings(path);
     if(path.endsWith(".json",Qt::CaseInsensitive)) { QFile f(path); if(f.open(QIODevice::ReadOnly)) { deserializeJsonToModel(QJsonDocument::fromJson(f.readAll()).array()); return true; } return false; }
     return loadFileWithConfig(s);
 }
 
 bool DataEditorWidget::loadFileWithConfig(const DataImportSettings& settings) {
-    m_dataModel->clear(); m_columnDefinitions.clear();
-    if(settings.isExcel) {
-        if(settings.filePath.endsWith(".xlsx", Qt::CaseInsensitive)) {
-            QXlsx::Document xlsx(settings.filePath);
-            if(!xlsx.load()) { QMessageBox::critical(this,"错误","无法加载.xlsx文件"); return false; }
-            if(xlsx.currentWorksheet()==nullptr && !xlsx.sheetNames().isEmpty()) xlsx.selectSheet(xlsx.sheetNames().first());
-            int maxRow = xlsx.dimension().lastRow(); int maxCol = xlsx.dimension().lastColumn();
-            if(maxRow<1||maxCol<1) return true;
-            for(int r=1; r<=maxRow; ++r) {
-                if(r<settings.startRow && !(settings.useHeader && r==settings.headerRow)) continue;
-                QStringList fields;
-                for(int c=1; c<=maxCol; ++c) {
-                    auto cell=xlsx.cellAt(r,c);
-                    if(cell) {
-                        if(cell->isDateTime()) fields.append(cell->readValue().toDateTime().toString("yyyy-MM-dd hh:mm:ss"));
-                        else fields.append(cell->value().toString());
-                    } else fields.append("");
-                }
-                if(settings.useHeader && r==settings.headerRow) { m_dataModel->setHorizontalHeaderLabels(fields); for(auto h:fields) {ColumnDefinition d; d.name=h; m_columnDefinitions.append(d);} }
-                else if(r>=settings.startRow) { QList<QStandardItem*> items; for(auto f:fields) items.append(new QStandardItem(f)); m_dataModel->appendRow(items); }
-            }
-            return true;
-        } else {
+    if(settings.isExcel && settings.filePath.endsWith(".xls", Qt::CaseInsensitive)) {
+        m_undoStack->clear();
+        m_dataModel->clear(); m_columnDefinitions.clear();
+        {
             QAxObject excel("Excel.Application"); if(excel.isNull()) return false;
             excel.setProperty("Visible", false); excel.setProperty("DisplayAlerts", false);
             QAxObject* wb = excel.querySubObject("Workbooks")->querySubObject("Open(const QString&)", QDir::toNativeSeparators(settings.filePath));
@@ -387,22 +513,281 @@ bool DataEditorWidget::loadFileWithConfig(const DataImportSettings& settings) {
             return true;
         }
     }
-    QFile f(settings.filePath); if(!f.open(QIODevice::ReadOnly|QIODevice::Text)) return false;
-    QTextStream in(&f); in.setEncoding(QStringConverter::Utf8); // 简化
-    while(!in.atEnd()) { QString line=in.readLine(); /* simplified text logic */ m_dataModel->appendRow(new QStandardItem(line)); } // 简化占位
+    // .xlsx 与文本文件：与后台加载相同的流程，在当前线程同步执行
+    DataLoadResult res = runLoadTask(settings, nullptr);
+    if(!res.success) { QMessageBox::critical(this,"错误",res.errorMessage); return false; }
+    applyLoadResult(res);
     return true;
 }
 
+// 工作线程：读取解析 (.xlsx 流式 / 文本并行分块)，再按列构建 QStandardItem
+// QStandardItem 未加入模型前不属于任何线程，可以在工作线程创建
+DataLoadResult DataEditorWidget::runLoadTask(const DataImportSettings& settings, ImportControl* control) {
+    DataLoadResult res;
+    res.filePath = settings.filePath;
+    ImportedTable table;
+    if(settings.filePath.endsWith(".xlsx", Qt::CaseInsensitive)) {
+        XlsxReadResult r = XlsxStreamReader::readFirstSheet(settings, -1, -1, control);
+        if(!r.success) { res.errorMessage = r.errorMessage; res.cancelled = control && control->cancelled; return res; }
+        table = std::move(r.table);
+    } else {
+        TextImportResult r = TextDataImporter::importFile(settings, -1, control);
+        if(!r.success) { res.errorMessage = r.errorMessage; res.cancelled = control && control->cancelled; return res; }
+        qDebug() << "文本导入完成:" << r.table.rows.size() << "行, 编码" << r.encoding << ", 分隔符" << r.separator;
+        table = std::move(r.table);
+    }
+
+    if(control) { control->stage = 1; control->total = table.rows.size(); control->processed = 0; }
+    res.headers = table.headers;
+    res.rowCount = table.rows.size();
+    res.columns.resize(table.columnCount);
+    for(auto& col : res.columns) col.reserve(res.rowCount);
+    for(int r=0; r<table.rows.size(); ++r) {
+        if(control && (r & 8191) == 0) {
+            control->processed = r;
+            if(control->cancelled) { res.cancelled = true; discardLoadResult(res); return res; }
+        }
+        const QStringList& row = table.rows[r];
+        for(int c=0; c<table.columnCount; ++c) res.columns[c].append(new QStandardItem(c<row.size() ? row[c] : QString()));
+        table.rows[r] = QStringList(); // 逐行释放文本，降低峰值内存
+    }
+    res.success = true;
+    return res;
+}
+
+void DataEditorWidget::discardLoadResult(DataLoadResult& result) {
+    for(auto& col : result.columns) qDeleteAll(col);
+    result.columns.clear();
+}
+
+void DataEditorWidget::startAsyncLoad(const DataImportSettings& settings, const QString& fileType) {
+    cancelRunningLoad();
+
+    m_loadControl = std::make_shared<ImportControl>();
+    const quint64 generation = ++m_loadGeneration;
+    std::shared_ptr<ImportControl> control = m_loadControl;
+    m_loadWatcher->setFuture(QtConcurrent::run([settings, fileType, control, generation]() {
+        DataLoadResult r = runLoadTask(settings, control.get());
+        r.fileType = fileType;
+        r.generation = generation;
+        return r;
+    }));
+
+    ui->statusLabel->setText("正在加载: " + QFileInfo(settings.filePath).fileName());
+    m_loadProgressBar->setValue(0);
+    m_loadProgressBar->setVisible(true);
+    m_btnCancelLoad->setEnabled(true);
+    m_btnCancelLoad->setVisible(true);
+    ui->btnOpenFile->setEnabled(false);
+    m_loadProgressTimer->start();
+}
+
+// 取消并等待正在进行的加载 (解析循环会频繁检查取消标记，等待时间很短)
+void DataEditorWidget::cancelRunningLoad() {
+    if(!m_loadWatcher->isRunning()) return;
+    if(m_loadControl) m_loadControl->cancelled = true;
+    m_loadWatcher->waitForFinished();
+    DataLoadResult stale = m_loadWatcher->result();
+    discardLoadResult(stale);
+    ++m_loadGeneration; // 使随后到达的 finished 信号失效
+}
+
+void DataEditorWidget::onCancelLoad() {
+    if(m_loadControl) m_loadControl->cancelled = true;
+    m_btnCancelLoad->setEnabled(false);
+    ui->statusLabel->setText("正在取消...");
+}
+
+// 读取解析阶段占 0-80%，构建表格阶段占 80-100%
+void DataEditorWidget::onLoadProgressTick() {
+    if(!m_loadControl) return;
+    int pct = m_loadControl->percent();
+    m_loadProgressBar->setValue(m_loadControl->stage == 0 ? pct * 80 / 100 : 80 + pct / 5);
+}
+
+void DataEditorWidget::onLoadFinished() {
+    if(m_loadWatcher->future().resultCount() == 0) return;
+    DataLoadResult res = m_loadWatcher->result();
+    if(res.generation != m_loadGeneration) { discardLoadResult(res); return; }
+
+    m_loadProgressTimer->stop();
+    m_loadProgressBar->setVisible(false);
+    m_btnCancelLoad->setVisible(false);
+    ui->btnOpenFile->setEnabled(true);
+    m_loadControl.reset();
+
+    if(res.cancelled) {
+        discardLoadResult(res);
+        ui->statusLabel->setText("已取消加载");
+        return;
+    }
+    if(!res.success) {
+        ui->statusLabel->setText("加载失败");
+        QMessageBox::critical(this, "错误", res.errorMessage);
+        return;
+    }
+
+    applyLoadResult(res);
+    m_currentFilePath = res.filePath;
+    ui->filePathLabel->setText("当前文件: " + res.filePath);
+    ui->statusLabel->setText(QString("加载成功 (%1 行)").arg(res.rowCount));
+    updateButtonsState();
+    emit fileChanged(res.filePath, res.fileType);
+    emit dataChanged();
+}
+
+// 将构建好的列一次性交换进模型 (交换期间断开代理模型，每列只触发一次插入)
+void DataEditorWidget::applyLoadResult(DataLoadResult& result) {
+    m_undoStack->clear();
+    m_proxyModel->setSourceModel(nullptr);
+    m_dataModel->clear(); m_columnDefinitions.clear();
+    for(auto& col : result.columns) m_dataModel->appendColumn(col);
+    result.columns.clear(); // 单元格所有权已转移给模型
+    if(m_dataModel->columnCount() < result.headers.size()) m_dataModel->setColumnCount(result.headers.size());
+    if(!result.headers.isEmpty()) {
+        m_dataModel->setHorizontalHeaderLabels(result.headers);
+        for(const auto& h : result.headers) { ColumnDefinition d; d.name=h; m_columnDefinitions.append(d); }
+    }
+    m_proxyModel->setSourceModel(m_dataModel);
+}
+
 // ... 错误检查 ...
+// 数据质量检查：分批复制列快照后交给后台并行检查，完成后以背景色标记问题单元格
 void DataEditorWidget::onHighlightErrors() {
-    for(int r=0; r<m_dataModel->rowCount(); ++r) for(int c=0; c<m_dataModel->columnCount(); ++c) m_dataModel->item(r,c)->setBackground(Qt::NoBrush);
-    int pIdx = -1;
-    for(int i=0; i<m_columnDefinitions.size(); ++i) if(m_columnDefinitions[i].type==WellTestColumnType::Pressure) pIdx=i;
-    int err=0;
-    for(int r=0; r<m_dataModel->rowCount(); ++r) {
-        if(pIdx!=-1 && m_dataModel->item(r,pIdx)->text().toDouble()<0) { m_dataModel->item(r,pIdx)->setBackground(QColor(255,200,200)); err++; }
+    if (m_qualityWatcher->isRunning() || m_qualitySnapshotRow >= 0) return;
+    beginColumnSnapshot(m_qualitySnapshotHeaders, m_qualitySnapshotColumns);
+    m_qualitySnapshotRow = 0;
+    m_qualityStale = false;
+    m_proxyModel->clearCellBackgrounds();
+    ui->btnErrorCheck->setEnabled(false);
+    ui->statusLabel->setText("正在检查数据质量...");
+    m_qualitySnapshotTimer->start();
+}
+
+void DataEditorWidget::onQualitySnapshotStep() {
+    if (m_qualitySnapshotRow < 0) return;
+    if (m_qualityStale) {
+        // 复制期间表格结构已变化
+        m_qualitySnapshotRow = -1;
+        m_qualitySnapshotHeaders.clear();
+        m_qualitySnapshotColumns.clear();
+        ui->btnErrorCheck->setEnabled(m_dataModel->rowCount() > 0);
+        ui->statusLabel->setText("检查期间表格结构已变化，请重新检查");
+        return;
+    }
+    m_qualitySnapshotRow = copySnapshotRows(m_qualitySnapshotColumns, m_qualitySnapshotRow);
+    if (m_qualitySnapshotRow < m_dataModel->rowCount()) {
+        m_qualitySnapshotTimer->start();
+        return;
+    }
+
+    QualityCheckInput input;
+    input.headers.swap(m_qualitySnapshotHeaders);
+    input.columns.swap(m_qualitySnapshotColumns);
+    input.rowCount = m_dataModel->rowCount();
+    for (int c = 0; c < input.columns.size(); ++c)
+        input.types.append(c < m_columnDefinitions.size() ? m_columnDefinitions[c].type : WellTestColumnType::Custom);
+    m_qualitySnapshotRow = -1;
+    m_qualityWatcher->setFuture(QtConcurrent::run([input]() { return DataQualityChecker::run(input); }));
+}
+
+void DataEditorWidget::onQualityCheckFinished() {
+    ui->btnErrorCheck->setEnabled(m_dataModel->rowCount() > 0);
+    QualityCheckReport report = m_qualityWatcher->result();
+    if (m_qualityStale) {
+        ui->statusLabel->setText("检查期间表格结构已变化，请重新检查");
+        return;
+    }
+    if (!report.success) { ui->statusLabel->setText("检查失败"); QMessageBox::warning(this, "检查失败", report.errorMessage); return; }
+
+    // 问题按区间交给代理模型；同一单元格有多个问题时按最严重的一级着色 (错误 > 警告 > 提示)
+    QVector<RowMaskFilterProxyModel::BackgroundRange> ranges;
+    ranges.reserve(report.issues.size());
+    for (const QualityIssue& issue : std::as_const(report.issues)) {
+        const QColor color = issue.severity == QualitySeverity::Error ? QColor(255, 200, 200)
+                           : issue.severity == QualitySeverity::Warning ? QColor(255, 235, 180) : QColor(215, 230, 255);
+        ranges.append({ issue.column, issue.row, issue.rowCount, int(issue.severity), color });
+    }
+    m_proxyModel->setCellBackgrounds(ranges);
+
+    QStringList summary;
+    for (auto it = report.counts.constBegin(); it != report.counts.constEnd(); ++it)
+        summary << QString("%1: %2 行").arg(DataQualityChecker::typeName(it.key())).arg(it.value());
+    if (report.timeColumn < 0) summary << "未找到数值时间列，已跳过时间检查";
+    QStringList details;
+    for (int i = 0; i < report.issues.size() && i < 500; ++i) {
+        const QualityIssue& issue = report.issues[i];
+        details << QString("[%1] %2 第 %3 行%4: %5")
+                       .arg(DataQualityChecker::severityName(issue.severity),
+                            m_dataModel->headerData(issue.column, Qt::Horizontal).toString())
+                       .arg(issue.row + 1)
+                       .arg(issue.rowCount > 1 ? QString(" 起 %1 行").arg(issue.rowCount) : QString())
+                       .arg(issue.message);
     }
-    QMessageBox::information(this, "检查完成", QString("发现 %1 个错误。").arg(err));
+    if (report.issues.size() > 500) details << QString("... 共 %1 条").arg(report.issues.size());
+
+    ui->statusLabel->setText(QString("数据质量检查: %1 条问题").arg(report.issues.size()));
+    QMessageBox box(QMessageBox::Information, "检查完成",
+                    report.issues.isEmpty() ? QString("未发现数据质量问题。")
+                                            : QString("发现 %1 条问题:\n%2").arg(report.issues.size()).arg(summary.join("\n")),
+                    QMessageBox::Ok, this);
+    if (!details.isEmpty()) box.setDetailedText(details.join("\n"));
+    box.exec();
+}
+
+// 压力-产量反褶积：界面线程只复制三列文本，解析与反演在后台完成
+void DataEditorWidget::onDeconvolution() {
+    if (m_deconvWatcher->isRunning()) return;
+    QStringList headers;
+    for (int i = 0; i < m_dataModel->columnCount(); ++i) headers << m_dataModel->headerData(i, Qt::Horizontal).toString();
+    DeconvolutionDialog dlg(headers, this);
+    if (dlg.exec() != QDialog::Accepted) return;
+    const DeconvolutionConfig config = dlg.getConfig();
+
+    const int rows = m_dataModel->rowCount();
+    QStringList colT, colP, colQ;
+    colT.reserve(rows); colP.reserve(rows); colQ.reserve(rows);
+    for (int r = 0; r < rows; ++r) {
+        QStandardItem* it = m_dataModel->item(r, config.timeColumn);
+        QStandardItem* ip = m_dataModel->item(r, config.pressureColumn);
+        QStandardItem* iq = m_dataModel->item(r, config.rateColumn);
+        colT.append(it ? it->text() : QString());
+        colP.append(ip ? ip->text() : QString());
+        colQ.append(iq ? iq->text() : QString());
+    }
+
+    ui->btnDeconvolution->setEnabled(false);
+    ui->statusLabel->setText("正在反褶积...");
+    m_deconvWatcher->setFuture(QtConcurrent::run([colT, colP, colQ, config]() {
+        QVector<double> t, p, q;
+        t.reserve(colT.size()); p.reserve(colT.size()); q.reserve(colT.size());
+        for (int r = 0; r < colT.size(); ++r) {
+            double tv, pv, qv;
+            if (!TextDataImporter::parseDouble(colT[r], tv) || !TextDataImporter::parseDouble(colP[r], pv)
+                || !TextDataImporter::parseDouble(colQ[r], qv)) continue;
+            t.append(tv); p.append(pv); q.append(qv);
+        }
+        return Deconvolution::run(t, p, q, config);
+    }));
+}
+
+void DataEditorWidget::onDeconvolutionFinished() {
+    ui->btnDeconvolution->setEnabled(m_dataModel->rowCount() > 0);
+    DeconvolutionResult res = m_deconvWatcher->result();
+    if (!res.success) {
+        ui->statusLabel->setText("反褶积失败");
+        QMessageBox::warning(this, "反褶积失败", res.errorMessage);
+        return;
+    }
+    ui->statusLabel->setText(QString("反褶积完成: %1 个产量阶梯, %2 个压力点").arg(res.rateSteps).arg(res.pressurePoints));
+    QMessageBox::information(this, "反褶积完成",
+                             QString("产量阶梯: %1\n参与反演的压力点: %2\n迭代次数: %3\n初始压力 p0: %4\n压力拟合误差 (RMS): %5\n\n"
+                                     "结果为参考产量 q = %6 下的恒产量响应，已作为观测数据发送到拟合界面，"
+                                     "拟合时请将产量参数设为该值。")
+                                 .arg(res.rateSteps).arg(res.pressurePoints).arg(res.iterations)
+                                 .arg(res.initialPressure, 0, 'f', 4).arg(res.rmsError, 0, 'g', 4)
+                                 .arg(res.referenceRate, 0, 'g', 6));
+    emit deconvolutionReady(res.time, res.deltaP, res.derivative);
 }
 
 // ============================================================================
@@ -412,6 +797,11 @@ void DataEditorWidget::onCustomContextMenu(const QPoint& pos) {
     QMenu menu(this);
     menu.setStyleSheet("QMenu { background-color: white; color: black; border: 1px solid #ccc; } QMenu::item { padding: 5px 20px; } QMenu::item:selected { background-color: #e0e0e0; color: black; }");
 
+    // 0. 撤销/重做
+    menu.addAction(m_undoAction);
+    menu.addAction(m_redoAction);
+    menu.addSeparator();
+
     // 1. 行操作子菜单
     QMenu* rowMenu = menu.addMenu("行操作");
     rowMenu->addAction("在上方插入行", [=](){ onAddRow(1); });
@@ -497,18 +887,28 @@ void DataEditorWidget::onSplitColumn() {
     else m_columnDefinitions.append(def);
     m_dataModel->setHeaderData(col + 1, Qt::Horizontal, "拆分数据");
 
+    QVector<CellDiff> diffs;
     for (int i = 0; i < rows; ++i) {
         QStandardItem* item = m_dataModel->item(i, col);
         if (!item) continue;
         QString text = item->text();
         int sepIdx = text.indexOf(separator);
         if (sepIdx != -1) {
-            item->setText(text.left(sepIdx).trimmed());
+            QString left = text.left(sepIdx).trimmed();
+            if (left != text) diffs.append({i, col, text, left});
+            item->setText(left);
             m_dataModel->setItem(i, col + 1, new QStandardItem(text.mid(sepIdx + separator.length()).trimmed()));
         } else {
             m_dataModel->setItem(i, col + 1, new QStandardItem(""));
         }
     }
+
+    // 撤销记录：原列只保存被截断的单元格，新列整列保存
+    TableUndoCommand* cmd = new TableUndoCommand(m_dataModel, &m_columnDefinitions, "数据分列", true);
+    new CellEditCommand(m_dataModel, diffs, "分列原列", false, cmd);
+    new InsertColumnCommand(m_dataModel, &m_columnDefinitions, col + 1,
+                            ColumnBuffer::capture(m_dataModel, col + 1, &m_columnDefinitions), "分列新列", false, cmd);
+    pushUndo(cmd);
 }
 
 void DataEditorWidget::onMergeCells() {
@@ -519,20 +919,31 @@ void DataEditorWidget::onMergeCells() {
         minRow = qMin(minRow, idx.row()); maxRow = qMax(maxRow, idx.row());
         minCol = qMin(minCol, idx.column()); maxCol = qMax(maxCol, idx.column());
     }
-    ui->dataTableView->setSpan(minRow, minCol, maxRow - minRow + 1, maxCol - minCol + 1);
+    QTableView* view = ui->dataTableView;
+    pushUndo(new SpanCommand(view, minRow, minCol, view->rowSpan(minRow, minCol), view->columnSpan(minRow, minCol),
+                             maxRow - minRow + 1, maxCol - minCol + 1));
 }
 
 void DataEditorWidget::onUnmergeCells() {
     QModelIndex idx = ui->dataTableView->currentIndex();
-    if (idx.isValid()) ui->dataTableView->setSpan(idx.row(), idx.column(), 1, 1);
+    if (!idx.isValid()) return;
+    QTableView* view = ui->dataTableView;
+    int rowSpan = view->rowSpan(idx.row(), idx.column()), colSpan = view->columnSpan(idx.row(), idx.column());
+    if (rowSpan == 1 && colSpan == 1) return;
+    pushUndo(new SpanCommand(view, idx.row(), idx.column(), rowSpan, colSpan, 1, 1));
 }
 
+// 排序只作用于代理模型 (视图顺序)，撤销时恢复原排序列与顺序
 void DataEditorWidget::onSortAscending() {
-    if(ui->dataTableView->currentIndex().isValid()) m_proxyModel->sort(ui->dataTableView->currentIndex().column(), Qt::AscendingOrder);
+    if(ui->dataTableView->currentIndex().isValid())
+        pushUndo(new SortCommand(m_proxyModel, m_proxyModel->sortColumn(), m_proxyModel->sortOrder(),
+                                 ui->dataTableView->currentIndex().column(), Qt::AscendingOrder));
 }
 
 void DataEditorWidget::onSortDescending() {
-    if(ui->dataTableView->currentIndex().isValid()) m_proxyModel->sort(ui->dataTableView->currentIndex().column(), Qt::DescendingOrder);
+    if(ui->dataTableView->currentIndex().isValid())
+        pushUndo(new SortCommand(m_proxyModel, m_proxyModel->sortColumn(), m_proxyModel->sortOrder(),
+                                 ui->dataTableView->currentIndex().column(), Qt::DescendingOrder));
 }
 
 // 行列增删 (优化：无选中则操作当前行)
@@ -543,25 +954,22 @@ void DataEditorWidget::onAddRow(int insertMode) {
         int srcRow = m_proxyModel->mapToSource(idx).row();
         row = (insertMode == 1) ? srcRow : srcRow + 1;
     }
-    QList<QStandardItem*> items;
-    for(int i=0; i<m_dataModel->columnCount(); ++i) items << new QStandardItem("");
-    m_dataModel->insertRow(row, items);
+    pushUndo(new InsertRowsCommand(m_dataModel, row, 1));
     updateButtonsState();
 }
 
 void DataEditorWidget::onDeleteRow() {
     QModelIndexList idxs = ui->dataTableView->selectionModel()->selectedRows();
+    QList<int> rows;
     if(idxs.isEmpty()) {
         // 无多选，尝试删除当前行
         QModelIndex idx = ui->dataTableView->currentIndex();
-        if(idx.isValid()) m_dataModel->removeRow(m_proxyModel->mapToSource(idx).row());
+        if(idx.isValid()) rows << m_proxyModel->mapToSource(idx).row();
     } else {
-        QList<int> rows;
         for(auto i : idxs) rows << m_proxyModel->mapToSource(i).row();
-        std::sort(rows.begin(), rows.end(), std::greater<int>());
-        auto last = std::unique(rows.begin(), rows.end()); rows.erase(last, rows.end());
-        for(int r : rows) m_dataModel->removeRow(r);
     }
+    // 命令内部排序去重，按连续区间批量删除
+    if(!rows.isEmpty()) pushUndo(new RemoveRowsCommand(m_dataModel, rows));
     updateButtonsState();
 }
 
@@ -572,43 +980,426 @@ void DataEditorWidget::onAddCol(int insertMode) {
         int srcCol = m_proxyModel->mapToSource(idx).column();
         col = (insertMode == 1) ? srcCol : srcCol + 1;
     }
-    m_dataModel->insertColumn(col);
-    ColumnDefinition def; def.name = "新列";
-    if(col < m_columnDefinitions.size()) m_columnDefinitions.insert(col, def); else m_columnDefinitions.append(def);
-    m_dataModel->setHeaderData(col, Qt::Horizontal, "新列");
+    ColumnBuffer buffer;
+    buffer.header = "新列";
+    buffer.definition.name = "新列";
+    pushUndo(new InsertColumnCommand(m_dataModel, &m_columnDefinitions, col, buffer, "插入列", false));
 }
 
 void DataEditorWidget::onDeleteCol() {
     QModelIndexList idxs = ui->dataTableView->selectionModel()->selectedColumns();
+    QList<int> cols;
     if(idxs.isEmpty()) {
         QModelIndex idx = ui->dataTableView->currentIndex();
-        if(idx.isValid()) {
-            int c = m_proxyModel->mapToSource(idx).column();
-            m_dataModel->removeColumn(c);
-            if(c < m_columnDefinitions.size()) m_columnDefinitions.removeAt(c);
-        }
+        if(idx.isValid()) cols << m_proxyModel->mapToSource(idx).column();
     } else {
-        QList<int> cols;
         for(auto i : idxs) cols << m_proxyModel->mapToSource(i).column();
-        std::sort(cols.begin(), cols.end(), std::greater<int>());
-        auto last = std::unique(cols.begin(), cols.end()); cols.erase(last, cols.end());
-        for(int c : cols) {
-            m_dataModel->removeColumn(c);
-            if(c < m_columnDefinitions.size()) m_columnDefinitions.removeAt(c);
-        }
     }
+    if(!cols.isEmpty()) pushUndo(new RemoveColumnsCommand(m_dataModel, &m_columnDefinitions, cols));
     updateButtonsState();
 }
 
+// ============================================================================
+// 撤销/重做
+// ============================================================================
+void DataEditorWidget::onCellEdited(const QModelIndex& index, const QString& oldText, const QString& newText)
+{
+    if (!index.isValid()) return;
+    pushUndo(new CellEditCommand(m_dataModel, {CellDiff{index.row(), index.column(), oldText, newText}},
+                                 "编辑单元格", true));
+}
+
+qint64 DataEditorWidget::undoStackBytes() const
+{
+    qint64 total = 0;
+    for (int i = 0; i < m_undoStack->count(); ++i) {
+        if (auto cmd = dynamic_cast<const TableUndoCommand*>(m_undoStack->command(i))) total += cmd->byteSize();
+    }
+    return total;
+}
+
+void DataEditorWidget::pushUndo(TableUndoCommand* command)
+{
+    // 撤销栈总内存上限，超出时放弃旧记录
+    const qint64 budget = 256LL * 1024 * 1024;
+    const qint64 bytes = command->byteSize();
+    if (bytes > budget) {
+        if (!command->alreadyApplied()) command->redo();
+        delete command;
+        m_undoStack->clear();
+        ui->statusLabel->setText("操作数据量过大，撤销记录已清空");
+        return;
+    }
+    if (undoStackBytes() + bytes > budget) m_undoStack->clear();
+    m_undoStack->push(command);
+}
+
 // 保持不变
-void DataEditorWidget::onModelDataChanged() {}
-void DataEditorWidget::onSave() { QJsonArray d=serializeModelToJson(); ModelParameter::instance()->saveTableData(d); ModelParameter::instance()->saveProject(); QMessageBox::information(this,"保存","数据已保存"); }
-void DataEditorWidget::loadFromProjectData() { QJsonArray d=ModelParameter::instance()->getTableData(); if(!d.isEmpty()){deserializeJsonToModel(d);ui->statusLabel->setText("恢复数据");updateButtonsState();}else{m_dataModel->clear();ui->statusLabel->setText("无数据");} }
+void DataEditorWidget::onModelDataChanged(QStandardItem* item)
+{
+    if (!item) return;
+
+    // 搜索索引增量更新；正在过滤时重新执行查询
+    if (m_indexWatcher->isRunning() || m_indexSnapshotRow >= 0) {
+        m_pendingIndexEdits.append(qMakePair(item->row(), item->column()));
+    } else if (m_searchIndex && !m_searchIndexStale) {
+        m_searchIndex->updateCell(item->row(), item->column(), item->text());
+    }
+    if (m_proxyModel->hasRowMask()) m_searchTimer->start();
+
+    if (m_recomputingColumns || m_computedColumns.isEmpty()) return;
+    if (m_computedBindingsStale) rebindComputedColumns();
+
+    const int col = item->column();
+    const int fullThreshold = qMax(64, m_dataModel->rowCount() / 8);
+    bool affected = false;
+    for (ComputedColumnState& s : m_computedColumns) {
+        if (s.fullDirty || !s.inputColumns.contains(col)) continue;
+        s.dirtyRows.insert(item->row());
+        if (s.dirtyRows.size() > fullThreshold) { s.dirtyRows.clear(); s.fullDirty = true; }
+        affected = true;
+    }
+    if (affected) m_recomputeTimer->start();
+}
+
+void DataEditorWidget::onRecomputeComputedColumns()
+{
+    if (m_computedBindingsStale) rebindComputedColumns();
+    DataCalculate calc;
+    bool changed = false;
+    m_recomputingColumns = true;
+    for (int i = 0; i < m_computedColumns.size(); ++i) {
+        ComputedColumnState& s = m_computedColumns[i];
+        if (!s.fullDirty && s.dirtyRows.isEmpty()) continue;
+        if (s.targetColumn < 0 || s.inputColumns.isEmpty()) { s.dirtyRows.clear(); s.fullDirty = false; continue; }
+
+        ExpressionColumnConfig cfg;
+        cfg.expression = s.expression;
+        cfg.variables = s.variables;
+        cfg.decimalPlaces = s.decimalPlaces;
+        QList<int> rows;
+        if (!s.fullDirty) {
+            for (int r : std::as_const(s.dirtyRows)) if (r < m_dataModel->rowCount()) rows.append(r);
+            std::sort(rows.begin(), rows.end());
+        }
+        QString err;
+        QVector<int> changedRows;
+        if (!calc.recomputeExpressionColumn(m_dataModel, cfg, rows, &changedRows, &err)) qDebug() << "计算列重算失败:" << err;
+        // 整列重算不发出逐格 itemChanged，搜索索引在此同步 (部分重算已由 onModelDataChanged 处理)
+        if (s.fullDirty) syncSearchIndexColumn(s.targetColumn, changedRows);
+        changed = true;
+
+        // 以本列为输入的后续计算列同样需要重算
+        for (int j = i + 1; j < m_computedColumns.size(); ++j) {
+            ComputedColumnState& next = m_computedColumns[j];
+            if (!next.inputColumns.contains(s.targetColumn)) continue;
+            if (s.fullDirty) { next.fullDirty = true; next.dirtyRows.clear(); }
+            else if (!next.fullDirty) next.dirtyRows.unite(s.dirtyRows);
+        }
+        s.dirtyRows.clear();
+        s.fullDirty = false;
+    }
+    m_recomputingColumns = false;
+    if (changed) emit dataChanged();
+}
+
+void DataEditorWidget::syncSearchIndexColumn(int col, const QVector<int>& rows)
+{
+    if (rows.isEmpty()) return;
+    if (m_indexWatcher->isRunning() || m_indexSnapshotRow >= 0) {
+        for (int r : rows) m_pendingIndexEdits.append(qMakePair(r, col));
+    } else if (m_searchIndex && !m_searchIndexStale) {
+        // 变化较多时整列重建，避免逐格更新有序数值数组
+        if (rows.size() > 1024) {
+            QStringList texts;
+            texts.reserve(m_dataModel->rowCount());
+            for (int r = 0; r < m_dataModel->rowCount(); ++r) {
+                QStandardItem* item = m_dataModel->item(r, col);
+                texts.append(item ? item->text() : QString());
+            }
+            m_searchIndex->rebuildColumn(col, texts);
+        } else {
+            for (int r : rows) {
+                QStandardItem* item = m_dataModel->item(r, col);
+                m_searchIndex->updateCell(r, col, item ? item->text() : QString());
+            }
+        }
+    }
+    if (m_proxyModel->hasRowMask()) m_searchTimer->start();
+}
+
+void DataEditorWidget::rebindComputedColumns()
+{
+    QStringList headers;
+    for (int i = 0; i < m_dataModel->columnCount(); ++i) headers << m_dataModel->headerData(i, Qt::Horizontal).toString();
+    for (ComputedColumnState& s : m_computedColumns) {
+        ColumnExpression expr;
+        s.inputColumns.clear();
+        s.targetColumn = -1;
+        if (expr.compile(s.expression) && expr.bind(headers, s.variables)) {
+            s.inputColumns = expr.inputColumns();
+            s.targetColumn = headers.indexOf(expr.targetName().isEmpty() ? QString("计算列") : expr.targetName());
+        }
+    }
+    m_computedBindingsStale = false;
+}
+
+// 只更新项目数据中的计算列定义，随手动保存或自动保存 (压缩完成后的 saveProject) 写入 .pwt
+void DataEditorWidget::saveComputedColumns()
+{
+    QJsonArray arr;
+    for (const ComputedColumnState& s : m_computedColumns) {
+        QJsonObject o;
+        o["expression"] = s.expression;
+        o["decimals"] = s.decimalPlaces;
+        QJsonObject vars;
+        for (auto it = s.variables.constBegin(); it != s.variables.constEnd(); ++it) vars[it.key()] = it.value();
+        o["variables"] = vars;
+        arr.append(o);
+    }
+    ModelParameter::instance()->setComputedColumns(arr);
+}
+
+void DataEditorWidget::restoreComputedColumns()
+{
+    m_computedColumns.clear();
+    const QJsonArray arr = ModelParameter::instance()->getComputedColumns();
+    for (const auto& v : arr) {
+        QJsonObject o = v.toObject();
+        ComputedColumnState s;
+        s.expression = o["expression"].toString();
+        s.decimalPlaces = o["decimals"].toInt(3);
+        QJsonObject vars = o["variables"].toObject();
+        for (auto it = vars.constBegin(); it != vars.constEnd(); ++it) s.variables[it.key()] = it.value().toDouble();
+        m_computedColumns.append(s);
+    }
+    m_computedBindingsStale = true;
+}
+
+void DataEditorWidget::onExpressionColumn()
+{
+    QStringList h;
+    for (int i = 0; i < m_dataModel->columnCount(); ++i) h << m_dataModel->headerData(i, Qt::Horizontal).toString();
+    ExpressionColumnDialog d(h, this);
+    if (d.exec() != QDialog::Accepted) return;
+
+    ExpressionColumnConfig cfg = d.getConfig();
+
+    // 覆盖已有列时先保存原列内容，供撤销使用
+    ColumnBuffer before;
+    {
+        ColumnExpression expr;
+        int target = expr.compile(cfg.expression)
+                         ? h.indexOf(expr.targetName().isEmpty() ? QString("计算列") : expr.targetName()) : -1;
+        if (target >= 0) before = ColumnBuffer::capture(m_dataModel, target, &m_columnDefinitions);
+    }
+    const int oldColumnCount = m_dataModel->columnCount();
+
+    DataCalculate c;
+    auto res = c.calculateExpressionColumn(m_dataModel, m_columnDefinitions, cfg);
+    if (!res.success) { QMessageBox::warning(this, "失败", res.errorMessage); return; }
+
+    // 记录定义，之后输入列变化时自动重算；同名目标列的旧定义被替换
+    const QList<ComputedColumnState> statesBefore = m_computedColumns;
+    ComputedColumnState s;
+    s.expression = cfg.expression;
+    s.variables = cfg.variables;
+    s.decimalPlaces = cfg.decimalPlaces;
+    rebindComputedColumns();
+    for (int i = m_computedColumns.size() - 1; i >= 0; --i) {
+        if (m_computedColumns[i].targetColumn == res.addedColumnIndex) m_computedColumns.removeAt(i);
+    }
+    m_computedColumns.append(s);
+    m_computedBindingsStale = true;
+    saveComputedColumns();
+
+    // 结果列与定义作为一条撤销记录
+    ColumnBuffer after = ColumnBuffer::capture(m_dataModel, res.addedColumnIndex, &m_columnDefinitions);
+    TableUndoCommand* cmd = new TableUndoCommand(m_dataModel, &m_columnDefinitions, "计算列", true);
+    if (m_dataModel->columnCount() > oldColumnCount)
+        new InsertColumnCommand(m_dataModel, &m_columnDefinitions, res.addedColumnIndex, after, "计算列", false, cmd);
+    else
+        new ReplaceColumnCommand(m_dataModel, &m_columnDefinitions, res.addedColumnIndex, before, after, "计算列", false, cmd);
+    new ComputedColumnsCommand(&m_computedColumns, statesBefore, m_computedColumns, [this]() {
+        m_computedBindingsStale = true;
+        saveComputedColumns();
+    }, cmd);
+    pushUndo(cmd);
+
+    QMessageBox::information(this, "成功", QString("计算列 \"%1\" 已生成，有效行数 %2").arg(res.columnName).arg(res.processedRows));
+    emit dataChanged();
+}
+void DataEditorWidget::setAutoSaveService(AutoSaveService* service)
+{
+    if (m_autoSave) disconnect(m_autoSave, nullptr, this, nullptr);
+    m_autoSave = service;
+    if (m_autoSave) connect(m_autoSave, &AutoSaveService::saveFinished, this, &DataEditorWidget::onSaveFinished);
+}
+
+// 保存在后台进行 (日志 + 压缩/完整快照)，结果在 onSaveFinished 中提示
+void DataEditorWidget::onSave()
+{
+    if (!m_autoSave) { QMessageBox::warning(this, "保存", "保存服务未就绪"); return; }
+    if (m_saveInProgress) return;
+    m_saveInProgress = true;
+    ui->statusLabel->setText("正在保存...");
+    updateButtonsState();
+    m_autoSave->saveNow();
+}
+
+void DataEditorWidget::onSaveFinished(bool ok, const QString& error)
+{
+    // 关闭项目等其他途径发起的保存不在此提示
+    if (!m_saveInProgress) return;
+    m_saveInProgress = false;
+    updateButtonsState();
+    if (!ok) {
+        ui->statusLabel->setText("保存失败");
+        QMessageBox::warning(this, "保存", "表格数据保存失败: " + error);
+        return;
+    }
+    ModelParameter::instance()->saveProject();
+    ui->statusLabel->setText("数据已保存");
+    QMessageBox::information(this, "保存", "数据已保存");
+}
+void DataEditorWidget::loadFromProjectData() {
+    ModelParameter* mp = ModelParameter::instance();
+    m_undoStack->clear();
+    restoreComputedColumns();
+    if(mp->hasTableStore() && mp->tableStore().rowCount()>0) {
+        // 二进制列式数据：断开代理后逐列解码填充
+        m_proxyModel->setSourceModel(nullptr);
+        m_columnDefinitions.clear();
+        mp->tableStore().fillModel(m_dataModel);
+        for(const auto& h : mp->tableStore().headers()) { ColumnDefinition d; d.name=h; m_columnDefinitions.append(d); }
+        m_proxyModel->setSourceModel(m_dataModel);
+        ui->statusLabel->setText("恢复数据"); updateButtonsState();
+        return;
+    }
+    QJsonArray d=mp->getTableData(); if(!d.isEmpty()){deserializeJsonToModel(d);ui->statusLabel->setText("恢复数据");updateButtonsState();}else{m_dataModel->clear();ui->statusLabel->setText("无数据");} }
 QJsonArray DataEditorWidget::serializeModelToJson() const { QJsonArray a; QJsonObject h; QJsonArray hs; for(int i=0;i<m_dataModel->columnCount();++i) hs.append(m_dataModel->headerData(i,Qt::Horizontal).toString()); h["headers"]=hs; a.append(h); for(int i=0;i<m_dataModel->rowCount();++i){QJsonArray r; for(int j=0;j<m_dataModel->columnCount();++j)r.append(m_dataModel->item(i,j)->text()); QJsonObject o; o["row_data"]=r; a.append(o);} return a; }
-void DataEditorWidget::deserializeJsonToModel(const QJsonArray& a) { m_dataModel->clear(); m_columnDefinitions.clear(); if(a.isEmpty())return; QJsonObject h=a.first().toObject(); if(h.contains("headers")){QJsonArray hs=h["headers"].toArray(); QStringList sl; for(auto v:hs)sl<<v.toString(); m_dataModel->setHorizontalHeaderLabels(sl); for(auto s:sl){ColumnDefinition d; d.name=s; m_columnDefinitions.append(d);}} for(int i=1;i<a.size();++i){QJsonObject o=a[i].toObject(); if(o.contains("row_data")){QJsonArray r=o["row_data"].toArray(); QList<QStandardItem*> l; for(auto v:r)l.append(new QStandardItem(v.toString())); m_dataModel->appendRow(l);}} }
-void DataEditorWidget::onDefineColumns() { QStringList h; for(int i=0;i<m_dataModel->columnCount();++i)h<<m_dataModel->headerData(i,Qt::Horizontal).toString(); DataColumnDialog d(h,m_columnDefinitions,this); if(d.exec()==QDialog::Accepted){m_columnDefinitions=d.getColumnDefinitions(); for(int i=0;i<m_columnDefinitions.size();++i)if(i<m_dataModel->columnCount())m_dataModel->setHeaderData(i,Qt::Horizontal,m_columnDefinitions[i].name); emit dataChanged();} }
-void DataEditorWidget::onTimeConvert() { DataCalculate c; QStringList h; for(int i=0;i<m_dataModel->columnCount();++i)h<<m_dataModel->headerData(i,Qt::Horizontal).toString(); TimeConversionDialog d(h,this); if(d.exec()==QDialog::Accepted){auto cfg=d.getConversionConfig(); auto res=c.convertTimeColumn(m_dataModel,m_columnDefinitions,cfg); if(res.success)QMessageBox::information(this,"成功","完成"); else QMessageBox::warning(this,"失败",res.errorMessage);} }
-void DataEditorWidget::onPressureDropCalc() { DataCalculate c; auto res=c.calculatePressureDrop(m_dataModel,m_columnDefinitions); if(res.success)QMessageBox::information(this,"成功","完成"); else QMessageBox::warning(this,"失败",res.errorMessage); }
-void DataEditorWidget::onCalcPwf() { DataCalculate c; QStringList h; for(int i=0;i<m_dataModel->columnCount();++i)h<<m_dataModel->headerData(i,Qt::Horizontal).toString(); PwfCalculationDialog d(h,this); if(d.exec()==QDialog::Accepted){auto cfg=d.getConfig(); auto res=c.calculateBottomHolePressure(m_dataModel,m_columnDefinitions,cfg); if(res.success){QMessageBox::information(this,"成功","完成");emit dataChanged();} else QMessageBox::warning(this,"失败",res.errorMessage);} }
+void DataEditorWidget::deserializeJsonToModel(const QJsonArray& a) { m_undoStack->clear(); m_dataModel->clear(); m_columnDefinitions.clear(); if(a.isEmpty())return; QJsonObject h=a.first().toObject(); if(h.contains("headers")){QJsonArray hs=h["headers"].toArray(); QStringList sl; for(auto v:hs)sl<<v.toString(); m_dataModel->setHorizontalHeaderLabels(sl); for(auto s:sl){ColumnDefinition d; d.name=s; m_columnDefinitions.append(d);}} for(int i=1;i<a.size();++i){QJsonObject o=a[i].toObject(); if(o.contains("row_data")){QJsonArray r=o["row_data"].toArray(); QList<QStandardItem*> l; for(auto v:r)l.append(new QStandardItem(v.toString())); m_dataModel->appendRow(l);}} }
+void DataEditorWidget::onDefineColumns() { QStringList h; for(int i=0;i<m_dataModel->columnCount();++i)h<<m_dataModel->headerData(i,Qt::Horizontal).toString(); DataColumnDialog d(h,m_columnDefinitions,this); if(d.exec()==QDialog::Accepted){auto* cmd=new ColumnDefinitionsCommand(m_dataModel,&m_columnDefinitions,m_columnDefinitions,d.getColumnDefinitions()); m_columnDefinitions=d.getColumnDefinitions(); for(int i=0;i<m_columnDefinitions.size();++i)if(i<m_dataModel->columnCount())m_dataModel->setHeaderData(i,Qt::Horizontal,m_columnDefinitions[i].name); pushUndo(cmd); emit dataChanged();} }
+void DataEditorWidget::onTimeConvert() { DataCalculate c; QStringList h; for(int i=0;i<m_dataModel->columnCount();++i)h<<m_dataModel->headerData(i,Qt::Horizontal).toString(); TimeConversionDialog d(h,this); if(d.exec()==QDialog::Accepted){auto cfg=d.getConversionConfig(); auto res=c.convertTimeColumn(m_dataModel,m_columnDefinitions,cfg); if(res.success)pushUndo(new InsertColumnCommand(m_dataModel,&m_columnDefinitions,res.addedColumnIndex,ColumnBuffer::capture(m_dataModel,res.addedColumnIndex,&m_columnDefinitions),"时间转换",true)); if(res.success)QMessageBox::information(this,"成功","完成"); else QMessageBox::warning(this,"失败",res.errorMessage);} }
+void DataEditorWidget::onPressureDropCalc() { DataCalculate c; auto res=c.calculatePressureDrop(m_dataModel,m_columnDefinitions); if(res.success)pushUndo(new InsertColumnCommand(m_dataModel,&m_columnDefinitions,res.addedColumnIndex,ColumnBuffer::capture(m_dataModel,res.addedColumnIndex,&m_columnDefinitions),"压降计算",true)); if(res.success)QMessageBox::information(this,"成功","完成"); else QMessageBox::warning(this,"失败",res.errorMessage); }
+void DataEditorWidget::onCalcPwf() { DataCalculate c; QStringList h; for(int i=0;i<m_dataModel->columnCount();++i)h<<m_dataModel->headerData(i,Qt::Horizontal).toString(); PwfCalculationDialog d(h,this); if(d.exec()==QDialog::Accepted){auto cfg=d.getConfig(); auto res=c.calculateBottomHolePressure(m_dataModel,m_columnDefinitions,cfg); if(res.success){pushUndo(new InsertColumnCommand(m_dataModel,&m_columnDefinitions,res.addedColumnIndex,ColumnBuffer::capture(m_dataModel,res.addedColumnIndex,&m_columnDefinitions),"井底流压计算",true)); QMessageBox::information(this,"成功","完成");emit dataChanged();} else QMessageBox::warning(this,"失败",res.errorMessage);} }
 void DataEditorWidget::onSearchTextChanged() { m_searchTimer->start(); }
-void DataEditorWidget::clearAllData() { m_dataModel->clear(); m_columnDefinitions.clear(); m_currentFilePath.clear(); ui->filePathLabel->setText("当前文件: "); ui->statusLabel->setText("无数据"); updateButtonsState(); emit dataChanged(); }
+
+void DataEditorWidget::invalidateSearchIndex()
+{
+    m_searchIndexStale = true;
+    if (m_proxyModel->hasRowMask()) m_searchTimer->start();
+}
+
+void DataEditorWidget::beginColumnSnapshot(QStringList& headers, QVector<QStringList>& columns) const
+{
+    const int rows = m_dataModel->rowCount();
+    const int cols = m_dataModel->columnCount();
+    headers.clear();
+    columns = QVector<QStringList>(cols);
+    for (int c = 0; c < cols; ++c) {
+        headers << m_dataModel->headerData(c, Qt::Horizontal).toString();
+        columns[c].reserve(rows);
+    }
+}
+
+int DataEditorWidget::copySnapshotRows(QVector<QStringList>& columns, int row) const
+{
+    const int cellsPerStep = 50000;
+    const int cols = columns.size();
+    const int end = qMin(m_dataModel->rowCount(), row + qMax(1, cellsPerStep / qMax(1, cols)));
+    for (int c = 0; c < cols; ++c) {
+        QStringList& col = columns[c];
+        for (int r = row; r < end; ++r) {
+            QStandardItem* item = m_dataModel->item(r, c);
+            col.append(item ? item->text() : QString());
+        }
+    }
+    return end;
+}
+
+// 在界面线程分批复制列快照，后台构建索引；复制期间的修改记入 m_pendingIndexEdits
+void DataEditorWidget::startSearchIndexBuild()
+{
+    if (m_indexWatcher->isRunning() || m_indexSnapshotRow >= 0) return;
+    beginColumnSnapshot(m_indexSnapshotHeaders, m_indexSnapshotColumns);
+    m_indexSnapshotRow = 0;
+    m_searchIndexStale = false;
+    m_pendingIndexEdits.clear();
+    ui->statusLabel->setText("正在建立搜索索引...");
+    m_indexSnapshotTimer->start();
+}
+
+void DataEditorWidget::onIndexSnapshotStep()
+{
+    if (m_indexSnapshotRow < 0) return;
+    if (m_searchIndexStale) {
+        // 复制期间表格结构已变化，重新开始
+        m_indexSnapshotRow = -1;
+        m_indexSnapshotHeaders.clear();
+        m_indexSnapshotColumns.clear();
+        m_pendingIndexEdits.clear();
+        if (!ui->searchLineEdit->text().trimmed().isEmpty()) startSearchIndexBuild();
+        return;
+    }
+
+    const int rows = m_dataModel->rowCount();
+    m_indexSnapshotRow = copySnapshotRows(m_indexSnapshotColumns, m_indexSnapshotRow);
+    if (m_indexSnapshotRow < rows) {
+        m_indexSnapshotTimer->start();
+        return;
+    }
+
+    QStringList headers;
+    QVector<QStringList> columns;
+    headers.swap(m_indexSnapshotHeaders);
+    columns.swap(m_indexSnapshotColumns);
+    m_indexSnapshotRow = -1;
+    m_indexWatcher->setFuture(QtConcurrent::run([headers, columns, rows]() {
+        return TableSearchIndex::build(headers, columns, rows);
+    }));
+}
+
+void DataEditorWidget::onSearchIndexBuilt()
+{
+    std::shared_ptr<TableSearchIndex> index = m_indexWatcher->result();
+    if (m_searchIndexStale) {
+        // 构建期间表格结构已变化，结果作废
+        m_pendingIndexEdits.clear();
+        if (!ui->searchLineEdit->text().trimmed().isEmpty()) startSearchIndexBuild();
+        return;
+    }
+    m_searchIndex = index;
+    for (const auto& e : std::as_const(m_pendingIndexEdits)) {
+        QStandardItem* item = m_dataModel->item(e.first, e.second);
+        m_searchIndex->updateCell(e.first, e.second, item ? item->text() : QString());
+    }
+    m_pendingIndexEdits.clear();
+    // 表头在复制与构建期间可能被改名
+    for (int c = 0; c < m_searchIndex->columnCount(); ++c)
+        m_searchIndex->setHeader(c, m_dataModel->headerData(c, Qt::Horizontal).toString());
+    applySearch();
+}
+
+void DataEditorWidget::applySearch()
+{
+    const QString text = ui->searchLineEdit->text().trimmed();
+    if (text.isEmpty()) {
+        m_proxyModel->clearRowMask();
+        return;
+    }
+    if (!m_searchIndex || m_searchIndexStale) {
+        startSearchIndexBuild();
+        return;
+    }
+
+    QBitArray mask;
+    QString err;
+    if (!m_searchIndex->query(text, mask, &err)) {
+        ui->statusLabel->setText("查询错误: " + err);
+        return;
+    }
+    m_proxyModel->setRowMask(mask);
+    ui->statusLabel->setText(QString("匹配 %1 行").arg(mask.count(true)));
+}
+void DataEditorWidget::clearAllData() { m_undoStack->clear(); m_dataModel->clear(); m_columnDefinitions.clear(); m_computedColumns.clear(); m_recomputeTimer->stop(); m_currentFilePath.clear(); ui->filePathLabel->setText("当前文件: "); ui->statusLabel->setText("无数据"); updateButtonsState(); emit dataChanged(); }
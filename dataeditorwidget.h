@@ -20,7 +20,14 @@
 #include <QStyledItemDelegate>
 #include <QTimer>
 #include <QDialog>
+#include <QFutureWatcher>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSet>
+#include <memory>
 #include "dataimportdialog.h"
+#include "textdataimporter.h"
+#include "tablesearchindex.h"
 
 // 定义列的枚举类型
 enum class WellTestColumnType {
@@ -40,10 +47,39 @@ struct ColumnDefinition {
     ColumnDefinition() : type(WellTestColumnType::Custom), isRequired(false), decimalPlaces(3) {}
 };
 
+// 后台加载结果：工作线程按列构建好单元格，界面线程一次性交换进模型
+struct DataLoadResult {
+    bool success = false;
+    bool cancelled = false;
+    QString errorMessage;
+    QString filePath;
+    QString fileType;
+    QStringList headers;
+    QList<QList<QStandardItem*>> columns;
+    int rowCount = 0;
+    quint64 generation = 0;     // 加载批次号，用于丢弃被新加载取代的结果
+};
+
+// 表达式计算列状态：输入列的单元格变化时只标记受影响的行，稍后批量重算
+struct ComputedColumnState {
+    QString expression;
+    QMap<QString, double> variables;
+    int decimalPlaces = 3;
+    QVector<int> inputColumns;  // 最近一次绑定得到的输入列号
+    int targetColumn = -1;
+    QSet<int> dirtyRows;
+    bool fullDirty = false;
+};
+
 namespace Ui {
 class DataEditorWidget;
 }
 
+class AutoSaveService;
+class TableUndoCommand;
+struct QualityCheckReport;
+struct DeconvolutionResult;
+
 // 内部类前置声明
 class InternalSplitDialog;
 
@@ -55,6 +91,12 @@ public:
 
     QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option,
                           const QModelIndex &index) const override;
+    // 提交编辑时记录新旧文本，供撤销栈使用
+    void setModelData(QWidget *editor, QAbstractItemModel *model,
+                      const QModelIndex &index) const override;
+
+signals:
+    void cellEdited(const QModelIndex& index, const QString& oldText, const QString& newText) const;
 };
 
 class DataEditorWidget : public QWidget
@@ -72,15 +114,20 @@ public:
     QString getCurrentFileName() const;
     bool hasData() const;
     QList<ColumnDefinition> getColumnDefinitions() const { return m_columnDefinitions; }
+    // 设置自动保存服务后，手动保存由服务在后台完成 (同时清理增量日志)
+    void setAutoSaveService(AutoSaveService* service);
 
 signals:
     void dataChanged();
     void fileChanged(const QString& filePath, const QString& fileType);
+    // 反褶积得到的恒产量响应 (时间, 压降, 导数)，作为观测数据送往拟合界面
+    void deconvolutionReady(const QVector<double>& t, const QVector<double>& deltaP, const QVector<double>& deriv);
 
 private slots:
     // 文件操作
     void onOpenFile();
     void onSave();
+    void onSaveFinished(bool ok, const QString& error);
     void onExportExcel();
 
     // 数据处理
@@ -88,7 +135,9 @@ private slots:
     void onTimeConvert();
     void onPressureDropCalc();
     void onCalcPwf();
+    void onExpressionColumn();
     void onHighlightErrors();
+    void onDeconvolution();
 
     // 搜索
     void onSearchTextChanged();
@@ -113,20 +162,89 @@ private slots:
     void onHideCol();
     void onShowAllCols();
 
-    void onModelDataChanged();
+    void onModelDataChanged(QStandardItem* item);
+    void onRecomputeComputedColumns();
+    void onSearchIndexBuilt();
+    void onCellEdited(const QModelIndex& index, const QString& oldText, const QString& newText);
+    void onQualityCheckFinished();
+    void onDeconvolutionFinished();
+
+    // 后台加载
+    void onLoadFinished();
+    void onCancelLoad();
+    void onLoadProgressTick();
 
 private:
     Ui::DataEditorWidget *ui;
 
     QStandardItemModel* m_dataModel;
-    QSortFilterProxyModel* m_proxyModel;
+    RowMaskFilterProxyModel* m_proxyModel;
     QUndoStack* m_undoStack;
+    QAction* m_undoAction;
+    QAction* m_redoAction;
 
     QList<ColumnDefinition> m_columnDefinitions;
     QString m_currentFilePath;
     QMenu* m_contextMenu;
     QTimer* m_searchTimer;
 
+    // 后台加载状态
+    QFutureWatcher<DataLoadResult>* m_loadWatcher;
+    std::shared_ptr<ImportControl> m_loadControl;
+    QProgressBar* m_loadProgressBar;
+    QPushButton* m_btnCancelLoad;
+    QTimer* m_loadProgressTimer;
+    quint64 m_loadGeneration;
+
+    AutoSaveService* m_autoSave;
+    bool m_saveInProgress;            // 手动保存已提交，等待 saveFinished
+
+    // 表达式计算列 (惰性重算)
+    QList<ComputedColumnState> m_computedColumns;
+    QTimer* m_recomputeTimer;
+    bool m_computedBindingsStale;
+    bool m_recomputingColumns;
+    void rebindComputedColumns();
+    void saveComputedColumns();
+    void restoreComputedColumns();
+
+    // 搜索索引 (后台构建，编辑时增量更新)
+    std::shared_ptr<TableSearchIndex> m_searchIndex;
+    QFutureWatcher<std::shared_ptr<TableSearchIndex>>* m_indexWatcher;
+    bool m_searchIndexStale;
+    QList<QPair<int, int>> m_pendingIndexEdits;  // 构建期间的单元格修改 (行, 列)
+    // 不经 itemChanged 改写的单元格 (计算列整列重算) 同步到搜索索引
+    void syncSearchIndexColumn(int col, const QVector<int>& rows);
+    // 索引快照在界面线程分批复制 (每批有限个单元格)，复制完再交给后台构建
+    QTimer* m_indexSnapshotTimer;
+    QStringList m_indexSnapshotHeaders;
+    QVector<QStringList> m_indexSnapshotColumns;
+    int m_indexSnapshotRow;                      // 已复制到的行，-1 表示没有正在复制的快照
+    void startSearchIndexBuild();
+    void onIndexSnapshotStep();
+    void applySearch();
+    void invalidateSearchIndex();
+
+    // 数据质量检查 (后台并行执行，结果以代理模型背景色惰性显示)
+    QFutureWatcher<QualityCheckReport>* m_qualityWatcher;
+    bool m_qualityStale;
+    // 检查输入同样在界面线程分批复制
+    QTimer* m_qualitySnapshotTimer;
+    QStringList m_qualitySnapshotHeaders;
+    QVector<QStringList> m_qualitySnapshotColumns;
+    int m_qualitySnapshotRow;                    // 已复制到的行，-1 表示没有正在复制的快照
+    void onQualitySnapshotStep();
+    // 压力-产量反褶积 (后台执行)
+    QFutureWatcher<DeconvolutionResult>* m_deconvWatcher;
+    // 列文本快照分批复制：beginColumnSnapshot 取表头并预留空间，
+    // copySnapshotRows 从 row 起复制一批 (有限个单元格)，返回复制到的行
+    void beginColumnSnapshot(QStringList& headers, QVector<QStringList>& columns) const;
+    int copySnapshotRows(QVector<QStringList>& columns, int row) const;
+
+    // 撤销/重做：命令入栈并控制撤销栈总内存
+    void pushUndo(TableUndoCommand* command);
+    qint64 undoStackBytes() const;
+
     void initUI();
     void setupConnections();
     void setupModel();
@@ -135,6 +253,14 @@ private:
     bool loadFileInternal(const QString& path);
     bool loadFileWithConfig(const DataImportSettings& settings);
 
+    // 后台加载：读取解析与单元格构建均在工作线程，完成后一次性交换进模型
+    static DataImportSettings defaultImportSettings(const QString& path);
+    static DataLoadResult runLoadTask(const DataImportSettings& settings, ImportControl* control);
+    static void discardLoadResult(DataLoadResult& result);
+    void startAsyncLoad(const DataImportSettings& settings, const QString& fileType);
+    void cancelRunningLoad();
+    void applyLoadResult(DataLoadResult& result);
+
     QJsonArray serializeModelToJson() const;
     void deserializeJsonToModel(const QJsonArray& array);
 };
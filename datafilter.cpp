@@ -0,0 +1,278 @@
+/*
+ * 文件名: datafilter.cpp
+ * 文件作用: 曲线平滑滤波器实现文件
+ * 功能描述:
+ * 1. 移动平均与对数时间窗均为滑动窗口增量求和，Neumaier 补偿避免长序列累积误差。
+ * 2. Savitzky-Golay 的卷积按 "系数 × 整段数据" 的方式分块累加，内层循环无数据依赖，
+ *    便于编译器生成 SIMD 指令。
+ * 3. 中值滤波用两个有序多重集合 (低半区/高半区) 维护窗口，插入删除 O(log span)。
+ */
+
+#include "datafilter.h"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <vector>
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// Neumaier 补偿求和的滑动窗口和
+struct RunningSum {
+    double sum = 0.0;
+    double comp = 0.0;
+    int count = 0;
+
+    void add(double x)
+    {
+        const double s = sum + x;
+        if (std::abs(sum) >= std::abs(x)) comp += (sum - s) + x;
+        else comp += (x - s) + sum;
+        sum = s;
+    }
+    void insert(double x) { add(x); ++count; }
+    void remove(double x)
+    {
+        add(-x);
+        if (--count == 0) { sum = 0.0; comp = 0.0; } // 窗口清空时归零，防止误差残留
+    }
+    double mean() const { return count > 0 ? (sum + comp) / count : kNaN; }
+};
+
+// 中值滤波窗口：lo 存较小的一半 (含中位数)，hi 存较大的一半
+struct MedianWindow {
+    std::multiset<double> lo, hi;
+
+    void insert(double x)
+    {
+        if (lo.empty() || x <= *lo.rbegin()) lo.insert(x);
+        else hi.insert(x);
+        rebalance();
+    }
+    void erase(double x)
+    {
+        if (!lo.empty() && x <= *lo.rbegin()) lo.erase(lo.find(x));
+        else hi.erase(hi.find(x));
+        rebalance();
+    }
+    void rebalance()
+    {
+        while (lo.size() > hi.size() + 1) {
+            auto it = std::prev(lo.end());
+            hi.insert(*it);
+            lo.erase(it);
+        }
+        while (hi.size() > lo.size()) {
+            lo.insert(*hi.begin());
+            hi.erase(hi.begin());
+        }
+    }
+    double value() const
+    {
+        if (lo.empty()) return kNaN;
+        if (lo.size() > hi.size()) return *lo.rbegin();
+        return 0.5 * (*lo.rbegin() + *hi.begin());
+    }
+};
+
+int oddSpan(int span) { return span % 2 == 0 ? span + 1 : span; }
+
+} // namespace
+
+// ============================================================================
+// 移动平均
+// ============================================================================
+
+void DataFilter::movingAverage(const double* in, int n, int span, double* out)
+{
+    if (n <= 0) return;
+    if (span <= 1) { std::copy(in, in + n, out); return; }
+    const int half = oddSpan(span) / 2;
+
+    // 窗口 [i-half, i+half]，越界部分自动截断
+    RunningSum w;
+    for (int j = 0; j <= half && j < n; ++j) if (std::isfinite(in[j])) w.insert(in[j]);
+    for (int i = 0; i < n; ++i) {
+        out[i] = w.count > 0 ? w.mean() : in[i];
+        const int drop = i - half;
+        const int take = i + half + 1;
+        if (drop >= 0 && std::isfinite(in[drop])) w.remove(in[drop]);
+        if (take < n && std::isfinite(in[take])) w.insert(in[take]);
+    }
+}
+
+QVector<double> DataFilter::movingAverage(const QVector<double>& data, int span)
+{
+    if (data.isEmpty()) return QVector<double>();
+    if (span <= 1) return data;
+    QVector<double> out(data.size());
+    movingAverage(data.constData(), data.size(), span, out.data());
+    return out;
+}
+
+// ============================================================================
+// Savitzky-Golay
+// ============================================================================
+
+void DataFilter::savitzkyGolay(const double* in, int n, int span, int order, double* out)
+{
+    if (n <= 0) return;
+    span = oddSpan(span);
+    if (span > n) span = (n % 2 == 0) ? n - 1 : n;
+    order = qBound(0, order, span - 1);
+    if (span <= 1 || order >= span - 1) { std::copy(in, in + n, out); return; }
+    const int half = span / 2;
+
+    // 卷积系数：第 p 行为用窗口 [0, span) 拟合后在位置 p 的取值权重 (中心行 p = half 用于内部点)
+    Eigen::MatrixXd A(span, order + 1);
+    for (int j = 0; j < span; ++j) {
+        double x = 1.0;
+        for (int k = 0; k <= order; ++k) { A(j, k) = x; x *= (j - half); }
+    }
+    const Eigen::MatrixXd M = (A.transpose() * A).ldlt().solve(A.transpose()); // (order+1) x span
+    const Eigen::MatrixXd C = A * M;                                           // span x span
+
+    // 含非有限值的窗口保持原值
+    std::vector<int> badPrefix(n + 1, 0);
+    for (int i = 0; i < n; ++i) badPrefix[i + 1] = badPrefix[i] + (std::isfinite(in[i]) ? 0 : 1);
+    auto windowClean = [&](int begin) { return badPrefix[begin + span] == badPrefix[begin]; };
+
+    // 内部点：按系数逐项累加整块数据 (分块以保持缓存命中)
+    const int kBlock = 4096;
+    std::vector<double> coef(span);
+    for (int j = 0; j < span; ++j) coef[j] = C(half, j);
+    for (int b = half; b < n - half; b += kBlock) {
+        const int e = qMin(n - half, b + kBlock);
+        double* o = out + b;
+        const int len = e - b;
+        std::fill(o, o + len, 0.0);
+        for (int j = 0; j < span; ++j) {
+            const double cj = coef[j];
+            const double* src = in + b - half + j;
+            for (int i = 0; i < len; ++i) o[i] += cj * src[i];
+        }
+        for (int i = b; i < e; ++i) if (!windowClean(i - half)) out[i] = in[i];
+    }
+
+    // 边缘点：首/尾窗口的多项式在对应位置的取值
+    for (int i = 0; i < half; ++i) {
+        const int tail = n - 1 - i;
+        double head = 0.0, end = 0.0;
+        for (int j = 0; j < span; ++j) {
+            head += C(i, j) * in[j];
+            end += C(span - 1 - i, j) * in[n - span + j];
+        }
+        out[i] = windowClean(0) ? head : in[i];
+        out[tail] = windowClean(n - span) ? end : in[tail];
+    }
+}
+
+QVector<double> DataFilter::savitzkyGolay(const QVector<double>& data, int span, int order)
+{
+    if (data.isEmpty()) return QVector<double>();
+    QVector<double> out(data.size());
+    savitzkyGolay(data.constData(), data.size(), span, order, out.data());
+    return out;
+}
+
+// ============================================================================
+// 对数时间窗平均
+// ============================================================================
+
+void DataFilter::logTimeWindow(const double* t, const double* in, int n, double halfWidth, double* out)
+{
+    if (n <= 0) return;
+    std::vector<double> lt(n);
+    for (int i = 0; i < n; ++i) lt[i] = t[i] > 0 ? std::log(t[i]) : kNaN;
+    auto valid = [&](int j) { return std::isfinite(lt[j]) && std::isfinite(in[j]); };
+
+    // 双指针：窗口为下标区间 [lo, hi)，t 升序时两端单调前移
+    RunningSum w;
+    int lo = 0, hi = 0;
+    for (int i = 0; i < n; ++i) {
+        if (!std::isfinite(lt[i])) { out[i] = in[i]; continue; }
+        while (hi < n && (!std::isfinite(lt[hi]) || lt[hi] <= lt[i] + halfWidth)) {
+            if (valid(hi)) w.insert(in[hi]);
+            ++hi;
+        }
+        while (lo < hi && (!std::isfinite(lt[lo]) || lt[lo] < lt[i] - halfWidth)) {
+            if (valid(lo)) w.remove(in[lo]);
+            ++lo;
+        }
+        out[i] = w.count > 0 ? w.mean() : in[i];
+    }
+}
+
+QVector<double> DataFilter::logTimeWindow(const QVector<double>& t, const QVector<double>& data, double halfWidth)
+{
+    if (data.isEmpty() || t.size() != data.size()) return data;
+    QVector<double> out(data.size());
+    logTimeWindow(t.constData(), data.constData(), data.size(), halfWidth, out.data());
+    return out;
+}
+
+// ============================================================================
+// 中值滤波
+// ============================================================================
+
+void DataFilter::median(const double* in, int n, int span, double* out)
+{
+    if (n <= 0) return;
+    if (span <= 1) { std::copy(in, in + n, out); return; }
+    const int half = oddSpan(span) / 2;
+
+    MedianWindow w;
+    for (int j = 0; j <= half && j < n; ++j) if (std::isfinite(in[j])) w.insert(in[j]);
+    for (int i = 0; i < n; ++i) {
+        const double m = w.value();
+        out[i] = std::isfinite(m) ? m : in[i];
+        const int drop = i - half;
+        const int take = i + half + 1;
+        if (drop >= 0 && std::isfinite(in[drop])) w.erase(in[drop]);
+        if (take < n && std::isfinite(in[take])) w.insert(in[take]);
+    }
+}
+
+QVector<double> DataFilter::median(const QVector<double>& data, int span)
+{
+    if (data.isEmpty()) return QVector<double>();
+    if (span <= 1) return data;
+    QVector<double> out(data.size());
+    median(data.constData(), data.size(), span, out.data());
+    return out;
+}
+
+// ============================================================================
+// 分派
+// ============================================================================
+
+QVector<double> DataFilter::smooth(SmoothMethod method, const QVector<double>& t, const QVector<double>& data,
+                                   int span, double logHalfWidth)
+{
+    switch (method) {
+    case SmoothMethod::SavitzkyGolay:
+        return savitzkyGolay(data, span, 2);
+    case SmoothMethod::LogTimeWindow:
+        if (t.size() == data.size()) return logTimeWindow(t, data, logHalfWidth * std::log(10.0));
+        return movingAverage(data, span);
+    case SmoothMethod::Median:
+        return median(data, span);
+    case SmoothMethod::MovingAverage:
+    default:
+        return movingAverage(data, span);
+    }
+}
+
+QString DataFilter::methodName(SmoothMethod method)
+{
+    switch (method) {
+    case SmoothMethod::MovingAverage: return "移动平均";
+    case SmoothMethod::SavitzkyGolay: return "Savitzky-Golay";
+    case SmoothMethod::LogTimeWindow: return "对数时间窗";
+    case SmoothMethod::Median: return "中值滤波";
+    }
+    return QString();
+}
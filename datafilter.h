@@ -0,0 +1,71 @@
+/*
+ * 文件名: datafilter.h
+ * 文件作用: 曲线平滑滤波器头文件
+ * 功能描述:
+ * 1. 移动平均：窗口滑动时增量维护和 (补偿求和)，复杂度 O(n)，与窗口大小无关。
+ * 2. Savitzky-Golay：按多项式最小二乘预先求卷积系数，边缘用首/尾窗口拟合值，保留峰形。
+ * 3. 对数时间窗平滑：窗口为 ln(t) ± L，双指针滑动，适合对数分布的试井数据。
+ * 4. 中值滤波：双堆 (有序多重集合) 维护窗口，复杂度 O(n log span)，可剔除孤立尖峰。
+ * 5. 各滤波器在原始指针区间上运算，QVector 接口为其包装；非有限值 (NaN) 不参与窗口统计。
+ */
+
+#ifndef DATAFILTER_H
+#define DATAFILTER_H
+
+#include <QVector>
+#include <QString>
+
+// 平滑方法
+enum class SmoothMethod {
+    MovingAverage = 0,  // 移动平均 (类似 Matlab smooth)
+    SavitzkyGolay,      // Savitzky-Golay 多项式平滑
+    LogTimeWindow,      // 对数时间窗平均
+    Median              // 中值滤波
+};
+
+class DataFilter
+{
+public:
+    /**
+     * @brief 移动平均，边缘处窗口自动缩小
+     * @param span 窗口大小 (偶数自动 +1)
+     */
+    static void movingAverage(const double* in, int n, int span, double* out);
+    static QVector<double> movingAverage(const QVector<double>& data, int span);
+
+    /**
+     * @brief Savitzky-Golay 平滑
+     * @param span 窗口大小 (奇数，偶数自动 +1)
+     * @param order 多项式阶数 (小于 span)
+     */
+    static void savitzkyGolay(const double* in, int n, int span, int order, double* out);
+    static QVector<double> savitzkyGolay(const QVector<double>& data, int span, int order = 2);
+
+    /**
+     * @brief 对数时间窗平均：对每个点取 |ln(t_j) - ln(t_i)| <= halfWidth 的点求平均
+     * @param t 时间 (升序，t <= 0 的点原样输出)
+     * @param halfWidth ln(t) 半窗宽
+     */
+    static void logTimeWindow(const double* t, const double* in, int n, double halfWidth, double* out);
+    static QVector<double> logTimeWindow(const QVector<double>& t, const QVector<double>& data, double halfWidth);
+
+    /**
+     * @brief 中值滤波，边缘处窗口自动缩小
+     * @param span 窗口大小 (偶数自动 +1)
+     */
+    static void median(const double* in, int n, int span, double* out);
+    static QVector<double> median(const QVector<double>& data, int span);
+
+    /**
+     * @brief 按方法分派
+     * @param t 时间 (仅对数时间窗需要)
+     * @param span 窗口点数 (移动平均/SG/中值)
+     * @param logHalfWidth 对数时间窗的 log10 半窗宽 (周期)
+     */
+    static QVector<double> smooth(SmoothMethod method, const QVector<double>& t, const QVector<double>& data,
+                                  int span, double logHalfWidth = 0.1);
+
+    static QString methodName(SmoothMethod method);
+};
+
+#endif // DATAFILTER_H
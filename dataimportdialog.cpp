@@ -9,6 +9,8 @@
 
 #include "dataimportdialog.h"
 #include "ui_dataimportdialog.h"
+#include "textdataimporter.h"
+#include "xlsxstreamreader.h"
 #include <QFile>
 #include <QDebug>
 #include <QMessageBox>
@@ -110,41 +112,25 @@ void DataImportDialog::readExcelForPreview()
 {
     m_excelPreviewData.clear();
 
-    // 分支 1: 使用 QXlsx 读取 .xlsx 文件
+    // 分支 1: 流式读取 .xlsx 文件 (XlsxStreamReader)
     if (m_filePath.endsWith(".xlsx", Qt::CaseInsensitive)) {
-        QXlsx::Document xlsx(m_filePath);
-        if (!xlsx.load()) {
+        // 流式读取前 50 行 / 20 列，读满即停止
+        DataImportSettings s;
+        s.filePath = m_filePath;
+        s.startRow = 1;
+        s.headerRow = 1;
+        s.useHeader = false;
+        s.isExcel = true;
+        XlsxReadResult res = XlsxStreamReader::readFirstSheet(s, 50, 20);
+        if (!res.success) {
             QMessageBox::warning(this, "警告", "无法加载 .xlsx 文件。");
             return;
         }
 
-        if (xlsx.currentWorksheet() == nullptr) {
-            QStringList sheets = xlsx.sheetNames();
-            if (!sheets.isEmpty()) xlsx.selectSheet(sheets.first());
-        }
-
-        QXlsx::CellRange dim = xlsx.dimension();
-        int maxRow = dim.lastRow();
-        int maxCol = dim.lastColumn();
-
-        int readRowCount = (maxRow > 50) ? 50 : maxRow;
-        int readColCount = (maxCol > 20) ? 20 : maxCol;
-
-        for (int r = 1; r <= readRowCount; ++r) {
-            QStringList rowData;
-            for (int c = 1; c <= readColCount; ++c) {
-                std::shared_ptr<QXlsx::Cell> cell = xlsx.cellAt(r, c);
-                if (cell) {
-                    // [修复] 先 readValue 再 toDateTime
-                    if (cell->isDateTime()) {
-                        rowData.append(cell->readValue().toDateTime().toString("yyyy-MM-dd hh:mm:ss"));
-                    } else {
-                        rowData.append(cell->value().toString());
-                    }
-                } else {
-                    rowData.append("");
-                }
-            }
+        int readColCount = res.table.columnCount;
+        for (const QStringList& row : res.table.rows) {
+            QStringList rowData = row;
+            while (rowData.size() < readColCount) rowData.append("");
             m_excelPreviewData.append(rowData);
         }
         return;
@@ -321,6 +307,8 @@ QChar DataImportDialog::getSeparatorChar(const QString& sepStr, const QString& l
     if (sepStr.contains("Space")) return ' ';
     if (sepStr.contains("Semicolon")) return ';';
     if (sepStr.contains("Auto")) {
+        // 与正式导入使用同一套识别逻辑，保证预览与导入结果一致
+        if (!m_previewLines.isEmpty()) return TextDataImporter::detectSeparator(m_previewLines.join('\n'));
         if (lineData.count('\t') > lineData.count(',')) return '\t';
         return ',';
     }
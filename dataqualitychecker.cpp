@@ -0,0 +1,330 @@
+/*
+ * 文件名: dataqualitychecker.cpp
+ * 文件作用: 数据质量检查实现文件
+ * 功能描述:
+ * 1. 解析与逐点检查按 (列, 数据块) 拆分后并行执行，平直段与台阶定位按列并行。
+ * 2. 噪声水平由一阶差分的中位数绝对值稳健估计，作为尖峰与台阶阈值的下限，
+ *    避免量化后 MAD 为 0 的平稳段产生大量误报。
+ * 3. 连续行上的同类问题合并为一条 (rowCount > 1)。
+ */
+
+#include "dataqualitychecker.h"
+#include "textdataimporter.h"
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+const int kChunk = 65536;
+
+enum class ColumnRole { Ignore, Time, Pressure, Temperature, Rate, Other };
+
+// 列在检查中的角色：优先按列定义类型，未定义 (Custom) 时按表头推断
+ColumnRole columnRole(WellTestColumnType type, const QString& header)
+{
+    switch (type) {
+    case WellTestColumnType::Time: return ColumnRole::Time;
+    case WellTestColumnType::Pressure:
+    case WellTestColumnType::CasingPressure:
+    case WellTestColumnType::BottomHolePressure: return ColumnRole::Pressure;
+    case WellTestColumnType::Temperature: return ColumnRole::Temperature;
+    case WellTestColumnType::FlowRate: return ColumnRole::Rate;
+    case WellTestColumnType::SerialNumber:
+    case WellTestColumnType::Date:
+    case WellTestColumnType::TimeOfDay: return ColumnRole::Ignore;
+    case WellTestColumnType::Custom: break;
+    default: return ColumnRole::Other;
+    }
+
+    const QString h = header.toLower();
+    const QString base = h.section('\\', 0, 0).section('(', 0, 0).section(QChar(0xFF08), 0, 0).trimmed();
+    if (h.contains("时间") || h.contains("time") || base == "t") return ColumnRole::Time;
+    if (h.contains("压降") || base == "dp") return ColumnRole::Other;
+    if (h.contains("压") || h.contains("pressure") || base == "p" || base == "pwf") return ColumnRole::Pressure;
+    if (h.contains("温") || h.contains("temp")) return ColumnRole::Temperature;
+    if (h.contains("产") || h.contains("流量") || h.contains("rate") || base == "q") return ColumnRole::Rate;
+    return ColumnRole::Other;
+}
+
+// 中位数 (会重排 b)
+double medianInPlace(double* b, int n)
+{
+    const int mid = n / 2;
+    std::nth_element(b, b + mid, b + n);
+    double m = b[mid];
+    if (n % 2 == 0) m = 0.5 * (m + *std::max_element(b, b + mid));
+    return m;
+}
+
+// 噪声标准差的稳健估计：sigma = 1.4826 * median|x[i]-x[i-1]| / sqrt(2)
+double noiseSigma(const std::vector<double>& v)
+{
+    std::vector<double> d;
+    d.reserve(v.size());
+    double prev = kNaN;
+    double minStep = std::numeric_limits<double>::infinity();
+    for (double x : v) {
+        if (!std::isfinite(x)) continue;
+        if (std::isfinite(prev)) {
+            const double s = std::abs(x - prev);
+            d.push_back(s);
+            if (s > 0 && s < minStep) minStep = s;
+        }
+        prev = x;
+    }
+    if (d.empty()) return 0.0;
+    double sigma = 1.4826 * medianInPlace(d.data(), int(d.size())) / std::sqrt(2.0);
+    if (sigma <= 0 && std::isfinite(minStep)) sigma = minStep; // 量化数据：以分辨率为下限
+    return sigma;
+}
+
+// 区间 [begin, end) 内有限值的中位数，有效点数不足 minCount 时返回 NaN
+double windowMedian(const std::vector<double>& v, int begin, int end, int minCount, std::vector<double>& buf)
+{
+    buf.clear();
+    for (int i = qMax(0, begin); i < qMin(int(v.size()), end); ++i) {
+        if (std::isfinite(v[i])) buf.push_back(v[i]);
+    }
+    if (int(buf.size()) < minCount) return kNaN;
+    return medianInPlace(buf.data(), int(buf.size()));
+}
+
+struct ColumnData {
+    ColumnRole role = ColumnRole::Ignore;
+    std::vector<double> values;
+    std::vector<double> steps;  // 台阶检测：后窗口中位数 - 前窗口中位数
+    bool numeric = false;
+    double sigma = 0.0;
+};
+
+struct ChunkTask {
+    int column;
+    int begin;
+    int end;
+    QVector<QualityIssue> issues;
+};
+
+// 追加问题；与上一条同类、同列且行号相接时合并
+void addIssue(QVector<QualityIssue>& out, QualityIssueType type, QualitySeverity severity,
+              int col, int row, double value, const QString& message)
+{
+    if (!out.isEmpty()) {
+        QualityIssue& last = out.last();
+        if (last.type == type && last.column == col && last.row + last.rowCount == row) {
+            ++last.rowCount;
+            return;
+        }
+    }
+    out.append({type, severity, col, row, 1, value, message});
+}
+
+QVector<ChunkTask> makeChunks(const QVector<int>& columns, int rowCount)
+{
+    QVector<ChunkTask> tasks;
+    for (int c : columns) {
+        for (int b = 0; b < rowCount; b += kChunk) tasks.append({c, b, qMin(rowCount, b + kChunk), {}});
+    }
+    return tasks;
+}
+
+} // namespace
+
+QualityCheckReport DataQualityChecker::run(const QualityCheckInput& input, const QualityCheckConfig& config)
+{
+    QualityCheckReport report;
+    const int n = input.rowCount;
+    const int cols = input.columns.size();
+    if (n <= 0 || cols <= 0) {
+        report.errorMessage = "没有可检查的数据";
+        return report;
+    }
+
+    // 1. 解析数值 (列 × 数据块并行；各任务只写自己的区间，使用 std::vector 避免隐式共享的分离检查)
+    std::vector<ColumnData> data(cols);
+    QVector<int> allColumns;
+    for (int c = 0; c < cols; ++c) {
+        const WellTestColumnType type = c < input.types.size() ? input.types[c] : WellTestColumnType::Custom;
+        data[c].role = columnRole(type, c < input.headers.size() ? input.headers[c] : QString());
+        if (data[c].role == ColumnRole::Ignore) continue;
+        data[c].values.assign(n, kNaN);
+        allColumns.append(c);
+    }
+    std::vector<std::atomic<int>> finiteCount(cols), textCount(cols);
+    for (int c = 0; c < cols; ++c) { finiteCount[c] = 0; textCount[c] = 0; }
+
+    QVector<ChunkTask> parseTasks = makeChunks(allColumns, n);
+    QtConcurrent::blockingMap(parseTasks, [&](ChunkTask& t) {
+        const QStringList& texts = input.columns[t.column];
+        double* out = data[t.column].values.data();
+        int finite = 0, nonEmpty = 0;
+        for (int i = t.begin; i < t.end && i < texts.size(); ++i) {
+            const QString& s = texts[i];
+            if (s.isEmpty()) continue;
+            ++nonEmpty;
+            double v;
+            if (TextDataImporter::parseDouble(s, v) && std::isfinite(v)) { out[i] = v; ++finite; }
+        }
+        finiteCount[t.column] += finite;
+        textCount[t.column] += nonEmpty;
+    });
+
+    // 数值为主的列才参与检查；时间检查只取第一列时间列
+    QVector<int> checkColumns;
+    for (int c : std::as_const(allColumns)) {
+        ColumnData& d = data[c];
+        d.numeric = finiteCount[c] >= 3 && finiteCount[c] >= 0.8 * textCount[c];
+        if (!d.numeric) { std::vector<double>().swap(d.values); continue; }
+        if (d.role == ColumnRole::Time) {
+            if (report.timeColumn >= 0) { d.role = ColumnRole::Ignore; std::vector<double>().swap(d.values); continue; }
+            report.timeColumn = c;
+        }
+        checkColumns.append(c);
+    }
+
+    // 2. 各列噪声水平 (按列并行)
+    QtConcurrent::blockingMap(checkColumns, [&](int c) {
+        ColumnData& d = data[c];
+        if (d.role != ColumnRole::Time) d.sigma = noiseSigma(d.values);
+        if (d.role == ColumnRole::Pressure || d.role == ColumnRole::Temperature) d.steps.assign(n, 0.0);
+    });
+
+    // 3. 逐点检查 (列 × 数据块并行)
+    const int halfWin = qMax(1, config.medianWindow / 2);
+    const int minWin = qMin(5, 2 * halfWin + 1);
+    const int jumpWin = qMax(3, config.jumpWindow);
+    QVector<ChunkTask> tasks = makeChunks(checkColumns, n);
+    QtConcurrent::blockingMap(tasks, [&](ChunkTask& t) {
+        ColumnData& d = data[t.column];
+        const std::vector<double>& v = d.values;
+        std::vector<double> buf, dev;
+        buf.reserve(2 * qMax(halfWin, jumpWin) + 1);
+        dev.reserve(2 * halfWin + 1);
+
+        if (d.role == ColumnRole::Time) {
+            double prev = kNaN;
+            for (int i = t.begin - 1; i >= 0; --i) { if (std::isfinite(v[i])) { prev = v[i]; break; } }
+            for (int i = t.begin; i < t.end; ++i) {
+                const double x = v[i];
+                if (!std::isfinite(x)) continue;
+                if (std::isfinite(prev)) {
+                    if (x < prev) {
+                        addIssue(t.issues, QualityIssueType::NonMonotonicTime, QualitySeverity::Error, t.column, i, x,
+                                 QString("时间回退: %1 < 上一行 %2").arg(x).arg(prev));
+                    } else if (x == prev) {
+                        addIssue(t.issues, QualityIssueType::DuplicateTime, QualitySeverity::Warning, t.column, i, x,
+                                 QString("重复时间戳: %1").arg(x));
+                    }
+                }
+                prev = x;
+            }
+            return;
+        }
+
+        const bool gauge = d.role == ColumnRole::Pressure || d.role == ColumnRole::Temperature;
+        double* steps = gauge ? d.steps.data() : nullptr;
+        for (int i = t.begin; i < t.end; ++i) {
+            const double x = v[i];
+            if (!std::isfinite(x)) continue;
+
+            if (d.role == ColumnRole::Pressure && x < 0) {
+                addIssue(t.issues, QualityIssueType::NegativeValue, QualitySeverity::Error, t.column, i, x,
+                         QString("压力为负值: %1").arg(x));
+            }
+
+            // 尖峰：滑动中位数 + MAD，阈值不低于列噪声水平
+            const double med = windowMedian(v, i - halfWin, i + halfWin + 1, minWin, buf);
+            if (std::isfinite(med)) {
+                dev.clear();
+                for (double b : buf) dev.push_back(std::abs(b - med));
+                const double mad = medianInPlace(dev.data(), int(dev.size()));
+                const double scale = qMax(1.4826 * mad, d.sigma);
+                if (scale > 0 && std::abs(x - med) > config.spikeThreshold * scale) {
+                    addIssue(t.issues, QualityIssueType::Spike, QualitySeverity::Warning, t.column, i, x,
+                             QString("尖峰: %1 (局部中位数 %2)").arg(x).arg(med));
+                }
+            }
+
+            // 台阶：前后窗口中位数之差 (第 4 步中取局部最大值定位)
+            if (steps && i >= jumpWin && i + jumpWin <= n) {
+                const double before = windowMedian(v, i - jumpWin, i, jumpWin / 2, buf);
+                const double after = windowMedian(v, i, i + jumpWin, jumpWin / 2, buf);
+                if (std::isfinite(before) && std::isfinite(after)) steps[i] = after - before;
+            }
+        }
+    });
+
+    // 4. 平直段与台阶定位 (按列并行)
+    QVector<ChunkTask> columnTasks;
+    for (int c : std::as_const(checkColumns)) {
+        if (data[c].role == ColumnRole::Pressure || data[c].role == ColumnRole::Temperature) columnTasks.append({c, 0, n, {}});
+    }
+    QtConcurrent::blockingMap(columnTasks, [&](ChunkTask& t) {
+        const ColumnData& d = data[t.column];
+        const std::vector<double>& v = d.values;
+
+        int runStart = 0;
+        for (int i = 1; i <= n; ++i) {
+            if (i < n && std::isfinite(v[i]) && v[i] == v[runStart]) continue;
+            const int len = i - runStart;
+            if (std::isfinite(v[runStart]) && len >= config.flatlineMinRun) {
+                t.issues.append({QualityIssueType::Flatline, QualitySeverity::Info, t.column, runStart, len, v[runStart],
+                                 QString("平直段: 连续 %1 行数值均为 %2").arg(len).arg(v[runStart])});
+            }
+            runStart = i;
+        }
+
+        const double threshold = config.jumpThreshold * d.sigma;
+        if (threshold <= 0) return;
+        for (int i = 0; i < n; ++i) {
+            const double s = std::abs(d.steps[i]);
+            if (s <= threshold) continue;
+            bool isPeak = true;
+            for (int j = qMax(0, i - jumpWin); j <= qMin(n - 1, i + jumpWin) && isPeak; ++j) {
+                const double o = std::abs(d.steps[j]);
+                if (o > s || (o == s && j < i)) isPeak = false;
+            }
+            if (!isPeak) continue;
+            t.issues.append({QualityIssueType::GaugeJump, QualitySeverity::Warning, t.column, i, 1, v[i],
+                             QString("台阶跳变: %1%2 (请确认是否为开关井)").arg(d.steps[i] > 0 ? "+" : "").arg(d.steps[i])});
+        }
+    });
+
+    // 5. 汇总
+    for (const QVector<ChunkTask>* list : {&tasks, &columnTasks}) {
+        for (const ChunkTask& t : *list) report.issues += t.issues;
+    }
+    std::stable_sort(report.issues.begin(), report.issues.end(), [](const QualityIssue& a, const QualityIssue& b) {
+        return a.column != b.column ? a.column < b.column : a.row < b.row;
+    });
+    for (const QualityIssue& issue : std::as_const(report.issues)) report.counts[issue.type] += issue.rowCount;
+    report.success = true;
+    return report;
+}
+
+QString DataQualityChecker::typeName(QualityIssueType type)
+{
+    switch (type) {
+    case QualityIssueType::Spike: return "尖峰";
+    case QualityIssueType::NonMonotonicTime: return "时间回退";
+    case QualityIssueType::DuplicateTime: return "重复时间";
+    case QualityIssueType::Flatline: return "平直段";
+    case QualityIssueType::GaugeJump: return "台阶跳变";
+    case QualityIssueType::NegativeValue: return "负压力";
+    }
+    return QString();
+}
+
+QString DataQualityChecker::severityName(QualitySeverity severity)
+{
+    switch (severity) {
+    case QualitySeverity::Info: return "提示";
+    case QualitySeverity::Warning: return "警告";
+    case QualitySeverity::Error: return "错误";
+    }
+    return QString();
+}
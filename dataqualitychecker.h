@@ -0,0 +1,84 @@
+/*
+ * 文件名: dataqualitychecker.h
+ * 文件作用: 数据质量检查 (异常点与压力计故障识别) 头文件
+ * 功能描述:
+ * 1. 在表格列快照上运行，不访问 Qt 模型，可在工作线程执行；各列、各数据块并行检查。
+ * 2. 检查项：
+ *    - 滑动中位数 + MAD (中位数绝对偏差) 识别尖峰；
+ *    - 时间列非单调 (回退) 与重复时间戳；
+ *    - 压力/温度平直段 (压力计卡死)；
+ *    - 前后窗口中位数的台阶跳变 (压力计跳变)；
+ *    - 压力为负值。
+ * 3. 输出带类型与严重程度的问题列表，由界面按单元格着色 (代理模型 data() 中惰性提供背景色)。
+ */
+
+#ifndef DATAQUALITYCHECKER_H
+#define DATAQUALITYCHECKER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include "dataeditorwidget.h" // WellTestColumnType
+
+enum class QualityIssueType {
+    Spike,              // 尖峰 (MAD 异常点)
+    NonMonotonicTime,   // 时间回退
+    DuplicateTime,      // 重复时间戳
+    Flatline,           // 平直段
+    GaugeJump,          // 台阶跳变
+    NegativeValue       // 负压力
+};
+
+enum class QualitySeverity {
+    Info,
+    Warning,
+    Error
+};
+
+// 单条问题 (平直段等连续问题用 rowCount 表示覆盖的行数)
+struct QualityIssue {
+    QualityIssueType type;
+    QualitySeverity severity;
+    int column;
+    int row;
+    int rowCount;
+    double value;
+    QString message;
+};
+
+// 检查参数
+struct QualityCheckConfig {
+    int medianWindow = 11;          // 滑动中位数窗口 (奇数)
+    double spikeThreshold = 6.0;    // 尖峰阈值: |x - 中位数| > k * 1.4826 * MAD
+    int flatlineMinRun = 30;        // 平直段最短行数
+    int jumpWindow = 15;            // 台阶检测前后窗口长度
+    double jumpThreshold = 10.0;    // 台阶阈值: 前后中位数差 > k * 噪声标准差
+};
+
+// 输入快照
+struct QualityCheckInput {
+    QStringList headers;
+    QVector<QStringList> columns;               // 按列存储的单元格文本
+    QVector<WellTestColumnType> types;          // 列类型 (与 columns 对应)
+    int rowCount = 0;
+};
+
+struct QualityCheckReport {
+    bool success = false;
+    QString errorMessage;
+    QVector<QualityIssue> issues;               // 按列、行排序
+    QMap<QualityIssueType, int> counts;
+    int timeColumn = -1;                        // 参与时间检查的列，-1 表示未找到数值时间列
+};
+
+class DataQualityChecker
+{
+public:
+    static QualityCheckReport run(const QualityCheckInput& input, const QualityCheckConfig& config = QualityCheckConfig());
+
+    static QString typeName(QualityIssueType type);
+    static QString severityName(QualitySeverity severity);
+};
+
+#endif // DATAQUALITYCHECKER_H
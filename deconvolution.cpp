@@ -0,0 +1,426 @@
+/*
+ * 文件名: deconvolution.cpp
+ * 文件作用: 压力-产量反褶积实现文件
+ * 功能描述:
+ * 1. UnitResponse：在节点上预先累加各段积分及其对 z 的导数，任一 τ 的 g(τ) 与局部导数 O(1) 求得。
+ * 2. 雅可比行：τ 越过节点 m+1 后 ∂g/∂z_m 为常数 G_m，故每个压力点只需对各阶梯的 Δq
+ *    做一次后缀累加，再加上所在段两端的局部导数，单行代价 O(阶梯数 + 节点数)。
+ * 3. 法方程按行秩一更新累加，节点数很少 (数十个)，Levenberg-Marquardt 每步求解极快。
+ */
+
+#include "deconvolution.h"
+#include "flowperiodsegmenter.h"
+#include "rateschedule.h"
+#include <QComboBox>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QCheckBox>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QLabel>
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+// ∫_0^u e^{a s} ds 与 ∫_0^u s·e^{a s} ds
+void expMoments(double a, double u, double& e0, double& e1)
+{
+    const double x = a * u;
+    if (std::abs(x) < 1e-4) {
+        e0 = u * (1.0 + x / 2.0 + x * x / 6.0);
+        e1 = u * u * (0.5 + x / 3.0 + x * x / 8.0);
+    } else {
+        const double ex = std::exp(x);
+        e0 = (ex - 1.0) / a;
+        e1 = (ex * (x - 1.0) + 1.0) / (a * a);
+    }
+}
+
+// 单位产量响应 g(τ) = ∫_{-∞}^{ln τ} e^{z(σ)} dσ
+// 首节点之前按单位斜率 (井储) 外推，末节点之后 z 取常数
+class UnitResponse
+{
+public:
+    UnitResponse(double sigma0, double h, const std::vector<double>& z)
+        : m_s0(sigma0), m_h(h), m_z(z), m_n(int(z.size())),
+          m_ez(m_n), m_C(m_n), m_L(m_n, 0.0), m_R(m_n, 0.0), m_G(m_n)
+    {
+        for (int i = 0; i < m_n; ++i) m_ez[i] = std::exp(z[i]);
+        m_C[0] = m_ez[0];
+        for (int i = 0; i + 1 < m_n; ++i) {
+            double e0, e1;
+            expMoments((z[i + 1] - z[i]) / h, h, e0, e1);
+            m_L[i] = m_ez[i] * (e0 - e1 / h);
+            m_R[i] = m_ez[i] * e1 / h;
+            m_C[i + 1] = m_C[i] + m_ez[i] * e0;
+        }
+        for (int m = 0; m < m_n; ++m) m_G[m] = leftBase(m) + (m + 1 < m_n ? m_L[m] : 0.0);
+    }
+
+    /**
+     * @brief g(τ) 及局部导数
+     * @param seg 所在段 (首节点之前为 -1)
+     * @param dLeft 对 z_seg 的导数 (首节点之前为对 z_0 的导数)
+     * @param dRight 对 z_seg+1 的导数
+     * 节点 m < seg 的导数为 prefixGrad(m)
+     */
+    double value(double tau, int& seg, double& dLeft, double& dRight) const
+    {
+        const double x = std::log(tau) - m_s0;
+        dRight = 0.0;
+        if (x < 0) {
+            seg = -1;
+            dLeft = m_ez[0] * std::exp(x);
+            return dLeft;
+        }
+        seg = qMin(int(x / m_h), m_n - 1);
+        const double u = x - seg * m_h;
+        if (seg == m_n - 1) {
+            dLeft = leftBase(seg) + m_ez[seg] * u;
+            return m_C[seg] + m_ez[seg] * u;
+        }
+        double e0, e1;
+        expMoments((m_z[seg + 1] - m_z[seg]) / m_h, u, e0, e1);
+        dLeft = leftBase(seg) + m_ez[seg] * (e0 - e1 / m_h);
+        dRight = m_ez[seg] * e1 / m_h;
+        return m_C[seg] + m_ez[seg] * e0;
+    }
+
+    double prefixGrad(int m) const { return m_G[m]; }
+    double nodeValue(int i) const { return m_C[i]; }
+    double nodeDerivative(int i) const { return m_ez[i]; }
+
+private:
+    // 节点 m 左侧 (已完整积分部分) 对 z_m 的导数
+    double leftBase(int m) const { return m == 0 ? m_ez[0] : m_R[m - 1]; }
+
+    double m_s0, m_h;
+    std::vector<double> m_z;
+    int m_n;
+    std::vector<double> m_ez, m_C, m_L, m_R, m_G;
+};
+
+// 按对数经历时间在 [begin, end) 内抽取约 count 个点
+void pickLogSpaced(const QVector<double>& t, int begin, int end, int count, std::vector<int>& out)
+{
+    if (end - begin < 2) return;
+    const double t0 = t[begin];
+    double lo = 0.0;
+    for (int i = begin + 1; i < end && lo <= 0.0; ++i) lo = t[i] - t0;
+    const double hi = t[end - 1] - t0;
+    if (!(lo > 0.0) || !(hi > 0.0)) return;
+    int last = -1;
+    for (int k = 0; k < count; ++k) {
+        const double target = t0 + (count > 1 ? lo * std::pow(hi / lo, double(k) / (count - 1)) : hi);
+        int idx = int(std::lower_bound(t.constBegin() + begin, t.constBegin() + end, target) - t.constBegin());
+        idx = qMin(idx, end - 1);
+        if (idx > last && t[idx] > t0) { out.push_back(idx); last = idx; }
+    }
+}
+
+} // namespace
+
+DeconvolutionResult Deconvolution::run(const QVector<double>& t, const QVector<double>& p, const QVector<double>& q,
+                                       const DeconvolutionConfig& config)
+{
+    DeconvolutionResult result;
+    const int n = t.size();
+    if (n < 20 || p.size() != n || q.size() != n) {
+        result.errorMessage = "有效数据不足 (至少需要 20 个同时含时间、压力、产量的点)。";
+        return result;
+    }
+    for (int i = 1; i < n; ++i) {
+        if (t[i] < t[i - 1]) {
+            result.errorMessage = "时间列需按升序排列。";
+            return result;
+        }
+    }
+
+    // 1. 产量阶梯：按流动段识别，关井段产量记为 0
+    QVector<int> rows(n);
+    std::iota(rows.begin(), rows.end(), 0);
+    FlowPeriodResult segments = FlowPeriodSegmenter::detect(t, p, q, rows);
+    RateSchedule schedule;
+    std::vector<std::pair<int, int>> periods;
+    if (segments.success && !segments.periods.isEmpty()) {
+        for (const FlowPeriod& fp : std::as_const(segments.periods)) {
+            schedule.addStep(fp.startTime, fp.type == FlowPeriodType::Buildup ? 0.0 : fp.rate);
+            periods.emplace_back(fp.startRow, fp.endRow);
+        }
+    } else {
+        schedule = RateSchedule::fromSamples(t, q);
+        periods.emplace_back(0, n);
+    }
+    std::vector<double> stepT, stepDq;
+    double qRef = 0.0;
+    for (int j = 0; j < schedule.size(); ++j) {
+        const double dq = schedule.rate(j) - (j > 0 ? schedule.rate(j - 1) : 0.0);
+        qRef = std::max(qRef, std::abs(schedule.rate(j)));
+        if (dq == 0.0) continue;
+        stepT.push_back(schedule.startTime(j));
+        stepDq.push_back(dq);
+    }
+    if (stepT.empty() || qRef <= 0.0) {
+        result.errorMessage = "产量历史中没有产量变化，无法反褶积。";
+        return result;
+    }
+
+    // 2. 每个流动段按对数时间抽取压力点
+    std::vector<int> picked;
+    const int perPeriod = std::max(20, config.maxPressurePoints / int(periods.size()));
+    for (const auto& pr : periods) pickLogSpaced(t, pr.first, pr.second, perPeriod, picked);
+    std::sort(picked.begin(), picked.end());
+    picked.erase(std::unique(picked.begin(), picked.end()), picked.end());
+    picked.erase(std::remove_if(picked.begin(), picked.end(), [&](int i) { return t[i] <= stepT.front(); }), picked.end());
+    const int M = int(picked.size());
+    if (M < 10) {
+        result.errorMessage = "流动段内可用的压力点过少。";
+        return result;
+    }
+
+    // 3. 节点范围：覆盖各点相对最近一次变产的最短经历时间到总时长
+    double tauMin = std::numeric_limits<double>::infinity();
+    for (int k : picked) {
+        int j = int(std::lower_bound(stepT.begin(), stepT.end(), t[k]) - stepT.begin()) - 1;
+        if (j >= 0) tauMin = std::min(tauMin, t[k] - stepT[j]);
+    }
+    const double tauMax = t[picked.back()] - stepT.front();
+    if (!(tauMin > 0.0) || !(tauMax > tauMin)) {
+        result.errorMessage = "时间范围不足以建立响应节点。";
+        return result;
+    }
+    const double lnMin = std::log(tauMin), lnMax = std::log(tauMax);
+    const int N = std::max(3, int(std::ceil((lnMax - lnMin) / std::log(10.0) * config.nodesPerDecade)) + 1);
+    const double h = (lnMax - lnMin) / (N - 1);
+
+    // 4. 压力噪声尺度 (二阶差分的稳健估计)，用于残差归一化
+    double pMin = p[0], pMax = p[0];
+    for (double v : p) { pMin = std::min(pMin, v); pMax = std::max(pMax, v); }
+    std::vector<double> d2;
+    const int stride = std::max(1, n / 20000);
+    for (int i = 1; i + 1 < n; i += stride) d2.push_back(std::abs(p[i + 1] - 2.0 * p[i] + p[i - 1]));
+    double sigma = 0.0;
+    if (!d2.empty()) {
+        std::nth_element(d2.begin(), d2.begin() + d2.size() / 2, d2.end());
+        sigma = 1.4826 * d2[d2.size() / 2] / std::sqrt(6.0);
+    }
+    sigma = std::max({sigma, 1e-4 * (pMax - pMin), 1e-12});
+
+    // 5. 初值：常数 z (径向流)，p0 取闭式最小二乘
+    std::vector<double> z(N, std::log(std::max(pMax - pMin, sigma) / (qRef * std::max(1.0, lnMax - lnMin))));
+    const bool fitP0 = config.fitInitialPressure || !std::isfinite(config.initialPressure);
+    const double lambdaC = config.regularization * std::sqrt(double(M) / std::max(1, N - 2));
+    const int P = N + 1;
+
+    // 代价函数 (可选组装法方程)
+    auto evaluate = [&](const std::vector<double>& zz, double p0, Eigen::MatrixXd* A, Eigen::VectorXd* b, double* sse) {
+        UnitResponse resp(lnMin, h, zz);
+        if (A) { A->setZero(P, P); b->setZero(P); }
+        Eigen::VectorXd row(P);
+        std::vector<double> diff(N + 1);
+        double cost = 0.0, pressureSse = 0.0;
+        for (int k : picked) {
+            double model = p0;
+            if (A) { row.setZero(); std::fill(diff.begin(), diff.end(), 0.0); }
+            for (size_t j = 0; j < stepT.size() && stepT[j] < t[k]; ++j) {
+                int seg;
+                double dl, dr;
+                model -= stepDq[j] * resp.value(t[k] - stepT[j], seg, dl, dr);
+                if (!A) continue;
+                if (seg < 0) { row[0] -= stepDq[j] * dl; continue; }
+                diff[seg] += stepDq[j];
+                row[seg] -= stepDq[j] * dl;
+                if (seg + 1 < N) row[seg + 1] -= stepDq[j] * dr;
+            }
+            const double r = (model - p[k]) / sigma;
+            cost += r * r;
+            pressureSse += (model - p[k]) * (model - p[k]);
+            if (!A) continue;
+            // 后缀累加：节点 m 的前缀导数作用于所有 seg > m 的阶梯
+            double w = 0.0;
+            for (int m = N - 2; m >= 0; --m) {
+                w += diff[m + 1];
+                row[m] -= w * resp.prefixGrad(m);
+            }
+            row[N] = fitP0 ? 1.0 : 0.0;
+            row /= sigma;
+            A->selfadjointView<Eigen::Lower>().rankUpdate(row);
+            *b += row * r;
+        }
+        for (int i = 1; i + 1 < N; ++i) {
+            const double c = lambdaC * (zz[i - 1] - 2.0 * zz[i] + zz[i + 1]);
+            cost += c * c;
+            if (!A) continue;
+            const int idx[3] = {i - 1, i, i + 1};
+            const double coef[3] = {lambdaC, -2.0 * lambdaC, lambdaC};
+            for (int a = 0; a < 3; ++a) {
+                (*b)[idx[a]] += coef[a] * c;
+                for (int bb = 0; bb < 3; ++bb) if (idx[bb] <= idx[a]) (*A)(idx[a], idx[bb]) += coef[a] * coef[bb];
+            }
+        }
+        if (A) A->triangularView<Eigen::StrictlyUpper>() = A->transpose();
+        if (sse) *sse = pressureSse;
+        return cost;
+    };
+
+    double p0 = config.initialPressure;
+    if (fitP0) {
+        UnitResponse resp(lnMin, h, z);
+        double sum = 0.0;
+        for (int k : picked) {
+            double drop = 0.0;
+            int seg;
+            double dl, dr;
+            for (size_t j = 0; j < stepT.size() && stepT[j] < t[k]; ++j) drop += stepDq[j] * resp.value(t[k] - stepT[j], seg, dl, dr);
+            sum += p[k] + drop;
+        }
+        p0 = sum / M;
+    }
+
+    // 6. Levenberg-Marquardt
+    Eigen::MatrixXd A;
+    Eigen::VectorXd b;
+    double cost = evaluate(z, p0, &A, &b, nullptr);
+    double mu = 1e-3;
+    int iter = 0;
+    for (; iter < config.maxIterations; ++iter) {
+        bool accepted = false;
+        for (int tries = 0; tries < 10 && !accepted; ++tries) {
+            Eigen::MatrixXd Ad = A;
+            for (int i = 0; i < P; ++i) Ad(i, i) += mu * A(i, i) + 1e-12;
+            if (!fitP0) { Ad.row(N).setZero(); Ad.col(N).setZero(); Ad(N, N) = 1.0; }
+            Eigen::VectorXd rhs = -b;
+            if (!fitP0) rhs[N] = 0.0;
+            Eigen::VectorXd delta = Ad.ldlt().solve(rhs);
+            std::vector<double> zt(z);
+            for (int i = 0; i < N; ++i) zt[i] += qBound(-2.0, delta[i], 2.0);
+            const double p0t = p0 + delta[N];
+            const double trial = evaluate(zt, p0t, nullptr, nullptr, nullptr);
+            if (std::isfinite(trial) && trial < cost) {
+                const double gain = (cost - trial) / cost;
+                z.swap(zt);
+                p0 = p0t;
+                cost = evaluate(z, p0, &A, &b, nullptr);
+                mu = std::max(mu / 3.0, 1e-9);
+                accepted = true;
+                if (gain < 1e-8) iter = config.maxIterations;
+            } else {
+                mu *= 4.0;
+            }
+        }
+        if (!accepted) break;
+    }
+
+    // 7. 输出参考产量下的响应
+    double pressureSse = 0.0;
+    evaluate(z, p0, nullptr, nullptr, &pressureSse);
+    UnitResponse resp(lnMin, h, z);
+    result.time.resize(N);
+    result.deltaP.resize(N);
+    result.derivative.resize(N);
+    for (int i = 0; i < N; ++i) {
+        result.time[i] = std::exp(lnMin + i * h);
+        result.deltaP[i] = qRef * resp.nodeValue(i);
+        result.derivative[i] = qRef * resp.nodeDerivative(i);
+    }
+    result.referenceRate = qRef;
+    result.initialPressure = p0;
+    result.rmsError = std::sqrt(pressureSse / M);
+    result.rateSteps = int(stepT.size());
+    result.pressurePoints = M;
+    result.iterations = qMin(iter, config.maxIterations);
+    result.success = true;
+    return result;
+}
+
+// ============================================================================
+// DeconvolutionDialog
+// ============================================================================
+
+DeconvolutionDialog::DeconvolutionDialog(const QStringList& columnNames, QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle("压力-产量反褶积");
+    resize(400, 360);
+    setStyleSheet("QDialog { background-color: white; color: black; font-family: \"Microsoft YaHei\", Arial; } "
+                  "QLabel { color: black; background: transparent; font-weight: normal;} "
+                  "QGroupBox { color: black; border: 1px solid #ccc; margin-top: 10px; font-weight: bold; } "
+                  "QDoubleSpinBox { background-color: white; border: 1px solid #ccc; padding: 2px; } "
+                  "QSpinBox { background-color: white; border: 1px solid #ccc; padding: 2px; } "
+                  "QComboBox { background-color: white; border: 1px solid #ccc; padding: 2px; } "
+                  "QPushButton { color: white; background-color: #4a90e2; border: none; border-radius: 4px; padding: 6px 12px; } "
+                  "QPushButton:hover { background-color: #357abd; }");
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    // 列选择组
+    QGroupBox* colGroup = new QGroupBox("数据列");
+    QFormLayout* formCol = new QFormLayout(colGroup);
+    m_comboTime = new QComboBox;
+    m_comboPressure = new QComboBox;
+    m_comboRate = new QComboBox;
+    for (QComboBox* box : {m_comboTime, m_comboPressure, m_comboRate}) box->addItems(columnNames);
+    for (int i = 0; i < columnNames.size(); ++i) {
+        const QString h = columnNames[i].toLower();
+        if (h.contains("time") || h.contains("时间")) m_comboTime->setCurrentIndex(i);
+        if (h.contains("pressure") || h.contains("压力")) m_comboPressure->setCurrentIndex(i);
+        if (h.contains("rate") || h.contains("产量") || h.contains("流量")) m_comboRate->setCurrentIndex(i);
+    }
+    formCol->addRow("时间列:", m_comboTime);
+    formCol->addRow("压力列:", m_comboPressure);
+    formCol->addRow("产量列:", m_comboRate);
+    mainLayout->addWidget(colGroup);
+
+    // 反演参数组
+    QGroupBox* paramGroup = new QGroupBox("反演参数");
+    QFormLayout* formParam = new QFormLayout(paramGroup);
+    m_spinNodes = new QSpinBox;
+    m_spinNodes->setRange(3, 20);
+    m_spinNodes->setValue(8);
+    m_spinReg = new QDoubleSpinBox;
+    m_spinReg->setRange(0.01, 100.0);
+    m_spinReg->setDecimals(2);
+    m_spinReg->setValue(1.0);
+    m_spinReg->setToolTip("越大导数曲线越光滑，越小越贴合压力数据");
+    m_checkFitPi = new QCheckBox("同时反演初始压力");
+    m_checkFitPi->setChecked(true);
+    m_spinPi = new QDoubleSpinBox;
+    m_spinPi->setRange(0, 1000);
+    m_spinPi->setDecimals(4);
+    m_spinPi->setSuffix(" MPa");
+    m_spinPi->setEnabled(false);
+    connect(m_checkFitPi, &QCheckBox::toggled, m_spinPi, [this](bool fit) { m_spinPi->setEnabled(!fit); });
+    formParam->addRow("每十倍程节点数:", m_spinNodes);
+    formParam->addRow("正则化权重:", m_spinReg);
+    formParam->addRow(m_checkFitPi);
+    formParam->addRow("初始压力 (Pi):", m_spinPi);
+    mainLayout->addWidget(paramGroup);
+
+    QLabel* note = new QLabel("结果为最大产量下的恒产量响应，将作为观测数据发送到拟合界面。");
+    note->setWordWrap(true);
+    mainLayout->addWidget(note);
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttons);
+}
+
+DeconvolutionConfig DeconvolutionDialog::getConfig() const
+{
+    DeconvolutionConfig config;
+    config.timeColumn = m_comboTime->currentIndex();
+    config.pressureColumn = m_comboPressure->currentIndex();
+    config.rateColumn = m_comboRate->currentIndex();
+    config.nodesPerDecade = m_spinNodes->value();
+    config.regularization = m_spinReg->value();
+    config.fitInitialPressure = m_checkFitPi->isChecked();
+    if (!config.fitInitialPressure) config.initialPressure = m_spinPi->value();
+    return config;
+}
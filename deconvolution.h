@@ -0,0 +1,87 @@
+/*
+ * 文件名: deconvolution.h
+ * 文件作用: 压力-产量反褶积头文件
+ * 功能描述:
+ * 1. 采用 von Schroeter / Levitan 的表示：未知量为 z(σ) = ln(dg/dlnτ)，σ = ln τ，
+ *    z 在对数等距节点上分段线性，g 为单位产量压降响应，天然保证 g 单调递增。
+ * 2. 压力模型 p(t) = p0 - Σ Δq_j · g(t - t_j)，产量阶梯由流动段自动识别得到。
+ * 3. 目标函数为压力残差平方和 + 曲率正则项，用 Levenberg-Marquardt 求解；
+ *    雅可比按 "前缀权重 × 节点导数" 的结构逐行组装，不展开 (点数 × 阶梯数 × 节点数)。
+ * 4. 每个流动段按对数时间抽取压力点，数月的高频数据也只参与少量点的迭代。
+ * 5. DeconvolutionDialog：选择时间/压力/产量列与正则化参数。
+ */
+
+#ifndef DECONVOLUTION_H
+#define DECONVOLUTION_H
+
+#include <QDialog>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <limits>
+
+class QComboBox;
+class QSpinBox;
+class QDoubleSpinBox;
+class QCheckBox;
+
+struct DeconvolutionConfig {
+    int timeColumn = -1;
+    int pressureColumn = -1;
+    int rateColumn = -1;
+    int nodesPerDecade = 8;         // 每十倍程节点数
+    double regularization = 1.0;    // 曲率正则化权重
+    int maxIterations = 50;
+    int maxPressurePoints = 2000;   // 参与迭代的压力点上限
+    bool fitInitialPressure = true; // false 时 p0 固定为 initialPressure
+    double initialPressure = std::numeric_limits<double>::quiet_NaN();
+};
+
+struct DeconvolutionResult {
+    bool success = false;
+    QString errorMessage;
+    QVector<double> time;           // 节点经历时间 τ
+    QVector<double> deltaP;         // 参考产量下的压降 qRef · g(τ)
+    QVector<double> derivative;     // 参考产量下的导数 qRef · dg/dlnτ
+    double referenceRate = 0.0;     // 参考产量 (最大产量)
+    double initialPressure = 0.0;   // 反演得到的 p0
+    double rmsError = 0.0;          // 压力拟合均方根误差
+    int rateSteps = 0;              // 产量阶梯数
+    int pressurePoints = 0;         // 参与反演的压力点数
+    int iterations = 0;
+};
+
+class Deconvolution
+{
+public:
+    /**
+     * @brief 反褶积
+     * @param t 时间 (升序)
+     * @param p 压力
+     * @param q 产量 (与 t 同长度，开井为正)
+     */
+    static DeconvolutionResult run(const QVector<double>& t, const QVector<double>& p, const QVector<double>& q,
+                                   const DeconvolutionConfig& config = DeconvolutionConfig());
+};
+
+// ============================================================================
+// 反褶积参数对话框
+// ============================================================================
+class DeconvolutionDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit DeconvolutionDialog(const QStringList& columnNames, QWidget* parent = nullptr);
+    DeconvolutionConfig getConfig() const;
+
+private:
+    QComboBox* m_comboTime;
+    QComboBox* m_comboPressure;
+    QComboBox* m_comboRate;
+    QSpinBox* m_spinNodes;
+    QDoubleSpinBox* m_spinReg;
+    QCheckBox* m_checkFitPi;
+    QDoubleSpinBox* m_spinPi;
+};
+
+#endif // DECONVOLUTION_H
@@ -6,6 +6,7 @@
  * 2. 实现智能列名识别，自动匹配 Time, Pressure 等列。
  * 3. 实现试井类型切换逻辑：降落试井需输入地层压力，恢复试井自动计算。
  * 4. 提供完整的配置获取接口。
+ * 5. 流动段识别：选中某一段后自动切换试井类型，降落段填入开井前压力作为 Pi。
  */
 
 #include "fittingdatadialog.h"
@@ -18,6 +19,7 @@
 #include <QDebug>
 #include <QAxObject>
 #include <QDir>
+#include <QLabel>
 
 // 构造函数
 FittingDataDialog::FittingDataDialog(QStandardItemModel* projectModel, QWidget *parent) :
@@ -28,6 +30,20 @@ FittingDataDialog::FittingDataDialog(QStandardItemModel* projectModel, QWidget *
 {
     ui->setupUi(this);
 
+    // 流动段选择 (设置区最后一行)
+    QLabel* labelPeriod = new QLabel("流动段:", this);
+    labelPeriod->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    m_periodSelector = new FlowPeriodSelector(this);
+    ui->gridLayout->addWidget(labelPeriod, 5, 0);
+    ui->gridLayout->addWidget(m_periodSelector, 5, 1, 1, 3);
+    connect(m_periodSelector, &FlowPeriodSelector::periodSelected, this, &FittingDataDialog::onFlowPeriodSelected);
+    auto syncPeriodColumns = [this]() {
+        m_periodSelector->setColumns(ui->comboTime->currentIndex(), ui->comboPressure->currentIndex());
+    };
+    connect(ui->comboTime, QOverload<int>::of(&QComboBox::currentIndexChanged), this, syncPeriodColumns);
+    connect(ui->comboPressure, QOverload<int>::of(&QComboBox::currentIndexChanged), this, syncPeriodColumns);
+    connect(ui->spinSkipRows, QOverload<int>::of(&QSpinBox::valueChanged), m_periodSelector, &FlowPeriodSelector::setSkipRows);
+
     // 连接数据源相关信号槽
     connect(ui->radioProjectData, &QRadioButton::toggled, this, &FittingDataDialog::onSourceChanged);
     connect(ui->radioExternalFile, &QRadioButton::toggled, this, &FittingDataDialog::onSourceChanged);
@@ -40,8 +56,14 @@ FittingDataDialog::FittingDataDialog(QStandardItemModel* projectModel, QWidget *
     connect(ui->radioDrawdown, &QRadioButton::toggled, this, &FittingDataDialog::onTestTypeChanged);
     connect(ui->radioBuildup, &QRadioButton::toggled, this, &FittingDataDialog::onTestTypeChanged);
 
-    // 连接平滑复选框
+    // 连接平滑复选框与平滑方法
+    for (SmoothMethod m : {SmoothMethod::MovingAverage, SmoothMethod::SavitzkyGolay,
+                           SmoothMethod::LogTimeWindow, SmoothMethod::Median}) {
+        ui->comboSmoothMethod->addItem(DataFilter::methodName(m), int(m));
+    }
     connect(ui->checkSmoothing, &QCheckBox::toggled, this, &FittingDataDialog::onSmoothingToggled);
+    connect(ui->comboSmoothMethod, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this]() { onSmoothingToggled(ui->checkSmoothing->isChecked()); });
 
     // 重写确定按钮逻辑，先进行校验
     connect(ui->buttonBox->button(QDialogButtonBox::Ok), &QPushButton::clicked, this, &FittingDataDialog::onAccepted);
@@ -96,6 +118,7 @@ void FittingDataDialog::onSourceChanged()
     ui->widgetFileSelect->setVisible(!isProject);
 
     QStandardItemModel* targetModel = isProject ? m_projectModel : m_fileModel;
+    m_periodSelector->setModel(targetModel);
 
     // 清空预览表格
     ui->tablePreview->clear();
@@ -176,6 +199,17 @@ void FittingDataDialog::onTestTypeChanged()
     }
 }
 
+// 选中流动段
+void FittingDataDialog::onFlowPeriodSelected(const FlowPeriod& period)
+{
+    if (period.type == FlowPeriodType::Buildup) {
+        ui->radioBuildup->setChecked(true);
+    } else {
+        ui->radioDrawdown->setChecked(true);
+        ui->spinPi->setValue(period.startPressure);
+    }
+}
+
 // 浏览文件
 void FittingDataDialog::onBrowseFile()
 {
@@ -301,7 +335,11 @@ void FittingDataDialog::onDerivColumnChanged(int index)
 // 平滑选项切换
 void FittingDataDialog::onSmoothingToggled(bool checked)
 {
-    ui->spinSmoothSpan->setEnabled(checked);
+    // 对数时间窗按 log10 半宽取点，其余方法按窗口点数
+    const bool logWindow = SmoothMethod(ui->comboSmoothMethod->currentData().toInt()) == SmoothMethod::LogTimeWindow;
+    ui->comboSmoothMethod->setEnabled(checked);
+    ui->spinSmoothSpan->setEnabled(checked && !logWindow);
+    ui->spinSmoothLogWidth->setEnabled(checked && logWindow);
 }
 
 // 获取设置结果
@@ -330,6 +368,21 @@ FittingDataSettings FittingDataDialog::getSettings() const
 
     s.enableSmoothing = ui->checkSmoothing->isChecked();
     s.smoothingSpan = ui->spinSmoothSpan->value();
+    s.smoothingMethod = SmoothMethod(ui->comboSmoothMethod->currentData().toInt());
+    s.smoothingLogWidth = ui->spinSmoothLogWidth->value();
+
+    s.periodStartRow = -1;
+    s.periodEndRow = -1;
+    s.periodStartTime = 0.0;
+    s.periodStartPressure = 0.0;
+    if (m_periodSelector->hasSelection()) {
+        FlowPeriod fp = m_periodSelector->selectedPeriod();
+        s.periodStartRow = fp.startRow;
+        s.periodEndRow = fp.endRow;
+        s.periodStartTime = fp.startTime;
+        s.periodStartPressure = fp.startPressure;
+        s.rateSchedule = m_periodSelector->selectedRateSchedule();
+    }
 
     return s;
 }
@@ -5,6 +5,7 @@
  * 1. 声明 FittingDataSettings 结构体，用于封装用户的选择（列索引、试井类型、初始压力、平滑参数等）。
  * 2. 声明 FittingDataDialog 类，提供从项目或文件加载数据、预览数据、配置列映射的界面。
  * 3. 包含了文件解析逻辑（CSV, TXT, Excel）。
+ * 4. 可自动识别长历史中的流动段，只加载所选的一段开井/关井数据。
  */
 
 #ifndef FITTINGDATADIALOG_H
@@ -12,6 +13,8 @@
 
 #include <QDialog>
 #include <QStandardItemModel>
+#include "datafilter.h"
+#include "flowperiodsegmenter.h"
 
 namespace Ui {
 class FittingDataDialog;
@@ -38,6 +41,14 @@ struct FittingDataSettings {
 
     bool enableSmoothing;       // 是否启用平滑
     int smoothingSpan;          // 平滑窗口大小 (奇数)
+    SmoothMethod smoothingMethod;   // 平滑方法
+    double smoothingLogWidth;   // 对数时间窗半宽 (log10 周期)
+
+    int periodStartRow;         // 所选流动段起始行 (-1 表示使用全部数据)
+    int periodEndRow;           // 所选流动段结束行 (不含)
+    double periodStartTime;     // 流动段起点时间，加载时作为 Δt 的零点
+    double periodStartPressure; // 流动段起点压力 (恢复试井的关井流压)
+    RateSchedule rateSchedule;  // 流动段之前的产量历史 (有产量列时)，用于变产量叠加
 };
 
 class FittingDataDialog : public QDialog
@@ -74,11 +85,15 @@ private slots:
     // 点击确定按钮时的校验
     void onAccepted();
 
+    // 选中自动识别的流动段：同步试井类型与初始压力
+    void onFlowPeriodSelected(const FlowPeriod& period);
+
 private:
     Ui::FittingDataDialog *ui;
 
     QStandardItemModel* m_projectModel; // 项目数据引用
     QStandardItemModel* m_fileModel;    // 文件数据临时模型
+    FlowPeriodSelector* m_periodSelector; // 流动段选择
 
     // 更新列选择下拉框的内容
     void updateColumnComboBoxes(const QStringList& headers);
@@ -0,0 +1,380 @@
+/*
+ * 文件名: flowperiodsegmenter.cpp
+ * 文件作用: 流动段自动划分实现文件
+ * 功能描述:
+ * 1. PELT：F(e) = min_s { F(s) + C(s,e) + β }，C 为段内均值模型的代价 -S²/len (平方和为常数已略去)；
+ *    满足 F(s) + C(s,e) > F(e) 的候选起点以后不可能最优，直接剪除。
+ * 2. 噪声水平用中位数绝对偏差稳健估计，序列归一化后惩罚 β = penalty · ln(n)。
+ */
+
+#include "flowperiodsegmenter.h"
+#include "textdataimporter.h"
+#include <QStandardItemModel>
+#include <QComboBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+double medianOf(std::vector<double> v)
+{
+    if (v.empty()) return kNaN;
+    const size_t mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + mid, v.end());
+    return v[mid];
+}
+
+// 稳健标准差: 1.4826 · median|x - median(x)|
+double robustSigma(const QVector<double>& x)
+{
+    std::vector<double> v;
+    v.reserve(x.size());
+    for (double d : x) if (std::isfinite(d)) v.push_back(d);
+    const double med = medianOf(v);
+    for (double& d : v) d = std::abs(d - med);
+    const double mad = medianOf(v);
+    return std::isfinite(mad) ? 1.4826 * mad : 0.0;
+}
+
+// 块平均降采样 (忽略 NaN；整块无效时沿用上一块的值)
+QVector<double> blockMean(const QVector<double>& v, int block)
+{
+    const int n = v.size();
+    QVector<double> out;
+    out.reserve((n + block - 1) / block);
+    double prev = 0.0;
+    for (int b = 0; b < n; b += block) {
+        double sum = 0.0;
+        int cnt = 0;
+        for (int i = b; i < qMin(n, b + block); ++i) if (std::isfinite(v[i])) { sum += v[i]; ++cnt; }
+        prev = cnt > 0 ? sum / cnt : prev;
+        out.append(prev);
+    }
+    return out;
+}
+
+void normalize(QVector<double>& x, double sigma)
+{
+    double maxAbs = 0.0;
+    for (double d : std::as_const(x)) maxAbs = qMax(maxAbs, std::abs(d));
+    if (!(sigma > 0)) sigma = 1e-6 * maxAbs + 1e-12; // 分段常数的理想数据：任何变化都视为变点
+    for (double& d : x) d /= sigma;
+}
+
+} // namespace
+
+QString FlowPeriod::label() const
+{
+    QString text = QString("%1  t = %2 ~ %3  (%4 点)")
+                       .arg(type == FlowPeriodType::Buildup ? "关井恢复" : "开井降落")
+                       .arg(startTime, 0, 'g', 6)
+                       .arg(endTime, 0, 'g', 6)
+                       .arg(endRow - startRow);
+    if (std::isfinite(rate)) text += QString("  q = %1").arg(rate, 0, 'g', 5);
+    return text;
+}
+
+QVector<int> FlowPeriodSegmenter::pelt(const QVector<double>& x, double penalty, int minSize)
+{
+    const int m = x.size();
+    minSize = qMax(1, minSize);
+    QVector<int> starts{0};
+    if (m < 2 * minSize) return starts;
+
+    std::vector<double> S(m + 1, 0.0);
+    for (int i = 0; i < m; ++i) S[i + 1] = S[i] + x[i];
+    auto cost = [&S](int s, int e) {
+        const double sum = S[e] - S[s];
+        return -sum * sum / (e - s);
+    };
+
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> F(m + 1, inf);
+    std::vector<int> last(m + 1, 0);
+    F[0] = -penalty;
+    std::vector<int> R{0}, kept;
+    for (int e = minSize; e <= m; ++e) {
+        double best = inf;
+        int arg = 0;
+        for (int s : R) {
+            if (e - s < minSize) continue;
+            const double v = F[s] + cost(s, e) + penalty;
+            if (v < best) { best = v; arg = s; }
+        }
+        F[e] = best;
+        last[e] = arg;
+
+        // 剪枝，并加入下一步起满足最短段长的新起点
+        kept.clear();
+        for (int s : R) if (e - s < minSize || F[s] + cost(s, e) <= F[e]) kept.push_back(s);
+        const int cand = e - minSize + 1;
+        if (cand >= minSize && std::isfinite(F[cand])) kept.push_back(cand);
+        R.swap(kept);
+    }
+
+    QVector<int> rev;
+    for (int e = m; e > 0; e = last[e]) rev.append(last[e]);
+    starts.clear();
+    for (int i = rev.size() - 1; i >= 0; --i) starts.append(rev[i]);
+    return starts;
+}
+
+FlowPeriodResult FlowPeriodSegmenter::detect(const QVector<double>& t, const QVector<double>& p, const QVector<double>& q,
+                                             const QVector<int>& rows, const FlowPeriodConfig& config)
+{
+    FlowPeriodResult result;
+    const int n = t.size();
+    if (p.size() != n || rows.size() != n || n < 2 * config.minPoints) {
+        result.errorMessage = "有效数据点不足，无法划分流动段";
+        return result;
+    }
+    int rateCount = 0;
+    if (q.size() == n) for (double v : q) if (std::isfinite(v)) ++rateCount;
+    const bool hasRate = rateCount > n / 2;
+
+    const int block = qMax(1, (n + config.maxSamples - 1) / config.maxSamples);
+    const int minSize = qMax(2, config.minPoints / block);
+
+    // 1. 分段 (降采样序列上)，得到原始下标的分界
+    QVector<int> bounds{0};
+    if (hasRate) {
+        QVector<double> x = blockMean(q, block);
+        QVector<double> diff;
+        for (int k = 1; k < x.size(); ++k) diff.append(x[k] - x[k - 1]);
+        normalize(x, robustSigma(diff) / std::sqrt(2.0));
+        const QVector<int> cps = pelt(x, config.penalty * std::log(double(x.size())), minSize);
+        for (int k = 1; k < cps.size(); ++k) {
+            // 回到原始数据：块附近产量变化最大处；段起点取变化前最后一点 (关井/变产时刻, Δt = 0)
+            const int b = cps[k] * block;
+            int best = b;
+            double bestJump = -1.0;
+            for (int i = qMax(1, b - block); i <= qMin(n - 1, b + block); ++i) {
+                const double jump = std::abs(q[i] - q[i - 1]);
+                if (std::isfinite(jump) && jump > bestJump) { bestJump = jump; best = i; }
+            }
+            if (best - 1 > bounds.last()) bounds.append(best - 1);
+        }
+    } else {
+        const QVector<double> pm = blockMean(p, block);
+        QVector<double> d;
+        for (int k = 1; k < pm.size(); ++k) d.append(pm[k] - pm[k - 1]);
+        normalize(d, robustSigma(d));
+        const QVector<int> cps = pelt(d, config.penalty * std::log(double(qMax(2, int(d.size())))), minSize);
+        for (int k = 1; k < cps.size(); ++k) {
+            const int b = qMin(n - 1, cps[k] * block);
+            if (b > bounds.last()) bounds.append(b);
+        }
+    }
+    bounds.append(n);
+
+    // 2. 归类：有产量按产量是否接近 0，无产量按段内压力净变化的符号
+    struct Segment { int begin; int end; FlowPeriodType type; double rate; };
+    QVector<Segment> segs;
+    double maxRate = 0.0;
+    for (int k = 0; k + 1 < bounds.size(); ++k) {
+        Segment s{bounds[k], bounds[k + 1], FlowPeriodType::Drawdown, kNaN};
+        if (hasRate) {
+            double sum = 0.0;
+            int cnt = 0;
+            for (int i = s.begin; i < s.end; ++i) if (std::isfinite(q[i])) { sum += q[i]; ++cnt; }
+            s.rate = cnt > 0 ? sum / cnt : 0.0;
+            maxRate = qMax(maxRate, std::abs(s.rate));
+        } else {
+            s.type = p[s.end - 1] > p[s.begin] ? FlowPeriodType::Buildup : FlowPeriodType::Drawdown;
+        }
+        segs.append(s);
+    }
+    if (hasRate) {
+        for (Segment& s : segs) s.type = std::abs(s.rate) <= 0.02 * maxRate ? FlowPeriodType::Buildup : FlowPeriodType::Drawdown;
+    }
+
+    // 3. 合并：过短的段并入前一段；无产量时相邻同类段合并 (有产量时保留变产台阶)
+    QVector<Segment> merged;
+    for (const Segment& s : std::as_const(segs)) {
+        if (!merged.isEmpty()) {
+            Segment& prev = merged.last();
+            const bool sameKind = prev.type == s.type && (!hasRate || s.type == FlowPeriodType::Buildup);
+            if (sameKind || s.end - s.begin < config.minPoints) {
+                if (hasRate && std::isfinite(prev.rate) && std::isfinite(s.rate)) {
+                    const int a = prev.end - prev.begin, b = s.end - s.begin;
+                    prev.rate = (prev.rate * a + s.rate * b) / (a + b);
+                }
+                prev.end = s.end;
+                continue;
+            }
+        }
+        merged.append(s);
+    }
+
+    // 4. 无产量时分界细化到附近的压力极值 (恢复段起于最低点，降落段起于最高点)
+    if (!hasRate) {
+        const int radius = qMax(2 * block, 5);
+        for (int k = 1; k < merged.size(); ++k) {
+            const int b = merged[k].begin;
+            const int lo = qMax(merged[k - 1].begin + 1, b - radius);
+            const int hi = qMin(merged[k].end - 2, b + radius);
+            int best = b;
+            for (int i = lo; i <= hi; ++i) {
+                const bool better = merged[k].type == FlowPeriodType::Buildup ? p[i] < p[best] : p[i] > p[best];
+                if (better) best = i;
+            }
+            merged[k].begin = best;
+            merged[k - 1].end = best;
+        }
+    }
+
+    for (const Segment& s : std::as_const(merged)) {
+        if (s.end <= s.begin) continue;
+        FlowPeriod fp;
+        fp.startRow = rows[s.begin];
+        fp.endRow = rows[s.end - 1] + 1;
+        fp.startTime = t[s.begin];
+        fp.endTime = t[s.end - 1];
+        fp.startPressure = p[s.begin];
+        fp.rate = s.rate;
+        fp.type = s.type;
+        result.periods.append(fp);
+    }
+    result.success = !result.periods.isEmpty();
+    if (!result.success) result.errorMessage = "未能识别流动段";
+    return result;
+}
+
+// ============================================================================
+// FlowPeriodSelector
+// ============================================================================
+
+FlowPeriodSelector::FlowPeriodSelector(QWidget* parent)
+    : QWidget(parent), m_model(nullptr), m_timeColumn(-1), m_pressureColumn(-1), m_skipRows(0)
+{
+    QHBoxLayout* layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    m_comboRate = new QComboBox(this);
+    m_comboRate->setToolTip("用于识别变产与关井的产量列 (可选)");
+    m_btnDetect = new QPushButton("识别流动段", this);
+    m_comboPeriod = new QComboBox(this);
+    m_comboPeriod->addItem("全部数据");
+    m_comboPeriod->setEnabled(false);
+    layout->addWidget(new QLabel("产量列:", this));
+    layout->addWidget(m_comboRate);
+    layout->addWidget(m_btnDetect);
+    layout->addWidget(m_comboPeriod, 1);
+
+    connect(m_btnDetect, &QPushButton::clicked, this, &FlowPeriodSelector::onDetect);
+    connect(m_comboPeriod, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &FlowPeriodSelector::onPeriodChanged);
+}
+
+void FlowPeriodSelector::setModel(QStandardItemModel* model)
+{
+    m_model = model;
+    m_comboRate->clear();
+    m_comboRate->addItem("无", -1);
+    if (model) {
+        for (int c = 0; c < model->columnCount(); ++c) {
+            const QString h = model->headerData(c, Qt::Horizontal).toString();
+            m_comboRate->addItem(h, c);
+            const QString l = h.toLower();
+            if (m_comboRate->currentIndex() == 0 && (l.contains("产量") || l.contains("流量") || l.contains("rate")))
+                m_comboRate->setCurrentIndex(m_comboRate->count() - 1);
+        }
+    }
+    clearPeriods();
+}
+
+void FlowPeriodSelector::setColumns(int timeColumn, int pressureColumn)
+{
+    if (timeColumn == m_timeColumn && pressureColumn == m_pressureColumn) return;
+    m_timeColumn = timeColumn;
+    m_pressureColumn = pressureColumn;
+    clearPeriods();
+}
+
+void FlowPeriodSelector::setSkipRows(int rows)
+{
+    if (rows == m_skipRows) return;
+    m_skipRows = rows;
+    clearPeriods();
+}
+
+void FlowPeriodSelector::clearPeriods()
+{
+    m_periods.clear();
+    m_comboPeriod->blockSignals(true);
+    m_comboPeriod->clear();
+    m_comboPeriod->addItem("全部数据");
+    m_comboPeriod->blockSignals(false);
+    m_comboPeriod->setEnabled(false);
+}
+
+bool FlowPeriodSelector::hasSelection() const
+{
+    return m_comboPeriod->currentIndex() > 0 && m_comboPeriod->currentIndex() <= m_periods.size();
+}
+
+FlowPeriod FlowPeriodSelector::selectedPeriod() const
+{
+    return hasSelection() ? m_periods[m_comboPeriod->currentIndex() - 1] : FlowPeriod();
+}
+
+RateSchedule FlowPeriodSelector::selectedRateSchedule() const
+{
+    RateSchedule schedule;
+    if (!hasSelection()) return schedule;
+    const int sel = m_comboPeriod->currentIndex() - 1;
+    const double t0 = m_periods[sel].startTime;
+    for (int i = 0; i <= sel; ++i) {
+        const FlowPeriod& fp = m_periods[i];
+        if (!std::isfinite(fp.rate)) return RateSchedule();
+        schedule.addStep(fp.startTime - t0, fp.type == FlowPeriodType::Buildup ? 0.0 : fp.rate);
+    }
+    return schedule;
+}
+
+void FlowPeriodSelector::onDetect()
+{
+    if (!m_model || m_timeColumn < 0 || m_pressureColumn < 0) return;
+    const int rateColumn = m_comboRate->currentData().toInt();
+
+    QVector<double> t, p, q;
+    QVector<int> rows;
+    for (int r = qMax(0, m_skipRows); r < m_model->rowCount(); ++r) {
+        QStandardItem* it = m_model->item(r, m_timeColumn);
+        QStandardItem* ip = m_model->item(r, m_pressureColumn);
+        double tv, pv;
+        if (!it || !ip || !TextDataImporter::parseDouble(it->text(), tv) || !TextDataImporter::parseDouble(ip->text(), pv)) continue;
+        t.append(tv);
+        p.append(pv);
+        rows.append(r);
+        if (rateColumn >= 0) {
+            QStandardItem* iq = m_model->item(r, rateColumn);
+            double qv;
+            q.append(iq && TextDataImporter::parseDouble(iq->text(), qv) ? qv : std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+
+    FlowPeriodResult res = FlowPeriodSegmenter::detect(t, p, q, rows);
+    clearPeriods();
+    if (!res.success) {
+        QMessageBox::warning(this, "流动段识别", res.errorMessage);
+        return;
+    }
+    m_periods = res.periods;
+    m_comboPeriod->blockSignals(true);
+    for (int i = 0; i < m_periods.size(); ++i) m_comboPeriod->addItem(QString("#%1  %2").arg(i + 1).arg(m_periods[i].label()));
+    m_comboPeriod->blockSignals(false);
+    m_comboPeriod->setEnabled(true);
+    m_comboPeriod->showPopup();
+}
+
+void FlowPeriodSelector::onPeriodChanged(int index)
+{
+    if (index > 0 && index <= m_periods.size()) emit periodSelected(m_periods[index - 1]);
+}
@@ -0,0 +1,117 @@
+/*
+ * 文件名: flowperiodsegmenter.h
+ * 文件作用: 流动段 (开井/关井/变产) 自动划分头文件
+ * 功能描述:
+ * 1. 采用 PELT (剪枝精确线性时间) 变点检测，代价为高斯均值变化，期望复杂度 O(n)。
+ * 2. 有产量列时对产量序列分段 (分段常数)，产量接近 0 的段为关井 (压力恢复)。
+ * 3. 只有压力时对压力增量序列分段，再按段内净变化的符号归类：上升为恢复，下降为降落，
+ *    相邻同类段合并；段起点在分界附近的压力极值处精确定位。
+ * 4. 超长历史先按块平均降采样后分段，再回到原始数据细化分界位置。
+ * 5. FlowPeriodSelector：嵌入拟合/绘图数据对话框的选择控件，一键识别并选取某一流动段。
+ */
+
+#ifndef FLOWPERIODSEGMENTER_H
+#define FLOWPERIODSEGMENTER_H
+
+#include <QString>
+#include <QVector>
+#include <QWidget>
+#include "rateschedule.h"
+
+class QStandardItemModel;
+class QComboBox;
+class QPushButton;
+
+enum class FlowPeriodType {
+    Drawdown,   // 开井生产 (压力降落)
+    Buildup     // 关井 (压力恢复)
+};
+
+// 单个流动段
+struct FlowPeriod {
+    int startRow;           // 起点在数据模型中的行号 (含)
+    int endRow;             // 终点行号 (不含)
+    double startTime;       // 起点时间 (开关井时刻)
+    double endTime;         // 末点时间
+    double startPressure;   // 起点压力 (恢复段为关井前流压，降落段为开井前静压)
+    double rate;            // 段内平均产量，无产量列时为 NaN
+    FlowPeriodType type;
+
+    QString label() const;
+};
+
+struct FlowPeriodConfig {
+    double penalty = 10.0;      // 变点惩罚系数 (乘以 ln(n))，越大分段越少
+    int minPoints = 10;         // 每段最少点数
+    int maxSamples = 20000;     // 分段前降采样的上限点数
+};
+
+struct FlowPeriodResult {
+    bool success = false;
+    QString errorMessage;
+    QVector<FlowPeriod> periods;
+};
+
+class FlowPeriodSegmenter
+{
+public:
+    /**
+     * @brief 划分流动段
+     * @param t 时间 (升序)
+     * @param p 压力
+     * @param q 产量 (可为空)
+     * @param rows 每个采样点对应的模型行号
+     */
+    static FlowPeriodResult detect(const QVector<double>& t, const QVector<double>& p, const QVector<double>& q,
+                                   const QVector<int>& rows, const FlowPeriodConfig& config = FlowPeriodConfig());
+
+    /**
+     * @brief PELT 均值变点检测
+     * @param x 已按噪声标准差归一化的序列
+     * @param penalty 每个变点的惩罚
+     * @param minSize 最短段长
+     * @return 各段起点下标 (首元素为 0)
+     */
+    static QVector<int> pelt(const QVector<double>& x, double penalty, int minSize);
+};
+
+// ============================================================================
+// 流动段选择控件
+// ============================================================================
+class FlowPeriodSelector : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit FlowPeriodSelector(QWidget* parent = nullptr);
+
+    // 数据源或列选择变化后，已识别的流动段作废
+    void setModel(QStandardItemModel* model);
+    void setColumns(int timeColumn, int pressureColumn);
+    void setSkipRows(int rows);
+
+    bool hasSelection() const;
+    FlowPeriod selectedPeriod() const;
+    // 所选段及其之前各段的产量制度，时间以所选段起点为零点；未选产量列时为空
+    RateSchedule selectedRateSchedule() const;
+
+signals:
+    void periodSelected(const FlowPeriod& period);
+
+private slots:
+    void onDetect();
+    void onPeriodChanged(int index);
+
+private:
+    void clearPeriods();
+
+    QStandardItemModel* m_model;
+    int m_timeColumn;
+    int m_pressureColumn;
+    int m_skipRows;
+    QComboBox* m_comboRate;
+    QPushButton* m_btnDetect;
+    QComboBox* m_comboPeriod;
+    QVector<FlowPeriod> m_periods;
+};
+
+#endif // FLOWPERIODSEGMENTER_H
@@ -4,6 +4,9 @@
  * 功能描述：
  * 1. 实例化 ModelManager，其内部现在初始化了新的 WT_ModelWidget 列表。
  * 2. 协调各个模块的交互逻辑。
+ * 3. 数据文件在编辑器中加载完成 (fileChanged) 后，才关联拟合模型并安排绘图数据传递。
+ * 4. 关闭项目时未保存的表格修改由自动保存服务在后台写出，完成后再清理界面。
+ * 5. 选择不保存关闭时放弃未保存的修改并删除日志，不再写盘。
  */
 
 #include "mainwindow.h"
@@ -16,9 +19,11 @@
 #include "wt_plottingwidget.h"
 #include "fittingpage.h"
 #include "settingswidget.h"
+#include "autosaveservice.h"
 
 #include <QDateTime>
 #include <QMessageBox>
+#include <QApplication>
 #include <QDebug>
 #include <QStandardItemModel>
 #include <QTimer>
@@ -151,6 +156,10 @@ void MainWindow::init()
     ui->verticalLayoutHandle->addWidget(m_DataEditorWidget);
     connect(m_DataEditorWidget, &DataEditorWidget::fileChanged, this, &MainWindow::onFileLoaded);
     connect(m_DataEditorWidget, &DataEditorWidget::dataChanged, this, &MainWindow::onDataEditorDataChanged);
+    connect(m_DataEditorWidget, &DataEditorWidget::deconvolutionReady, this,
+            [this](const QVector<double>& t, const QVector<double>& p, const QVector<double>& d) {
+                if (m_FittingPage) m_FittingPage->setObservedDataToCurrent(t, p, d);
+            });
 
     // 初始化模型管理器 (内部现在包含新的 Widget 和 Solver)
     m_ModelManager = new ModelManager(this);
@@ -175,6 +184,16 @@ void MainWindow::init()
     connect(m_SettingsWidget, &SettingsWidget::settingsChanged,
             this, &MainWindow::onSystemSettingsChanged);
 
+    // 表格数据自动保存 (增量日志 + 后台压缩)
+    m_AutoSave = new AutoSaveService(this);
+    m_AutoSave->attach(m_DataEditorWidget->getDataModel());
+    m_DataEditorWidget->setAutoSaveService(m_AutoSave);
+    connect(m_AutoSave, &AutoSaveService::statusChanged, this, [this](const QString& msg) {
+        this->statusBar()->showMessage(msg, 3000);
+    });
+    connect(m_AutoSave, &AutoSaveService::saveFinished, this, &MainWindow::onAutoSaveFinished);
+    onSystemSettingsChanged();
+
     initProjectForm();
     initDataEditorForm();
     initModelForm();
@@ -206,6 +225,11 @@ void MainWindow::onProjectOpened(bool isNew)
         }
     }
 
+    if (m_AutoSave) {
+        m_AutoSave->setEnabled(true);
+        m_AutoSave->markClean();
+    }
+
     if (m_FittingPage) {
         m_FittingPage->updateBasicParameters();
         m_FittingPage->loadAllFittingStates();
@@ -229,12 +253,47 @@ void MainWindow::onProjectOpened(bool isNew)
     msgBox.exec();
 }
 
-void MainWindow::onProjectClosed()
+void MainWindow::onProjectClosed(bool saveChanges)
 {
     qDebug() << "项目已关闭，重置界面状态...";
     m_isProjectLoaded = false;
     m_hasValidData = false;
 
+    if (m_AutoSave && !saveChanges) {
+        m_AutoSave->discardChanges();
+        finishProjectClose(true, QString(), false);
+        return;
+    }
+
+    // 未写入的修改在后台保存，期间界面不可操作但保持刷新；完成后再清理
+    if (m_AutoSave && m_AutoSave->isDirty()) {
+        m_closingProject = true;
+        setEnabled(false);
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        statusBar()->showMessage("正在保存项目数据...");
+        m_AutoSave->saveNow();
+        return;
+    }
+    finishProjectClose(true, QString(), saveChanges);
+}
+
+void MainWindow::onAutoSaveFinished(bool ok, const QString& error)
+{
+    // 之前提交的保存 (如编辑器中的手动保存) 结束时，关闭前请求的保存可能仍在排队
+    if (!m_closingProject || m_AutoSave->isSaving()) return;
+    m_closingProject = false;
+    QApplication::restoreOverrideCursor();
+    setEnabled(true);
+    statusBar()->clearMessage();
+    finishProjectClose(ok, error, true);
+}
+
+void MainWindow::finishProjectClose(bool saved, const QString& error, bool saveChanges)
+{
+    if (m_AutoSave) {
+        m_AutoSave->setEnabled(false);
+    }
+
     if (m_DataEditorWidget) {
         m_DataEditorWidget->clearAllData();
     }
@@ -257,8 +316,9 @@ void MainWindow::onProjectClosed()
 
     QMessageBox msgBox;
     msgBox.setWindowTitle("提示");
-    msgBox.setText("项目已保存并关闭。");
-    msgBox.setIcon(QMessageBox::Information);
+    if (!saveChanges) msgBox.setText("项目已关闭，未保存的修改已放弃。");
+    else msgBox.setText(saved ? "项目已保存并关闭。" : "项目已关闭，但表格数据保存失败：" + error);
+    msgBox.setIcon(saved ? QMessageBox::Information : QMessageBox::Warning);
     msgBox.setStyleSheet(getMessageBoxStyle());
     msgBox.exec();
 }
@@ -288,8 +348,11 @@ void MainWindow::onFileLoaded(const QString& filePath, const QString& fileType)
         item++;
     }
 
+    // 文本/Excel 文件在后台加载，此时模型仍是旧数据；
+    // 加载完成后编辑器发出 fileChanged 再次进入本函数，执行下面的后续步骤
     if (m_DataEditorWidget && sender() != m_DataEditorWidget) {
         m_DataEditorWidget->loadData(filePath, fileType);
+        return;
     }
 
     if (m_FittingPage && m_DataEditorWidget) {
@@ -394,6 +457,10 @@ void MainWindow::onFittingProgressChanged(int progress)
 void MainWindow::onSystemSettingsChanged()
 {
     qDebug() << "系统设置已变更";
+    if (m_AutoSave && m_SettingsWidget) {
+        m_AutoSave->setInterval(m_SettingsWidget->getAutoSaveInterval());
+        m_AutoSave->setBackup(m_SettingsWidget->isBackupEnabled(), m_SettingsWidget->getBackupPath());
+    }
 }
 
 void MainWindow::onPerformanceSettingsChanged() {}
@@ -22,6 +22,7 @@ class DataEditorWidget;
 class WT_PlottingWidget;
 class FittingPage;
 class SettingsWidget;
+class AutoSaveService;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -45,7 +46,8 @@ public:
 
 private slots:
     void onProjectOpened(bool isNew);
-    void onProjectClosed();
+    void onProjectClosed(bool saveChanges);
+    void onAutoSaveFinished(bool ok, const QString& error);
     void onFileLoaded(const QString& filePath, const QString& fileType);
 
     void onPlotAnalysisCompleted(const QString &analysisType, const QMap<QString, double> &results);
@@ -67,11 +69,16 @@ private:
     WT_PlottingWidget* m_PlottingWidget;
     FittingPage* m_FittingPage;
     SettingsWidget* m_SettingsWidget;
+    AutoSaveService* m_AutoSave;
 
     QMap<QString, NavBtn*> m_NavBtnMap;
     QTimer m_timer;
     bool m_hasValidData = false;
     bool m_isProjectLoaded = false;
+    bool m_closingProject = false;    // 关闭项目前的后台保存进行中
+
+    // 关闭项目：清理各界面 (saveChanges 为 false 表示放弃修改；saved 为 false 时提示保存失败原因)
+    void finishProjectClose(bool saved, const QString& error, bool saveChanges);
 
     void transferDataFromEditorToPlotting();
     void updateNavigationState();
@@ -5,6 +5,8 @@
  * 1. 实例化并管理 6 个 WT_ModelWidget (用于界面显示)。
  * 2. 实例化并管理 6 个 ModelSolver01_06 (用于后台计算)。
  * 3. 处理模型选择逻辑，分发计算任务。
+ * 4. 初始化时尝试加载程序目录下的 typecurves.atlas，缺失时预览退回逐点求解。
+ * 5. 求解线程池与全局线程池分开，文件读写等后台任务不会因长时间的拟合或敏感性计算而排队。
  */
 
 #include "modelmanager.h"
@@ -43,6 +45,12 @@ void ModelManager::initializeModels(QWidget* parentWidget)
     m_modelWidgets.clear();
     m_solvers.clear();
 
+    // 典型曲线图版为可选资源，由 typecurvebuilder 离线生成
+    QString atlasError;
+    if (!m_atlas.load(TypeCurveAtlas::defaultFilePath(), &atlasError)) {
+        qDebug() << "未加载典型曲线图版:" << atlasError;
+    }
+
     // 循环创建 6 组界面和求解器
     // 使用 ModelSolver01_06::Model_x 枚举
     using MT = ModelSolver01_06::ModelType;
@@ -56,6 +64,7 @@ void ModelManager::initializeModels(QWidget* parentWidget)
 
         // 连接子界面的模型选择请求信号
         connect(widget, &WT_ModelWidget::requestModelSelection, this, &ModelManager::onSelectModelClicked);
+        if (m_atlas.isLoaded()) widget->setTypeCurveAtlas(&m_atlas);
 
         // 2. 创建独立的求解器对象，用于后台/拟合计算
         ModelSolver01_06* solver = new ModelSolver01_06(type);
@@ -191,21 +200,44 @@ QMap<QString, double> ModelManager::getDefaultParameters(ModelType type)
 }
 
 // [核心修改] 使用独立的 Solver 进行计算，不再调用 Widget 方法
-ModelCurveData ModelManager::calculateTheoreticalCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime)
+ModelCurveData ModelManager::calculateTheoreticalCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime,
+                                                       const RateSchedule& schedule, SolveControl* control)
 {
     int index = (int)type;
     // 使用 m_solvers 而不是 m_modelWidgets
     if (index >= 0 && index < m_solvers.size()) {
-        return m_solvers[index]->calculateTheoreticalCurve(params, providedTime);
+        return m_solvers[index]->calculateTheoreticalCurve(params, providedTime, schedule, nullptr, control);
     }
     return ModelCurveData();
 }
 
+ModelCurveData ModelManager::calculatePreviewCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime,
+                                                   const RateSchedule& schedule, SolveControl* control)
+{
+    int index = (int)type;
+    if (index >= 0 && index < m_solvers.size()) {
+        return m_solvers[index]->calculateTheoreticalCurve(params, providedTime, schedule, m_atlas.isLoaded() ? &m_atlas : nullptr, control);
+    }
+    return ModelCurveData();
+}
+
+bool ModelManager::typeCurveAtlasCovers(ModelType type, const QMap<QString, double>& params) const
+{
+    TypeCurveAtlas::Column column;
+    return m_atlas.lookup(type, params, column);
+}
+
 QVector<double> ModelManager::generateLogTimeSteps(int count, double startExp, double endExp) {
     // 委托给 Solver 的静态方法
     return ModelSolver01_06::generateLogTimeSteps(count, startExp, endExp);
 }
 
+QThreadPool* ModelManager::solverPool()
+{
+    static QThreadPool pool;
+    return &pool;
+}
+
 void ModelManager::setObservedData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d)
 {
     m_cachedObsTime = t;
@@ -5,6 +5,8 @@
  * 1. 管理所有试井模型界面 (WT_ModelWidget) 的显示与切换。
  * 2. 管理所有数学模型求解器 (ModelSolver01_06) 的实例与计算。
  * 3. 协调模型计算请求，实现界面与算法的解耦。
+ * 4. 持有程序目录下的典型曲线图版 (若存在)，提供快速预览计算接口。
+ * 5. 提供模型计算专用线程池，拟合、正演计算与敏感性分析共用，不占用全局线程池。
  */
 
 #ifndef MODELMANAGER_H
@@ -15,10 +17,12 @@
 #include <QVector>
 #include <QStackedWidget>
 #include <QPushButton>
+#include <QThreadPool>
 
 // 引入新的界面类和求解器类头文件
 #include "wt_modelwidget.h"
 #include "modelsolver01-06.h"
+#include "typecurveatlas.h"
 
 class ModelManager : public QObject
 {
@@ -47,7 +51,16 @@ public:
     static QString getModelTypeName(ModelType type);
 
     // 核心计算接口：代理给对应的 Solver 进行计算 (线程安全，可在拟合线程调用)
-    ModelCurveData calculateTheoreticalCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>());
+    // schedule 非空时按变产量叠加 (见 ModelSolver01_06::calculateTheoreticalCurve)；control 用于进度与取消
+    ModelCurveData calculateTheoreticalCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>(),
+                                             const RateSchedule& schedule = RateSchedule(), SolveControl* control = nullptr);
+
+    // 快速预览计算：图版已加载且覆盖参数时按图版插值，否则同 calculateTheoreticalCurve
+    ModelCurveData calculatePreviewCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>(),
+                                         const RateSchedule& schedule = RateSchedule(), SolveControl* control = nullptr);
+    bool hasTypeCurveAtlas() const { return m_atlas.isLoaded(); }
+    // 参数点是否落在图版网格内 (不含时间范围检查)
+    bool typeCurveAtlasCovers(ModelType type, const QMap<QString, double>& params) const;
 
     // 获取默认参数
     QMap<QString, double> getDefaultParameters(ModelType type);
@@ -61,6 +74,9 @@ public:
     // 生成对数时间步长 (静态工具)
     static QVector<double> generateLogTimeSteps(int count, double startExp, double endExp);
 
+    // 模型计算线程池 (线程数 = CPU 核数)，所有后台求解任务都提交到这里
+    static QThreadPool* solverPool();
+
     // 观测数据缓存管理
     void setObservedData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d);
     void getObservedData(QVector<double>& t, QVector<double>& p, QVector<double>& d) const;
@@ -92,6 +108,9 @@ private:
 
     ModelType m_currentModelType;
 
+    // 典型曲线图版 (内存映射，只读，各求解器共享)
+    TypeCurveAtlas m_atlas;
+
     QVector<double> m_cachedObsTime;
     QVector<double> m_cachedObsPressure;
     QVector<double> m_cachedObsDerivative;
@@ -3,7 +3,8 @@
  * 文件作用: 项目参数单例类实现文件
  * 功能描述:
  * 1. 实现项目数据的加载与保存。
- * 2. [关键] loadProject 时强制读取 _date.json 到 m_fullProjectData["table_data"]，解决数据丢失问题。
+ * 2. [关键] loadProject 时优先打开二进制 _date.wtd (只读列索引)，不存在时读取旧版 _date.json 到 m_fullProjectData["table_data"]。
+ * 3. 绘图数据：_chart.json 保存曲线配置，数据点数组读写 _chart.wtc，不进入 JSON 缓存。
  */
 
 #include "modelparameter.h"
@@ -11,6 +12,10 @@
 #include <QJsonDocument>
 #include <QFileInfo>
 #include <QDebug>
+#include <QStandardItemModel>
+#include <QDir>
+#include <QDateTime>
+#include "tablejournal.h"
 
 ModelParameter* ModelParameter::m_instance = nullptr;
 
@@ -58,6 +63,15 @@ QString ModelParameter::getPlottingDataFilePath() const
     return fi.absolutePath() + "/" + baseName + "_chart.json";
 }
 
+// 构造曲线数据路径: 原文件名 + "_chart.wtc"
+QString ModelParameter::getPlottingStoreFilePath() const
+{
+    if (m_projectFilePath.isEmpty()) return QString();
+    QFileInfo fi(m_projectFilePath);
+    QString baseName = fi.completeBaseName();
+    return fi.absolutePath() + "/" + baseName + "_chart.wtc";
+}
+
 // 构造表格数据路径: 原文件名 + "_date.json"
 QString ModelParameter::getTableDataFilePath() const
 {
@@ -67,6 +81,110 @@ QString ModelParameter::getTableDataFilePath() const
     return fi.absolutePath() + "/" + baseName + "_date.json";
 }
 
+// 构造二进制表格数据路径: 原文件名 + "_date.wtd"
+QString ModelParameter::getTableStoreFilePath() const
+{
+    if (m_projectFilePath.isEmpty()) return QString();
+    QFileInfo fi(m_projectFilePath);
+    QString baseName = fi.completeBaseName();
+    return fi.absolutePath() + "/" + baseName + "_date.wtd";
+}
+
+// 构造表格增量日志路径: 原文件名 + "_date.journal"
+QString ModelParameter::getTableJournalFilePath() const
+{
+    if (m_projectFilePath.isEmpty()) return QString();
+    QFileInfo fi(m_projectFilePath);
+    QString baseName = fi.completeBaseName();
+    return fi.absolutePath() + "/" + baseName + "_date.journal";
+}
+
+// 崩溃恢复
+// 1. 存在 .wtd.new：说明压缩已完成但替换未结束，直接采用新文件
+// 2. 存在 .journal.compacting / .journal：依次回放到 .wtd (无 .wtd 时以旧版 _date.json 为基础)
+void ModelParameter::recoverTableJournal()
+{
+    const QString storePath = getTableStoreFilePath();
+    const QString newPath = storePath + ".new";
+    const QString journalPath = getTableJournalFilePath();
+    const QString compactingPath = journalPath + ".compacting";
+
+    if (QFile::exists(newPath)) {
+        QFile::remove(compactingPath);
+        QFile::remove(storePath);
+        QFile::rename(newPath, storePath);
+        qDebug() << "已完成上次未结束的表格数据替换:" << storePath;
+    }
+
+    QStringList journals;
+    if (QFile::exists(compactingPath)) journals << compactingPath;
+    if (QFile::exists(journalPath)) journals << journalPath;
+    if (journals.isEmpty()) return;
+
+    TableJournal::Table base;
+    bool hasBase = false;
+    if (!QFile::exists(storePath)) {
+        QFile legacy(getTableDataFilePath());
+        if (legacy.open(QIODevice::ReadOnly)) {
+            QJsonArray arr = QJsonDocument::fromJson(legacy.readAll()).object().value("table_data").toArray();
+            for (int i = 0; i < arr.size(); ++i) {
+                QJsonObject o = arr[i].toObject();
+                if (i == 0 && o.contains("headers")) {
+                    for (const auto& v : o["headers"].toArray()) base.headers << v.toString();
+                    base.columns.resize(base.headers.size());
+                } else if (o.contains("row_data")) {
+                    QJsonArray row = o["row_data"].toArray();
+                    if (row.size() > base.columns.size()) base.columns.resize(row.size());
+                    for (int c = 0; c < base.columns.size(); ++c) {
+                        while (base.columns[c].size() < base.rowCount) base.columns[c].append(QString());
+                        base.columns[c].append(c < row.size() ? row[c].toString() : QString());
+                    }
+                    base.rowCount++;
+                }
+            }
+            while (base.headers.size() < base.columns.size()) base.headers.append(QString());
+            hasBase = true;
+        }
+    }
+
+    QString err;
+    if (TableJournal::compact(storePath, journals, newPath, hasBase ? &base : nullptr, &err)) {
+        for (const QString& j : journals) QFile::remove(j);
+        QFile::remove(storePath);
+        QFile::rename(newPath, storePath);
+        qDebug() << "已从增量日志恢复表格数据:" << journals;
+    } else {
+        qDebug() << "表格日志恢复失败:" << err;
+    }
+}
+
+bool ModelParameter::replaceTableStore(const QString& newStorePath, const QString& compactedJournalPath, const QString& backupDir)
+{
+    const QString storePath = getTableStoreFilePath();
+    if (storePath.isEmpty() || !QFile::exists(newStorePath)) return false;
+
+    // 顺序不可调换：日志已并入 .new，先删日志；此后崩溃时由 recoverTableJournal 采用 .new
+    if (!compactedJournalPath.isEmpty()) QFile::remove(compactedJournalPath);
+
+    m_tableStore.close();
+    if (!backupDir.isEmpty() && QFile::exists(storePath)) {
+        QDir().mkpath(backupDir);
+        QString backupPath = backupDir + "/" + QFileInfo(storePath).completeBaseName() + "_backup.wtd";
+        QFile::remove(backupPath);
+        QFile::copy(storePath, backupPath);
+    }
+    QFile::remove(storePath);
+    bool ok = QFile::rename(newStorePath, storePath);
+    if (ok) {
+        // 旧版 JSON 数据已并入新文件
+        m_fullProjectData.remove("table_data");
+        QString legacyPath = getTableDataFilePath();
+        if (QFile::exists(legacyPath)) QFile::remove(legacyPath);
+    }
+    m_tableStore.open(storePath);
+    return ok;
+}
+
 bool ModelParameter::loadProject(const QString& filePath)
 {
     // 1. 加载主项目文件 (.pwt)
@@ -116,9 +234,31 @@ bool ModelParameter::loadProject(const QString& filePath)
         }
         chartFile.close();
     }
+    m_curveStore.close();
+    QString curvePath = getPlottingStoreFilePath();
+    if (QFile::exists(curvePath)) {
+        QString err;
+        if (!m_curveStore.open(curvePath, &err))
+            qDebug() << "曲线数据文件读取失败:" << curvePath << err;
+    }
 
-    // 3. [关键修复] 加载表格数据 (_date.json)
+    // 3. [关键修复] 加载表格数据
     // 必须确保这里的逻辑与 DataEditorWidget::onSave 对应
+    // 优先使用二进制列式文件 (_date.wtd)，只映射文件并读取列索引
+    m_tableStore.close();
+    m_fullProjectData.remove("table_data");
+    recoverTableJournal();
+    QString storePath = getTableStoreFilePath();
+    if (QFile::exists(storePath)) {
+        QString err;
+        if (m_tableStore.open(storePath, &err)) {
+            qDebug() << "成功打开表格数据文件:" << storePath << "行数:" << m_tableStore.rowCount() << "列数:" << m_tableStore.columnCount();
+            return true;
+        }
+        qDebug() << "表格数据文件打开失败:" << storePath << err;
+    }
+
+    // 旧版项目：读取 _date.json
     QString datePath = getTableDataFilePath();
     QFile dateFile(datePath);
     if (dateFile.exists() && dateFile.open(QIODevice::ReadOnly)) {
@@ -178,6 +318,8 @@ bool ModelParameter::saveProject()
 
 void ModelParameter::closeProject()
 {
+    m_tableStore.close();
+    m_curveStore.close();
     m_hasLoaded = false;
     m_projectPath.clear();
     m_projectFilePath.clear();
@@ -205,9 +347,37 @@ QJsonObject ModelParameter::getFittingResult() const
     return m_fullProjectData.value("fitting").toObject();
 }
 
-void ModelParameter::savePlottingData(const QJsonArray& plots)
+void ModelParameter::setComputedColumns(const QJsonArray& columns)
 {
-    if (m_projectFilePath.isEmpty()) return;
+    if (columns.isEmpty()) m_fullProjectData.remove("computed_columns");
+    else m_fullProjectData["computed_columns"] = columns;
+}
+
+QJsonArray ModelParameter::getComputedColumns() const
+{
+    return m_fullProjectData.value("computed_columns").toArray();
+}
+
+bool ModelParameter::savePlottingData(const QJsonArray& plots, const CurveStore::ArrayMap& arrays, QString* error)
+{
+    if (m_projectFilePath.isEmpty()) return true;
+
+    // 先写数据点，再写引用它们的配置；替换前释放映射 (Windows 下被映射的文件无法替换)
+    QString curvePath = getPlottingStoreFilePath();
+    m_curveStore.close();
+    if (!arrays.isEmpty()) {
+        QString err;
+        if (!CurveStore::write(curvePath, arrays, &err)) {
+            qDebug() << err;
+            if (error) *error = err;
+            // 原文件未被替换，恢复映射以便继续按需读取
+            m_curveStore.open(curvePath);
+            return false;
+        }
+        m_curveStore.open(curvePath);
+    } else if (QFile::exists(curvePath)) {
+        QFile::remove(curvePath);
+    }
 
     m_fullProjectData["plotting_data"] = plots;
 
@@ -220,6 +390,7 @@ void ModelParameter::savePlottingData(const QJsonArray& plots)
         file.write(QJsonDocument(dataObj).toJson());
         file.close();
     }
+    return true;
 }
 
 QJsonArray ModelParameter::getPlottingData() const
@@ -251,9 +422,44 @@ void ModelParameter::saveTableData(const QJsonArray& tableData)
 }
 
 
+// 保存表格数据 (二进制列式)
+bool ModelParameter::saveTableModel(const QStandardItemModel* model)
+{
+    if (m_projectFilePath.isEmpty() || !model) return false;
+
+    // 覆盖前先解除映射 (Windows 下映射中的文件无法替换)
+    QString storePath = getTableStoreFilePath();
+    m_tableStore.close();
+
+    TableStore::WriteOptions options;
+    QString err;
+    if (!TableStore::writeModel(storePath, model, options, &err)) {
+        qDebug() << "表格数据保存失败:" << storePath << err;
+        return false;
+    }
+    qDebug() << "表格数据已保存至:" << storePath << "行数:" << model->rowCount();
+
+    // 旧版 JSON 数据已迁移，移除以免与新文件不一致
+    m_fullProjectData.remove("table_data");
+    QString legacyPath = getTableDataFilePath();
+    if (QFile::exists(legacyPath)) QFile::remove(legacyPath);
+
+    // 完整保存后，增量日志及未完成的压缩结果均已失效
+    QString journalPath = getTableJournalFilePath();
+    QFile::remove(journalPath);
+    QFile::remove(journalPath + ".compacting");
+    QFile::remove(storePath + ".new");
+
+    m_tableStore.open(storePath, &err);
+    return true;
+}
+
 // [新增] 实现重置逻辑
 void ModelParameter::resetAllData()
 {
+    m_tableStore.close();
+    m_curveStore.close();
+
     // 1. 重置基础物理参数为默认值
     m_phi = 0.05;
     m_h = 20.0;
@@ -3,8 +3,10 @@
  * 文件作用: 项目参数单例类头文件
  * 功能描述:
  * 1. 管理项目核心数据（孔隙度、粘度等）和文件路径。
- * 2. 负责 _chart.json (图表) 和 _date.json (表格) 的路径生成和存取。
+ * 2. 负责 _chart.json (图表) 和 _date.wtd (表格，二进制列式；兼容旧版 _date.json) 的路径生成和存取。
  * 3. 确保项目保存和加载时，数据表格的内容能被正确持久化。
+ * 4. 绘图曲线的数据点存于 _chart.wtc (二进制)，_chart.json 只保存曲线配置 (兼容旧版内嵌数组)。
+ * 5. 打开项目时 _chart.wtc 只建立索引，曲线数据点由绘图界面在显示时按需读取。
  */
 
 #ifndef MODELPARAMETER_H
@@ -16,6 +18,10 @@
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QMutex>
+#include "tablestore.h"
+#include "curvestore.h"
+
+class QStandardItemModel;
 
 class ModelParameter : public QObject
 {
@@ -60,25 +66,48 @@ public:
     void saveFittingResult(const QJsonObject& fittingData);
     QJsonObject getFittingResult() const;
 
+    // 表达式计算列定义 (随 .pwt 主文件保存)
+    void setComputedColumns(const QJsonArray& columns);
+    QJsonArray getComputedColumns() const;
+
     // ========================================================================
     // 独立数据文件存取 (关键修复部分)
     // ========================================================================
 
-    // 保存绘图数据到 "_chart.json"
-    void savePlottingData(const QJsonArray& plots);
+    // 保存绘图配置到 "_chart.json"，曲线数据点到 "_chart.wtc"
+    // arrays 须包含全部曲线的数据点 (文件会被整体替换)
+    bool savePlottingData(const QJsonArray& plots, const CurveStore::ArrayMap& arrays = CurveStore::ArrayMap(),
+                          QString* error = nullptr);
     QJsonArray getPlottingData() const;
+    // 曲线数据点存储 (按需读取)
+    const CurveStore& curveStore() const { return m_curveStore; }
 
-    // 保存表格数据到 "_date.json"
-    // DataEditorWidget 调用此函数将表格内容写入磁盘
+    // 保存表格数据到 "_date.json" (旧格式，仅保留兼容)
     void saveTableData(const QJsonArray& tableData);
 
+    // 保存表格数据到 "_date.wtd" (二进制列式)
+    // DataEditorWidget 调用此函数将表格内容写入磁盘，成功后删除旧的 _date.json
+    bool saveTableModel(const QStandardItemModel* model);
+
+    // 二进制表格数据 (loadProject 时只读取列索引，列数据由数据编辑器填充模型时解码)
+    bool hasTableStore() const { return m_tableStore.isOpen(); }
+    const TableStore& tableStore() const { return m_tableStore; }
+
+    // 表格数据附属文件路径 (自动保存服务使用)
+    QString getTableStoreFilePath() const;
+    QString getTableJournalFilePath() const;
+
+    // 用日志压缩生成的新文件替换 _date.wtd (先删除已压缩的日志，再替换，任一步骤崩溃均可恢复)
+    // backupDir 非空时，替换前将旧文件复制为备份
+    bool replaceTableStore(const QString& newStorePath, const QString& compactedJournalPath, const QString& backupDir = QString());
+
 
     // 重置所有项目数据（清空缓存）
     void resetAllData();
 
 
-    // 获取表格数据
-    // DataEditorWidget 加载项目时调用此函数恢复界面
+    // 获取表格数据 (旧版 _date.json)
+    // DataEditorWidget 加载项目时，未找到 _date.wtd 则调用此函数恢复界面
     QJsonArray getTableData() const;
 
 private:
@@ -92,6 +121,12 @@ private:
     // 缓存完整的JSON对象，包含从各个子文件读取的内容
     QJsonObject m_fullProjectData;
 
+    // 二进制表格数据 (内存映射)
+    TableStore m_tableStore;
+
+    // 绘图曲线数据点 (_chart.wtc，内存映射)
+    CurveStore m_curveStore;
+
     // 基础参数变量
     double m_phi;
     double m_h;
@@ -103,7 +138,11 @@ private:
 
     // 辅助：获取附属文件的绝对路径
     QString getPlottingDataFilePath() const;
+    QString getPlottingStoreFilePath() const;
     QString getTableDataFilePath() const;
+
+    // 崩溃恢复：完成未结束的替换，并把残留日志合并进 _date.wtd
+    void recoverTableJournal();
 };
 
 #endif // MODELPARAMETER_H
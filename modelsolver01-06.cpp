@@ -5,14 +5,22 @@
  * 1. 实现6种不同边界和井储条件组合的页岩油数学模型解。
  * 2. 包含 Stehfest 数值反演算法、自适应高斯积分、Bessel 函数调用等核心算法。
  * 3. 实现了数据处理和物理量到无因次量的转换逻辑。
+ * 4. 变产量叠加：Δp(t) = Σ (q_j - q_{j-1}) · u(t - t_j)，u 为单位产量响应。
+ *    u 在覆盖所有 (t - t_j) 的对数网格上只做一次 Stehfest 反演，叠加时按 ln t 线性插值，
+ *    计算量与变产次数无关。
+ * 5. 图版预览：储层解由 TypeCurveAtlas 插值给出，井储表皮与压敏修正照常施加；
+ *    插值误差经 Stehfest 放大，图版路径固定取 4 项。
+ * 6. 取消检查放在 Stehfest 反演的时间点循环中，单点耗时即取消的最大延迟。
  */
 
 #include "modelsolver01-06.h"
+#include "typecurveatlas.h"
 #include "pressurederivativecalculator.h" // 假设此文件为通用算法库，若未包含可将导数计算逻辑移入此处
 
 #include <Eigen/Dense>
 #include <boost/math/special_functions/bessel.hpp>
 #include <cmath>
+#include <limits>
 #include <algorithm>
 #include <QDebug>
 
@@ -66,7 +74,9 @@ QVector<double> ModelSolver01_06::generateLogTimeSteps(int count, double startEx
 }
 
 // 核心计算函数
-ModelCurveData ModelSolver01_06::calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime)
+ModelCurveData ModelSolver01_06::calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime,
+                                                           const RateSchedule& schedule, const TypeCurveAtlas* atlas,
+                                                           SolveControl* control)
 {
     // 1. 准备时间序列
     QVector<double> tPoints = providedTime;
@@ -74,12 +84,38 @@ ModelCurveData ModelSolver01_06::calculateTheoreticalCurve(const QMap<QString, d
         tPoints = generateLogTimeSteps(100, -3.0, 3.0);
     }
 
+    // 从 0 时刻开始的单一产量直接计算，其余情况走叠加
+    double q = params.value("q", 5.0);
+    if (!schedule.isEmpty()) {
+        if (schedule.size() > 1 || schedule.startTime(0) != 0.0) {
+            return superposeRateSchedule(params, tPoints, schedule, atlas, control);
+        }
+        q = schedule.rate(0);
+    }
+
+    QVector<double> unitDP, unitDeriv;
+    calculateUnitResponse(tPoints, params, unitDP, unitDeriv, atlas, control);
+    if (control && control->cancelled) return ModelCurveData();
+
+    QVector<double> finalP(tPoints.size()), finalDP(tPoints.size());
+    for(int i=0; i<tPoints.size(); ++i) {
+        finalP[i] = q * unitDP[i];
+        finalDP[i] = q * unitDeriv[i];
+    }
+
+    return std::make_tuple(tPoints, finalP, finalDP);
+}
+
+// 单位产量响应
+void ModelSolver01_06::calculateUnitResponse(const QVector<double>& tPoints, const QMap<QString, double>& params,
+                                             QVector<double>& outDP, QVector<double>& outDeriv, const TypeCurveAtlas* atlas,
+                                             SolveControl* control)
+{
     // 2. 提取物理参数
     double phi = params.value("phi", 0.05);
     double mu = params.value("mu", 0.5);
     double B = params.value("B", 1.05);
     double Ct = params.value("Ct", 5e-4);
-    double q = params.value("q", 5.0);
     double h = params.value("h", 20.0);
     double kf = params.value("kf", 1e-3);
     double L = params.value("L", 1000.0);
@@ -98,20 +134,116 @@ ModelCurveData ModelSolver01_06::calculateTheoreticalCurve(const QMap<QString, d
         tD_vec.append(val);
     }
 
-    // 4. 计算无因次压力和导数
+    // 4. 计算无因次压力和导数 (图版覆盖所需 z 范围时走插值)
     QVector<double> PD_vec, Deriv_vec;
-    auto func = std::bind(&ModelSolver01_06::flaplace_composite, this, std::placeholders::_1, std::placeholders::_2);
-    calculatePDandDeriv(tD_vec, params, func, PD_vec, Deriv_vec);
+    TypeCurveAtlas::Column column;
+    bool useAtlas = false;
+    if (atlas && atlas->lookup(m_type, params, column)) {
+        double tDMin = std::numeric_limits<double>::infinity(), tDMax = 0.0;
+        for (double v : tD_vec) {
+            if (v <= 1e-12) continue;
+            tDMin = std::min(tDMin, v);
+            tDMax = std::max(tDMax, v);
+        }
+        const double ln2 = std::log(2.0);
+        useAtlas = tDMax > 0.0 && column.covers(ln2 / tDMax, 4.0 * ln2 / tDMin);
+    }
+    if (useAtlas) {
+        auto func = [this, &column](double z, const QMap<QString, double>& p) {
+            return applyWellboreStorage(z, column.value(z), p);
+        };
+        calculatePDandDeriv(tD_vec, params, func, PD_vec, Deriv_vec, 4, control);
+    } else {
+        auto func = std::bind(&ModelSolver01_06::flaplace_composite, this, std::placeholders::_1, std::placeholders::_2);
+        calculatePDandDeriv(tD_vec, params, func, PD_vec, Deriv_vec, 0, control);
+    }
 
-    // 5. 将无因次量转换为物理量 (压差 dp)
+    // 5. 将无因次量转换为物理量 (单位产量压差)
     // dp = 1.842e-3 * q * mu * B / (k * h) * pD
-    double p_coeff = 1.842e-3 * q * mu * B / (kf * h);
-
-    QVector<double> finalP(tPoints.size()), finalDP(tPoints.size());
+    double p_coeff = 1.842e-3 * mu * B / (kf * h);
 
+    outDP.resize(tPoints.size());
+    outDeriv.resize(tPoints.size());
     for(int i=0; i<tPoints.size(); ++i) {
-        finalP[i] = p_coeff * PD_vec[i];
-        finalDP[i] = p_coeff * Deriv_vec[i];
+        outDP[i] = p_coeff * PD_vec[i];
+        outDeriv[i] = p_coeff * Deriv_vec[i];
+    }
+}
+
+// 变产量叠加
+ModelCurveData ModelSolver01_06::superposeRateSchedule(const QMap<QString, double>& params, const QVector<double>& tPoints,
+                                                       const RateSchedule& schedule, const TypeCurveAtlas* atlas,
+                                                       SolveControl* control)
+{
+    const int nSteps = schedule.size();
+    QVector<double> stepTime, stepDq;
+    for (int j = 0; j < nSteps; ++j) {
+        const double dq = schedule.rate(j) - (j > 0 ? schedule.rate(j - 1) : 0.0);
+        if (dq == 0.0) continue;
+        stepTime.append(schedule.startTime(j));
+        stepDq.append(dq);
+    }
+
+    // 段起点 (t = 0) 之前最后一次变产决定压力变化的方向：关井为恢复 (正)，开井/提产为降落 (正)
+    double sign = 1.0;
+    for (int j = 0; j < stepTime.size() && stepTime[j] <= 0.0; ++j) sign = stepDq[j] < 0 ? -1.0 : 1.0;
+
+    // 1. 叠加需要的经历时间范围 (含 t = 0 处的参考值)
+    double tauMin = std::numeric_limits<double>::infinity(), tauMax = 0.0;
+    auto cover = [&](double t) {
+        for (int j = 0; j < stepTime.size() && stepTime[j] < t; ++j) {
+            const double tau = t - stepTime[j];
+            tauMin = std::min(tauMin, tau);
+            tauMax = std::max(tauMax, tau);
+        }
+    };
+    cover(0.0);
+    for (double t : tPoints) cover(t);
+
+    QVector<double> finalP(tPoints.size(), 0.0), finalDP(tPoints.size(), 0.0);
+    if (!(tauMax > 0.0) || !std::isfinite(tauMin)) return std::make_tuple(tPoints, finalP, finalDP);
+
+    // 2. 公共对数网格上计算单位响应 (每十倍程 25 点)
+    const double lnMin = std::log(tauMin), lnMax = std::log(tauMax);
+    const int nGrid = qMax(2, int(std::ceil((lnMax - lnMin) / std::log(10.0) * 25.0)) + 1);
+    const double hGrid = (nGrid > 1 && lnMax > lnMin) ? (lnMax - lnMin) / (nGrid - 1) : 1.0;
+    QVector<double> grid(nGrid);
+    for (int i = 0; i < nGrid; ++i) grid[i] = std::exp(lnMin + i * hGrid);
+    QVector<double> unitDP, unitDeriv;
+    calculateUnitResponse(grid, params, unitDP, unitDeriv, atlas, control);
+    if (control && control->cancelled) return ModelCurveData();
+
+    // 按 ln τ 线性插值
+    auto interp = [&](const QVector<double>& v, double tau) {
+        const double x = (std::log(tau) - lnMin) / hGrid;
+        if (x <= 0.0) return v[0];
+        if (x >= nGrid - 1) return v[nGrid - 1];
+        const int i = int(x);
+        const double w = x - i;
+        return v[i] * (1.0 - w) + v[i + 1] * w;
+    };
+
+    // 3. 叠加：Δp_dd(t) 与 dΔp_dd/dt
+    // 压敏修正 (gamaD) 为非线性，此处按各单位响应分别修正后叠加，属近似处理
+    auto drawdown = [&](double t, double& slope) {
+        double dp = 0.0;
+        slope = 0.0;
+        for (int j = 0; j < stepTime.size() && stepTime[j] < t; ++j) {
+            const double tau = t - stepTime[j];
+            dp += stepDq[j] * interp(unitDP, tau);
+            slope += stepDq[j] * interp(unitDeriv, tau) / tau;
+        }
+        return dp;
+    };
+
+    double slope0;
+    const double dp0 = drawdown(0.0, slope0);
+    for (int i = 0; i < tPoints.size(); ++i) {
+        const double t = tPoints[i];
+        double slope;
+        const double dp = drawdown(t, slope);
+        finalP[i] = sign * (dp - dp0);
+        finalDP[i] = t > 0 ? sign * t * slope : 0.0; // 对段内 ln(Δt) 的导数
     }
 
     return std::make_tuple(tPoints, finalP, finalDP);
@@ -120,20 +252,27 @@ ModelCurveData ModelSolver01_06::calculateTheoreticalCurve(const QMap<QString, d
 // Stehfest 数值反演计算 PD 和导数
 void ModelSolver01_06::calculatePDandDeriv(const QVector<double>& tD, const QMap<QString, double>& params,
                                            std::function<double(double, const QMap<QString, double>&)> laplaceFunc,
-                                           QVector<double>& outPD, QVector<double>& outDeriv)
+                                           QVector<double>& outPD, QVector<double>& outDeriv, int maxTerms,
+                                           SolveControl* control)
 {
     int numPoints = tD.size();
     outPD.resize(numPoints);
     outDeriv.resize(numPoints);
+    if (control) control->total += numPoints;
 
     int N_param = (int)params.value("N", 4);
     int N = m_highPrecision ? N_param : 4;
     if (N % 2 != 0) N = 4;
+    if (maxTerms > 0 && N > maxTerms) N = maxTerms;
     double ln2 = log(2.0);
 
     double gamaD = params.value("gamaD", 0.0);
 
     for (int k = 0; k < numPoints; ++k) {
+        if (control) {
+            if (control->cancelled) { outPD.fill(0.0); outDeriv.fill(0.0); return; }
+            ++control->processed;
+        }
         double t = tD[k];
         if (t <= 1e-12) { outPD[k] = 0; continue; }
 
@@ -166,6 +305,11 @@ void ModelSolver01_06::calculatePDandDeriv(const QVector<double>& tD, const QMap
 
 // 拉普拉斯空间下的复合模型总函数 (包含井储和表皮)
 double ModelSolver01_06::flaplace_composite(double z, const QMap<QString, double>& p) {
+    return applyWellboreStorage(z, reservoirLaplace(z, p), p);
+}
+
+// 不含井储和表皮的储层拉普拉斯解
+double ModelSolver01_06::reservoirLaplace(double z, const QMap<QString, double>& p) {
     double kf = p.value("kf");
     double km = p.value("km");
     double LfD = p.value("LfD");
@@ -195,9 +339,11 @@ double ModelSolver01_06::flaplace_composite(double z, const QMap<QString, double
     double fs2 = M12 * temp;
 
     // 计算不含井储的拉普拉斯空间压力
-    double pf = PWD_composite(z, fs1, fs2, M12, LfD, rmD, reD, nf, xwD, m_type);
+    return PWD_composite(z, fs1, fs2, M12, LfD, rmD, reD, nf, xwD, m_type);
+}
 
-    // 加入井储和表皮效应
+// 加入井储和表皮效应
+double ModelSolver01_06::applyWellboreStorage(double z, double pf, const QMap<QString, double>& p) const {
     bool hasStorage = (m_type == Model_1 || m_type == Model_3 || m_type == Model_5);
     if (hasStorage) {
         double CD = p.value("cD", 0.0);
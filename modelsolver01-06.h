@@ -5,6 +5,10 @@
  * 1. 定义模型类型枚举 (ModelType) 和曲线数据类型 (ModelCurveData)。
  * 2. 声明纯数学计算逻辑，包括拉普拉斯变换、贝塞尔函数计算、Stehfest 数值反演等。
  * 3. 不依赖任何 UI 控件，仅负责数据输入与结果输出。
+ * 4. 支持分段恒定产量制度：单位产量响应在公共对数网格上只反演一次，再插值叠加。
+ * 5. 可选使用预计算的典型曲线图版 (TypeCurveAtlas) 代替逐点求解储层拉普拉斯解，用于快速预览。
+ * 6. 可传入 SolveControl 在工作线程中计算：逐个时间点上报进度，取消后尽快返回空结果。
+ * 7. 精度标志为原子变量，后台计算进行中切换精度不构成数据竞争 (新精度从下一次求解起生效)。
  */
 
 #ifndef MODELSOLVER01_06_H  // 修改点：将 - 改为 _
@@ -15,10 +19,26 @@
 #include <QString>
 #include <tuple>
 #include <functional>
+#include <atomic>
+#include "rateschedule.h"
 
 // 类型定义: <时间, 压力, 导数>
 using ModelCurveData = std::tuple<QVector<double>, QVector<double>, QVector<double>>;
 
+class TypeCurveAtlas;
+
+// 求解进度与取消控制 (工作线程写入进度，界面线程轮询并可置位取消)
+struct SolveControl {
+    std::atomic<bool> cancelled{false};
+    std::atomic<int> processed{0};      // 已反演的时间点数
+    std::atomic<int> total{0};          // 需反演的时间点数
+
+    int percent() const {
+        int t = total.load();
+        return t > 0 ? qMin(100, processed.load() * 100 / t) : 0;
+    }
+};
+
 class ModelSolver01_06
 {
 public:
@@ -40,7 +60,16 @@ public:
     void setHighPrecision(bool high);
 
     // 核心计算接口：根据参数和时间序列计算理论曲线
-    ModelCurveData calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>());
+    // schedule 非空时按变产量叠加：时间以分析段起点为零点 (历史阶梯时间为负)，
+    // 返回自段起点起的压力变化及其对 ln(Δt) 的导数，参数 q 不再使用
+    // atlas 非空且覆盖当前参数时按图版插值计算 (Stehfest 取 4 项)，否则按原方法求解
+    // control 非空时上报进度，被取消时返回空曲线
+    ModelCurveData calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>(),
+                                             const RateSchedule& schedule = RateSchedule(), const TypeCurveAtlas* atlas = nullptr,
+                                             SolveControl* control = nullptr);
+
+    // 不含井储和表皮的储层拉普拉斯解 (图版生成使用)
+    double reservoirLaplace(double z, const QMap<QString, double>& p);
 
     // 获取模型名称（静态辅助函数）
     static QString getModelName(ModelType type);
@@ -49,14 +78,27 @@ public:
     static QVector<double> generateLogTimeSteps(int count, double startExp, double endExp);
 
 private:
+    // 单位产量下的压差及导数 (物理量)
+    void calculateUnitResponse(const QVector<double>& tPoints, const QMap<QString, double>& params,
+                               QVector<double>& outDP, QVector<double>& outDeriv, const TypeCurveAtlas* atlas,
+                               SolveControl* control);
+
+    // 变产量叠加
+    ModelCurveData superposeRateSchedule(const QMap<QString, double>& params, const QVector<double>& tPoints,
+                                         const RateSchedule& schedule, const TypeCurveAtlas* atlas, SolveControl* control);
+
     // 计算无因次压力和导数
     void calculatePDandDeriv(const QVector<double>& tD, const QMap<QString, double>& params,
                              std::function<double(double, const QMap<QString, double>&)> laplaceFunc,
-                             QVector<double>& outPD, QVector<double>& outDeriv);
+                             QVector<double>& outPD, QVector<double>& outDeriv, int maxTerms = 0,
+                             SolveControl* control = nullptr);
 
     // 拉普拉斯空间下的复合模型函数
     double flaplace_composite(double z, const QMap<QString, double>& p);
 
+    // 在储层解上叠加井储和表皮效应 (仅变井储模型)
+    double applyWellboreStorage(double z, double pf, const QMap<QString, double>& p) const;
+
     // 计算点源解的拉普拉斯变换值
     double PWD_composite(double z, double fs1, double fs2, double M12, double LfD, double rmD, double reD, int nf, const QVector<double>& xwD, ModelType type);
 
@@ -69,7 +111,7 @@ private:
 
 private:
     ModelType m_type;       // 当前模型类型
-    bool m_highPrecision;   // 高精度计算标志
+    std::atomic<bool> m_highPrecision;   // 高精度计算标志 (界面线程修改，计算线程读取)
 };
 
 #endif // MODELSOLVER01_06_H  // 修改点：保持一致
@@ -6,6 +6,7 @@
 
 MouseZoom::MouseZoom(QWidget *parent)
     : QCustomPlot(parent)
+    , m_hitIndex(new PlotHitIndex(this))
 {
     setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iSelectItems);
     setContextMenuPolicy(Qt::CustomContextMenu);
@@ -38,54 +39,17 @@ void MouseZoom::wheelEvent(QWheelEvent *event)
     }
 }
 
-double MouseZoom::distToSegment(const QPointF& p, const QPointF& s, const QPointF& e)
-{
-    double l2 = (s.x()-e.x())*(s.x()-e.x()) + (s.y()-e.y())*(s.y()-e.y());
-    if (l2 == 0) return std::sqrt((p.x()-s.x())*(p.x()-s.x()) + (p.y()-s.y())*(p.y()-s.y()));
-    double t = ((p.x()-s.x())*(e.x()-s.x()) + (p.y()-s.y())*(e.y()-s.y())) / l2;
-    t = std::max(0.0, std::min(1.0, t));
-    QPointF proj = s + t * (e - s);
-    return std::sqrt((p.x()-proj.x())*(p.x()-proj.x()) + (p.y()-proj.y())*(p.y()-proj.y()));
-}
-
 void MouseZoom::onCustomContextMenuRequested(const QPoint &pos)
 {
     QMenu menu(this);
 
-    QCPAbstractItem* hitItem = nullptr;
-    QCPItemLine* hitLine = nullptr;
     QCPItemText* hitText = nullptr;
     double tolerance = 8.0;
     QPointF pMouse = pos;
 
-    // Check lines
-    for (int i = 0; i < itemCount(); ++i) {
-        if (auto line = qobject_cast<QCPItemLine*>(item(i))) {
-            if (line->property("isCharacteristic").isValid()) {
-                double x1 = xAxis->coordToPixel(line->start->coords().x());
-                double y1 = yAxis->coordToPixel(line->start->coords().y());
-                double x2 = xAxis->coordToPixel(line->end->coords().x());
-                double y2 = yAxis->coordToPixel(line->end->coords().y());
-                if (distToSegment(pMouse, QPointF(x1, y1), QPointF(x2, y2)) < tolerance) {
-                    hitLine = line;
-                    hitItem = line;
-                    break;
-                }
-            }
-        }
-    }
-    // Check text
-    if (!hitItem) {
-        for (int i = 0; i < itemCount(); ++i) {
-            if (auto text = qobject_cast<QCPItemText*>(item(i))) {
-                if (text->selectTest(pMouse, false) < tolerance) {
-                    hitText = text;
-                    hitItem = text;
-                    break;
-                }
-            }
-        }
-    }
+    // Check lines, then text
+    QCPItemLine* hitLine = m_hitIndex->lineAt(pMouse, tolerance, true);
+    if (!hitLine) hitText = m_hitIndex->textAt(pMouse, tolerance);
 
     if (hitLine) {
         deselectAll();
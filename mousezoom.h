@@ -2,6 +2,7 @@
 #define MOUSEZOOM_H
 
 #include "qcustomplot.h"
+#include "plothitindex.h"
 
 class MouseZoom : public QCustomPlot
 {
@@ -11,6 +12,9 @@ public:
     explicit MouseZoom(QWidget *parent = nullptr);
     ~MouseZoom();
 
+    // 图元与数据点命中测试索引 (惰性重建)
+    PlotHitIndex* hitIndex() const { return m_hitIndex; }
+
 signals:
     void saveImageRequested();
     void exportDataRequested();
@@ -29,7 +33,7 @@ private slots:
     void onCustomContextMenuRequested(const QPoint &pos);
 
 private:
-    double distToSegment(const QPointF& p, const QPointF& s, const QPointF& e);
+    PlotHitIndex* m_hitIndex;
 };
 
 #endif // MOUSEZOOM_H
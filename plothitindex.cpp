@@ -0,0 +1,288 @@
+/*
+ * 文件名: plothitindex.cpp
+ * 文件作用: 图表命中测试空间索引实现文件
+ * 功能描述:
+ * 1. 网格按两遍扫描构建：先统计每个单元的条目数得到起始偏移，再填入条目编号，构建 O(n)。
+ * 2. 图元按像素包围盒登记到所有相交单元；数据点只登记到所在单元。
+ * 3. 视图指纹包含各坐标轴范围/类型、绘图区几何，数据点指纹另含各曲线的点数和首、中、尾点。
+ */
+
+#include "plothitindex.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+const double kItemCellSize = 32.0;
+const double kPointCellSize = 16.0;
+}
+
+// ============================================================================
+// Grid
+// ============================================================================
+
+bool PlotHitIndex::Grid::cellRange(const QRectF& box, int& c0, int& r0, int& c1, int& r1) const
+{
+    if (m_cols <= 0 || m_rows <= 0) return false;
+    if (box.right() < m_area.left() || box.left() > m_area.right() ||
+        box.bottom() < m_area.top() || box.top() > m_area.bottom()) return false;
+
+    c0 = qBound(0, int(std::floor((box.left() - m_area.left()) / m_cellSize)), m_cols - 1);
+    c1 = qBound(0, int(std::floor((box.right() - m_area.left()) / m_cellSize)), m_cols - 1);
+    r0 = qBound(0, int(std::floor((box.top() - m_area.top()) / m_cellSize)), m_rows - 1);
+    r1 = qBound(0, int(std::floor((box.bottom() - m_area.top()) / m_cellSize)), m_rows - 1);
+    return true;
+}
+
+void PlotHitIndex::Grid::build(const QRectF& area, double cellSize, const QVector<QRectF>& bounds)
+{
+    m_area = area;
+    m_cellSize = cellSize;
+    m_cols = qMax(1, int(std::ceil(area.width() / cellSize)));
+    m_rows = qMax(1, int(std::ceil(area.height() / cellSize)));
+    m_cellStart.fill(0, m_cols * m_rows + 1);
+    m_ids.clear();
+
+    // 1. 统计各单元条目数
+    int c0, r0, c1, r1;
+    for (const QRectF& b : bounds) {
+        if (!cellRange(b, c0, r0, c1, r1)) continue;
+        for (int r = r0; r <= r1; ++r)
+            for (int c = c0; c <= c1; ++c) ++m_cellStart[r * m_cols + c + 1];
+    }
+    for (int i = 1; i < m_cellStart.size(); ++i) m_cellStart[i] += m_cellStart[i - 1];
+
+    // 2. 填入条目编号
+    m_ids.resize(m_cellStart.last());
+    QVector<int> fill(m_cellStart.constBegin(), m_cellStart.constEnd() - 1);
+    for (int id = 0; id < bounds.size(); ++id) {
+        if (!cellRange(bounds[id], c0, r0, c1, r1)) continue;
+        for (int r = r0; r <= r1; ++r)
+            for (int c = c0; c <= c1; ++c) m_ids[fill[r * m_cols + c]++] = id;
+    }
+}
+
+template <typename Visitor>
+void PlotHitIndex::Grid::visit(const QRectF& box, Visitor visitor) const
+{
+    int c0, r0, c1, r1;
+    if (!cellRange(box, c0, r0, c1, r1)) return;
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            const int cell = r * m_cols + c;
+            for (int k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k) visitor(m_ids[k]);
+        }
+    }
+}
+
+// ============================================================================
+// PlotHitIndex
+// ============================================================================
+
+PlotHitIndex::PlotHitIndex(QCustomPlot* plot)
+    : QObject(plot)
+    , m_plot(plot)
+    , m_itemsDirty(true)
+    , m_itemCount(-1)
+    , m_pointsDirty(true)
+{
+}
+
+double PlotHitIndex::distToSegment(const QPointF& p, const QPointF& s, const QPointF& e)
+{
+    double l2 = (s.x()-e.x())*(s.x()-e.x()) + (s.y()-e.y())*(s.y()-e.y());
+    if (l2 == 0) return std::sqrt((p.x()-s.x())*(p.x()-s.x()) + (p.y()-s.y())*(p.y()-s.y()));
+    double t = ((p.x()-s.x())*(e.x()-s.x()) + (p.y()-s.y())*(e.y()-s.y())) / l2;
+    t = std::max(0.0, std::min(1.0, t));
+    QPointF proj = s + t * (e - s);
+    return std::sqrt((p.x()-proj.x())*(p.x()-proj.x()) + (p.y()-proj.y())*(p.y()-proj.y()));
+}
+
+void PlotHitIndex::invalidateItems()
+{
+    m_itemsDirty = true;
+}
+
+void PlotHitIndex::invalidatePoints()
+{
+    m_pointsDirty = true;
+}
+
+QVector<double> PlotHitIndex::viewKey(bool withData) const
+{
+    QVector<double> key;
+    const QRect viewport = m_plot->viewport();
+    key << viewport.x() << viewport.y() << viewport.width() << viewport.height();
+    for (QCPAxisRect* rect : m_plot->axisRects()) {
+        const QRect r = rect->rect();
+        key << r.x() << r.y() << r.width() << r.height();
+        for (QCPAxis* axis : rect->axes()) {
+            key << axis->range().lower << axis->range().upper
+                << int(axis->scaleType()) << int(axis->rangeReversed());
+        }
+    }
+    if (!withData) return key;
+
+    for (int g = 0; g < m_plot->graphCount(); ++g) {
+        QCPGraph* graph = m_plot->graph(g);
+        const QSharedPointer<QCPGraphDataContainer> data = graph->data();
+        key << double(quintptr(graph)) << int(graph->visible()) << data->size();
+        if (data->isEmpty()) continue;
+        const int n = data->size();
+        for (int i : { 0, n / 2, n - 1 }) {
+            const QCPGraphData& p = *(data->constBegin() + i);
+            key << p.key << p.value;
+        }
+    }
+    return key;
+}
+
+void PlotHitIndex::ensureItems()
+{
+    const QVector<double> key = viewKey(false);
+    if (!m_itemsDirty && m_itemCount == m_plot->itemCount() && key == m_itemViewKey) return;
+
+    m_items.clear();
+    QVector<QRectF> bounds;
+    for (int i = 0; i < m_plot->itemCount(); ++i) {
+        QCPAbstractItem* item = m_plot->item(i);
+        connect(item, &QObject::destroyed, this, &PlotHitIndex::invalidateItems, Qt::UniqueConnection);
+
+        ItemEntry entry;
+        entry.item = item;
+        QRectF box;
+        if (auto text = qobject_cast<QCPItemText*>(item)) {
+            // 四角取包围盒，兼容旋转文字
+            entry.kind = Kind_Text;
+            QPolygonF corners;
+            corners << text->topLeft->pixelPosition() << text->topRight->pixelPosition()
+                    << text->bottomRight->pixelPosition() << text->bottomLeft->pixelPosition();
+            box = corners.boundingRect();
+        } else if (auto line = qobject_cast<QCPItemLine*>(item)) {
+            entry.kind = line->property("isCharacteristic").isValid() ? Kind_Characteristic : Kind_Arrow;
+            entry.start = line->start->pixelPosition();
+            entry.end = line->end->pixelPosition();
+            box = QRectF(entry.start, entry.end).normalized();
+        } else {
+            continue;
+        }
+        m_items.append(entry);
+        bounds.append(box);
+    }
+
+    m_itemGrid.build(QRectF(m_plot->viewport()), kItemCellSize, bounds);
+    m_itemCount = m_plot->itemCount();
+    m_itemViewKey = key;
+    m_itemsDirty = false;
+}
+
+void PlotHitIndex::ensurePoints()
+{
+    const QVector<double> key = viewKey(true);
+    if (!m_pointsDirty && key == m_pointViewKey) return;
+
+    m_points.clear();
+    QVector<QRectF> bounds;
+    for (int g = 0; g < m_plot->graphCount(); ++g) {
+        QCPGraph* graph = m_plot->graph(g);
+        QCPAxis* keyAxis = graph->keyAxis();
+        if (!graph->visible() || !keyAxis || !graph->valueAxis()) continue;
+
+        const QRectF clip = keyAxis->axisRect()->rect();
+        const QSharedPointer<QCPGraphDataContainer> data = graph->data();
+        const QCPGraphDataContainer::const_iterator first = data->constBegin();
+        const QCPGraphDataContainer::const_iterator begin = data->findBegin(keyAxis->range().lower);
+        const QCPGraphDataContainer::const_iterator end = data->findEnd(keyAxis->range().upper);
+
+        // 按 key 排序的相邻点常落在同一像素，只保留第一个
+        qint64 lastPixel = std::numeric_limits<qint64>::min();
+        for (QCPGraphDataContainer::const_iterator it = begin; it != end; ++it) {
+            if (!std::isfinite(it->key) || !std::isfinite(it->value)) continue;
+            const QPointF p = graph->coordsToPixels(it->key, it->value);
+            if (!clip.contains(p)) continue;
+            const qint64 pixel = (qint64(std::floor(p.x())) << 32) ^ qint64(quint32(int(std::floor(p.y()))));
+            if (pixel == lastPixel) continue;
+            lastPixel = pixel;
+
+            PointEntry entry;
+            entry.graph = graph;
+            entry.index = int(it - first);
+            entry.pos = p;
+            m_points.append(entry);
+            bounds.append(QRectF(p, QSizeF(0, 0)));
+        }
+    }
+
+    m_pointGrid.build(QRectF(m_plot->viewport()), kPointCellSize, bounds);
+    m_pointViewKey = key;
+    m_pointsDirty = false;
+}
+
+QCPItemText* PlotHitIndex::textAt(const QPointF& pos, double tolerance)
+{
+    ensureItems();
+    QCPItemText* best = nullptr;
+    double bestDist = tolerance;
+    const QRectF box(pos.x() - tolerance, pos.y() - tolerance, 2 * tolerance, 2 * tolerance);
+    m_itemGrid.visit(box, [&](int id) {
+        const ItemEntry& entry = m_items[id];
+        if (entry.kind != Kind_Text) return;
+        QCPItemText* text = static_cast<QCPItemText*>(entry.item);
+        const double d = text->selectTest(pos, false);
+        if (d >= 0 && d < bestDist) {
+            bestDist = d;
+            best = text;
+        }
+    });
+    return best;
+}
+
+QCPItemLine* PlotHitIndex::lineAt(const QPointF& pos, double tolerance, bool characteristic, LinePart* part)
+{
+    ensureItems();
+    if (part) *part = Part_None;
+
+    QCPItemLine* best = nullptr;
+    double bestDist = tolerance;
+    LinePart bestPart = Part_None;
+    const QRectF box(pos.x() - tolerance, pos.y() - tolerance, 2 * tolerance, 2 * tolerance);
+    m_itemGrid.visit(box, [&](int id) {
+        const ItemEntry& entry = m_items[id];
+        if (entry.kind != (characteristic ? Kind_Characteristic : Kind_Arrow)) return;
+
+        const double dStart = std::hypot(pos.x() - entry.start.x(), pos.y() - entry.start.y());
+        const double dEnd = std::hypot(pos.x() - entry.end.x(), pos.y() - entry.end.y());
+        const double d = characteristic ? distToSegment(pos, entry.start, entry.end) : qMin(dStart, dEnd);
+        if (d >= bestDist) return;
+
+        bestDist = d;
+        best = static_cast<QCPItemLine*>(entry.item);
+        if (dStart < tolerance) bestPart = Part_Start;
+        else if (dEnd < tolerance) bestPart = Part_End;
+        else bestPart = Part_Segment;
+    });
+
+    if (part) *part = bestPart;
+    return best;
+}
+
+bool PlotHitIndex::pointAt(const QPointF& pos, double tolerance, QCPGraph** graph, int* dataIndex)
+{
+    ensurePoints();
+    int best = -1;
+    double bestDist = tolerance;
+    const QRectF box(pos.x() - tolerance, pos.y() - tolerance, 2 * tolerance, 2 * tolerance);
+    m_pointGrid.visit(box, [&](int id) {
+        const QPointF& p = m_points[id].pos;
+        const double d = std::hypot(pos.x() - p.x(), pos.y() - p.y());
+        if (d < bestDist) {
+            bestDist = d;
+            best = id;
+        }
+    });
+
+    if (best < 0) return false;
+    if (graph) *graph = m_points[best].graph;
+    if (dataIndex) *dataIndex = m_points[best].index;
+    return true;
+}
@@ -0,0 +1,101 @@
+/*
+ * 文件名: plothitindex.h
+ * 文件作用: 图表命中测试空间索引头文件
+ * 功能描述:
+ * 1. 在像素空间建立均匀网格 (CSR 紧凑存储)，分别索引标注图元 (文字、特征标识线、箭头) 和曲线数据点。
+ * 2. 查询只检查容差框覆盖的网格单元，再对候选做精确距离计算，耗时与图元数、数据点数基本无关。
+ * 3. 惰性重建：坐标轴范围、绘图区几何、图元数量或曲线数据变化后，在下一次查询时才重建；
+ *    图元被拖动或修改文字后由调用方 invalidateItems()。
+ * 4. 数据点按像素去重 (同一曲线落在同一像素的相邻点只保留一个)，大数据量曲线的网格规模受屏幕大小限制。
+ */
+
+#ifndef PLOTHITINDEX_H
+#define PLOTHITINDEX_H
+
+#include <QObject>
+#include <QRectF>
+#include <QVector>
+#include "qcustomplot.h"
+
+class PlotHitIndex : public QObject
+{
+    Q_OBJECT
+public:
+    // 直线图元的命中部位
+    enum LinePart {
+        Part_None = 0,
+        Part_Start,
+        Part_End,
+        Part_Segment
+    };
+
+    explicit PlotHitIndex(QCustomPlot* plot);
+
+    // 距 pos 最近且在容差内的文字标注
+    QCPItemText* textAt(const QPointF& pos, double tolerance);
+    // characteristic 为 true 时查特征标识线 (线段上任一点可命中，端点优先)，否则查箭头 (只有端点可命中)
+    QCPItemLine* lineAt(const QPointF& pos, double tolerance, bool characteristic, LinePart* part = nullptr);
+    // 距 pos 最近的可见曲线数据点，dataIndex 为该点在 graph->data() 中的下标
+    bool pointAt(const QPointF& pos, double tolerance, QCPGraph** graph, int* dataIndex);
+
+    static double distToSegment(const QPointF& p, const QPointF& s, const QPointF& e);
+
+public slots:
+    // 图元位置、文字变化后调用
+    void invalidateItems();
+    // 曲线数据原位修改 (点数不变) 后调用
+    void invalidatePoints();
+
+private:
+    // 像素空间均匀网格：每个单元记录与其相交的条目编号
+    class Grid
+    {
+    public:
+        void build(const QRectF& area, double cellSize, const QVector<QRectF>& bounds);
+        template <typename Visitor> void visit(const QRectF& box, Visitor visitor) const;
+
+    private:
+        bool cellRange(const QRectF& box, int& c0, int& r0, int& c1, int& r1) const;
+
+        QRectF m_area;
+        double m_cellSize = 1.0;
+        int m_cols = 0;
+        int m_rows = 0;
+        QVector<int> m_cellStart; // 大小 cols*rows+1
+        QVector<int> m_ids;
+    };
+
+    enum ItemKind { Kind_Text, Kind_Characteristic, Kind_Arrow };
+
+    struct ItemEntry {
+        QCPAbstractItem* item = nullptr;
+        ItemKind kind = Kind_Text;
+        QPointF start;
+        QPointF end;
+    };
+
+    struct PointEntry {
+        QCPGraph* graph = nullptr;
+        int index = 0;
+        QPointF pos;
+    };
+
+    QVector<double> viewKey(bool withData) const;
+    void ensureItems();
+    void ensurePoints();
+
+    QCustomPlot* m_plot;
+
+    QVector<ItemEntry> m_items;
+    Grid m_itemGrid;
+    bool m_itemsDirty;
+    int m_itemCount;
+    QVector<double> m_itemViewKey;
+
+    QVector<PointEntry> m_points;
+    Grid m_pointGrid;
+    bool m_pointsDirty;
+    QVector<double> m_pointViewKey;
+};
+
+#endif // PLOTHITINDEX_H
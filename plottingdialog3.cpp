@@ -5,6 +5,7 @@
  * 1. 实现了对话框的初始化，设置默认值为标准的双对数曲线配置（压差 & 导数）。
  * 2. 实现了试井类型（降落/恢复）的逻辑切换。
  * 3. 提供了从UI控件获取试井参数（Pi, TestType）的具体实现。
+ * 4. 流动段识别：选中某一段后自动切换试井类型，降落段填入开井前压力作为 Pi。
  */
 
 #include "plottingdialog3.h"
@@ -56,7 +57,19 @@ PlottingDialog3::PlottingDialog3(QStandardItemModel* model, QWidget *parent) :
     connect(ui->radioBuildup, &QRadioButton::toggled, this, &PlottingDialog3::onTestTypeChanged);
     onTestTypeChanged(); // 初始化状态
 
-    // 3. 颜色按钮点击信号
+    // 3. 流动段选择 (数据与计算分组最后一行)
+    m_periodSelector = new FlowPeriodSelector(this);
+    m_periodSelector->setModel(m_dataModel);
+    ui->gridLayout->addWidget(m_periodSelector, 6, 0, 1, 2);
+    auto syncPeriodColumns = [this]() {
+        m_periodSelector->setColumns(ui->comboTime->currentIndex(), ui->comboPress->currentIndex());
+    };
+    syncPeriodColumns();
+    connect(ui->comboTime, QOverload<int>::of(&QComboBox::currentIndexChanged), this, syncPeriodColumns);
+    connect(ui->comboPress, QOverload<int>::of(&QComboBox::currentIndexChanged), this, syncPeriodColumns);
+    connect(m_periodSelector, &FlowPeriodSelector::periodSelected, this, &PlottingDialog3::onFlowPeriodSelected);
+
+    // 4. 颜色按钮点击信号
     connect(ui->btnPressPointColor, &QPushButton::clicked, this, &PlottingDialog3::selectPressPointColor);
     connect(ui->btnPressLineColor, &QPushButton::clicked, this, &PlottingDialog3::selectPressLineColor);
     connect(ui->btnDerivPointColor, &QPushButton::clicked, this, &PlottingDialog3::selectDerivPointColor);
@@ -193,3 +206,17 @@ Qt::PenStyle PlottingDialog3::getDerivLineStyle() const { return (Qt::PenStyle)u
 QColor PlottingDialog3::getDerivLineColor() const { return m_derivLineColor; }
 
 bool PlottingDialog3::isNewWindow() const { return ui->checkNewWindow->isChecked(); }
+
+bool PlottingDialog3::hasFlowPeriod() const { return m_periodSelector->hasSelection(); }
+FlowPeriod PlottingDialog3::getFlowPeriod() const { return m_periodSelector->selectedPeriod(); }
+
+// 选中流动段：恢复段切换为压力恢复，降落段以开井前压力作为 Pi
+void PlottingDialog3::onFlowPeriodSelected(const FlowPeriod& period)
+{
+    if (period.type == FlowPeriodType::Buildup) {
+        ui->radioBuildup->setChecked(true);
+    } else {
+        ui->radioDrawdown->setChecked(true);
+        ui->spinPi->setValue(period.startPressure);
+    }
+}
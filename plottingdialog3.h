@@ -5,6 +5,7 @@
  * 1. 声明了用于配置曲线样式的对话框类。
  * 2. 提供获取用户设置（如试井类型、地层压力、曲线名称、图例、L-Spacing等）的接口。
  * 3. 管理界面交互逻辑，如颜色选择、试井类型切换带来的输入框状态变化等。
+ * 4. 可自动识别流动段，只对所选的一段开井/关井数据作双对数分析。
  */
 
 #ifndef PLOTTINGDIALOG3_H
@@ -14,6 +15,7 @@
 #include <QStandardItemModel>
 #include <QColor>
 #include "qcustomplot.h"
+#include "flowperiodsegmenter.h"
 
 namespace Ui {
 class PlottingDialog3;
@@ -48,6 +50,10 @@ public:
     TestType getTestType() const;       // 获取试井类型（降落/恢复）
     double getInitialPressure() const;  // 获取地层初始压力 (仅降落试井有效)
 
+    // --- 流动段接口 ---
+    bool hasFlowPeriod() const;         // 是否选定了某一流动段
+    FlowPeriod getFlowPeriod() const;   // 获取所选流动段 (行范围、起点时间与压力)
+
     // --- 计算参数接口 ---
     double getLSpacing() const;         // 获取导数计算步长 L-Spacing
     bool isSmoothEnabled() const;       // 获取是否启用平滑处理
@@ -80,6 +86,9 @@ private slots:
     // 用于控制地层压力输入框的启用/禁用
     void onTestTypeChanged();
 
+    // 槽函数：选中流动段后同步试井类型与初始压力
+    void onFlowPeriodSelected(const FlowPeriod& period);
+
     // 槽函数：响应各颜色选择按钮的点击事件
     void selectPressPointColor();
     void selectPressLineColor();
@@ -89,6 +98,7 @@ private slots:
 private:
     Ui::PlottingDialog3 *ui;
     QStandardItemModel* m_dataModel; // 指向数据源模型的指针
+    FlowPeriodSelector* m_periodSelector; // 流动段选择
     static int s_counter;            // 静态计数器，用于生成默认的曲线名称
 
     // 内部成员变量：存储当前选择的颜色
@@ -5,6 +5,7 @@
  */
 
 #include "pressurederivativecalculator1.h"
+#include "datafilter.h"
 #include <QtMath>
 #include <QDebug>
 
@@ -90,33 +91,6 @@ PressureDerivativeResult PressureDerivativeCalculator1::calculateSmoothedDerivat
 
 QVector<double> PressureDerivativeCalculator1::smoothData(const QVector<double>& data, int span)
 {
-    int n = data.size();
-    if (n == 0) return QVector<double>();
-    if (span <= 1) return data;
-
-    // 确保span是奇数
-    if (span % 2 == 0) span++;
-
-    QVector<double> result(n);
-    int halfSpan = (span - 1) / 2;
-
-    for (int i = 0; i < n; ++i) {
-        double sum = 0;
-        int count = 0;
-
-        // 简单的移动平均，边缘处窗口自动缩小（类似Matlab默认行为）
-        int start = qMax(0, i - halfSpan);
-        int end = qMin(n - 1, i + halfSpan);
-
-        for (int j = start; j <= end; ++j) {
-            sum += data[j];
-            count++;
-        }
-
-        if (count > 0)
-            result[i] = sum / count;
-        else
-            result[i] = data[i];
-    }
-    return result;
+    // 移动平均，边缘处窗口自动缩小；滑动窗口增量求和，耗时与窗口大小无关
+    return DataFilter::movingAverage(data, span);
 }
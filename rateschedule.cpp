@@ -0,0 +1,83 @@
+/*
+ * 文件名: rateschedule.cpp
+ * 文件作用: 分段恒定产量制度实现文件
+ * 功能描述:
+ * 1. 构造时丢弃非有限值并合并相邻同产量阶梯，保证阶梯数等于真实的变产次数。
+ * 2. rateAt 在阶梯起始时间上二分查找，复杂度 O(log n)。
+ */
+
+#include "rateschedule.h"
+#include <QJsonArray>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+void RateSchedule::addStep(double startTime, double rate)
+{
+    if (!std::isfinite(startTime) || !std::isfinite(rate)) return;
+    if (!m_startTimes.isEmpty()) {
+        if (startTime < m_startTimes.last()) return;
+        if (rate == m_rates.last()) return; // 产量未变，沿用上一阶梯
+        if (startTime == m_startTimes.last()) { m_rates.last() = rate; return; }
+    }
+    m_startTimes.append(startTime);
+    m_rates.append(rate);
+}
+
+RateSchedule RateSchedule::fromDurations(const QVector<double>& durations, const QVector<double>& rates)
+{
+    RateSchedule s;
+    double t = 0.0;
+    const int n = qMin(durations.size(), rates.size());
+    for (int i = 0; i < n; ++i) {
+        s.addStep(t, rates[i]);
+        if (std::isfinite(durations[i]) && durations[i] > 0) t += durations[i];
+    }
+    return s;
+}
+
+RateSchedule RateSchedule::fromSamples(const QVector<double>& times, const QVector<double>& rates)
+{
+    const int n = qMin(times.size(), rates.size());
+    QVector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return times[a] < times[b]; });
+
+    RateSchedule s;
+    for (int i : order) s.addStep(times[i], rates[i]);
+    return s;
+}
+
+double RateSchedule::rateAt(double t) const
+{
+    auto it = std::upper_bound(m_startTimes.constBegin(), m_startTimes.constEnd(), t);
+    if (it == m_startTimes.constBegin()) return 0.0;
+    return m_rates[int(it - m_startTimes.constBegin()) - 1];
+}
+
+RateSchedule RateSchedule::shifted(double dt) const
+{
+    RateSchedule s = *this;
+    for (double& t : s.m_startTimes) t += dt;
+    return s;
+}
+
+QJsonObject RateSchedule::toJson() const
+{
+    QJsonArray tArr, qArr;
+    for (double v : m_startTimes) tArr.append(v);
+    for (double v : m_rates) qArr.append(v);
+    QJsonObject obj;
+    obj["startTimes"] = tArr;
+    obj["rates"] = qArr;
+    return obj;
+}
+
+RateSchedule RateSchedule::fromJson(const QJsonObject& json)
+{
+    RateSchedule s;
+    QJsonArray tArr = json["startTimes"].toArray();
+    QJsonArray qArr = json["rates"].toArray();
+    for (int i = 0; i < qMin(tArr.size(), qArr.size()); ++i) s.addStep(tArr[i].toDouble(), qArr[i].toDouble());
+    return s;
+}
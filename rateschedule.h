@@ -0,0 +1,49 @@
+/*
+ * 文件名: rateschedule.h
+ * 文件作用: 分段恒定产量制度头文件
+ * 功能描述:
+ * 1. 以 (起始时间, 产量) 阶梯描述变产量历史，时间升序，最后一段一直延续。
+ * 2. 可由 "时长+产量" 表 (阶梯图) 或 "时间+产量" 采样 (散点图) 构造，相邻同产量合并。
+ * 3. rateAt 二分查找任一时刻的产量，供导出与叠加计算使用。
+ * 4. 支持 JSON 序列化，随拟合状态一起保存。
+ */
+
+#ifndef RATESCHEDULE_H
+#define RATESCHEDULE_H
+
+#include <QVector>
+#include <QJsonObject>
+
+class RateSchedule
+{
+public:
+    RateSchedule() = default;
+
+    // 追加一个阶梯：startTime 起产量为 rate (startTime 须不小于上一阶梯)
+    void addStep(double startTime, double rate);
+
+    // durations[i] 为第 i 段持续时间，产量为 rates[i]，首段从 t = 0 开始
+    static RateSchedule fromDurations(const QVector<double>& durations, const QVector<double>& rates);
+    // 按采样点构造：每个采样的产量一直保持到下一个采样时刻
+    static RateSchedule fromSamples(const QVector<double>& times, const QVector<double>& rates);
+
+    bool isEmpty() const { return m_startTimes.isEmpty(); }
+    int size() const { return m_startTimes.size(); }
+    double startTime(int i) const { return m_startTimes[i]; }
+    double rate(int i) const { return m_rates[i]; }
+
+    // t 时刻的产量，首个阶梯之前为 0
+    double rateAt(double t) const;
+
+    // 所有时间平移 dt (例如以某一流动段起点为零点)
+    RateSchedule shifted(double dt) const;
+
+    QJsonObject toJson() const;
+    static RateSchedule fromJson(const QJsonObject& json);
+
+private:
+    QVector<double> m_startTimes;
+    QVector<double> m_rates;
+};
+
+#endif // RATESCHEDULE_H
@@ -0,0 +1,331 @@
+/*
+ * 文件名: reportwriter.cpp
+ * 文件作用: 分析报告生成 (图像渲染、编码与文档写出) 实现文件
+ * 功能描述:
+ * 1. 指纹覆盖输出尺寸、坐标轴 (范围/类型/标签/画笔)、标题文字、图例、各曲线的样式与数据、标注图元；
+ *    出现无法识别的绘图对象时不生成指纹，该图每次重新渲染。
+ * 2. 缓存存放 base64 后的 PNG，按千字节计容量，上限 64 MB。
+ * 3. 图像编码放在写文件之前统一并行完成，写文件时按 16 KB 缓冲逐段落盘。
+ * 4. 指纹同时覆盖网格画笔 (主/次网格、零线)、刻度设置 (刻度器类型与步长、刻度长度与画笔、
+ *    刻度标签字体/颜色/数字格式)、图例内容与字体、坐标区背景，仅改样式也会重新渲染。
+ */
+
+#include "reportwriter.h"
+#include "qcustomplot.h"
+
+#include <QBuffer>
+#include <QCache>
+#include <QCryptographicHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QtConcurrent>
+#include <typeinfo>
+
+namespace {
+
+const int kCacheCostKB = 64 * 1024;
+
+QMutex& cacheMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+QCache<QByteArray, QByteArray>& figureCache()
+{
+    static QCache<QByteArray, QByteArray> cache(kCacheCostKB);
+    return cache;
+}
+
+void addNumber(QCryptographicHash& hash, double value)
+{
+    hash.addData(QByteArray::fromRawData(reinterpret_cast<const char*>(&value), sizeof(value)));
+}
+
+void addString(QCryptographicHash& hash, const QString& text)
+{
+    hash.addData(text.toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+}
+
+void addPen(QCryptographicHash& hash, const QPen& pen)
+{
+    addNumber(hash, pen.color().rgba());
+    addNumber(hash, pen.widthF());
+    addNumber(hash, int(pen.style()));
+}
+
+void addBrush(QCryptographicHash& hash, const QBrush& brush)
+{
+    addNumber(hash, brush.color().rgba());
+    addNumber(hash, int(brush.style()));
+    addNumber(hash, brush.style() == Qt::TexturePattern ? double(brush.texture().cacheKey()) : 0.0);
+}
+
+void addTicker(QCryptographicHash& hash, const QSharedPointer<QCPAxisTicker>& ticker)
+{
+    if (!ticker) {
+        addNumber(hash, 0);
+        return;
+    }
+    addString(hash, QString::fromLatin1(typeid(*ticker).name()));
+    addNumber(hash, ticker->tickCount());
+    addNumber(hash, ticker->tickOrigin());
+    addNumber(hash, int(ticker->tickStepStrategy()));
+    if (auto log = ticker.dynamicCast<QCPAxisTickerLog>())
+        addNumber(hash, log->logBase());
+    else if (auto fixed = ticker.dynamicCast<QCPAxisTickerFixed>())
+        addNumber(hash, fixed->tickStep());
+}
+
+void addAxis(QCryptographicHash& hash, QCPAxis* axis)
+{
+    addNumber(hash, axis->visible());
+    addNumber(hash, axis->range().lower);
+    addNumber(hash, axis->range().upper);
+    addNumber(hash, axis->rangeReversed());
+    addNumber(hash, int(axis->scaleType()));
+    addString(hash, axis->label());
+    addString(hash, axis->labelFont().toString());
+    addNumber(hash, axis->labelColor().rgba());
+    addNumber(hash, axis->labelPadding());
+    addPen(hash, axis->basePen());
+
+    // 刻度与刻度标签
+    addTicker(hash, axis->ticker());
+    addNumber(hash, axis->ticks());
+    addNumber(hash, axis->subTicks());
+    addNumber(hash, axis->tickLengthIn());
+    addNumber(hash, axis->tickLengthOut());
+    addNumber(hash, axis->subTickLengthIn());
+    addNumber(hash, axis->subTickLengthOut());
+    addPen(hash, axis->tickPen());
+    addPen(hash, axis->subTickPen());
+    addNumber(hash, axis->tickLabels());
+    addString(hash, axis->tickLabelFont().toString());
+    addNumber(hash, axis->tickLabelColor().rgba());
+    addNumber(hash, axis->tickLabelRotation());
+    addNumber(hash, axis->tickLabelPadding());
+    addNumber(hash, int(axis->tickLabelSide()));
+    addString(hash, axis->numberFormat());
+    addNumber(hash, axis->numberPrecision());
+
+    // 网格
+    QCPGrid* grid = axis->grid();
+    addNumber(hash, grid->visible());
+    addNumber(hash, grid->subGridVisible());
+    addNumber(hash, grid->antialiasedSubGrid());
+    addNumber(hash, grid->antialiasedZeroLine());
+    addPen(hash, grid->pen());
+    addPen(hash, grid->subGridPen());
+    addPen(hash, grid->zeroLinePen());
+}
+
+void addLegend(QCryptographicHash& hash, QCPLegend* legend)
+{
+    addNumber(hash, legend->visible());
+    addString(hash, legend->font().toString());
+    addNumber(hash, legend->textColor().rgba());
+    addPen(hash, legend->borderPen());
+    addBrush(hash, legend->brush());
+    addNumber(hash, legend->iconSize().width());
+    addNumber(hash, legend->iconSize().height());
+    addNumber(hash, legend->iconTextPadding());
+    addNumber(hash, legend->rowCount());
+    addNumber(hash, legend->columnCount());
+    if (auto inset = qobject_cast<QCPLayoutInset*>(legend->layout())) {
+        const int index = inset->elements(false).indexOf(legend);
+        if (index >= 0)
+            addNumber(hash, int(inset->insetAlignment(index)));
+    }
+
+    addNumber(hash, legend->itemCount());
+    for (int i = 0; i < legend->itemCount(); ++i) {
+        QCPAbstractLegendItem* item = legend->item(i);
+        if (!item) continue;
+        addNumber(hash, item->visible());
+        addString(hash, item->font().toString());
+        addNumber(hash, item->textColor().rgba());
+        if (auto plottableItem = qobject_cast<QCPPlottableLegendItem*>(item))
+            addString(hash, plottableItem->plottable()->name());
+    }
+}
+
+} // namespace
+
+void ReportDocument::appendHtml(const QString& html)
+{
+    // 相邻的文本片段合并，减少写出时的片段数
+    if (!parts.isEmpty() && parts.last().figure < 0) {
+        parts.last().html += html;
+        return;
+    }
+    Part part;
+    part.html = html;
+    parts.append(part);
+}
+
+void ReportDocument::appendFigure(const ReportFigure& figure)
+{
+    Part part;
+    part.figure = figures.size();
+    figures.append(figure);
+    parts.append(part);
+}
+
+QByteArray ReportWriter::plotFingerprint(QCustomPlot* plot, int width, int height)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    addNumber(hash, width);
+    addNumber(hash, height);
+    addNumber(hash, plot->background().isNull() ? 0.0 : double(plot->background().cacheKey()));
+
+    // 1. 布局元素：坐标轴、网格、刻度、标题与图例
+    for (QCPLayoutElement* element : plot->plotLayout()->elements(true)) {
+        if (!element) continue;
+        if (auto text = qobject_cast<QCPTextElement*>(element)) {
+            addString(hash, text->text());
+            addString(hash, text->font().toString());
+            addNumber(hash, text->textColor().rgba());
+        } else if (auto rect = qobject_cast<QCPAxisRect*>(element)) {
+            addBrush(hash, rect->backgroundBrush());
+            addNumber(hash, rect->background().isNull() ? 0.0 : double(rect->background().cacheKey()));
+            addNumber(hash, rect->backgroundScaled());
+            for (QCPAxis* axis : rect->axes())
+                addAxis(hash, axis);
+        } else if (auto legend = qobject_cast<QCPLegend*>(element)) {
+            addLegend(hash, legend);
+        }
+    }
+    addNumber(hash, plot->legend && plot->legend->visible());
+
+    // 2. 曲线：样式与数据 (数据容器内部连续存储，整段计入)
+    for (int i = 0; i < plot->plottableCount(); ++i) {
+        QCPGraph* graph = qobject_cast<QCPGraph*>(plot->plottable(i));
+        if (!graph) return QByteArray();
+        addNumber(hash, graph->visible());
+        addString(hash, graph->name());
+        addPen(hash, graph->pen());
+        addNumber(hash, graph->brush().color().rgba());
+        addNumber(hash, int(graph->brush().style()));
+        addNumber(hash, int(graph->lineStyle()));
+        addNumber(hash, int(graph->scatterStyle().shape()));
+        addNumber(hash, graph->scatterStyle().size());
+        addPen(hash, graph->scatterStyle().pen());
+
+        const QSharedPointer<QCPGraphDataContainer> data = graph->data();
+        addNumber(hash, data->size());
+        if (!data->isEmpty()) {
+            const QCPGraphData* first = &*data->constBegin();
+            hash.addData(QByteArray::fromRawData(reinterpret_cast<const char*>(first), qsizetype(data->size()) * qsizetype(sizeof(QCPGraphData))));
+        }
+    }
+
+    // 3. 标注图元：位置、文字与画笔
+    for (int i = 0; i < plot->itemCount(); ++i) {
+        QCPAbstractItem* item = plot->item(i);
+        addString(hash, QString::fromLatin1(item->metaObject()->className()));
+        addNumber(hash, item->visible());
+        for (QCPItemPosition* position : item->positions()) {
+            addNumber(hash, int(position->type()));
+            addNumber(hash, position->coords().x());
+            addNumber(hash, position->coords().y());
+        }
+        if (auto text = qobject_cast<QCPItemText*>(item)) {
+            addString(hash, text->text());
+            addString(hash, text->font().toString());
+        } else if (auto line = qobject_cast<QCPItemLine*>(item)) {
+            addPen(hash, line->pen());
+            addNumber(hash, int(line->head().style()));
+        } else if (!qobject_cast<QCPItemStraightLine*>(item)) {
+            return QByteArray();
+        }
+    }
+
+    return hash.result();
+}
+
+ReportFigure ReportWriter::captureFigure(QCustomPlot* plot, int width, int height, int displayWidth)
+{
+    ReportFigure figure;
+    figure.displayWidth = displayWidth;
+    if (!plot || width <= 0 || height <= 0) return figure;
+
+    figure.fingerprint = plotFingerprint(plot, width, height);
+    if (!figure.fingerprint.isEmpty()) {
+        QMutexLocker locker(&cacheMutex());
+        if (const QByteArray* cached = figureCache().object(figure.fingerprint)) {
+            figure.encoded = *cached;
+            return figure;
+        }
+    }
+
+    // QCPPainter 直接绘制到 QImage：图像数据可交给工作线程编码
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QCPPainter painter(&image);
+    plot->toPainter(&painter, width, height);
+    painter.end();
+
+    figure.image = image;
+    return figure;
+}
+
+ReportWriteResult ReportWriter::write(const QString& fileName, const ReportDocument& document)
+{
+    ReportWriteResult result;
+    result.fileName = fileName;
+
+    // 1. 并行编码未命中缓存的图像
+    QVector<ReportFigure> figures = document.figures;
+    QtConcurrent::blockingMap(figures, [](ReportFigure& figure) {
+        if (!figure.encoded.isEmpty() || figure.image.isNull()) return;
+
+        QByteArray png;
+        QBuffer buffer(&png);
+        buffer.open(QIODevice::WriteOnly);
+        if (!figure.image.save(&buffer, "PNG")) return;
+        figure.encoded = png.toBase64();
+        figure.image = QImage();
+
+        if (!figure.fingerprint.isEmpty()) {
+            QMutexLocker locker(&cacheMutex());
+            figureCache().insert(figure.fingerprint, new QByteArray(figure.encoded), qMax(1, int(figure.encoded.size() / 1024)));
+        }
+    });
+
+    // 2. 按顺序流式写出
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        result.errorMessage = "无法写入文件，请检查权限或文件是否被占用。";
+        return result;
+    }
+
+    QTextStream out(&file);
+    out.setEncoding(QStringConverter::Utf8);
+    for (const ReportDocument::Part& part : document.parts) {
+        if (part.figure < 0) {
+            out << part.html;
+            continue;
+        }
+        const ReportFigure& figure = figures.at(part.figure);
+        if (figure.encoded.isEmpty()) {
+            out << QString("<p>图像导出失败。</p>");
+            continue;
+        }
+        out << "<div style='text-align:center;'><img src='data:image/png;base64,"
+            << QLatin1String(figure.encoded.constData(), figure.encoded.size())
+            << "' width='" << figure.displayWidth << "' /></div>";
+    }
+    out.flush();
+
+    if (out.status() != QTextStream::Ok || !file.commit()) {
+        result.errorMessage = "写入文件失败: " + file.errorString();
+        return result;
+    }
+
+    result.success = true;
+    return result;
+}
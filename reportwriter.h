@@ -0,0 +1,63 @@
+/*
+ * 文件名: reportwriter.h
+ * 文件作用: 分析报告生成 (图像渲染、编码与文档写出) 头文件
+ * 功能描述:
+ * 1. captureFigure：在界面线程用离屏 QCPPainter 把图表绘制到 QImage (不经过 QPixmap)，
+ *    先按图表内容计算指纹，内容未变的图直接取用上次的编码结果，不再重新绘制。
+ * 2. write：在工作线程执行，各图像并行 PNG 编码 + base64，随后按片段顺序流式写入磁盘
+ *    (QSaveFile，写完后原子替换)，不在内存中拼接整篇 HTML。
+ * 3. 编码结果按指纹缓存在进程内 (线程安全，按大小淘汰)，连续导出多份报告时共用。
+ */
+
+#ifndef REPORTWRITER_H
+#define REPORTWRITER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+#include <QVector>
+
+class QCustomPlot;
+
+// 报告中的一张图
+struct ReportFigure {
+    QByteArray fingerprint;     // 图表内容指纹 (缓存键)
+    QImage image;               // 待编码的渲染结果；缓存命中时为空
+    QByteArray encoded;         // base64 编码的 PNG；缓存命中时已填好
+    int displayWidth = 600;     // 文档中的显示宽度 (像素)
+};
+
+// 报告文档：HTML 片段与图像按顺序排列
+struct ReportDocument {
+    struct Part {
+        QString html;
+        int figure = -1;        // >= 0 时该片段为 figures[figure]
+    };
+
+    QVector<Part> parts;
+    QVector<ReportFigure> figures;
+
+    void appendHtml(const QString& html);
+    void appendFigure(const ReportFigure& figure);
+};
+
+struct ReportWriteResult {
+    bool success = false;
+    QString errorMessage;
+    QString fileName;
+};
+
+class ReportWriter
+{
+public:
+    // 界面线程调用：渲染图表 (width × height 像素)，内容未变时返回缓存的编码结果
+    static ReportFigure captureFigure(QCustomPlot* plot, int width, int height, int displayWidth);
+
+    // 工作线程调用：并行编码未缓存的图像，按顺序流式写出文档
+    static ReportWriteResult write(const QString& fileName, const ReportDocument& document);
+
+private:
+    static QByteArray plotFingerprint(QCustomPlot* plot, int width, int height);
+};
+
+#endif // REPORTWRITER_H
@@ -0,0 +1,68 @@
+/*
+ * 文件名: sensitivityrunner.cpp
+ * 文件作用: 模型敏感性分析计算服务实现文件
+ * 功能描述:
+ * 1. 各工况由 QtConcurrent::mapped 分发到模型计算线程池 (与拟合共用)，每个工况一次完整求解。
+ * 2. 结果经 QFutureWatcher::resultReadyAt 在界面线程逐个转发，下标与输入工况一一对应。
+ * 3. 取消时同时置位共用的 SolveControl，正在求解的工况提前返回空曲线，不再转发。
+ */
+
+#include "sensitivityrunner.h"
+#include "modelmanager.h"
+
+#include <QtConcurrent>
+
+SensitivityRunner::SensitivityRunner(QObject* parent)
+    : QObject(parent)
+    , m_finishedCount(0)
+{
+    connect(&m_watcher, &QFutureWatcher<ModelCurveData>::resultReadyAt, this, &SensitivityRunner::onResultReady);
+    connect(&m_watcher, &QFutureWatcher<ModelCurveData>::finished, this, &SensitivityRunner::onFinished);
+}
+
+SensitivityRunner::~SensitivityRunner()
+{
+    cancel();
+    waitForFinished();
+}
+
+void SensitivityRunner::start(ModelSolver01_06* solver, const QVector<SensitivityCase>& cases,
+                              const QVector<double>& time, const TypeCurveAtlas* atlas)
+{
+    if (m_watcher.isRunning()) {
+        cancel();
+        m_watcher.waitForFinished();
+    }
+
+    m_cases = cases;
+    m_finishedCount = 0;
+    m_control = std::make_shared<SolveControl>();
+    std::shared_ptr<SolveControl> control = m_control;
+    m_watcher.setFuture(QtConcurrent::mapped(ModelManager::solverPool(), m_cases, [solver, time, atlas, control](const SensitivityCase& c) {
+        return solver->calculateTheoreticalCurve(c.params, time, RateSchedule(), atlas, control.get());
+    }));
+}
+
+void SensitivityRunner::cancel()
+{
+    if (m_control) m_control->cancelled = true;
+    m_watcher.cancel();
+}
+
+void SensitivityRunner::waitForFinished()
+{
+    m_watcher.waitForFinished();
+}
+
+void SensitivityRunner::onResultReady(int index)
+{
+    // 取消后提前返回的工况是空曲线
+    if (m_control && m_control->cancelled) return;
+    ++m_finishedCount;
+    emit caseFinished(index, m_watcher.resultAt(index));
+}
+
+void SensitivityRunner::onFinished()
+{
+    emit finished(m_watcher.isCanceled());
+}
@@ -0,0 +1,68 @@
+/*
+ * 文件名: sensitivityrunner.h
+ * 文件作用: 模型敏感性分析计算服务头文件
+ * 功能描述:
+ * 1. 接收一组参数组合 (单参数或双参数扫描展开后的各工况)，在工作线程上并行调用求解器计算理论曲线。
+ * 2. 每个工况算完即发出 caseFinished，界面逐条绘制，不等待全部完成。
+ * 3. 支持取消：尚未开始的工况不再计算，正在计算的工况完成后丢弃。
+ * 4. 工况数量不受限制，由调用方负责配色与图例。
+ * 5. 同一批工况共用一个 SolveControl，取消时正在计算的工况在下一个时间点即返回。
+ */
+
+#ifndef SENSITIVITYRUNNER_H
+#define SENSITIVITYRUNNER_H
+
+#include <QObject>
+#include <QMap>
+#include <QVector>
+#include <QString>
+#include <QFutureWatcher>
+#include <memory>
+#include "modelsolver01-06.h"
+
+class TypeCurveAtlas;
+
+// 敏感性分析的一个工况
+struct SensitivityCase {
+    QMap<QString, double> params;   // 完整计算参数
+    QString label;                  // 图例名，如 "lambda1 = 0.001"
+};
+
+class SensitivityRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SensitivityRunner(QObject* parent = nullptr);
+    ~SensitivityRunner();
+
+    // 开始计算 (上一批未完成时先取消并等待)；solver 与 atlas 须在计算期间保持有效，
+    // 求解器只读访问，可被多个线程同时调用
+    void start(ModelSolver01_06* solver, const QVector<SensitivityCase>& cases,
+               const QVector<double>& time, const TypeCurveAtlas* atlas = nullptr);
+    void cancel();
+    // 等待已开始的工况结束 (析构求解器前调用；已取消时只需等到各工况的下一个时间点)
+    void waitForFinished();
+
+    bool isRunning() const { return m_watcher.isRunning(); }
+    int caseCount() const { return m_cases.size(); }
+    int finishedCount() const { return m_finishedCount; }
+    const SensitivityCase& caseAt(int index) const { return m_cases[index]; }
+
+signals:
+    // index 为工况在 cases 中的下标，完成顺序不固定
+    void caseFinished(int index, const ModelCurveData& curve);
+    void finished(bool canceled);
+
+private slots:
+    void onResultReady(int index);
+    void onFinished();
+
+private:
+    QFutureWatcher<ModelCurveData> m_watcher;
+    std::shared_ptr<SolveControl> m_control;
+    QVector<SensitivityCase> m_cases;
+    int m_finishedCount;
+};
+
+#endif // SENSITIVITYRUNNER_H
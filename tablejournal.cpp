@@ -0,0 +1,210 @@
+/*
+ * 文件名: tablejournal.cpp
+ * 文件作用: 表格数据增量日志实现文件
+ * 功能描述:
+ * 1. 帧格式: payloadSize(u32) | payload (QDataStream 小端) | checksum(u16, qChecksum)。
+ * 2. apply 在列式内存表格上执行单条记录，行列越界时自动扩展或忽略。
+ * 3. compact 读取 .wtd 全部列，回放日志后经 TableStore::writeTable 写出。
+ * 4. merge 重新编码两份日志的有效记录，经 QSaveFile 原子写回，避免残缺帧截断其后的记录。
+ */
+
+#include "tablejournal.h"
+#include "tablestore.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QtEndian>
+#include <QDebug>
+
+namespace {
+
+const int kFrameOverhead = 4 + 2;
+
+// 保证表格至少有 rows 行 / cols 列
+void ensureSize(TableJournal::Table& t, int rows, int cols)
+{
+    while (t.columns.size() < cols) {
+        t.columns.append(QStringList());
+        t.columns.last().reserve(t.rowCount);
+        for (int r = 0; r < t.rowCount; ++r) t.columns.last().append(QString());
+    }
+    while (t.headers.size() < t.columns.size()) t.headers.append(QString());
+    if (rows > t.rowCount) {
+        for (QStringList& col : t.columns) {
+            while (col.size() < rows) col.append(QString());
+        }
+        t.rowCount = rows;
+    }
+}
+
+} // namespace
+
+QByteArray TableJournal::encode(const QList<Record>& records)
+{
+    QByteArray out;
+    for (const Record& rec : records) {
+        QByteArray payload;
+        QDataStream ds(&payload, QIODevice::WriteOnly);
+        ds.setByteOrder(QDataStream::LittleEndian);
+        ds << rec.type << rec.column << rec.index << rec.count << rec.texts;
+
+        char head[4];
+        qToLittleEndian<quint32>(quint32(payload.size()), head);
+        char tail[2];
+        qToLittleEndian<quint16>(qChecksum(payload), tail);
+        out.append(head, 4);
+        out.append(payload);
+        out.append(tail, 2);
+    }
+    return out;
+}
+
+bool TableJournal::append(const QString& path, const QByteArray& frames, QString* error)
+{
+    if (frames.isEmpty()) return true;
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    bool ok = (file.write(frames) == frames.size()) && file.flush();
+    if (!ok && error) *error = file.errorString();
+    file.close();
+    return ok;
+}
+
+QList<TableJournal::Record> TableJournal::read(const QString& path)
+{
+    QList<Record> records;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return records;
+    const QByteArray data = file.readAll();
+
+    qint64 pos = 0;
+    while (pos + kFrameOverhead <= data.size()) {
+        quint32 size = qFromLittleEndian<quint32>(data.constData() + pos);
+        if (pos + kFrameOverhead + qint64(size) > data.size()) break; // 残缺帧
+        QByteArray payload = data.mid(pos + 4, int(size));
+        quint16 sum = qFromLittleEndian<quint16>(data.constData() + pos + 4 + size);
+        if (qChecksum(payload) != sum) break;
+
+        Record rec;
+        QDataStream ds(payload);
+        ds.setByteOrder(QDataStream::LittleEndian);
+        ds >> rec.type >> rec.column >> rec.index >> rec.count >> rec.texts;
+        if (ds.status() != QDataStream::Ok) break;
+        records.append(rec);
+        pos += kFrameOverhead + size;
+    }
+    if (pos < data.size()) {
+        qDebug() << "表格日志尾部存在残缺记录，已忽略:" << path << (data.size() - pos) << "字节";
+    }
+    return records;
+}
+
+bool TableJournal::merge(const QString& target, const QString& source, QString* error)
+{
+    if (!QFile::exists(source)) return true;
+    if (!QFile::exists(target)) {
+        if (QFile::rename(source, target)) return true;
+        if (error) *error = "无法重命名日志文件";
+        return false;
+    }
+
+    QList<Record> records = read(target);
+    records += read(source);
+    QSaveFile file(target);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    const QByteArray frames = encode(records);
+    if (file.write(frames) != frames.size() || !file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    QFile::remove(source);
+    return true;
+}
+
+void TableJournal::apply(Table& t, const Record& rec)
+{
+    switch (rec.type) {
+    case Record_Cells: {
+        if (rec.column < 0 || rec.index < 0) return;
+        ensureSize(t, rec.index + rec.texts.size(), rec.column + 1);
+        QStringList& col = t.columns[rec.column];
+        for (int i = 0; i < rec.texts.size(); ++i) col[rec.index + i] = rec.texts[i];
+        break;
+    }
+    case Record_InsertRows: {
+        if (rec.count <= 0) return;
+        int at = qBound(0, rec.index, t.rowCount);
+        for (QStringList& col : t.columns) col.insert(at, rec.count, QString());
+        t.rowCount += rec.count;
+        break;
+    }
+    case Record_RemoveRows: {
+        int at = qBound(0, rec.index, t.rowCount);
+        int n = qBound(0, rec.count, t.rowCount - at);
+        for (QStringList& col : t.columns) col.erase(col.begin() + at, col.begin() + at + n);
+        t.rowCount -= n;
+        break;
+    }
+    case Record_InsertColumns: {
+        if (rec.count <= 0) return;
+        int at = qBound(0, rec.index, int(t.columns.size()));
+        QStringList empty;
+        for (int r = 0; r < t.rowCount; ++r) empty.append(QString());
+        t.columns.insert(at, rec.count, empty);
+        t.headers.insert(qMin(at, int(t.headers.size())), rec.count, QString());
+        break;
+    }
+    case Record_RemoveColumns: {
+        int at = qBound(0, rec.index, int(t.columns.size()));
+        int n = qBound(0, rec.count, int(t.columns.size()) - at);
+        t.columns.remove(at, n);
+        for (int i = 0; i < n && at < t.headers.size(); ++i) t.headers.removeAt(at);
+        break;
+    }
+    case Record_Header:
+        if (rec.column < 0 || rec.texts.isEmpty()) return;
+        ensureSize(t, t.rowCount, rec.column + 1);
+        t.headers[rec.column] = rec.texts.first();
+        break;
+    default:
+        break;
+    }
+}
+
+bool TableJournal::compact(const QString& storePath, const QStringList& journals, const QString& outPath,
+                           const Table* base, QString* error)
+{
+    Table table;
+    {
+        TableStore store;
+        if (QFile::exists(storePath) && store.open(storePath, error)) {
+            table.headers = store.headers();
+            table.rowCount = int(store.rowCount());
+            for (int c = 0; c < store.columnCount(); ++c) table.columns.append(store.textColumn(c));
+        } else if (base) {
+            table = *base;
+        }
+    }
+    ensureSize(table, table.rowCount, table.headers.size());
+
+    int applied = 0;
+    for (const QString& path : journals) {
+        const QList<Record> records = read(path);
+        for (const Record& rec : records) apply(table, rec);
+        applied += records.size();
+    }
+
+    TableStore::WriteOptions options;
+    bool ok = TableStore::writeTable(outPath, table.headers, table.rowCount, [&table](int r, int c) {
+        return r < table.columns[c].size() ? table.columns[c][r] : QString();
+    }, options, error);
+    if (ok) qDebug() << "表格日志压缩完成:" << outPath << "回放记录数:" << applied;
+    return ok;
+}
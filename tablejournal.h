@@ -0,0 +1,74 @@
+/*
+ * 文件名: tablejournal.h
+ * 文件作用: 表格数据增量日志头文件
+ * 功能描述:
+ * 1. 定义 "_date.journal" 增量日志的记录类型 (单元格块、行/列插入删除、表头修改)。
+ * 2. 每条记录独立成帧 (长度 + 内容 + 校验)，崩溃导致的尾部残缺帧在回放时自动丢弃。
+ * 3. 提供日志压缩：以 _date.wtd 为基础依次回放日志，生成新的二进制表格文件。
+ * 4. 提供日志合并：把新日志并入尚未压缩的旧日志，旧日志在新数据落盘前始终保留。
+ */
+
+#ifndef TABLEJOURNAL_H
+#define TABLEJOURNAL_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QByteArray>
+
+class TableJournal
+{
+public:
+    // 日志记录类型
+    enum RecordType : quint8 {
+        Record_Cells = 1,          // 单列连续行的单元格文本: column, index(首行), texts
+        Record_InsertRows = 2,     // index, count
+        Record_RemoveRows = 3,     // index, count
+        Record_InsertColumns = 4,  // index, count
+        Record_RemoveColumns = 5,  // index, count
+        Record_Header = 6          // column, texts[0]
+    };
+
+    struct Record {
+        quint8 type = Record_Cells;
+        qint32 column = 0;
+        qint32 index = 0;
+        qint32 count = 0;
+        QStringList texts;
+    };
+
+    // 内存中的列式表格 (回放目标)
+    struct Table {
+        QStringList headers;
+        QVector<QStringList> columns;
+        int rowCount = 0;
+    };
+
+    // 将记录编码为可直接追加到日志文件的帧
+    static QByteArray encode(const QList<Record>& records);
+
+    // 追加帧到日志文件 (写入后立即 flush)
+    static bool append(const QString& path, const QByteArray& frames, QString* error = nullptr);
+
+    // 读取日志，遇到残缺或校验失败的帧即停止
+    static QList<Record> read(const QString& path);
+
+    // 把 source 的记录追加到 target 末尾 (丢弃两者尾部残缺帧)，成功后删除 source
+    static bool merge(const QString& target, const QString& source, QString* error = nullptr);
+
+    // 对内存表格应用一条记录
+    static void apply(Table& table, const Record& record);
+
+    /**
+     * @brief 日志压缩：基础表格 + 依次回放日志 -> 写出新的 .wtd 文件
+     * @param storePath 现有 .wtd 文件 (不存在时使用 base)
+     * @param journals 按顺序回放的日志文件
+     * @param outPath 输出文件
+     * @param base 没有 .wtd 时的基础表格 (如旧版 _date.json 的内容)，可为空
+     */
+    static bool compact(const QString& storePath, const QStringList& journals, const QString& outPath,
+                        const Table* base = nullptr, QString* error = nullptr);
+};
+
+#endif // TABLEJOURNAL_H
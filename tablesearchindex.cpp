@@ -0,0 +1,582 @@
+/*
+ * 文件名: tablesearchindex.cpp
+ * 文件作用: 数据表格搜索索引与行过滤代理实现文件
+ * 功能描述:
+ * 1. 构建：多数单元格为数值的列建立排序数值索引，其余列建立三元组倒排表。
+ * 2. 查询解析与求值同步进行 (递归下降)，每个子表达式直接得到行掩码再做位运算。
+ * 3. 少于 3 个字符的子串或未建倒排表的列，退化为对小写文本的顺序扫描 (不使用正则)。
+ * 4. 数值 != 只匹配有数值且不相等的行，空单元格与非数值不计入。
+ * 5. 单列构建逻辑 buildColumn 供整体构建与 rebuildColumn 共用。
+ * 6. 背景色区间按列扫描整理 (端点排序 + 按优先级计数)，代价与区间数成正比，与覆盖的行数无关。
+ */
+
+#include "tablesearchindex.h"
+#include "textdataimporter.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
+namespace {
+
+inline quint64 gramKey(const QChar* p)
+{
+    return (quint64(p[0].unicode()) << 32) | (quint64(p[1].unicode()) << 16) | quint64(p[2].unicode());
+}
+
+// 有序数组的插入/删除 (保持行号升序，便于求交集)
+inline void sortedInsert(QVector<int>& v, int row)
+{
+    auto it = std::lower_bound(v.begin(), v.end(), row);
+    if (it == v.end() || *it != row) v.insert(it, row);
+}
+
+inline void sortedRemove(QVector<int>& v, int row)
+{
+    auto it = std::lower_bound(v.begin(), v.end(), row);
+    if (it != v.end() && *it == row) v.erase(it);
+}
+
+QString headerBaseName(const QString& header)
+{
+    int pos = header.indexOf('\\');
+    return (pos < 0 ? header : header.left(pos)).trimmed();
+}
+
+} // namespace
+
+// ============================================================================
+// 构建与增量更新
+// ============================================================================
+
+std::shared_ptr<TableSearchIndex> TableSearchIndex::build(const QStringList& headers,
+                                                          const QVector<QStringList>& columns, int rowCount)
+{
+    auto index = std::make_shared<TableSearchIndex>();
+    index->m_rowCount = rowCount;
+    index->m_columns.resize(columns.size());
+
+    for (int c = 0; c < columns.size(); ++c) {
+        ColumnIndex& ci = index->m_columns[c];
+        ci.header = c < headers.size() ? headers[c] : QString();
+        buildColumn(ci, columns[c], rowCount);
+    }
+    return index;
+}
+
+void TableSearchIndex::buildColumn(ColumnIndex& ci, const QStringList& src, int rowCount)
+{
+    ci.lower.resize(rowCount);
+    ci.rowValue.fill(std::numeric_limits<double>::quiet_NaN(), rowCount);
+
+    int numeric = 0, nonEmpty = 0;
+    for (int r = 0; r < rowCount; ++r) {
+        const QString text = r < src.size() ? src[r] : QString();
+        ci.lower[r] = text.toLower();
+        if (text.isEmpty()) continue;
+        ++nonEmpty;
+        double v;
+        if (TextDataImporter::parseDouble(text, v)) {
+            ci.rowValue[r] = v;
+            ++numeric;
+        }
+    }
+
+    // 数值索引
+    QVector<int> order;
+    order.reserve(numeric);
+    for (int r = 0; r < rowCount; ++r) {
+        if (!std::isnan(ci.rowValue[r])) order.append(r);
+    }
+    std::stable_sort(order.begin(), order.end(), [&ci](int a, int b) { return ci.rowValue[a] < ci.rowValue[b]; });
+    ci.sortedRows = order;
+    ci.sortedValues.resize(order.size());
+    for (int i = 0; i < order.size(); ++i) ci.sortedValues[i] = ci.rowValue[order[i]];
+
+    // 数值为主的列子串搜索直接扫描即可，不必为数字建倒排表
+    ci.textIndexed = nonEmpty > 0 && numeric * 10 < nonEmpty * 9;
+    ci.grams.clear();
+    if (ci.textIndexed) {
+        for (int r = 0; r < rowCount; ++r) indexText(ci, r, true);
+    }
+}
+
+void TableSearchIndex::rebuildColumn(int col, const QStringList& texts)
+{
+    if (col < 0 || col >= m_columns.size()) return;
+    buildColumn(m_columns[col], texts, m_rowCount);
+}
+
+void TableSearchIndex::indexText(ColumnIndex& c, int row, bool add)
+{
+    const QString& s = c.lower[row];
+    if (s.size() < 3) return;
+    const QChar* p = s.constData();
+    for (int i = 0; i + 3 <= s.size(); ++i) {
+        QVector<int>& list = c.grams[gramKey(p + i)];
+        if (add) {
+            // 构建时行号递增，直接追加
+            if (list.isEmpty() || list.last() < row) list.append(row);
+            else sortedInsert(list, row);
+        } else {
+            sortedRemove(list, row);
+        }
+    }
+}
+
+void TableSearchIndex::updateCell(int row, int col, const QString& text)
+{
+    if (row < 0 || row >= m_rowCount || col < 0 || col >= m_columns.size()) return;
+    ColumnIndex& c = m_columns[col];
+
+    if (c.textIndexed) indexText(c, row, false);
+    c.lower[row] = text.toLower();
+    if (c.textIndexed) indexText(c, row, true);
+
+    // 数值索引：删除旧值，按新值插入
+    double old = c.rowValue[row];
+    if (!std::isnan(old)) {
+        auto lo = std::lower_bound(c.sortedValues.begin(), c.sortedValues.end(), old);
+        for (auto it = lo; it != c.sortedValues.end() && *it == old; ++it) {
+            int pos = int(it - c.sortedValues.begin());
+            if (c.sortedRows[pos] == row) {
+                c.sortedValues.remove(pos);
+                c.sortedRows.remove(pos);
+                break;
+            }
+        }
+    }
+    double v;
+    if (!text.isEmpty() && TextDataImporter::parseDouble(text, v)) {
+        c.rowValue[row] = v;
+        int pos = int(std::upper_bound(c.sortedValues.begin(), c.sortedValues.end(), v) - c.sortedValues.begin());
+        c.sortedValues.insert(pos, v);
+        c.sortedRows.insert(pos, row);
+    } else {
+        c.rowValue[row] = std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+void TableSearchIndex::setHeader(int col, const QString& header)
+{
+    if (col >= 0 && col < m_columns.size()) m_columns[col].header = header;
+}
+
+int TableSearchIndex::findColumn(const QString& name) const
+{
+    for (int c = 0; c < m_columns.size(); ++c) {
+        if (m_columns[c].header.compare(name, Qt::CaseInsensitive) == 0) return c;
+    }
+    for (int c = 0; c < m_columns.size(); ++c) {
+        if (headerBaseName(m_columns[c].header).compare(name, Qt::CaseInsensitive) == 0) return c;
+    }
+    return -1;
+}
+
+// ============================================================================
+// 匹配
+// ============================================================================
+
+void TableSearchIndex::matchContains(const ColumnIndex& c, const QString& needle, QBitArray& mask) const
+{
+    if (needle.isEmpty()) return;
+
+    if (!c.textIndexed || needle.size() < 3) {
+        for (int r = 0; r < m_rowCount; ++r) {
+            if (!mask.testBit(r) && c.lower[r].contains(needle)) mask.setBit(r);
+        }
+        return;
+    }
+
+    // 取最短的倒排表作为候选，逐行校验
+    const QVector<int>* best = nullptr;
+    for (int i = 0; i + 3 <= needle.size(); ++i) {
+        auto it = c.grams.constFind(gramKey(needle.constData() + i));
+        if (it == c.grams.constEnd()) return; // 某个三元组不存在，必然无匹配
+        if (!best || it->size() < best->size()) best = &it.value();
+    }
+    for (int r : *best) {
+        if (!mask.testBit(r) && c.lower[r].contains(needle)) mask.setBit(r);
+    }
+}
+
+void TableSearchIndex::matchNumeric(const ColumnIndex& c, const QString& op, double value, QBitArray& mask) const
+{
+    const auto begin = c.sortedValues.constBegin();
+    const auto end = c.sortedValues.constEnd();
+    int from = 0, to = c.sortedValues.size();
+    if (op == ">") from = int(std::upper_bound(begin, end, value) - begin);
+    else if (op == ">=") from = int(std::lower_bound(begin, end, value) - begin);
+    else if (op == "<") to = int(std::lower_bound(begin, end, value) - begin);
+    else if (op == "<=") to = int(std::upper_bound(begin, end, value) - begin);
+    else if (op == "==") {
+        from = int(std::lower_bound(begin, end, value) - begin);
+        to = int(std::upper_bound(begin, end, value) - begin);
+    }
+    for (int i = from; i < to; ++i) mask.setBit(c.sortedRows[i]);
+}
+
+// ============================================================================
+// 查询解析 (解析的同时求值)
+//   or   := and ("||" and)*
+//   and  := not ("&&" not)*
+//   not  := "!" not | "(" or ")" | cond
+//   cond := name op value | value       (单独的值在所有列中做子串搜索)
+// ============================================================================
+class TableSearchIndex::QueryParser
+{
+public:
+    QueryParser(const TableSearchIndex* index, const QString& text) : m_index(index), m_s(text), m_pos(0) {}
+
+    bool run(QBitArray& mask, QString* error)
+    {
+        if (!parseOr(mask)) return fail(error);
+        skipSpace();
+        if (m_pos < m_s.size()) {
+            m_error = QString("无法识别 '%1'").arg(m_s.mid(m_pos, 10));
+            return fail(error);
+        }
+        return true;
+    }
+
+private:
+    bool fail(QString* error)
+    {
+        if (error) *error = m_error.isEmpty() ? QString("查询语法错误") : m_error;
+        return false;
+    }
+
+    void skipSpace() { while (m_pos < m_s.size() && m_s[m_pos].isSpace()) ++m_pos; }
+    bool accept(const char* tok)
+    {
+        skipSpace();
+        QLatin1String t(tok);
+        if (QStringView(m_s).mid(m_pos).startsWith(t)) { m_pos += t.size(); return true; }
+        return false;
+    }
+
+    QBitArray empty() const { return QBitArray(m_index->m_rowCount); }
+
+    bool parseOr(QBitArray& out)
+    {
+        if (!parseAnd(out)) return false;
+        while (accept("||")) {
+            QBitArray rhs;
+            if (!parseAnd(rhs)) return false;
+            out |= rhs;
+        }
+        return true;
+    }
+
+    bool parseAnd(QBitArray& out)
+    {
+        if (!parseNot(out)) return false;
+        while (accept("&&")) {
+            QBitArray rhs;
+            if (!parseNot(rhs)) return false;
+            out &= rhs;
+        }
+        return true;
+    }
+
+    bool parseNot(QBitArray& out)
+    {
+        skipSpace();
+        if (m_pos < m_s.size() && m_s[m_pos] == '!' && !(m_pos + 1 < m_s.size() && m_s[m_pos + 1] == '=')) {
+            ++m_pos;
+            if (!parseNot(out)) return false;
+            out = ~out;
+            return true;
+        }
+        if (accept("(")) {
+            if (!parseOr(out)) return false;
+            if (!accept(")")) { m_error = "缺少 ')'"; return false; }
+            return true;
+        }
+        return parseCond(out);
+    }
+
+    // 读取一个操作数：[列名]、"字符串" 或到运算符/括号/空白为止的单词
+    bool readOperand(QString& text, bool& quoted)
+    {
+        skipSpace();
+        quoted = false;
+        if (m_pos >= m_s.size()) { m_error = "查询不完整"; return false; }
+        QChar c = m_s[m_pos];
+        if (c == '[' || c == '"' || c == '\'') {
+            QChar close = (c == '[') ? QChar(']') : c;
+            int end = m_s.indexOf(close, m_pos + 1);
+            if (end < 0) { m_error = QString("缺少 '%1'").arg(close); return false; }
+            text = m_s.mid(m_pos + 1, end - m_pos - 1);
+            m_pos = end + 1;
+            quoted = (c != '[');
+            return true;
+        }
+        int start = m_pos;
+        while (m_pos < m_s.size()) {
+            QChar ch = m_s[m_pos];
+            if (ch.isSpace() || QStringLiteral("<>=!~()&|").contains(ch)) break;
+            ++m_pos;
+        }
+        text = m_s.mid(start, m_pos - start);
+        if (text.isEmpty()) { m_error = QString("无法识别 '%1'").arg(c); return false; }
+        return true;
+    }
+
+    QString readOp()
+    {
+        skipSpace();
+        static const char* ops[] = {">=", "<=", "==", "!=", ">", "<", "=", "~"};
+        for (const char* op : ops) {
+            if (accept(op)) return QString::fromLatin1(op);
+        }
+        return QString();
+    }
+
+    bool parseCond(QBitArray& out)
+    {
+        QString lhs;
+        bool quoted;
+        if (!readOperand(lhs, quoted)) return false;
+
+        int save = m_pos;
+        QString op = quoted ? QString() : readOp();
+        if (op.isEmpty()) {
+            // 单独的值：在所有列中做子串搜索
+            m_pos = save;
+            out = empty();
+            const QString needle = lhs.toLower();
+            for (const ColumnIndex& c : m_index->m_columns) m_index->matchContains(c, needle, out);
+            return true;
+        }
+
+        int col = m_index->findColumn(lhs);
+        if (col < 0) { m_error = QString("找不到列 '%1'").arg(lhs); return false; }
+        QString rhs;
+        if (!readOperand(rhs, quoted)) return false;
+
+        const ColumnIndex& c = m_index->m_columns[col];
+        out = empty();
+        if (op == "~") {
+            m_index->matchContains(c, rhs.toLower(), out);
+            return true;
+        }
+
+        double value;
+        bool numeric = !quoted && TextDataImporter::parseDouble(rhs, value);
+        if (op == "=") op = "==";
+        if (numeric) {
+            if (op == "!=") {
+                for (int r = 0; r < m_index->m_rowCount; ++r) {
+                    const double v = c.rowValue[r];
+                    if (!std::isnan(v) && v != value) out.setBit(r);
+                }
+            } else {
+                m_index->matchNumeric(c, op, value, out);
+            }
+            return true;
+        }
+
+        // 文本比较 (不区分大小写)
+        const QString key = rhs.toLower();
+        for (int r = 0; r < m_index->m_rowCount; ++r) {
+            int cmp = c.lower[r].compare(key);
+            bool hit = (op == "==") ? cmp == 0 : (op == "!=") ? cmp != 0 : (op == ">") ? cmp > 0
+                     : (op == ">=") ? cmp >= 0 : (op == "<") ? cmp < 0 : cmp <= 0;
+            if (hit) out.setBit(r);
+        }
+        return true;
+    }
+
+    const TableSearchIndex* m_index;
+    QString m_s;
+    int m_pos;
+    QString m_error;
+};
+
+bool TableSearchIndex::query(const QString& text, QBitArray& mask, QString* error) const
+{
+    mask = QBitArray(m_rowCount);
+    const QString q = text.trimmed();
+    if (q.isEmpty()) {
+        mask.fill(true);
+        return true;
+    }
+
+    // 不含任何运算符时整句作为子串，在所有列中搜索 (允许包含空格)
+    static const QString opChars = QStringLiteral("<>=!~()&|[]\"'");
+    bool plain = std::none_of(q.begin(), q.end(), [](QChar ch) { return opChars.contains(ch); });
+    if (!plain) {
+        QueryParser parser(this, q);
+        if (parser.run(mask, error)) return true;
+        // 不是合法表达式 (如 "压力(MPa)")，按普通文本搜索
+        mask = QBitArray(m_rowCount);
+    }
+
+    const QString needle = q.toLower();
+    for (const ColumnIndex& c : m_columns) matchContains(c, needle, mask);
+    return true;
+}
+
+// ============================================================================
+// RowMaskFilterProxyModel
+// ============================================================================
+
+RowMaskFilterProxyModel::RowMaskFilterProxyModel(QObject* parent)
+    : QSortFilterProxyModel(parent), m_maskActive(false), m_hasBackgrounds(false)
+{
+}
+
+void RowMaskFilterProxyModel::setRowMask(const QBitArray& mask)
+{
+    m_mask = mask;
+    m_maskActive = true;
+    invalidateFilter();
+}
+
+void RowMaskFilterProxyModel::clearRowMask()
+{
+    if (!m_maskActive) return;
+    m_maskActive = false;
+    m_mask.clear();
+    invalidateFilter();
+}
+
+void RowMaskFilterProxyModel::setSourceModel(QAbstractItemModel* model)
+{
+    for (const QMetaObject::Connection& c : std::as_const(m_sourceConnections)) disconnect(c);
+    m_sourceConnections.clear();
+    // 先于基类处理插入，基类随后对新行调用 filterAcceptsRow 时掩码已对齐
+    if (model) {
+        m_sourceConnections << connect(model, &QAbstractItemModel::rowsAboutToBeInserted,
+                                       this, &RowMaskFilterProxyModel::onSourceRowsAboutToBeInserted);
+        m_sourceConnections << connect(model, &QAbstractItemModel::modelAboutToBeReset,
+                                       this, &RowMaskFilterProxyModel::onSourceModelAboutToBeReset);
+    }
+    QSortFilterProxyModel::setSourceModel(model);
+    if (model) {
+        m_sourceConnections << connect(model, &QAbstractItemModel::rowsRemoved,
+                                       this, &RowMaskFilterProxyModel::onSourceRowsRemoved);
+    }
+}
+
+void RowMaskFilterProxyModel::onSourceRowsAboutToBeInserted(const QModelIndex& parent, int first, int last)
+{
+    if (!m_maskActive || parent.isValid() || first >= m_mask.size()) return;
+    const int count = last - first + 1;
+    QBitArray shifted(m_mask.size() + count, false);
+    for (int r = 0; r < first; ++r) shifted.setBit(r, m_mask.testBit(r));
+    for (int r = first; r <= last; ++r) shifted.setBit(r);
+    for (int r = first; r < m_mask.size(); ++r) shifted.setBit(r + count, m_mask.testBit(r));
+    m_mask = shifted;
+}
+
+void RowMaskFilterProxyModel::onSourceRowsRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (!m_maskActive || parent.isValid() || first >= m_mask.size()) return;
+    const int count = qMin(last, int(m_mask.size()) - 1) - first + 1;
+    QBitArray shifted(m_mask.size() - count, false);
+    for (int r = 0; r < first; ++r) shifted.setBit(r, m_mask.testBit(r));
+    for (int r = first; r < shifted.size(); ++r) shifted.setBit(r, m_mask.testBit(r + count));
+    m_mask = shifted;
+}
+
+void RowMaskFilterProxyModel::onSourceModelAboutToBeReset()
+{
+    // 重置后的行与旧掩码无关，新查询结果到达前全部显示
+    m_mask.clear();
+}
+
+QVector<RowMaskFilterProxyModel::BackgroundSegment>
+RowMaskFilterProxyModel::flattenRanges(const QVector<BackgroundRange>& ranges)
+{
+    // 端点事件：区间起点 +1，终点 -1；同一行的事件全部处理后，当前最高优先级决定到下一事件行之前的颜色
+    struct Event {
+        int row;
+        int range;
+        bool start;
+    };
+    QVector<Event> events;
+    events.reserve(ranges.size() * 2);
+    for (int i = 0; i < ranges.size(); ++i) {
+        events.append({ ranges[i].firstRow, i, true });
+        events.append({ ranges[i].firstRow + ranges[i].rowCount, i, false });
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.row < b.row; });
+
+    QVector<BackgroundSegment> segments;
+    std::map<int, int> active;          // 优先级 -> 覆盖当前行的区间数
+    QHash<int, QColor> colorOf;         // 优先级 -> 颜色
+    int i = 0;
+    while (i < events.size()) {
+        const int row = events[i].row;
+        for (; i < events.size() && events[i].row == row; ++i) {
+            const BackgroundRange& r = ranges[events[i].range];
+            if (events[i].start) {
+                ++active[r.priority];
+                colorOf.insert(r.priority, r.color);
+            } else if (--active[r.priority] == 0) {
+                active.erase(r.priority);
+            }
+        }
+        if (active.empty() || i >= events.size()) continue;
+        const int end = events[i].row;
+        const QColor color = colorOf.value(active.rbegin()->first);
+        if (!segments.isEmpty() && segments.last().end == row && segments.last().color == color)
+            segments.last().end = end;
+        else
+            segments.append({ row, end, color });
+    }
+    return segments;
+}
+
+void RowMaskFilterProxyModel::setCellBackgrounds(const QVector<BackgroundRange>& ranges)
+{
+    int columns = 0;
+    for (const BackgroundRange& r : ranges) columns = qMax(columns, r.column + 1);
+    QVector<QVector<BackgroundRange>> byColumn(columns);
+    for (const BackgroundRange& r : ranges) {
+        if (r.column >= 0 && r.firstRow >= 0 && r.rowCount > 0) byColumn[r.column].append(r);
+    }
+
+    m_backgrounds.clear();
+    m_backgrounds.resize(columns);
+    m_hasBackgrounds = false;
+    for (int c = 0; c < columns; ++c) {
+        m_backgrounds[c] = flattenRanges(byColumn[c]);
+        if (!m_backgrounds[c].isEmpty()) m_hasBackgrounds = true;
+    }
+    if (rowCount() > 0 && columnCount() > 0)
+        emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1), {Qt::BackgroundRole});
+}
+
+void RowMaskFilterProxyModel::clearCellBackgrounds()
+{
+    if (!m_hasBackgrounds) return;
+    m_backgrounds.clear();
+    m_hasBackgrounds = false;
+    if (rowCount() > 0 && columnCount() > 0)
+        emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1), {Qt::BackgroundRole});
+}
+
+QVariant RowMaskFilterProxyModel::data(const QModelIndex& index, int role) const
+{
+    if (role == Qt::BackgroundRole && m_hasBackgrounds) {
+        const QModelIndex source = mapToSource(index);
+        const int row = source.row();
+        if (source.column() >= 0 && source.column() < m_backgrounds.size()) {
+            const QVector<BackgroundSegment>& segments = m_backgrounds[source.column()];
+            auto it = std::upper_bound(segments.begin(), segments.end(), row,
+                                       [](int r, const BackgroundSegment& s) { return r < s.first; });
+            if (it != segments.begin() && row < (it - 1)->end) return (it - 1)->color;
+        }
+    }
+    return QSortFilterProxyModel::data(index, role);
+}
+
+bool RowMaskFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    if (!m_maskActive) return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+    // 掩码之后新增的行始终显示
+    return sourceRow >= m_mask.size() || m_mask.testBit(sourceRow);
+}
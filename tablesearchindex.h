@@ -0,0 +1,140 @@
+/*
+ * 文件名: tablesearchindex.h
+ * 文件作用: 数据表格搜索索引与行过滤代理头文件
+ * 功能描述:
+ * 1. TableSearchIndex：按列建立索引 (可在后台线程构建)。
+ *    - 数值列：按数值排序的 (值, 行号) 数组，范围查询为二分查找。
+ *    - 文本列：三元组 (n-gram, n=3) 倒排表，子串查询先求候选行再逐行校验。
+ * 2. 查询语法：列名 比较符 值，用 && || ! 与括号组合，例如 "t > 10 && p < 25"、"备注 ~ 关井"。
+ *    比较符: > >= < <= == (=) != ~ (包含)；不含比较符的整句按子串在所有列中搜索。
+ * 3. 单元格编辑时增量更新对应列的索引，无需重建。
+ * 4. RowMaskFilterProxyModel：按查询得到的行掩码过滤，替代逐格正则匹配；
+ *    另可按单元格提供背景色 (数据质量标记)，在 data() 中惰性返回，不修改源模型。
+ * 5. 源模型插入/删除行时同步移动掩码，新索引建好之前已有行的显示状态保持不变。
+ * 6. 表达式解析失败时 (如 "压力(MPa)") 整句按子串搜索。
+ * 7. 整列内容变化 (计算列重算) 时只重建该列的索引。
+ * 8. 背景色以 (列, 起始行, 行数) 区间给出，按列整理为互不重叠的有序区段，data() 中二分查找，
+ *    长区间不展开为逐格记录。
+ */
+
+#ifndef TABLESEARCHINDEX_H
+#define TABLESEARCHINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QBitArray>
+#include <QColor>
+#include <QSortFilterProxyModel>
+#include <memory>
+
+class TableSearchIndex
+{
+public:
+    /**
+     * @brief 由表格快照构建索引 (不访问任何 Qt 模型，可在工作线程调用)
+     * @param headers 表头
+     * @param columns 按列存储的单元格文本
+     * @param rowCount 行数
+     */
+    static std::shared_ptr<TableSearchIndex> build(const QStringList& headers,
+                                                   const QVector<QStringList>& columns, int rowCount);
+
+    int rowCount() const { return m_rowCount; }
+    int columnCount() const { return m_columns.size(); }
+
+    // 单元格文本变化后增量更新
+    void updateCell(int row, int col, const QString& text);
+    // 整列文本变化后重建该列索引 (大量单元格变化时比逐格更新快)
+    void rebuildColumn(int col, const QStringList& texts);
+    void setHeader(int col, const QString& header);
+
+    /**
+     * @brief 执行查询
+     * @param query 查询语句
+     * @param mask 输出行掩码 (大小为 rowCount)
+     * @param error 语法错误或列名无效时的提示
+     */
+    bool query(const QString& query, QBitArray& mask, QString* error = nullptr) const;
+
+private:
+    struct ColumnIndex {
+        QString header;
+        QVector<QString> lower;          // 小写文本 (子串与相等比较使用)
+        QVector<double> rowValue;        // 每行的数值，非数值为 NaN
+        QVector<double> sortedValues;    // 已排序的数值
+        QVector<int> sortedRows;         // 与 sortedValues 对应的行号
+        bool textIndexed = false;        // 是否建立三元组倒排表 (数值为主的列不建)
+        QHash<quint64, QVector<int>> grams;
+    };
+
+    class QueryParser;
+    friend class QueryParser;
+
+    static void buildColumn(ColumnIndex& c, const QStringList& src, int rowCount);
+    static void indexText(ColumnIndex& c, int row, bool add);
+    int findColumn(const QString& name) const;
+    // 子串匹配 (needle 已转小写)
+    void matchContains(const ColumnIndex& c, const QString& needle, QBitArray& mask) const;
+    // 数值比较: op 为 "<" "<=" ">" ">=" "=="
+    void matchNumeric(const ColumnIndex& c, const QString& op, double value, QBitArray& mask) const;
+
+    int m_rowCount = 0;
+    QVector<ColumnIndex> m_columns;
+};
+
+// ============================================================================
+// 行掩码过滤代理
+// ============================================================================
+class RowMaskFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit RowMaskFilterProxyModel(QObject* parent = nullptr);
+
+    void setRowMask(const QBitArray& mask);
+    void clearRowMask();
+    bool hasRowMask() const { return m_maskActive; }
+
+    // 单元格背景色区间 (源列、起始源行、行数)；多个区间重叠时取 priority 最高者，相同 priority 应使用同一颜色
+    struct BackgroundRange {
+        int column;
+        int firstRow;
+        int rowCount;
+        int priority;
+        QColor color;
+    };
+    void setCellBackgrounds(const QVector<BackgroundRange>& ranges);
+    void clearCellBackgrounds();
+    bool hasCellBackgrounds() const { return m_hasBackgrounds; }
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    void setSourceModel(QAbstractItemModel* model) override;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    // 掩码随源模型的行插入/删除移动 (插入的行显示)
+    void onSourceRowsAboutToBeInserted(const QModelIndex& parent, int first, int last);
+    void onSourceRowsRemoved(const QModelIndex& parent, int first, int last);
+    void onSourceModelAboutToBeReset();
+
+    QBitArray m_mask;
+    bool m_maskActive;
+    QList<QMetaObject::Connection> m_sourceConnections;
+
+    // 某列中颜色相同的连续行 [first, end)
+    struct BackgroundSegment {
+        int first;
+        int end;
+        QColor color;
+    };
+    // 同一列的区间整理为按行升序、互不重叠的区段
+    static QVector<BackgroundSegment> flattenRanges(const QVector<BackgroundRange>& ranges);
+    QVector<QVector<BackgroundSegment>> m_backgrounds;   // 按源列
+    bool m_hasBackgrounds;
+};
+
+#endif // TABLESEARCHINDEX_H
@@ -0,0 +1,366 @@
+/*
+ * 文件名: tablestore.cpp
+ * 文件作用: 项目表格数据二进制列式存储实现文件
+ * 功能描述:
+ * 1. writeTable / writeModel: 逐列判定类型 (数值且文本可无损还原 -> double，否则文本)，写数据块后追加列索引。
+ * 2. open: QFile::map 映射整个文件，只解析文件头和列索引。
+ * 3. numericColumn / textColumn: 按需解码单列，未压缩的数值列直接从映射内存拷贝。
+ * 4. 列索引的 QDataStream 固定为 Qt 6.0 格式，不随运行时 Qt 版本变化。
+ * 5. fillModel 逐列解码后直接生成单元格并整列插入，不经中间字符串列表，也不逐格触发模型信号。
+ */
+
+#include "tablestore.h"
+#include "textdataimporter.h"
+
+#include <QStandardItemModel>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QBuffer>
+#include <QtEndian>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const char kMagic[4] = { 'W', 'T', 'T', 'B' };
+const int kHeaderSize = 36;
+// 列索引序列化格式 (与文件版本号一同决定索引布局)
+const QDataStream::Version kIndexStreamVersion = QDataStream::Qt_6_0;
+
+// 数值列格式判定：同时检查 "固定小数位" 与 "最短表示" 两种还原方式
+struct NumericProbe {
+    bool fixedOk = true;
+    bool shortestOk = true;
+    int decimals = -1;
+};
+
+inline int decimalsOf(const QString& text)
+{
+    int dot = text.indexOf('.');
+    return dot < 0 ? 0 : text.size() - dot - 1;
+}
+
+void writeHeader(QByteArray& out, quint32 columnCount, quint64 rowCount, quint64 indexOffset, quint64 indexSize)
+{
+    out.resize(kHeaderSize);
+    char* p = out.data();
+    memcpy(p, kMagic, 4);
+    qToLittleEndian<quint16>(TableStore::kFormatVersion, p + 4);
+    qToLittleEndian<quint16>(0, p + 6);
+    qToLittleEndian<quint32>(columnCount, p + 8);
+    qToLittleEndian<quint64>(rowCount, p + 12);
+    qToLittleEndian<quint64>(indexOffset, p + 20);
+    qToLittleEndian<quint64>(indexSize, p + 28);
+}
+
+} // namespace
+
+TableStore::TableStore() : m_data(nullptr), m_size(0), m_rowCount(0) {}
+
+TableStore::~TableStore()
+{
+    close();
+}
+
+// ============================================================================
+// 写入
+// ============================================================================
+
+bool TableStore::writeModel(const QString& path, const QStandardItemModel* model,
+                            const WriteOptions& options, QString* error)
+{
+    if (!model) return false;
+    QStringList headers;
+    for (int c = 0; c < model->columnCount(); ++c) headers << model->headerData(c, Qt::Horizontal).toString();
+    return writeTable(path, headers, model->rowCount(), [model](int r, int c) {
+        QStandardItem* item = model->item(r, c);
+        return item ? item->text() : QString();
+    }, options, error);
+}
+
+bool TableStore::writeTable(const QString& path, const QStringList& headers, int rowCount,
+                            const std::function<QString(int row, int col)>& cell,
+                            const WriteOptions& options, QString* error)
+{
+    const int cols = headers.size();
+    const int rows = rowCount;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = "无法写入表格数据文件: " + file.errorString();
+        return false;
+    }
+
+    QByteArray header;
+    writeHeader(header, 0, 0, 0, 0); // 占位，写完列数据后回填
+    file.write(header);
+    quint64 offset = kHeaderSize;
+
+    QVector<ColumnEntry> entries;
+    entries.reserve(cols);
+
+    QStringList texts;
+    for (int c = 0; c < cols; ++c) {
+        ColumnEntry entry;
+        entry.name = headers.at(c);
+
+        // 1. 取出该列文本并判定类型
+        texts.clear();
+        texts.reserve(rows);
+        NumericProbe probe;
+        QVector<double> values(rows, std::numeric_limits<double>::quiet_NaN());
+        bool anyValue = false;
+        for (int r = 0; r < rows; ++r) {
+            QString t = cell(r, c);
+            texts.append(t);
+            if (t.isEmpty() || (!probe.fixedOk && !probe.shortestOk)) continue;
+            double v;
+            if (!TextDataImporter::parseDouble(t, v)) { probe.fixedOk = probe.shortestOk = false; continue; }
+            values[r] = v;
+            anyValue = true;
+            if (probe.fixedOk) {
+                if (probe.decimals < 0) probe.decimals = decimalsOf(t);
+                if (probe.decimals > 30 || QString::number(v, 'f', probe.decimals) != t) probe.fixedOk = false;
+            }
+            if (probe.shortestOk && QString::number(v, 'g', QLocale::FloatingPointShortest) != t) probe.shortestOk = false;
+        }
+
+        // 2. 编码列数据
+        QByteArray raw;
+        if (anyValue && (probe.fixedOk || probe.shortestOk)) {
+            entry.kind = probe.fixedOk ? Column_NumberFixed : Column_NumberShortest;
+            entry.decimals = probe.fixedOk ? quint8(probe.decimals) : 0;
+            raw.resize(rows * int(sizeof(double)));
+            char* p = raw.data();
+            for (int r = 0; r < rows; ++r) qToLittleEndian<double>(values[r], p + r * sizeof(double));
+        } else {
+            entry.kind = Column_Text;
+            QByteArray blob;
+            QVector<quint32> offsets(rows + 1);
+            offsets[0] = 0;
+            for (int r = 0; r < rows; ++r) {
+                blob += texts[r].toUtf8();
+                if (quint64(blob.size()) > std::numeric_limits<quint32>::max()) {
+                    if (error) *error = QString("第 %1 列文本数据超过 4GB，无法保存").arg(c + 1);
+                    file.cancelWriting();
+                    return false;
+                }
+                offsets[r + 1] = quint32(blob.size());
+            }
+            raw.resize((rows + 1) * int(sizeof(quint32)));
+            char* p = raw.data();
+            for (int r = 0; r <= rows; ++r) qToLittleEndian<quint32>(offsets[r], p + r * sizeof(quint32));
+            raw += blob;
+        }
+        values.clear();
+
+        // 3. 可选压缩，无收益时保留原始字节
+        entry.rawSize = quint64(raw.size());
+        QByteArray stored = raw;
+        if (options.compress && !raw.isEmpty()) {
+            QByteArray packed = qCompress(raw, options.compressionLevel);
+            if (packed.size() < raw.size() * 0.9) { stored = packed; entry.compressed = 1; }
+        }
+        entry.offset = offset;
+        entry.storedSize = quint64(stored.size());
+        if (file.write(stored) != stored.size()) {
+            if (error) *error = "写入表格数据失败: " + file.errorString();
+            file.cancelWriting();
+            return false;
+        }
+        offset += entry.storedSize;
+        entries.append(entry);
+    }
+
+    // 4. 列索引
+    QByteArray index;
+    {
+        QDataStream ds(&index, QIODevice::WriteOnly);
+        ds.setVersion(kIndexStreamVersion);
+        ds.setByteOrder(QDataStream::LittleEndian);
+        for (const ColumnEntry& e : entries) {
+            ds << e.name << e.kind << e.decimals << e.compressed
+               << e.offset << e.storedSize << e.rawSize;
+        }
+    }
+    file.write(index);
+
+    // 5. 回填文件头
+    writeHeader(header, quint32(cols), quint64(rows), offset, quint64(index.size()));
+    file.seek(0);
+    file.write(header);
+
+    if (!file.commit()) {
+        if (error) *error = "保存表格数据文件失败: " + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// 读取
+// ============================================================================
+
+bool TableStore::open(const QString& path, QString* error)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = "无法打开表格数据文件: " + m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size < kHeaderSize) {
+        if (error) *error = "表格数据文件已损坏";
+        close();
+        return false;
+    }
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        if (error) *error = "无法映射表格数据文件";
+        close();
+        return false;
+    }
+
+    const char* p = reinterpret_cast<const char*>(m_data);
+    quint16 version = qFromLittleEndian<quint16>(p + 4);
+    if (memcmp(p, kMagic, 4) != 0 || version > kFormatVersion) {
+        if (error) *error = QString("不支持的表格数据格式 (版本 %1)").arg(version);
+        close();
+        return false;
+    }
+    quint32 cols = qFromLittleEndian<quint32>(p + 8);
+    m_rowCount = qint64(qFromLittleEndian<quint64>(p + 12));
+    quint64 indexOffset = qFromLittleEndian<quint64>(p + 20);
+    quint64 indexSize = qFromLittleEndian<quint64>(p + 28);
+    if (indexOffset + indexSize > quint64(m_size)) {
+        if (error) *error = "表格数据文件索引已损坏";
+        close();
+        return false;
+    }
+
+    QByteArray index = QByteArray::fromRawData(p + indexOffset, int(indexSize));
+    QDataStream ds(index);
+    ds.setVersion(kIndexStreamVersion);
+    ds.setByteOrder(QDataStream::LittleEndian);
+    m_columns.resize(int(cols));
+    for (ColumnEntry& e : m_columns) {
+        ds >> e.name >> e.kind >> e.decimals >> e.compressed
+           >> e.offset >> e.storedSize >> e.rawSize;
+        if (ds.status() != QDataStream::Ok || e.offset + e.storedSize > indexOffset) {
+            if (error) *error = "表格数据文件索引已损坏";
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void TableStore::close()
+{
+    if (m_data) m_file.unmap(const_cast<uchar*>(m_data));
+    m_data = nullptr;
+    if (m_file.isOpen()) m_file.close();
+    m_size = 0;
+    m_rowCount = 0;
+    m_columns.clear();
+}
+
+QStringList TableStore::headers() const
+{
+    QStringList list;
+    for (const ColumnEntry& e : m_columns) list << e.name;
+    return list;
+}
+
+TableStore::ColumnKind TableStore::columnKind(int col) const
+{
+    if (col < 0 || col >= m_columns.size()) return Column_Text;
+    return ColumnKind(m_columns[col].kind);
+}
+
+QByteArray TableStore::columnBytes(int col) const
+{
+    if (!m_data || col < 0 || col >= m_columns.size()) return QByteArray();
+    const ColumnEntry& e = m_columns[col];
+    const char* p = reinterpret_cast<const char*>(m_data) + e.offset;
+    if (!e.compressed) return QByteArray::fromRawData(p, int(e.storedSize));
+    QByteArray raw = qUncompress(reinterpret_cast<const uchar*>(p), int(e.storedSize));
+    if (quint64(raw.size()) != e.rawSize) {
+        qDebug() << "表格数据列解压失败:" << e.name;
+        return QByteArray();
+    }
+    return raw;
+}
+
+QVector<double> TableStore::numericColumn(int col) const
+{
+    if (columnKind(col) == Column_Text) return QVector<double>();
+    QByteArray raw = columnBytes(col);
+    if (raw.size() < m_rowCount * qint64(sizeof(double))) return QVector<double>();
+    QVector<double> values(int(m_rowCount));
+    const char* p = raw.constData();
+    if (QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
+        memcpy(values.data(), p, size_t(m_rowCount) * sizeof(double));
+    } else {
+        for (int r = 0; r < values.size(); ++r) values[r] = qFromLittleEndian<double>(p + r * sizeof(double));
+    }
+    return values;
+}
+
+void TableStore::forEachCell(int col, const std::function<void(const QString& text)>& visit) const
+{
+    if (col < 0 || col >= m_columns.size()) return;
+    const ColumnEntry& e = m_columns[col];
+
+    if (e.kind != Column_Text) {
+        const QVector<double> values = numericColumn(col);
+        for (double v : values) {
+            if (std::isnan(v)) visit(QString());
+            else if (e.kind == Column_NumberFixed) visit(QString::number(v, 'f', e.decimals));
+            else visit(QString::number(v, 'g', QLocale::FloatingPointShortest));
+        }
+        return;
+    }
+
+    QByteArray raw = columnBytes(col);
+    const qint64 offsetBytes = (m_rowCount + 1) * qint64(sizeof(quint32));
+    if (raw.size() < offsetBytes) return;
+    const char* p = raw.constData();
+    const char* blob = p + offsetBytes;
+    const qint64 blobSize = raw.size() - offsetBytes;
+    for (qint64 r = 0; r < m_rowCount; ++r) {
+        quint32 b = qFromLittleEndian<quint32>(p + r * sizeof(quint32));
+        quint32 en = qFromLittleEndian<quint32>(p + (r + 1) * sizeof(quint32));
+        if (en < b || qint64(en) > blobSize) { visit(QString()); continue; }
+        visit(QString::fromUtf8(blob + b, int(en - b)));
+    }
+}
+
+QStringList TableStore::textColumn(int col) const
+{
+    QStringList out;
+    if (col < 0 || col >= m_columns.size()) return out;
+    out.reserve(int(m_rowCount));
+    forEachCell(col, [&out](const QString& text) { out.append(text); });
+    return out;
+}
+
+void TableStore::fillModel(QStandardItemModel* model) const
+{
+    if (!model) return;
+    model->clear();
+    const int rows = int(m_rowCount);
+    QList<QStandardItem*> items;
+    for (int c = 0; c < columnCount(); ++c) {
+        // 解码得到的文本直接生成单元格，整列一次插入 (列损坏时以空单元格补齐)
+        items.clear();
+        items.reserve(rows);
+        forEachCell(c, [&items](const QString& text) { items.append(new QStandardItem(text)); });
+        while (items.size() < rows) items.append(new QStandardItem());
+        model->appendColumn(items);
+    }
+    model->setHorizontalHeaderLabels(headers());
+}
@@ -0,0 +1,111 @@
+/*
+ * 文件名: tablestore.h
+ * 文件作用: 项目表格数据二进制列式存储头文件
+ * 功能描述:
+ * 1. 定义 "_date.wtd" 二进制列式文件格式 (带版本号)，替代逐行字符串的 _date.json。
+ * 2. 数值列以 double 存储并记录显示格式 (最短表示 / 固定小数位)，保证读回的文本与原表一致；其余列存为 UTF-8 文本。
+ * 3. 文件尾部为列索引 (列名、类型、偏移、大小)，打开时只读取索引，列数据在访问时才解码 (内存映射)。
+ * 4. 每列可选 zlib 压缩 (qCompress)，压缩无收益的列保持原样以便直接映射。
+ * 5. 编辑器使用的 QStandardItemModel 需要完整数据，fillModel 在打开项目时逐列解码全部列；
+ *    按需解码只用于 numericColumn / textColumn 等直接读取单列的场景。
+ *
+ * 文件布局:
+ *   [文件头 36 字节] magic "WTTB" | version u16 | reserved u16 | columnCount u32 | rowCount u64 | indexOffset u64 | indexSize u64
+ *   [列数据块 ...]
+ *   [列索引] (QDataStream Qt 6.0 格式, 小端) 每列: name(QString) kind(u8) decimals(u8) compressed(u8) offset(u64) storedSize(u64) rawSize(u64)
+ */
+
+#ifndef TABLESTORE_H
+#define TABLESTORE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QFile>
+#include <functional>
+
+class QStandardItemModel;
+
+class TableStore
+{
+public:
+    // 列存储类型
+    enum ColumnKind {
+        Column_Text = 0,          // UTF-8 文本：偏移表 (u32 × rowCount+1) + 字符数据
+        Column_NumberShortest = 1,// double，显示为最短精确表示
+        Column_NumberFixed = 2    // double，显示为固定小数位
+    };
+
+    // 写入选项
+    struct WriteOptions {
+        bool compress = true;     // 是否尝试压缩各列
+        int compressionLevel = 1; // zlib 压缩级别 (1 最快)
+    };
+
+    static const quint16 kFormatVersion = 1;
+
+    TableStore();
+    ~TableStore();
+
+    /**
+     * @brief 将数据模型按列写入二进制文件 (QSaveFile 原子替换)
+     * @param path 目标文件路径
+     * @param model 表格数据模型 (表头取 horizontalHeader)
+     * @param options 写入选项
+     * @param error 失败时的错误信息
+     */
+    static bool writeModel(const QString& path, const QStandardItemModel* model,
+                           const WriteOptions& options, QString* error = nullptr);
+
+    /**
+     * @brief 通用写入接口：按 (行, 列) 回调取单元格文本，供日志压缩等不经过模型的场景使用
+     */
+    static bool writeTable(const QString& path, const QStringList& headers, int rowCount,
+                           const std::function<QString(int row, int col)>& cell,
+                           const WriteOptions& options, QString* error = nullptr);
+
+    // 打开文件：映射文件并读取列索引，不解码任何列数据
+    bool open(const QString& path, QString* error = nullptr);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    QString filePath() const { return m_file.fileName(); }
+
+    qint64 rowCount() const { return m_rowCount; }
+    int columnCount() const { return m_columns.size(); }
+    QStringList headers() const;
+    ColumnKind columnKind(int col) const;
+
+    // 读取数值列 (文本列返回空)，空单元格为 NaN
+    QVector<double> numericColumn(int col) const;
+    // 读取任意列的显示文本
+    QStringList textColumn(int col) const;
+
+    // 将全部数据填入模型 (逐列解码后整列插入)
+    void fillModel(QStandardItemModel* model) const;
+
+private:
+    struct ColumnEntry {
+        QString name;
+        quint8 kind = Column_Text;
+        quint8 decimals = 0;
+        quint8 compressed = 0;
+        quint64 offset = 0;
+        quint64 storedSize = 0;
+        quint64 rawSize = 0;
+    };
+
+    // 取得列的原始 (解压后) 字节；未压缩时直接引用映射内存
+    QByteArray columnBytes(int col) const;
+    // 按行依次回调单列的显示文本
+    void forEachCell(int col, const std::function<void(const QString& text)>& visit) const;
+
+    QFile m_file;
+    const uchar* m_data;
+    qint64 m_size;
+    qint64 m_rowCount;
+    QVector<ColumnEntry> m_columns;
+
+    Q_DISABLE_COPY(TableStore)
+};
+
+#endif // TABLESTORE_H
@@ -0,0 +1,327 @@
+/*
+ * 文件名: tableundocommands.cpp
+ * 文件作用: 数据编辑器撤销/重做命令实现文件
+ * 功能描述:
+ * 1. 行/列的删除与恢复按连续区间批量进行，整列恢复通过 insertColumn 一次插入。
+ * 2. 单元格修改只保存变化的单元格 (行、列、旧文本、新文本)。
+ * 3. 被删除的行按连续区间一次 insertRows 恢复，再逐格填入文本。
+ */
+
+#include "tableundocommands.h"
+#include <QTableView>
+#include <QSortFilterProxyModel>
+#include <algorithm>
+
+// ============================================================================
+// TextBlock / ColumnBuffer
+// ============================================================================
+
+void TextBlock::append(const QString& text)
+{
+    m_data.append(text);
+    m_offsets.append(m_data.size());
+}
+
+QString TextBlock::text(int i) const
+{
+    if (i < 0 || i >= size()) return QString();
+    return m_data.mid(m_offsets[i], m_offsets[i + 1] - m_offsets[i]);
+}
+
+ColumnBuffer ColumnBuffer::capture(const QStandardItemModel* model, int col, const QList<ColumnDefinition>* defs)
+{
+    ColumnBuffer b;
+    b.header = model->headerData(col, Qt::Horizontal).toString();
+    if (defs && col < defs->size()) b.definition = defs->at(col);
+    else b.definition.name = b.header;
+    const int rows = model->rowCount();
+    for (int r = 0; r < rows; ++r) {
+        QStandardItem* item = model->item(r, col);
+        b.cells.append(item ? item->text() : QString());
+    }
+    return b;
+}
+
+QList<QStandardItem*> ColumnBuffer::createItems(int rowCount) const
+{
+    QList<QStandardItem*> items;
+    items.reserve(rowCount);
+    for (int r = 0; r < rowCount; ++r) items.append(new QStandardItem(cells.text(r)));
+    return items;
+}
+
+// ============================================================================
+// TableUndoCommand
+// ============================================================================
+
+TableUndoCommand::TableUndoCommand(QStandardItemModel* model, QList<ColumnDefinition>* defs, const QString& text,
+                                   bool alreadyApplied, QUndoCommand* parent)
+    : QUndoCommand(text, parent), m_model(model), m_defs(defs), m_skipRedo(alreadyApplied)
+{
+}
+
+void TableUndoCommand::redo()
+{
+    if (m_skipRedo) {
+        m_skipRedo = false;
+        return;
+    }
+    apply();
+}
+
+void TableUndoCommand::undo()
+{
+    revert();
+}
+
+qint64 TableUndoCommand::byteSize() const
+{
+    qint64 total = 0;
+    for (int i = 0; i < childCount(); ++i) {
+        if (auto c = dynamic_cast<const TableUndoCommand*>(child(i))) total += c->byteSize();
+    }
+    return total;
+}
+
+// ============================================================================
+// CellEditCommand
+// ============================================================================
+
+CellEditCommand::CellEditCommand(QStandardItemModel* model, const QVector<CellDiff>& diffs, const QString& text,
+                                 bool alreadyApplied, QUndoCommand* parent)
+    : TableUndoCommand(model, nullptr, text, alreadyApplied, parent), m_diffs(diffs)
+{
+}
+
+qint64 CellEditCommand::byteSize() const
+{
+    qint64 total = 0;
+    for (const CellDiff& d : m_diffs) total += 16 + (d.before.size() + d.after.size()) * 2;
+    return total;
+}
+
+void CellEditCommand::setCells(bool after)
+{
+    for (const CellDiff& d : m_diffs) {
+        const QString& text = after ? d.after : d.before;
+        QStandardItem* item = m_model->item(d.row, d.col);
+        if (item) item->setText(text);
+        else m_model->setItem(d.row, d.col, new QStandardItem(text));
+    }
+}
+
+void CellEditCommand::apply() { setCells(true); }
+void CellEditCommand::revert() { setCells(false); }
+
+// ============================================================================
+// 行操作
+// ============================================================================
+
+InsertRowsCommand::InsertRowsCommand(QStandardItemModel* model, int row, int count)
+    : TableUndoCommand(model, nullptr, "插入行", false), m_row(row), m_count(count)
+{
+}
+
+void InsertRowsCommand::apply()
+{
+    for (int i = 0; i < m_count; ++i) {
+        QList<QStandardItem*> items;
+        for (int c = 0; c < m_model->columnCount(); ++c) items << new QStandardItem("");
+        m_model->insertRow(m_row + i, items);
+    }
+}
+
+void InsertRowsCommand::revert()
+{
+    m_model->removeRows(m_row, m_count);
+}
+
+RemoveRowsCommand::RemoveRowsCommand(QStandardItemModel* model, const QList<int>& rows)
+    : TableUndoCommand(model, nullptr, "删除行", false), m_columnCount(model->columnCount())
+{
+    for (int r : rows) if (r >= 0 && r < model->rowCount()) m_rows.append(r);
+    std::sort(m_rows.begin(), m_rows.end());
+    m_rows.erase(std::unique(m_rows.begin(), m_rows.end()), m_rows.end());
+
+    for (int r : std::as_const(m_rows)) {
+        for (int c = 0; c < m_columnCount; ++c) {
+            QStandardItem* item = model->item(r, c);
+            m_cells.append(item ? item->text() : QString());
+        }
+    }
+    setText(QString("删除 %1 行").arg(m_rows.size()));
+}
+
+void RemoveRowsCommand::apply()
+{
+    // 从后往前按连续区间删除
+    int i = m_rows.size() - 1;
+    while (i >= 0) {
+        int end = m_rows[i];
+        int start = end;
+        while (i > 0 && m_rows[i - 1] == start - 1) { --i; --start; }
+        m_model->removeRows(start, end - start + 1);
+        --i;
+    }
+}
+
+void RemoveRowsCommand::revert()
+{
+    // 从前往后按连续区间恢复，区间起点即原行号
+    int i = 0;
+    while (i < m_rows.size()) {
+        const int start = m_rows[i];
+        int count = 1;
+        while (i + count < m_rows.size() && m_rows[i + count] == start + count) ++count;
+        m_model->insertRows(start, count);
+        for (int k = 0; k < count; ++k) {
+            for (int c = 0; c < m_columnCount; ++c)
+                m_model->setItem(start + k, c, new QStandardItem(m_cells.text((i + k) * m_columnCount + c)));
+        }
+        i += count;
+    }
+}
+
+// ============================================================================
+// 列操作
+// ============================================================================
+
+InsertColumnCommand::InsertColumnCommand(QStandardItemModel* model, QList<ColumnDefinition>* defs, int col,
+                                         const ColumnBuffer& buffer, const QString& text, bool alreadyApplied,
+                                         QUndoCommand* parent)
+    : TableUndoCommand(model, defs, text, alreadyApplied, parent), m_col(col), m_buffer(buffer)
+{
+}
+
+void InsertColumnCommand::apply()
+{
+    m_model->insertColumn(m_col, m_buffer.createItems(m_model->rowCount()));
+    m_model->setHorizontalHeaderItem(m_col, new QStandardItem(m_buffer.header));
+    if (m_defs) {
+        if (m_col < m_defs->size()) m_defs->insert(m_col, m_buffer.definition);
+        else m_defs->append(m_buffer.definition);
+    }
+}
+
+void InsertColumnCommand::revert()
+{
+    m_model->removeColumn(m_col);
+    if (m_defs && m_col < m_defs->size()) m_defs->removeAt(m_col);
+}
+
+RemoveColumnsCommand::RemoveColumnsCommand(QStandardItemModel* model, QList<ColumnDefinition>* defs, const QList<int>& cols)
+    : TableUndoCommand(model, defs, "删除列", false)
+{
+    for (int c : cols) if (c >= 0 && c < model->columnCount()) m_cols.append(c);
+    std::sort(m_cols.begin(), m_cols.end());
+    m_cols.erase(std::unique(m_cols.begin(), m_cols.end()), m_cols.end());
+    for (int c : std::as_const(m_cols)) m_buffers.append(ColumnBuffer::capture(model, c, defs));
+    setText(QString("删除 %1 列").arg(m_cols.size()));
+}
+
+qint64 RemoveColumnsCommand::byteSize() const
+{
+    qint64 total = 0;
+    for (const ColumnBuffer& b : m_buffers) total += b.byteSize();
+    return total;
+}
+
+void RemoveColumnsCommand::apply()
+{
+    for (int i = m_cols.size() - 1; i >= 0; --i) {
+        m_model->removeColumn(m_cols[i]);
+        if (m_defs && m_cols[i] < m_defs->size()) m_defs->removeAt(m_cols[i]);
+    }
+}
+
+void RemoveColumnsCommand::revert()
+{
+    for (int i = 0; i < m_cols.size(); ++i) {
+        const int c = m_cols[i];
+        m_model->insertColumn(c, m_buffers[i].createItems(m_model->rowCount()));
+        m_model->setHorizontalHeaderItem(c, new QStandardItem(m_buffers[i].header));
+        if (m_defs) {
+            if (c < m_defs->size()) m_defs->insert(c, m_buffers[i].definition);
+            else m_defs->append(m_buffers[i].definition);
+        }
+    }
+}
+
+ReplaceColumnCommand::ReplaceColumnCommand(QStandardItemModel* model, QList<ColumnDefinition>* defs, int col,
+                                           const ColumnBuffer& before, const ColumnBuffer& after,
+                                           const QString& text, bool alreadyApplied, QUndoCommand* parent)
+    : TableUndoCommand(model, defs, text, alreadyApplied, parent), m_col(col), m_before(before), m_after(after)
+{
+}
+
+void ReplaceColumnCommand::setColumn(const ColumnBuffer& buffer)
+{
+    qDeleteAll(m_model->takeColumn(m_col));
+    m_model->insertColumn(m_col, buffer.createItems(m_model->rowCount()));
+    m_model->setHorizontalHeaderItem(m_col, new QStandardItem(buffer.header));
+    if (m_defs && m_col < m_defs->size()) (*m_defs)[m_col] = buffer.definition;
+}
+
+void ReplaceColumnCommand::apply() { setColumn(m_after); }
+void ReplaceColumnCommand::revert() { setColumn(m_before); }
+
+ColumnDefinitionsCommand::ColumnDefinitionsCommand(QStandardItemModel* model, QList<ColumnDefinition>* defs,
+                                                   const QList<ColumnDefinition>& before,
+                                                   const QList<ColumnDefinition>& after)
+    : TableUndoCommand(model, defs, "定义列", true), m_before(before), m_after(after)
+{
+}
+
+void ColumnDefinitionsCommand::setDefinitions(const QList<ColumnDefinition>& defs)
+{
+    *m_defs = defs;
+    for (int i = 0; i < defs.size() && i < m_model->columnCount(); ++i) {
+        m_model->setHeaderData(i, Qt::Horizontal, defs[i].name);
+    }
+}
+
+void ColumnDefinitionsCommand::apply() { setDefinitions(m_after); }
+void ColumnDefinitionsCommand::revert() { setDefinitions(m_before); }
+
+ComputedColumnsCommand::ComputedColumnsCommand(QList<ComputedColumnState>* states,
+                                               const QList<ComputedColumnState>& before,
+                                               const QList<ComputedColumnState>& after,
+                                               std::function<void()> changed, QUndoCommand* parent)
+    : TableUndoCommand(nullptr, nullptr, "计算列定义", false, parent),
+    m_states(states), m_before(before), m_after(after), m_changed(std::move(changed))
+{
+}
+
+void ComputedColumnsCommand::setStates(const QList<ComputedColumnState>& states)
+{
+    *m_states = states;
+    if (m_changed) m_changed();
+}
+
+void ComputedColumnsCommand::apply() { setStates(m_after); }
+void ComputedColumnsCommand::revert() { setStates(m_before); }
+
+// ============================================================================
+// 视图操作
+// ============================================================================
+
+SortCommand::SortCommand(QSortFilterProxyModel* proxy, int oldColumn, Qt::SortOrder oldOrder,
+                         int newColumn, Qt::SortOrder newOrder)
+    : TableUndoCommand(nullptr, nullptr, "排序", false), m_proxy(proxy),
+    m_oldColumn(oldColumn), m_newColumn(newColumn), m_oldOrder(oldOrder), m_newOrder(newOrder)
+{
+}
+
+void SortCommand::apply() { m_proxy->sort(m_newColumn, m_newOrder); }
+void SortCommand::revert() { m_proxy->sort(m_oldColumn, m_oldOrder); }
+
+SpanCommand::SpanCommand(QTableView* view, int row, int col, int oldRowSpan, int oldColSpan,
+                         int newRowSpan, int newColSpan)
+    : TableUndoCommand(nullptr, nullptr, newRowSpan * newColSpan > 1 ? "合并单元格" : "取消合并", false),
+    m_view(view), m_row(row), m_col(col),
+    m_oldRowSpan(oldRowSpan), m_oldColSpan(oldColSpan), m_newRowSpan(newRowSpan), m_newColSpan(newColSpan)
+{
+}
+
+void SpanCommand::apply() { m_view->setSpan(m_row, m_col, m_newRowSpan, m_newColSpan); }
+void SpanCommand::revert() { m_view->setSpan(m_row, m_col, m_oldRowSpan, m_oldColSpan); }
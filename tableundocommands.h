@@ -0,0 +1,265 @@
+/*
+ * 文件名: tableundocommands.h
+ * 文件作用: 数据编辑器撤销/重做命令头文件
+ * 功能描述:
+ * 1. 定义紧凑的文本缓冲 TextBlock：所有单元格文本首尾相接存入一个字符串，另存偏移表，
+ *    避免为被删除的行/列保留成千上万个 QStandardItem。
+ * 2. 各编辑操作对应的 QUndoCommand：单元格修改 (稀疏差异)、行插入/删除、列插入/删除/替换、
+ *    列定义修改、视图排序与合并单元格。
+ * 3. 计算类操作 (时间转换、压降、流压、计算列) 执行后以 "已执行" 方式入栈，首次 redo 不重复执行。
+ * 4. 每条命令报告自身占用的字节数，由 DataEditorWidget 控制撤销栈的总内存。
+ * 5. 计算列定义的增删与结果列的插入/替换组合为一条命令，撤销时一并恢复。
+ */
+
+#ifndef TABLEUNDOCOMMANDS_H
+#define TABLEUNDOCOMMANDS_H
+
+#include <QUndoCommand>
+#include <QStandardItemModel>
+#include <QVector>
+#include <QList>
+#include <functional>
+#include "dataeditorwidget.h" // ColumnDefinition, ComputedColumnState
+
+class QTableView;
+class QSortFilterProxyModel;
+
+// 紧凑文本缓冲
+class TextBlock
+{
+public:
+    TextBlock() { m_offsets.append(0); }
+    void append(const QString& text);
+    int size() const { return m_offsets.size() - 1; }
+    QString text(int i) const;
+    qint64 byteSize() const { return m_data.size() * qint64(sizeof(QChar)) + m_offsets.size() * qint64(sizeof(qint32)); }
+
+private:
+    QString m_data;
+    QVector<qint32> m_offsets;
+};
+
+// 一整列的内容 (表头、列定义与全部单元格文本)
+struct ColumnBuffer {
+    QString header;
+    ColumnDefinition definition;
+    TextBlock cells;
+
+    static ColumnBuffer capture(const QStandardItemModel* model, int col, const QList<ColumnDefinition>* defs);
+    QList<QStandardItem*> createItems(int rowCount) const;
+    qint64 byteSize() const { return cells.byteSize() + header.size() * 2 + 64; }
+};
+
+// 单元格差异
+struct CellDiff {
+    int row;
+    int col;
+    QString before;
+    QString after;
+};
+
+// ============================================================================
+// 命令基类
+// ============================================================================
+class TableUndoCommand : public QUndoCommand
+{
+public:
+    /**
+     * @param alreadyApplied 为 true 表示操作已在入栈前执行，首次 redo 跳过
+     */
+    TableUndoCommand(QStandardItemModel* model, QList<ColumnDefinition>* defs, const QString& text,
+                     bool alreadyApplied, QUndoCommand* parent = nullptr);
+
+    void redo() override;
+    void undo() override;
+
+    bool alreadyApplied() const { return m_skipRedo; }
+    // 命令 (含子命令) 占用的内存估计
+    virtual qint64 byteSize() const;
+
+protected:
+    // 默认实现执行子命令 (用作组合命令)
+    virtual void apply() { QUndoCommand::redo(); }
+    virtual void revert() { QUndoCommand::undo(); }
+
+    QStandardItemModel* m_model;
+    QList<ColumnDefinition>* m_defs;
+
+private:
+    bool m_skipRedo;
+};
+
+// 单元格修改 (稀疏差异)
+class CellEditCommand : public TableUndoCommand
+{
+public:
+    CellEditCommand(QStandardItemModel* model, const QVector<CellDiff>& diffs, const QString& text,
+                    bool alreadyApplied, QUndoCommand* parent = nullptr);
+    qint64 byteSize() const override;
+
+protected:
+    void apply() override;
+    void revert() override;
+
+private:
+    void setCells(bool after);
+    QVector<CellDiff> m_diffs;
+};
+
+// 插入空行
+class InsertRowsCommand : public TableUndoCommand
+{
+public:
+    InsertRowsCommand(QStandardItemModel* model, int row, int count);
+
+protected:
+    void apply() override;
+    void revert() override;
+
+private:
+    int m_row;
+    int m_count;
+};
+
+// 删除行 (保存被删行的内容)
+class RemoveRowsCommand : public TableUndoCommand
+{
+public:
+    RemoveRowsCommand(QStandardItemModel* model, const QList<int>& rows);
+    qint64 byteSize() const override { return m_cells.byteSize() + m_rows.size() * 4; }
+
+protected:
+    void apply() override;
+    void revert() override;
+
+private:
+    QVector<int> m_rows;    // 升序
+    int m_columnCount;
+    TextBlock m_cells;      // 按行依次存放
+};
+
+// 插入整列 (新增列、计算结果列、分列结果)
+class InsertColumnCommand : public TableUndoCommand
+{
+public:
+    InsertColumnCommand(QStandardItemModel* model, QList<ColumnDefinition>* defs, int col,
+                        const ColumnBuffer& buffer, const QString& text, bool alreadyApplied,
+                        QUndoCommand* parent = nullptr);
+    qint64 byteSize() const override { return m_buffer.byteSize(); }
+
+protected:
+    void apply() override;
+    void revert() override;
+
+private:
+    int m_col;
+    ColumnBuffer m_buffer;
+};
+
+// 删除多列
+class RemoveColumnsCommand : public TableUndoCommand
+{
+public:
+    RemoveColumnsCommand(QStandardItemModel* model, QList<ColumnDefinition>* defs, const QList<int>& cols);
+    qint64 byteSize() const override;
+
+protected:
+    void apply() override;
+    void revert() override;
+
+private:
+    QVector<int> m_cols;            // 升序
+    QVector<ColumnBuffer> m_buffers;
+};
+
+// 整列内容替换 (计算列覆盖已有列)
+class ReplaceColumnCommand : public TableUndoCommand
+{
+public:
+    ReplaceColumnCommand(QStandardItemModel* model, QList<ColumnDefinition>* defs, int col,
+                         const ColumnBuffer& before, const ColumnBuffer& after, const QString& text,
+                         bool alreadyApplied, QUndoCommand* parent = nullptr);
+    qint64 byteSize() const override { return m_before.byteSize() + m_after.byteSize(); }
+
+protected:
+    void apply() override;
+    void revert() override;
+
+private:
+    void setColumn(const ColumnBuffer& buffer);
+    int m_col;
+    ColumnBuffer m_before;
+    ColumnBuffer m_after;
+};
+
+// 列定义 (名称、类型、单位) 修改
+class ColumnDefinitionsCommand : public TableUndoCommand
+{
+public:
+    ColumnDefinitionsCommand(QStandardItemModel* model, QList<ColumnDefinition>* defs,
+                             const QList<ColumnDefinition>& before, const QList<ColumnDefinition>& after);
+
+protected:
+    void apply() override;
+    void revert() override;
+
+private:
+    void setDefinitions(const QList<ColumnDefinition>& defs);
+    QList<ColumnDefinition> m_before;
+    QList<ColumnDefinition> m_after;
+};
+
+// 计算列定义列表替换 (changed 在每次替换后调用，用于标记重新绑定并保存到项目)
+class ComputedColumnsCommand : public TableUndoCommand
+{
+public:
+    ComputedColumnsCommand(QList<ComputedColumnState>* states, const QList<ComputedColumnState>& before,
+                           const QList<ComputedColumnState>& after, std::function<void()> changed,
+                           QUndoCommand* parent = nullptr);
+
+protected:
+    void apply() override;
+    void revert() override;
+
+private:
+    void setStates(const QList<ComputedColumnState>& states);
+    QList<ComputedColumnState>* m_states;
+    QList<ComputedColumnState> m_before;
+    QList<ComputedColumnState> m_after;
+    std::function<void()> m_changed;
+};
+
+// 视图排序 (排序只作用于代理模型，撤销时恢复原排序列与顺序，-1 为原始顺序)
+class SortCommand : public TableUndoCommand
+{
+public:
+    SortCommand(QSortFilterProxyModel* proxy, int oldColumn, Qt::SortOrder oldOrder,
+                int newColumn, Qt::SortOrder newOrder);
+
+protected:
+    void apply() override;
+    void revert() override;
+
+private:
+    QSortFilterProxyModel* m_proxy;
+    int m_oldColumn, m_newColumn;
+    Qt::SortOrder m_oldOrder, m_newOrder;
+};
+
+// 合并/取消合并单元格
+class SpanCommand : public TableUndoCommand
+{
+public:
+    SpanCommand(QTableView* view, int row, int col, int oldRowSpan, int oldColSpan, int newRowSpan, int newColSpan);
+
+protected:
+    void apply() override;
+    void revert() override;
+
+private:
+    QTableView* m_view;
+    int m_row, m_col;
+    int m_oldRowSpan, m_oldColSpan, m_newRowSpan, m_newColSpan;
+};
+
+#endif // TABLEUNDOCOMMANDS_H
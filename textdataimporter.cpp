@@ -0,0 +1,498 @@
+/*
+ * 文件名: textdataimporter.cpp
+ * 文件作用: 文本数据 (CSV/TXT) 高速导入器实现文件
+ * 功能描述:
+ * 1. 使用 QFile::map 内存映射整个文件，避免逐行 QTextStream 读取的拷贝开销。
+ * 2. 起始行/表头行之前的前导行串行处理，正文按换行符对齐切块后由 QtConcurrent 并行解析。
+ * 3. 分隔符均为 ASCII 字符，在 UTF-8/GBK 下不会出现在多字节序列中，因此先按字节切分再逐字段解码。
+ * 4. 实现与区域设置无关的快速浮点数解析，用于分隔符识别和数值列判定。
+ * 注意: 引号内的换行不支持 (试井仪表导出数据中不会出现)。
+ */
+
+#include "textdataimporter.h"
+
+#include <QFile>
+#include <QMap>
+#include <QTextCodec>
+#include <QThread>
+#include <QFuture>
+#include <QtConcurrent>
+#include <QDebug>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+// 文本编码类型
+enum class TextEncoding { Utf8, Gbk, System, Latin1 };
+
+// 单个分块的解析结果
+struct ChunkResult {
+    QVector<QStringList> rows;
+    QVector<bool> numeric;  // 列是否全部为数值
+    QVector<bool> seen;     // 列是否出现过非空值
+};
+
+// 并行切块的最小字节数，小文件直接串行处理
+const qint64 kMinChunkBytes = 1 << 20;
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+// 解码单个字段，纯 ASCII 字段直接走 Latin1 快速路径
+QString decodeField(const char* b, int len, TextEncoding enc, QTextCodec* codec)
+{
+    bool ascii = true;
+    for (int i = 0; i < len; ++i) {
+        if (static_cast<unsigned char>(b[i]) >= 0x80) { ascii = false; break; }
+    }
+    if (ascii || enc == TextEncoding::Latin1) return QString::fromLatin1(b, len);
+    switch (enc) {
+    case TextEncoding::Utf8:   return QString::fromUtf8(b, len);
+    case TextEncoding::Gbk:    return codec ? codec->toUnicode(b, len) : QString::fromLocal8Bit(b, len);
+    case TextEncoding::System: return QString::fromLocal8Bit(b, len);
+    default:                   return QString::fromLatin1(b, len);
+    }
+}
+
+// 按分隔符切分一行 (字节级，支持双引号包裹与 "" 转义；空格分隔时连续空格视为一个)
+// 回调参数为去除首尾空白和引号后的字段字节
+template <typename Func>
+void splitLine(const char* b, const char* e, char sep, Func onField)
+{
+    const bool collapse = (sep == ' ');
+    const char* p = b;
+    if (collapse) { while (p < e && *p == ' ') ++p; if (p == e) return; }
+
+    QByteArray unescaped;
+    while (true) {
+        const char* fs = p;
+        bool quoted = false;
+        bool hasEscape = false;
+        // 跳过字段前导空白以判断是否为引号字段
+        const char* q = fs;
+        while (q < e && (*q == ' ' || *q == '\t') && *q != sep) ++q;
+        if (q < e && *q == '"') {
+            quoted = true;
+            p = q + 1;
+            while (p < e) {
+                if (*p == '"') {
+                    if (p + 1 < e && p[1] == '"') { hasEscape = true; p += 2; continue; }
+                    break;
+                }
+                ++p;
+            }
+            const char* qs = q + 1;
+            const char* qe = p;
+            if (p < e) ++p; // 跳过闭合引号
+            while (p < e && *p != sep) ++p;
+            if (hasEscape) {
+                unescaped.clear();
+                for (const char* c = qs; c < qe; ++c) {
+                    unescaped.append(*c);
+                    if (*c == '"' && c + 1 < qe && c[1] == '"') ++c;
+                }
+                onField(unescaped.constData(), unescaped.constData() + unescaped.size());
+            } else {
+                onField(qs, qe);
+            }
+        }
+        if (!quoted) {
+            while (p < e && *p != sep) ++p;
+            const char* fb = fs; const char* fe = p;
+            while (fb < fe && isBlank(*fb)) ++fb;
+            while (fe > fb && isBlank(fe[-1])) --fe;
+            onField(fb, fe);
+        }
+        if (p >= e) break;
+        ++p; // 跳过分隔符
+        if (collapse) {
+            while (p < e && *p == ' ') ++p;
+            if (p >= e) break;
+        }
+    }
+}
+
+// 取下一行 [lineBegin, lineEnd)，返回下一行起始位置
+inline const char* nextLine(const char* p, const char* end, const char*& lineEnd)
+{
+    const char* nl = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+    lineEnd = nl ? nl : end;
+    const char* next = nl ? nl + 1 : end;
+    if (lineEnd > p && lineEnd[-1] == '\r') --lineEnd;
+    return next;
+}
+
+inline bool isEmptyLine(const char* b, const char* e)
+{
+    for (const char* p = b; p < e; ++p) if (!isBlank(*p)) return false;
+    return true;
+}
+
+// 解析一行为字段列表，同时更新数值列统计
+QStringList parseLine(const char* b, const char* e, char sep, TextEncoding enc, QTextCodec* codec,
+                      QVector<bool>* numeric, QVector<bool>* seen)
+{
+    QStringList fields;
+    splitLine(b, e, sep, [&](const char* fb, const char* fe) {
+        int col = fields.size();
+        fields.append(decodeField(fb, static_cast<int>(fe - fb), enc, codec));
+        if (numeric && fe > fb) {
+            if (col >= numeric->size()) { numeric->resize(col + 1); seen->resize(col + 1); }
+            double v;
+            bool isNum = TextDataImporter::parseDouble(fb, fe, v);
+            if (!(*seen)[col]) { (*seen)[col] = true; (*numeric)[col] = isNum; }
+            else if (!isNum) (*numeric)[col] = false;
+        }
+    });
+    return fields;
+}
+
+// 解析一个行对齐的分块，maxRows < 0 表示不限制
+// 每 4096 行上报一次进度并检查取消标记
+ChunkResult parseChunk(const char* b, const char* e, char sep, TextEncoding enc, QTextCodec* codec, int maxRows,
+                       ImportControl* control)
+{
+    ChunkResult res;
+    const char* p = b;
+    const char* reported = b;
+    int lines = 0;
+    while (p < e) {
+        if (maxRows >= 0 && res.rows.size() >= maxRows) break;
+        if (control && (++lines & 4095) == 0) {
+            control->processed += (p - reported);
+            reported = p;
+            if (control->cancelled) break;
+        }
+        const char* le;
+        const char* next = nextLine(p, e, le);
+        if (!isEmptyLine(p, le)) res.rows.append(parseLine(p, le, sep, enc, codec, &res.numeric, &res.seen));
+        p = next;
+    }
+    if (control) control->processed += (p - reported);
+    return res;
+}
+
+void mergeNumericFlags(ImportedTable& table, QVector<bool>& seenAll, const ChunkResult& chunk)
+{
+    if (chunk.numeric.size() > table.numericColumns.size()) {
+        int old = table.numericColumns.size();
+        table.numericColumns.resize(chunk.numeric.size());
+        seenAll.resize(chunk.numeric.size());
+        for (int i = old; i < table.numericColumns.size(); ++i) table.numericColumns[i] = true;
+    }
+    for (int c = 0; c < chunk.numeric.size(); ++c) {
+        if (!chunk.seen[c]) continue;
+        seenAll[c] = true;
+        if (!chunk.numeric[c]) table.numericColumns[c] = false;
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// 快速浮点数解析
+// ============================================================================
+
+bool TextDataImporter::parseDouble(const char* begin, const char* end, double& value)
+{
+    static const double kPow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* p = begin;
+    while (p < end && isBlank(*p)) ++p;
+    while (end > p && isBlank(end[-1])) --end;
+    if (p == end) return false;
+
+    const char* start = p;
+    bool negative = false;
+    if (*p == '+' || *p == '-') { negative = (*p == '-'); ++p; }
+
+    uint64_t mantissa = 0;
+    int digits = 0;        // 有效数字位数
+    int exp10 = 0;
+    bool anyDigit = false;
+
+    while (p < end && *p >= '0' && *p <= '9') {
+        anyDigit = true;
+        if (mantissa == 0 && *p == '0') { ++p; continue; }
+        if (digits < 19) { mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0'); ++digits; }
+        else ++exp10;
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            anyDigit = true;
+            if (mantissa == 0 && *p == '0') { --exp10; ++p; continue; }
+            if (digits < 19) { mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0'); ++digits; --exp10; }
+            ++p;
+        }
+    }
+    if (!anyDigit) return false;
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool expNeg = false;
+        if (p < end && (*p == '+' || *p == '-')) { expNeg = (*p == '-'); ++p; }
+        if (p == end || *p < '0' || *p > '9') return false;
+        int e = 0;
+        while (p < end && *p >= '0' && *p <= '9') { if (e < 100000) e = e * 10 + (*p - '0'); ++p; }
+        exp10 += expNeg ? -e : e;
+    }
+    if (p != end) return false;
+
+    // Clinger 快速路径：尾数可精确表示且 10 的幂在表内时结果精确
+    if (mantissa == 0) { value = negative ? -0.0 : 0.0; return true; }
+    if (digits <= 15 && exp10 >= -22 && exp10 <= 22) {
+        double v = static_cast<double>(mantissa);
+        v = (exp10 < 0) ? v / kPow10[-exp10] : v * kPow10[exp10];
+        value = negative ? -v : v;
+        return true;
+    }
+
+    // 其余情况交给 Qt 的 C 区域解析以保证精度
+    bool ok = false;
+    value = QByteArray::fromRawData(start, static_cast<int>(end - start)).toDouble(&ok);
+    return ok;
+}
+
+bool TextDataImporter::parseDouble(const QString& text, double& value)
+{
+    QByteArray latin = text.toLatin1();
+    return parseDouble(latin.constData(), latin.constData() + latin.size(), value);
+}
+
+// ============================================================================
+// 编码与分隔符识别
+// ============================================================================
+
+QString TextDataImporter::detectEncoding(const QByteArray& sample)
+{
+    if (sample.startsWith("\xEF\xBB\xBF")) return "UTF-8";
+
+    // UTF-8 合法性校验，样本末尾被截断的多字节序列不视为错误
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(sample.constData());
+    const unsigned char* e = p + sample.size();
+    while (p < e) {
+        unsigned char c = *p;
+        int len = 0;
+        if (c < 0x80) { ++p; continue; }
+        else if ((c & 0xE0) == 0xC0 && c >= 0xC2) len = 1;
+        else if ((c & 0xF0) == 0xE0) len = 2;
+        else if ((c & 0xF8) == 0xF0 && c <= 0xF4) len = 3;
+        else return "GBK";
+        if (e - p - 1 < len) break;
+        for (int i = 1; i <= len; ++i) {
+            if ((p[i] & 0xC0) != 0x80) return "GBK";
+        }
+        p += len + 1;
+    }
+    return "UTF-8";
+}
+
+QChar TextDataImporter::detectSeparator(const QByteArray& sample)
+{
+    const char candidates[] = { '\t', ',', ';', ' ' };
+    const char* p = sample.constData();
+    const char* end = p + sample.size();
+
+    // 取样本中最多 20 个非空行
+    QVector<QPair<const char*, const char*>> lines;
+    while (p < end && lines.size() < 20) {
+        const char* le;
+        const char* next = nextLine(p, end, le);
+        if (!isEmptyLine(p, le)) lines.append(qMakePair(p, le));
+        p = next;
+    }
+    if (lines.isEmpty()) return ',';
+
+    char best = 0;
+    int bestFreq = 0, bestCols = 0;
+    for (char sep : candidates) {
+        // 空格只有在其他分隔符都无效时才采用
+        if (sep == ' ' && best != 0) break;
+        QMap<int, int> hist;
+        for (const auto& ln : lines) {
+            int n = 0;
+            splitLine(ln.first, ln.second, sep, [&](const char*, const char*) { ++n; });
+            hist[n]++;
+        }
+        int modeCols = 0, modeFreq = 0;
+        for (auto it = hist.constBegin(); it != hist.constEnd(); ++it) {
+            if (it.value() > modeFreq || (it.value() == modeFreq && it.key() > modeCols)) {
+                modeFreq = it.value(); modeCols = it.key();
+            }
+        }
+        if (modeCols < 2) continue;
+        if (modeFreq > bestFreq || (modeFreq == bestFreq && modeCols > bestCols)) {
+            best = sep; bestFreq = modeFreq; bestCols = modeCols;
+        }
+    }
+    return best ? QChar(best) : QChar(',');
+}
+
+QChar TextDataImporter::separatorFromSetting(const QString& sepStr)
+{
+    if (sepStr.contains("Comma")) return ',';
+    if (sepStr.contains("Tab")) return '\t';
+    if (sepStr.contains("Space")) return ' ';
+    if (sepStr.contains("Semicolon")) return ';';
+    return QChar();
+}
+
+// ============================================================================
+// 文件导入
+// ============================================================================
+
+TextImportResult TextDataImporter::importFile(const DataImportSettings& settings, int maxRows, ImportControl* control)
+{
+    TextImportResult result;
+
+    QFile file(settings.filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.errorMessage = "无法打开文件: " + file.errorString();
+        return result;
+    }
+
+    const qint64 size = file.size();
+    if (size == 0) { result.success = true; result.separator = ','; result.encoding = "UTF-8"; return result; }
+
+    // 1. 内存映射，失败时退回一次性读取
+    QByteArray buffer;
+    const char* data = nullptr;
+    uchar* mapped = file.map(0, size);
+    if (mapped) {
+        data = reinterpret_cast<const char*>(mapped);
+    } else {
+        buffer = file.readAll();
+        data = buffer.constData();
+    }
+    const char* end = data + size;
+    if (control) { control->total = size; control->processed = 0; }
+
+    // 2. 编码：处理 BOM，UTF-16 文件先整体转为 UTF-8
+    QString encName = settings.encoding;
+    if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+        data += 3;
+        encName = "UTF-8";
+    } else if (size >= 2 && ((uchar(data[0]) == 0xFF && uchar(data[1]) == 0xFE) ||
+                             (uchar(data[0]) == 0xFE && uchar(data[1]) == 0xFF))) {
+        QByteArray raw = QByteArray::fromRawData(data, static_cast<int>(size));
+        buffer = QTextCodec::codecForUtfText(raw)->toUnicode(raw).toUtf8();
+        data = buffer.constData();
+        end = data + buffer.size();
+        encName = "UTF-8";
+    }
+
+    QByteArray sample = QByteArray::fromRawData(data, static_cast<int>(qMin<qint64>(end - data, 64 * 1024)));
+    if (!(encName.startsWith("UTF-8") || encName.startsWith("GBK") ||
+          encName.startsWith("System") || encName.startsWith("ISO"))) {
+        encName = detectEncoding(sample);
+    }
+
+    TextEncoding enc = TextEncoding::Utf8;
+    QTextCodec* codec = nullptr;
+    if (encName.startsWith("GBK")) {
+        enc = TextEncoding::Gbk;
+        codec = QTextCodec::codecForName("GBK");
+        result.encoding = "GBK";
+    } else if (encName.startsWith("System")) {
+        enc = TextEncoding::System;
+        result.encoding = "System";
+    } else if (encName.startsWith("ISO")) {
+        enc = TextEncoding::Latin1;
+        result.encoding = "ISO-8859-1";
+    } else {
+        result.encoding = "UTF-8";
+    }
+
+    // 3. 分隔符
+    QChar sepChar = separatorFromSetting(settings.separator);
+    if (sepChar.isNull()) sepChar = detectSeparator(sample);
+    result.separator = sepChar;
+    const char sep = sepChar.toLatin1();
+
+    ImportedTable& table = result.table;
+    QVector<bool> seenAll;
+
+    // 4. 前导行串行处理 (行号从 0 开始，与预览逻辑一致)
+    const int headerLine = settings.useHeader ? settings.headerRow - 1 : -1;
+    const int firstDataLine = qMax(0, settings.startRow - 1);
+    const int prefixLines = qMax(firstDataLine, headerLine + 1);
+
+    ChunkResult prefix;
+    const char* p = data;
+    for (int line = 0; line < prefixLines && p < end; ++line) {
+        const char* le;
+        const char* next = nextLine(p, end, le);
+        if (line == headerLine) {
+            table.headers = parseLine(p, le, sep, enc, codec, nullptr, nullptr);
+        } else if (line >= firstDataLine && !isEmptyLine(p, le)) {
+            prefix.rows.append(parseLine(p, le, sep, enc, codec, &prefix.numeric, &prefix.seen));
+        }
+        p = next;
+    }
+    if (maxRows >= 0 && prefix.rows.size() > maxRows) prefix.rows.resize(maxRows);
+    mergeNumericFlags(table, seenAll, prefix);
+
+    // 5. 正文：按换行对齐切块并行解析 (预览限制行数时串行)
+    QVector<ChunkResult> chunks;
+    const qint64 bodyBytes = end - p;
+    int threads = QThread::idealThreadCount();
+    if (maxRows >= 0 || bodyBytes < 2 * kMinChunkBytes || threads < 2) {
+        int remain = (maxRows >= 0) ? qMax(0, maxRows - int(prefix.rows.size())) : -1;
+        if (p < end && remain != 0) chunks.append(parseChunk(p, end, sep, enc, codec, remain, control));
+    } else {
+        int nChunks = static_cast<int>(qMin<qint64>(threads * 2, bodyBytes / kMinChunkBytes));
+        QVector<QPair<const char*, const char*>> ranges;
+        const char* cs = p;
+        for (int i = 1; i <= nChunks && cs < end; ++i) {
+            const char* ce = (i == nChunks) ? end : p + bodyBytes * i / nChunks;
+            if (ce < cs) ce = cs;
+            if (ce < end) {
+                const char* nl = static_cast<const char*>(memchr(ce, '\n', static_cast<size_t>(end - ce)));
+                ce = nl ? nl + 1 : end;
+            }
+            ranges.append(qMakePair(cs, ce));
+            cs = ce;
+        }
+
+        QVector<QFuture<ChunkResult>> futures;
+        for (const auto& r : ranges) {
+            futures.append(QtConcurrent::run([r, sep, enc, codec, control]() {
+                return parseChunk(r.first, r.second, sep, enc, codec, -1, control);
+            }));
+        }
+        for (auto& f : futures) chunks.append(f.result());
+    }
+
+    if (control && control->cancelled) {
+        if (mapped) file.unmap(mapped);
+        result.errorMessage = "导入已取消";
+        return result;
+    }
+
+    // 6. 按原顺序合并
+    qsizetype total = prefix.rows.size();
+    for (const auto& c : chunks) total += c.rows.size();
+    table.rows.reserve(total);
+    table.rows += prefix.rows;
+    for (auto& c : chunks) {
+        mergeNumericFlags(table, seenAll, c);
+        for (auto& row : c.rows) table.rows.append(std::move(row));
+        c.rows.clear();
+    }
+
+    table.columnCount = table.headers.size();
+    for (const auto& row : table.rows) table.columnCount = qMax(table.columnCount, int(row.size()));
+    table.numericColumns.resize(table.columnCount);
+    for (int c = 0; c < table.numericColumns.size(); ++c) {
+        if (c >= seenAll.size() || !seenAll[c]) table.numericColumns[c] = false;
+    }
+
+    if (mapped) file.unmap(mapped);
+    result.success = true;
+    return result;
+}
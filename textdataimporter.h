@@ -0,0 +1,88 @@
+/*
+ * 文件名: textdataimporter.h
+ * 文件作用: 文本数据 (CSV/TXT) 高速导入器头文件
+ * 功能描述:
+ * 1. 声明导入结果结构体 ImportedTable / TextImportResult。
+ * 2. 声明 TextDataImporter 类：基于内存映射读取文件，按行对齐切块后并行解析。
+ * 3. 提供编码与分隔符的自动识别，以及与区域设置无关的快速浮点数解析接口。
+ */
+
+#ifndef TEXTDATAIMPORTER_H
+#define TEXTDATAIMPORTER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QByteArray>
+#include <atomic>
+#include "dataimportdialog.h"
+
+// 导入后的表格数据 (表头 + 按行存储的单元格文本)
+struct ImportedTable {
+    QStringList headers;            // 表头 (未启用表头时为空)
+    QVector<QStringList> rows;      // 数据行
+    int columnCount = 0;            // 最大列数
+    QVector<bool> numericColumns;   // 各列是否全部为数值
+};
+
+// 导入进度与取消控制 (工作线程写入进度，界面线程轮询并可置位取消)
+struct ImportControl {
+    std::atomic<bool> cancelled{false};
+    std::atomic<qint64> processed{0};   // 已处理字节数
+    std::atomic<qint64> total{0};       // 总字节数
+    std::atomic<int> stage{0};          // 调用方自定义阶段 (如 0: 读取解析, 1: 构建表格)
+
+    int percent() const {
+        qint64 t = total.load();
+        return t > 0 ? int(qMin<qint64>(100, processed.load() * 100 / t)) : 0;
+    }
+};
+
+// 文本导入结果
+struct TextImportResult {
+    bool success = false;
+    QString errorMessage;
+    ImportedTable table;
+    QString encoding;               // 实际使用的编码 ("UTF-8", "GBK", "System", "ISO-8859-1")
+    QChar separator;                // 实际使用的分隔符
+};
+
+class TextDataImporter
+{
+public:
+    /**
+     * @brief 导入文本文件
+     * @param settings 导入配置 (编码/分隔符/起始行/表头行，"Auto" 表示自动识别)
+     * @param maxRows 最多读取的数据行数 (-1 表示全部，预览时可限制)
+     * @param control 进度与取消控制 (可为空)，取消后返回 success=false
+     * @return 导入结果
+     */
+    static TextImportResult importFile(const DataImportSettings& settings, int maxRows = -1,
+                                       ImportControl* control = nullptr);
+
+    /**
+     * @brief 根据文件头部样本识别编码 (BOM / UTF-8 合法性校验，否则按 GBK 处理)
+     */
+    static QString detectEncoding(const QByteArray& sample);
+
+    /**
+     * @brief 根据样本行识别分隔符 (Tab / 逗号 / 分号 / 空格，取列数最稳定者)
+     */
+    static QChar detectSeparator(const QByteArray& sample);
+
+    /**
+     * @brief 将界面上的分隔符选项文本转换为字符，"Auto" 时返回空 QChar
+     */
+    static QChar separatorFromSetting(const QString& sepStr);
+
+    /**
+     * @brief 快速浮点数解析 (与区域设置无关，小数点固定为 '.')
+     * @param begin/end 待解析字符区间，允许首尾空白
+     * @param value 输出值
+     * @return 整个区间为合法数值时返回 true
+     */
+    static bool parseDouble(const char* begin, const char* end, double& value);
+    static bool parseDouble(const QString& text, double& value);
+};
+
+#endif // TEXTDATAIMPORTER_H
@@ -0,0 +1,408 @@
+/*
+ * 文件名: typecurveatlas.cpp
+ * 文件作用: 无因次典型曲线图版实现文件
+ * 功能描述:
+ * 1. 文件布局：文件头 + 各图版块头 + 各轴取值 (float64) + 数据 (float32, 节点优先、z 连续)，
+ *    所有偏移按 8 字节对齐，可直接在映射内存上按指针访问。
+ * 2. 查询只访问 2^k 个相邻节点的 z 列 (k 为落在网格内部的连续参数个数)，耗时为微秒级。
+ * 3. 生成时每个网格节点独立调用 ModelSolver01_06::reservoirLaplace，按节点块并行。
+ */
+
+#include "typecurveatlas.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const char kAtlasMagic[8] = {'W', 'T', 'A', 'T', 'L', 'A', 'S', '1'};
+const quint32 kAtlasVersion = 1;
+
+struct AtlasFileHeader {
+    char magic[8];
+    quint32 version;
+    quint32 blockCount;
+    quint32 zCount;
+    quint32 reserved;
+    double lnZMin;
+    double dlnZ;
+};
+
+struct AtlasBlockHeader {
+    quint32 family;
+    quint32 axisSize[8];
+    quint32 reserved;
+    quint64 axisOffset;
+    quint64 dataOffset;
+};
+
+quint64 align8(quint64 v) { return (v + 7) & ~quint64(7); }
+
+} // namespace
+
+// ============================================================================
+// TypeCurveAtlasConfig
+// ============================================================================
+
+int TypeCurveAtlasConfig::zCount() const
+{
+    if (!(zMin > 0.0) || !(zMax > zMin) || zPerDecade < 1) return 0;
+    return int(std::ceil(std::log10(zMax / zMin) * zPerDecade)) + 1;
+}
+
+qint64 TypeCurveAtlasConfig::nodeCount() const
+{
+    const qint64 common = qint64(nf.size()) * LfD.size() * rmD.size() * omega1.size() * omega2.size()
+                          * lambda1.size() * M12.size();
+    // 无限大边界不使用 reD 轴
+    return common + 2 * common * reD.size();
+}
+
+// ============================================================================
+// Column
+// ============================================================================
+
+bool TypeCurveAtlas::Column::covers(double zLo, double zHi) const
+{
+    const int n = m_f.size();
+    if (n < 2 || !(zLo > 0.0) || !(zHi >= zLo)) return false;
+    const double xLo = (std::log(zLo) - m_lnZMin) / m_dlnZ;
+    const double xHi = (std::log(zHi) - m_lnZMin) / m_dlnZ;
+    if (xLo < -1e-9 || xHi > n - 1 + 1e-9) return false;
+
+    // 极大 z 处原求解器本身可能失效，图版中记为 NaN；只要求插值模板用到的点有效
+    const int iLo = qMax(0, int(std::floor(xLo)) - 1);
+    const int iHi = qMin(n - 1, int(std::ceil(xHi)) + 1);
+    for (int i = iLo; i <= iHi; ++i) {
+        if (!std::isfinite(m_f[i])) return false;
+    }
+    return true;
+}
+
+double TypeCurveAtlas::Column::value(double z) const
+{
+    const int n = m_f.size();
+    const double lnZ = std::log(z);
+    const double x = (lnZ - m_lnZMin) / m_dlnZ;
+    const int i = qBound(0, int(std::floor(x)), n - 2);
+    const double t = x - i;
+
+    // Catmull-Rom 三次插值，端点处线性外推补点
+    const double f1 = m_f[i], f2 = m_f[i + 1];
+    const double f0 = i > 0 ? m_f[i - 1] : 2.0 * f1 - f2;
+    const double f3 = i + 2 < n ? m_f[i + 2] : 2.0 * f2 - f1;
+    const double f = f1 + 0.5 * t * (f2 - f0 + t * (2.0 * f0 - 5.0 * f1 + 4.0 * f2 - f3 + t * (3.0 * (f1 - f2) + f3 - f0)));
+    return std::exp(f - lnZ);
+}
+
+// ============================================================================
+// TypeCurveAtlas
+// ============================================================================
+
+TypeCurveAtlas::TypeCurveAtlas()
+    : m_file(nullptr)
+    , m_data(nullptr)
+    , m_zCount(0)
+    , m_lnZMin(0.0)
+    , m_dlnZ(1.0)
+{
+}
+
+TypeCurveAtlas::~TypeCurveAtlas()
+{
+    unload();
+}
+
+QString TypeCurveAtlas::defaultFilePath()
+{
+    return QCoreApplication::applicationDirPath() + "/typecurves.atlas";
+}
+
+QString TypeCurveAtlas::filePath() const
+{
+    return m_file ? m_file->fileName() : QString();
+}
+
+int TypeCurveAtlas::boundaryFamily(ModelSolver01_06::ModelType type)
+{
+    switch (type) {
+    case ModelSolver01_06::Model_1:
+    case ModelSolver01_06::Model_2: return 0;
+    case ModelSolver01_06::Model_3:
+    case ModelSolver01_06::Model_4: return 1;
+    case ModelSolver01_06::Model_5:
+    case ModelSolver01_06::Model_6: return 2;
+    }
+    return -1;
+}
+
+void TypeCurveAtlas::unload()
+{
+    if (m_file) {
+        if (m_data) m_file->unmap(const_cast<uchar*>(m_data));
+        m_file->close();
+        delete m_file;
+    }
+    m_file = nullptr;
+    m_data = nullptr;
+    m_zCount = 0;
+    m_blocks.clear();
+}
+
+bool TypeCurveAtlas::load(const QString& path, QString* errorMessage)
+{
+    unload();
+    auto fail = [&](const QString& msg) {
+        if (errorMessage) *errorMessage = msg;
+        unload();
+        return false;
+    };
+
+    m_file = new QFile(path);
+    if (!m_file->open(QIODevice::ReadOnly)) return fail(QString("无法打开图版文件: %1").arg(path));
+
+    const qint64 fileSize = m_file->size();
+    if (fileSize < qint64(sizeof(AtlasFileHeader))) return fail("图版文件格式错误");
+
+    m_data = m_file->map(0, fileSize);
+    if (!m_data) return fail("图版文件内存映射失败");
+
+    AtlasFileHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    if (std::memcmp(header.magic, kAtlasMagic, sizeof(kAtlasMagic)) != 0 || header.version != kAtlasVersion)
+        return fail("图版文件版本不匹配");
+    if (header.zCount < 2 || header.blockCount == 0 || !(header.dlnZ > 0.0))
+        return fail("图版文件格式错误");
+
+    const quint64 headerEnd = sizeof(AtlasFileHeader) + quint64(header.blockCount) * sizeof(AtlasBlockHeader);
+    if (headerEnd > quint64(fileSize)) return fail("图版文件不完整");
+
+    m_zCount = int(header.zCount);
+    m_lnZMin = header.lnZMin;
+    m_dlnZ = header.dlnZ;
+
+    for (quint32 b = 0; b < header.blockCount; ++b) {
+        AtlasBlockHeader bh;
+        std::memcpy(&bh, m_data + sizeof(AtlasFileHeader) + b * sizeof(AtlasBlockHeader), sizeof(bh));
+
+        Block block;
+        block.family = int(bh.family);
+        quint64 axisValues = 0, nodes = 1;
+        for (int k = 0; k < AxisCount; ++k) {
+            if (bh.axisSize[k] == 0) return fail("图版文件格式错误");
+            block.axisSize[k] = int(bh.axisSize[k]);
+            axisValues += bh.axisSize[k];
+            nodes *= bh.axisSize[k];
+        }
+        if (bh.axisOffset % 8 != 0 || bh.dataOffset % 8 != 0
+            || bh.axisOffset + axisValues * sizeof(double) > quint64(fileSize)
+            || bh.dataOffset + nodes * m_zCount * sizeof(float) > quint64(fileSize))
+            return fail("图版文件不完整");
+
+        const double* axis = reinterpret_cast<const double*>(m_data + bh.axisOffset);
+        for (int k = 0; k < AxisCount; ++k) {
+            block.axis[k] = axis;
+            axis += block.axisSize[k];
+        }
+        block.data = reinterpret_cast<const float*>(m_data + bh.dataOffset);
+        m_blocks.append(block);
+    }
+
+    qDebug() << "典型曲线图版已加载:" << path << "块数" << m_blocks.size();
+    return true;
+}
+
+bool TypeCurveAtlas::lookup(ModelSolver01_06::ModelType type, const QMap<QString, double>& params, Column& out) const
+{
+    if (!m_data) return false;
+
+    const int family = boundaryFamily(type);
+    const Block* block = nullptr;
+    for (const Block& b : m_blocks) {
+        if (b.family == family) { block = &b; break; }
+    }
+    if (!block) return false;
+
+    // 与 ModelSolver01_06::flaplace_composite 相同的参数取法
+    const double km = params.value("km");
+    if (!(km > 0.0)) return false;
+    const double v[AxisCount] = {
+        double(qMax(1, (int)params.value("nf", 4))),
+        params.value("LfD"), params.value("rmD"),
+        params.value("omega1"), params.value("omega2"), params.value("lambda1"),
+        params.value("kf") / km, params.value("reD", 0.0)
+    };
+
+    // 1. 各轴定位：nf 须与网格值一致，其余轴在对数坐标下线性插值
+    qint64 stride[AxisCount];
+    stride[AxisCount - 1] = 1;
+    for (int k = AxisCount - 2; k >= 0; --k) stride[k] = stride[k + 1] * block->axisSize[k + 1];
+
+    qint64 base = 0;
+    int active[AxisCount];
+    double weight[AxisCount];
+    int nActive = 0;
+    for (int k = 0; k < AxisCount; ++k) {
+        const int n = block->axisSize[k];
+        const double* a = block->axis[k];
+        if (k == 0) {
+            const double* hit = std::find(a, a + n, v[0]);
+            if (hit == a + n) return false;
+            base += stride[k] * (hit - a);
+            continue;
+        }
+        if (n == 1) continue; // 该边界类型不使用此参数
+        const double x = v[k];
+        if (!(x > 0.0) || x < a[0] * (1.0 - 1e-9) || x > a[n - 1] * (1.0 + 1e-9)) return false;
+        const int i = qBound(0, int(std::upper_bound(a, a + n, x) - a) - 1, n - 2);
+        const double w = qBound(0.0, std::log(x / a[i]) / std::log(a[i + 1] / a[i]), 1.0);
+        base += stride[k] * i;
+        if (w > 0.0) {
+            active[nActive] = k;
+            weight[nActive] = w;
+            ++nActive;
+        }
+    }
+
+    // 2. 2^k 个相邻节点的 z 列加权求和
+    out.m_lnZMin = m_lnZMin;
+    out.m_dlnZ = m_dlnZ;
+    out.m_f.fill(0.0, m_zCount);
+    double* f = out.m_f.data();
+    for (int mask = 0; mask < (1 << nActive); ++mask) {
+        double w = 1.0;
+        qint64 node = base;
+        for (int j = 0; j < nActive; ++j) {
+            if (mask & (1 << j)) { w *= weight[j]; node += stride[active[j]]; }
+            else w *= 1.0 - weight[j];
+        }
+        if (w == 0.0) continue;
+        const float* col = block->data + node * m_zCount;
+        for (int i = 0; i < m_zCount; ++i) f[i] += w * col[i];
+    }
+    return true;
+}
+
+bool TypeCurveAtlas::build(const QString& path, const TypeCurveAtlasConfig& config,
+                           std::function<void(qint64, qint64)> progress, QString* errorMessage)
+{
+    auto fail = [&](const QString& msg) {
+        if (errorMessage) *errorMessage = msg;
+        return false;
+    };
+
+    const QVector<double> infiniteReD = {0.0};
+    const QVector<double>* axesFor[3][AxisCount];
+    for (int fam = 0; fam < 3; ++fam) {
+        const QVector<double>* axes[AxisCount] = { &config.nf, &config.LfD, &config.rmD, &config.omega1,
+                                                   &config.omega2, &config.lambda1, &config.M12,
+                                                   fam == 0 ? &infiniteReD : &config.reD };
+        for (int k = 0; k < AxisCount; ++k) {
+            if (axes[k]->isEmpty()) return fail("图版网格配置为空");
+            axesFor[fam][k] = axes[k];
+        }
+    }
+    if (!(config.zMin > 0.0) || !(config.zMax > config.zMin) || config.zPerDecade < 1)
+        return fail("图版 z 范围配置错误");
+
+    const double lnZMin = std::log(config.zMin);
+    const int zCount = config.zCount();
+    const double dlnZ = (std::log(config.zMax) - lnZMin) / (zCount - 1);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return fail(QString("无法写入图版文件: %1").arg(path));
+
+    // 1. 计算各块偏移并写入文件头
+    AtlasFileHeader header;
+    std::memcpy(header.magic, kAtlasMagic, sizeof(kAtlasMagic));
+    header.version = kAtlasVersion;
+    header.blockCount = 3;
+    header.zCount = quint32(zCount);
+    header.reserved = 0;
+    header.lnZMin = lnZMin;
+    header.dlnZ = dlnZ;
+
+    AtlasBlockHeader blockHeaders[3];
+    qint64 nodeCount[3];
+    qint64 totalNodes = 0;
+    quint64 offset = align8(sizeof(AtlasFileHeader) + 3 * sizeof(AtlasBlockHeader));
+    for (int fam = 0; fam < 3; ++fam) {
+        AtlasBlockHeader& bh = blockHeaders[fam];
+        bh.family = quint32(fam);
+        bh.reserved = 0;
+        quint64 axisValues = 0;
+        nodeCount[fam] = 1;
+        for (int k = 0; k < AxisCount; ++k) {
+            bh.axisSize[k] = quint32(axesFor[fam][k]->size());
+            axisValues += bh.axisSize[k];
+            nodeCount[fam] *= bh.axisSize[k];
+        }
+        bh.axisOffset = offset;
+        bh.dataOffset = align8(offset + axisValues * sizeof(double));
+        offset = align8(bh.dataOffset + quint64(nodeCount[fam]) * zCount * sizeof(float));
+        totalNodes += nodeCount[fam];
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(blockHeaders), sizeof(blockHeaders));
+
+    // 2. 逐块计算：节点按块分批并行，每批结束后写盘并汇报进度
+    const ModelSolver01_06::ModelType familyType[3] = { ModelSolver01_06::Model_2, ModelSolver01_06::Model_4,
+                                                        ModelSolver01_06::Model_6 };
+    qint64 doneNodes = 0;
+    for (int fam = 0; fam < 3; ++fam) {
+        const AtlasBlockHeader& bh = blockHeaders[fam];
+        file.seek(qint64(bh.axisOffset));
+        for (int k = 0; k < AxisCount; ++k)
+            file.write(reinterpret_cast<const char*>(axesFor[fam][k]->constData()), axesFor[fam][k]->size() * sizeof(double));
+
+        qint64 stride[AxisCount];
+        stride[AxisCount - 1] = 1;
+        for (int k = AxisCount - 2; k >= 0; --k) stride[k] = stride[k + 1] * bh.axisSize[k + 1];
+
+        auto computeNode = [&](qint64 node, float* col) {
+            double v[AxisCount];
+            for (int k = 0; k < AxisCount; ++k) v[k] = axesFor[fam][k]->at(int((node / stride[k]) % bh.axisSize[k]));
+
+            QMap<QString, double> p;
+            p["nf"] = v[0]; p["LfD"] = v[1]; p["rmD"] = v[2];
+            p["omega1"] = v[3]; p["omega2"] = v[4]; p["lambda1"] = v[5];
+            p["kf"] = v[6]; p["km"] = 1.0; p["reD"] = v[7];
+
+            ModelSolver01_06 solver(familyType[fam]);
+            for (int i = 0; i < zCount; ++i) {
+                const double z = std::exp(lnZMin + i * dlnZ);
+                const double pf = solver.reservoirLaplace(z, p);
+                col[i] = (std::isfinite(pf) && pf > 0.0) ? float(std::log(z * pf)) : std::numeric_limits<float>::quiet_NaN();
+            }
+        };
+
+        const qint64 batch = 1024;
+        QVector<float> buffer;
+        file.seek(qint64(bh.dataOffset));
+        for (qint64 first = 0; first < nodeCount[fam]; first += batch) {
+            const qint64 count = qMin(batch, nodeCount[fam] - first);
+            buffer.resize(int(count * zCount));
+            QVector<qint64> nodes(count);
+            for (qint64 i = 0; i < count; ++i) nodes[int(i)] = first + i;
+            // 在分发前取得写指针 (data() 会检查隐式共享，不应在各线程中重复调用)
+            float* out = buffer.data();
+            QtConcurrent::blockingMap(nodes, [&computeNode, out, first, zCount](qint64 node) {
+                computeNode(node, out + (node - first) * zCount);
+            });
+
+            if (file.write(reinterpret_cast<const char*>(buffer.constData()), buffer.size() * sizeof(float)) != qint64(buffer.size() * sizeof(float)))
+                return fail("写入图版文件失败");
+            doneNodes += count;
+            if (progress) progress(doneNodes, totalNodes);
+        }
+    }
+
+    file.close();
+    return true;
+}
@@ -0,0 +1,108 @@
+/*
+ * 文件名: typecurveatlas.h
+ * 文件作用: 无因次典型曲线图版头文件
+ * 功能描述:
+ * 1. 离线预先计算各边界类型在 (nf, LfD, rmD, omega1, omega2, lambda1, M12, reD) 网格上的
+ *    储层拉普拉斯解 ln(z·pf(z))，按对数等距 z 网格存为 float32，写入单个二进制图版文件。
+ * 2. 运行时以内存映射方式打开图版，不整体读入内存，多个求解器/线程共享只读数据。
+ * 3. 查询时对连续参数在对数坐标下做多线性插值，得到一条 z 列，再按 ln z 三次插值求 pf(z)。
+ *    井储、表皮和压敏修正仍在运行时按原公式施加，因此 cD、S、gamaD 不占用网格维度。
+ * 4. 井储条件不影响储层解，模型1/2、3/4、5/6 分别共用无限大、封闭、定压三组图版数据。
+ */
+
+#ifndef TYPECURVEATLAS_H
+#define TYPECURVEATLAS_H
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include "modelsolver01-06.h"
+
+class QFile;
+
+// 图版网格配置 (离线生成时使用，各轴须升序且为正)
+// 默认网格：无限大 108000 个节点 + 封闭/定压各 432000 个节点，共 972000 个节点，每节点 105 个 z 值，
+// 图版文件约 408 MB (float32)。文件按内存映射打开，查询只触及相邻节点所在的页，常驻内存远小于文件大小；
+// 生成时间与节点数成正比，须在多核机器上离线运行 typecurvebuilder。缩小网格可用更稀的轴重新生成。
+struct TypeCurveAtlasConfig {
+    QVector<double> nf      = {1, 2, 3, 4, 6, 8};
+    QVector<double> LfD     = {0.02, 0.05, 0.1, 0.2, 0.4};
+    QVector<double> rmD     = {1.0, 1.414, 2.0, 2.828, 4.0, 5.657, 8.0, 11.31, 16.0}; // 晚期过渡对 rmD 敏感，加密
+    QVector<double> omega1  = {0.02, 0.1, 0.4, 0.9};
+    QVector<double> omega2  = {0.01, 0.05, 0.2, 0.8};
+    QVector<double> lambda1 = {1e-5, 1e-4, 1e-3, 1e-2, 1e-1};
+    QVector<double> M12     = {1.0, 3.0, 10.0, 30.0, 100.0};
+    QVector<double> reD     = {5.0, 10.0, 20.0, 50.0}; // 无限大边界不使用
+    double zMin = 1e-4;     // 覆盖 Stehfest 反演所需的 z 范围
+    double zMax = 1e9;
+    int zPerDecade = 8;
+
+    // 每个节点的 z 值个数
+    int zCount() const;
+    // 三种边界类型的节点总数
+    qint64 nodeCount() const;
+    // 生成的图版文件大小 (字节，不含文件头与坐标轴)
+    qint64 estimatedBytes() const { return nodeCount() * zCount() * qint64(sizeof(float)); }
+};
+
+class TypeCurveAtlas
+{
+public:
+    // 某一参数点插值得到的储层拉普拉斯解 (不含井储表皮)
+    class Column
+    {
+    public:
+        bool isValid() const { return !m_f.isEmpty(); }
+        // [zLo, zHi] 是否落在图版 z 范围内
+        bool covers(double zLo, double zHi) const;
+        // pf(z)，z 须在覆盖范围内
+        double value(double z) const;
+
+    private:
+        friend class TypeCurveAtlas;
+        double m_lnZMin = 0.0;
+        double m_dlnZ = 1.0;
+        QVector<double> m_f; // ln(z·pf)
+    };
+
+    TypeCurveAtlas();
+    ~TypeCurveAtlas();
+
+    // 内存映射打开图版文件，失败时保持未加载状态
+    bool load(const QString& path, QString* errorMessage = nullptr);
+    void unload();
+    bool isLoaded() const { return m_data != nullptr; }
+    QString filePath() const;
+
+    // 查询参数点的储层解；参数超出网格范围或 nf 不在网格上时返回 false (z 覆盖另用 Column::covers 判断)
+    bool lookup(ModelSolver01_06::ModelType type, const QMap<QString, double>& params, Column& out) const;
+
+    // 离线生成图版文件 (耗时，按网格节点并行计算)；progress(已完成节点, 总节点)
+    static bool build(const QString& path, const TypeCurveAtlasConfig& config = TypeCurveAtlasConfig(),
+                      std::function<void(qint64, qint64)> progress = nullptr, QString* errorMessage = nullptr);
+
+    // 默认图版文件：程序目录下的 typecurves.atlas
+    static QString defaultFilePath();
+
+private:
+    enum { AxisCount = 8 };
+
+    struct Block {
+        int family = -1;                 // 0 无限大, 1 封闭, 2 定压
+        int axisSize[AxisCount] = {};
+        const double* axis[AxisCount] = {};
+        const float* data = nullptr;
+    };
+
+    static int boundaryFamily(ModelSolver01_06::ModelType type);
+
+    QFile* m_file;
+    const uchar* m_data;
+    int m_zCount;
+    double m_lnZMin;
+    double m_dlnZ;
+    QVector<Block> m_blocks;
+};
+
+#endif // TYPECURVEATLAS_H
@@ -0,0 +1,48 @@
+/*
+ * 文件名: main.cpp
+ * 文件作用: 典型曲线图版离线生成工具入口
+ * 功能描述:
+ * 1. 按 TypeCurveAtlasConfig 默认网格生成三种边界类型的储层拉普拉斯解图版。
+ * 2. 用法: typecurvebuilder [输出文件]，缺省输出到当前目录下的 typecurves.atlas。
+ * 3. 节点计算按 QThreadPool 并行，每完成 1% 输出一次进度。
+ * 4. 开始前输出节点数与预计文件大小。
+ */
+
+#include "typecurveatlas.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const QStringList args = app.arguments();
+    const QString path = args.size() > 1 ? args.at(1) : QString("typecurves.atlas");
+
+    const TypeCurveAtlasConfig config;
+    out << "生成典型曲线图版: " << path << Qt::endl;
+    out << QString("  节点数 %1，每节点 %2 个 z 值，文件约 %3 MB")
+               .arg(config.nodeCount()).arg(config.zCount()).arg(config.estimatedBytes() / 1000000) << Qt::endl;
+    QElapsedTimer timer;
+    timer.start();
+
+    int lastPercent = -1;
+    auto progress = [&](qint64 done, qint64 total) {
+        const int percent = int(done * 100 / qMax<qint64>(1, total));
+        if (percent == lastPercent) return;
+        lastPercent = percent;
+        out << QString("  %1% (%2/%3 节点, %4 s)").arg(percent).arg(done).arg(total).arg(timer.elapsed() / 1000) << Qt::endl;
+    };
+
+    QString error;
+    if (!TypeCurveAtlas::build(path, config, progress, &error)) {
+        out << "生成失败: " << error << Qt::endl;
+        return 1;
+    }
+
+    out << "完成，用时 " << timer.elapsed() / 1000 << " s" << Qt::endl;
+    return 0;
+}
@@ -0,0 +1,41 @@
+# ----------------------------------------------------
+# Project: typecurvebuilder
+# Description: 典型曲线图版离线生成工具 (控制台程序)
+# 生成的 typecurves.atlas 复制到 WellTest 可执行文件所在目录即可启用图版预览
+# ----------------------------------------------------
+
+QT += core gui concurrent
+QT -= widgets
+
+TEMPLATE = app
+TARGET = typecurvebuilder
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+# 编译优化选项
+QMAKE_CXXFLAGS += -O3
+QMAKE_CXXFLAGS_RELEASE -= -O2
+QMAKE_CXXFLAGS_RELEASE += -O3
+
+# 数学库链接
+unix: LIBS += -lm
+win32: LIBS += -lm
+
+# 第三方库路径配置 (与 WellTest.pro 保持一致)
+INCLUDEPATH += D:/08YYYXXX/eigen-3.3.8
+INCLUDEPATH += D:/08YYYXXX/boost_1_89_0
+
+HEADERS += ../typecurveatlas.h \
+           ../modelsolver01-06.h \
+           ../pressurederivativecalculator.h \
+           ../rateschedule.h
+
+SOURCES += main.cpp \
+           ../typecurveatlas.cpp \
+           ../modelsolver01-06.cpp \
+           ../pressurederivativecalculator.cpp \
+           ../rateschedule.cpp
+
+QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter
@@ -5,6 +5,13 @@
  * 1. 初始化界面，集成 ChartWidget 作为绘图容器。
  * 2. 实现了多线程 Levenberg-Marquardt 拟合算法。
  * 3. 包含了右侧坐标系动态加载和 35% 比例初始化逻辑。
+ * 4. 参数修改后的模型预览和 LM 初值扫描使用典型曲线图版 (若已加载)。
+ * 5. 迭代刷新：拟合线程覆盖写入最新状态，界面以 16 ms 定时器合并刷新，
+ *    参数表只改动变化的单元格，理论曲线层单独重绘，实测数据层沿用缓存。
+ * 6. 导出报告：界面线程只组织文字并离屏绘制图像，图像编码与文件写出在后台完成。
+ * 7. 拟合任务提交到 ModelManager::solverPool()，与模型界面的正演、敏感性计算共用线程池。
+ * 8. 理论曲线预览改为异步：参数表修改去抖 120 ms 后计算，新的修改取消旧计算；
+ *    先显示少量时间点的粗略曲线，再替换为完整曲线。拟合进行中不做预览。
  */
 
 #include "wt_fittingwidget.h"
@@ -14,6 +21,7 @@
 #include "fittingdatadialog.h"
 #include "pressurederivativecalculator.h"
 #include "pressurederivativecalculator1.h"
+#include "datafilter.h"
 
 #include <QtConcurrent>
 #include <QMessageBox>
@@ -32,7 +40,6 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDateTime>
-#include <QBuffer>
 #include <Eigen/Dense>
 
 FittingWidget::FittingWidget(QWidget *parent) :
@@ -44,7 +51,11 @@ FittingWidget::FittingWidget(QWidget *parent) :
     m_plot(nullptr),
     m_plotTitle(nullptr),
     m_currentModelType(ModelManager::Model_1),
-    m_isFitting(false)
+    m_isFitting(false),
+    m_hasPendingIteration(false),
+    m_renderScheduled(false),
+    m_renderTimer(nullptr),
+    m_modelLayer(nullptr)
 {
     ui->setupUi(this);
 
@@ -75,9 +86,18 @@ FittingWidget::FittingWidget(QWidget *parent) :
     qRegisterMetaType<ModelManager::ModelType>("ModelManager::ModelType");
     qRegisterMetaType<QVector<double>>("QVector<double>");
 
-    connect(this, &FittingWidget::sigIterationUpdated, this, &FittingWidget::onIterationUpdate, Qt::QueuedConnection);
+    // 约一帧 (16 ms) 合并一次迭代刷新
+    m_renderTimer = new QTimer(this);
+    m_renderTimer->setSingleShot(true);
+    m_renderTimer->setInterval(16);
+    connect(m_renderTimer, &QTimer::timeout, this, &FittingWidget::flushIterationUpdate);
     connect(this, &FittingWidget::sigProgress, ui->progressBar, &QProgressBar::setValue);
     connect(&m_watcher, &QFutureWatcher<void>::finished, this, &FittingWidget::onFitFinished);
+    connect(&m_reportWatcher, &QFutureWatcher<ReportWriteResult>::finished, this, &FittingWidget::onReportWritten);
+
+    m_preview = new CurvePreviewService(this);
+    connect(m_preview, &CurvePreviewService::previewReady, this, &FittingWidget::onPreviewReady);
+    connect(ui->tableParams, &QTableWidget::itemChanged, this, &FittingWidget::onParamItemChanged);
 
     connect(ui->sliderWeight, &QSlider::valueChanged, this, &FittingWidget::onSliderWeightChanged);
 
@@ -95,6 +115,7 @@ void FittingWidget::setModelManager(ModelManager *m)
 {
     m_modelManager = m;
     m_paramChart->setModelManager(m);
+    m_preview->setModelManager(m);
     initializeDefaultModel();
 }
 
@@ -161,11 +182,18 @@ void FittingWidget::setupPlot() {
     m_plot->graph(1)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssTriangle, Qt::magenta, 6));
     m_plot->graph(1)->setName("实测导数");
 
+    // 理论曲线放在独立的缓冲层，迭代时只重绘该层
+    m_plot->addLayer("model", m_plot->layer("main"), QCustomPlot::limAbove);
+    m_modelLayer = m_plot->layer("model");
+    m_modelLayer->setMode(QCPLayer::lmBuffered);
+
     m_plot->addGraph(); m_plot->graph(2)->setPen(QPen(Qt::red, 2));
     m_plot->graph(2)->setName("理论压差");
+    m_plot->graph(2)->setLayer(m_modelLayer);
 
     m_plot->addGraph(); m_plot->graph(3)->setPen(QPen(Qt::blue, 2));
     m_plot->graph(3)->setName("理论导数");
+    m_plot->graph(3)->setLayer(m_modelLayer);
 
     m_plot->legend->setVisible(true);
     m_plot->legend->setFont(QFont("Microsoft YaHei", 9));
@@ -187,6 +215,13 @@ void FittingWidget::on_btnLoadData_clicked() {
     QVector<double> rawTime, rawPressureData, finalDeriv;
     int skip = settings.skipRows;
     int rows = sourceModel->rowCount();
+    // 选定流动段时只取该段，时间以开关井时刻为零点
+    const bool usePeriod = settings.periodStartRow >= 0;
+    const double t0 = usePeriod ? settings.periodStartTime : 0.0;
+    if (usePeriod) {
+        skip = qMax(skip, settings.periodStartRow);
+        rows = qMin(rows, settings.periodEndRow);
+    }
 
     for (int i = skip; i < rows; ++i) {
         QStandardItem* itemT = sourceModel->item(i, settings.timeColIndex);
@@ -194,7 +229,7 @@ void FittingWidget::on_btnLoadData_clicked() {
 
         if (itemT && itemP) {
             bool okT, okP;
-            double t = itemT->text().toDouble(&okT);
+            double t = itemT->text().toDouble(&okT) - t0;
             double p = itemP->text().toDouble(&okP);
 
             if (okT && okP && t > 0) {
@@ -215,7 +250,7 @@ void FittingWidget::on_btnLoadData_clicked() {
     }
 
     QVector<double> finalDeltaP;
-    double p_shutin = rawPressureData.first();
+    double p_shutin = usePeriod ? settings.periodStartPressure : rawPressureData.first();
 
     for (double p : rawPressureData) {
         double deltaP = 0.0;
@@ -230,22 +265,26 @@ void FittingWidget::on_btnLoadData_clicked() {
     if (settings.derivColIndex == -1) {
         finalDeriv = PressureDerivativeCalculator::calculateBourdetDerivative(rawTime, finalDeltaP, 0.15);
         if (settings.enableSmoothing) {
-            finalDeriv = PressureDerivativeCalculator1::smoothData(finalDeriv, settings.smoothingSpan);
+            finalDeriv = DataFilter::smooth(settings.smoothingMethod, rawTime, finalDeriv,
+                                            settings.smoothingSpan, settings.smoothingLogWidth);
         }
     } else {
         if (settings.enableSmoothing) {
-            finalDeriv = PressureDerivativeCalculator1::smoothData(finalDeriv, settings.smoothingSpan);
+            finalDeriv = DataFilter::smooth(settings.smoothingMethod, rawTime, finalDeriv,
+                                            settings.smoothingSpan, settings.smoothingLogWidth);
         }
         if (finalDeriv.size() != rawTime.size()) {
             finalDeriv.resize(rawTime.size());
         }
     }
 
-    setObservedData(rawTime, finalDeltaP, finalDeriv);
+    setObservedData(rawTime, finalDeltaP, finalDeriv, settings.rateSchedule);
     QMessageBox::information(this, "成功", "观测数据已成功加载。");
 }
 
-void FittingWidget::setObservedData(const QVector<double>& t, const QVector<double>& deltaP, const QVector<double>& d) {
+void FittingWidget::setObservedData(const QVector<double>& t, const QVector<double>& deltaP, const QVector<double>& d,
+                                    const RateSchedule& schedule) {
+    m_rateSchedule = schedule;
     m_obsTime = t;
     m_obsDeltaP = deltaP;
     m_obsDerivative = d;
@@ -296,6 +335,7 @@ void FittingWidget::on_btnRunFit_clicked() {
     }
 
     m_paramChart->updateParamsFromTable();
+    m_preview->cancel();
     m_isFitting = true;
     m_stopRequested = false;
     ui->btnRunFit->setEnabled(false);
@@ -305,7 +345,7 @@ void FittingWidget::on_btnRunFit_clicked() {
     double w = ui->sliderWeight->value() / 100.0;
 
     // 启动异步线程拟合
-    m_watcher.setFuture(QtConcurrent::run([this, modelType, paramsCopy, w](){
+    m_watcher.setFuture(QtConcurrent::run(ModelManager::solverPool(), [this, modelType, paramsCopy, w](){
         runOptimizationTask(modelType, paramsCopy, w);
     }));
 }
@@ -488,8 +528,22 @@ void FittingWidget::runLevenbergMarquardtOptimization(ModelManager::ModelType mo
     QVector<double> residuals = calculateResiduals(currentParamMap, modelType, weight);
     currentSSE = calculateSumSquaredError(residuals);
 
-    ModelCurveData curve = m_modelManager->calculateTheoreticalCurve(modelType, currentParamMap);
-    emit sigIterationUpdated(currentSSE/residuals.size(), currentParamMap, std::get<0>(curve), std::get<1>(curve), std::get<2>(curve));
+    // 图版可用时先在图版上粗扫描找初值，精确残差确实下降才采用
+    if(m_modelManager->hasTypeCurveAtlas()) {
+        QMap<QString, double> seeded = seedFromTypeCurveAtlas(currentParamMap, params, fitIndices, modelType, weight);
+        if(seeded != currentParamMap) {
+            QVector<double> seededRes = calculateResiduals(seeded, modelType, weight);
+            double seededSSE = calculateSumSquaredError(seededRes);
+            if(seededRes.size() == residuals.size() && seededSSE < currentSSE) {
+                currentParamMap = seeded;
+                residuals = seededRes;
+                currentSSE = seededSSE;
+            }
+        }
+    }
+
+    ModelCurveData curve = m_modelManager->calculateTheoreticalCurve(modelType, currentParamMap, QVector<double>(), m_rateSchedule);
+    postIterationUpdate(currentSSE/residuals.size(), currentParamMap, std::get<0>(curve), std::get<1>(curve), std::get<2>(curve));
 
     for(int iter = 0; iter < maxIter; ++iter) {
         if(m_stopRequested) break;
@@ -556,8 +610,8 @@ void FittingWidget::runLevenbergMarquardtOptimization(ModelManager::ModelType mo
                 residuals = newRes;
                 lambda /= 10.0;
                 stepAccepted = true;
-                ModelCurveData iterCurve = m_modelManager->calculateTheoreticalCurve(modelType, currentParamMap);
-                emit sigIterationUpdated(currentSSE/nRes, currentParamMap, std::get<0>(iterCurve), std::get<1>(iterCurve), std::get<2>(iterCurve));
+                ModelCurveData iterCurve = m_modelManager->calculateTheoreticalCurve(modelType, currentParamMap, QVector<double>(), m_rateSchedule);
+                postIterationUpdate(currentSSE/nRes, currentParamMap, std::get<0>(iterCurve), std::get<1>(iterCurve), std::get<2>(iterCurve));
                 break;
             } else {
                 lambda *= 10.0;
@@ -571,17 +625,59 @@ void FittingWidget::runLevenbergMarquardtOptimization(ModelManager::ModelType mo
     if(currentParamMap.contains("L") && currentParamMap.contains("Lf") && currentParamMap["L"] > 1e-9)
         currentParamMap["LfD"] = currentParamMap["Lf"] / currentParamMap["L"];
 
-    ModelCurveData finalCurve = m_modelManager->calculateTheoreticalCurve(modelType, currentParamMap);
-    emit sigIterationUpdated(currentSSE/residuals.size(), currentParamMap, std::get<0>(finalCurve), std::get<1>(finalCurve), std::get<2>(finalCurve));
+    ModelCurveData finalCurve = m_modelManager->calculateTheoreticalCurve(modelType, currentParamMap, QVector<double>(), m_rateSchedule);
+    postIterationUpdate(currentSSE/residuals.size(), currentParamMap, std::get<0>(finalCurve), std::get<1>(finalCurve), std::get<2>(finalCurve));
 
     QMetaObject::invokeMethod(this, "onFitFinished");
 }
 
-QVector<double> FittingWidget::calculateResiduals(const QMap<QString, double>& params, ModelManager::ModelType modelType, double weight) {
+QMap<QString, double> FittingWidget::seedFromTypeCurveAtlas(const QMap<QString, double>& start, const QList<FitParameter>& params, const QVector<int>& fitIndices, ModelManager::ModelType modelType, double weight) {
+    QMap<QString, double> best = start;
+    if(!m_modelManager->typeCurveAtlasCovers(modelType, best)) return best;
+
+    QVector<double> bestRes = calculateResiduals(best, modelType, weight, true);
+    double bestSSE = calculateSumSquaredError(bestRes);
+
+    // 对数参数按 ±0.5、±1 个十倍程试探，表皮等线性参数按 ±1、±3 试探，坐标轮换两遍
+    static const double logSteps[] = { -1.0, -0.5, 0.5, 1.0 };
+    static const double linSteps[] = { -3.0, -1.0, 1.0, 3.0 };
+    for(int sweep = 0; sweep < 2 && !m_stopRequested; ++sweep) {
+        for(int idx : fitIndices) {
+            QString pName = params[idx].name;
+            if(pName == "nf") continue; // 裂缝条数为离散量，不参与扫描
+            double val = best.value(pName);
+            bool isLog = (val > 1e-12 && pName != "S");
+
+            for(int k = 0; k < 4; ++k) {
+                double v = isLog ? val * pow(10.0, logSteps[k]) : val + linSteps[k];
+                v = qMax(params[idx].min, qMin(v, params[idx].max));
+                if(v == best.value(pName)) continue;
+
+                QMap<QString, double> trial = best;
+                trial[pName] = v;
+                if(trial.contains("L") && trial.contains("Lf") && trial["L"] > 1e-9)
+                    trial["LfD"] = trial["Lf"] / trial["L"];
+                // 超出图版范围的试探点会退回逐点求解，直接跳过
+                if(!m_modelManager->typeCurveAtlasCovers(modelType, trial)) continue;
+
+                QVector<double> r = calculateResiduals(trial, modelType, weight, true);
+                double sse = calculateSumSquaredError(r);
+                if(r.size() == bestRes.size() && sse < bestSSE) {
+                    best = trial;
+                    bestSSE = sse;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+QVector<double> FittingWidget::calculateResiduals(const QMap<QString, double>& params, ModelManager::ModelType modelType, double weight, bool usePreview) {
     if(!m_modelManager || m_obsTime.isEmpty()) return QVector<double>();
 
     // 调用 Manager 接口，Manager 内部会调用 Solver，线程安全
-    ModelCurveData res = m_modelManager->calculateTheoreticalCurve(modelType, params, m_obsTime);
+    ModelCurveData res = usePreview ? m_modelManager->calculatePreviewCurve(modelType, params, m_obsTime, m_rateSchedule)
+                                    : m_modelManager->calculateTheoreticalCurve(modelType, params, m_obsTime, m_rateSchedule);
     const QVector<double>& pCal = std::get<1>(res);
     const QVector<double>& dpCal = std::get<2>(res);
 
@@ -682,11 +778,19 @@ void FittingWidget::updateModelCurve() {
         return;
     }
     ui->tableParams->clearFocus();
+    if(m_isFitting) return;
+
+    QMap<QString,double> currentParams;
+    QVector<double> targetT;
+    collectPreviewInput(currentParams, targetT);
+    m_preview->requestNow(m_currentModelType, currentParams, targetT, m_rateSchedule);
+}
 
+void FittingWidget::collectPreviewInput(QMap<QString, double>& currentParams, QVector<double>& targetT) {
     m_paramChart->updateParamsFromTable();
     QList<FitParameter> params = m_paramChart->getParameters();
 
-    QMap<QString,double> currentParams;
+    currentParams.clear();
     for(const auto& p : params) currentParams.insert(p.name, p.value);
 
     if(currentParams.contains("L") && currentParams.contains("Lf") && currentParams["L"] > 1e-9)
@@ -694,14 +798,28 @@ void FittingWidget::updateModelCurve() {
     else
         currentParams["LfD"] = 0.0;
 
-    ModelManager::ModelType type = m_currentModelType;
-    QVector<double> targetT = m_obsTime;
+    targetT = m_obsTime;
     if(targetT.isEmpty()) {
         for(double e = -4; e <= 4; e += 0.1) targetT.append(pow(10, e));
     }
+}
+
+void FittingWidget::onParamItemChanged(QTableWidgetItem* item) {
+    // 只响应数值列；拟合过程中参数表由拟合线程刷新
+    if(!item || item->column() != 2 || m_isFitting || !m_modelManager) return;
+
+    QMap<QString,double> currentParams;
+    QVector<double> targetT;
+    collectPreviewInput(currentParams, targetT);
+    m_preview->request(m_currentModelType, currentParams, targetT, m_rateSchedule);
+}
 
-    ModelCurveData res = m_modelManager->calculateTheoreticalCurve(type, currentParams, targetT);
-    onIterationUpdate(0, currentParams, std::get<0>(res), std::get<1>(res), std::get<2>(res));
+void FittingWidget::onPreviewReady(const QMap<QString, double>& params, const ModelCurveData& curve, bool final) {
+    Q_UNUSED(params);
+    if(m_isFitting) return;
+    // 交互预览：图版可用时按图版插值，拟合与导出仍用精确解；参数表保持用户输入的原样
+    if(final) ui->label_Error->setText(QString("误差(MSE): %1").arg(0.0, 0, 'e', 3));
+    plotCurves(std::get<0>(curve), std::get<1>(curve), std::get<2>(curve), true);
 }
 
 void FittingWidget::onIterationUpdate(double err, const QMap<QString,double>& p,
@@ -712,8 +830,10 @@ void FittingWidget::onIterationUpdate(double err, const QMap<QString,double>& p,
     for(int i=0; i<ui->tableParams->rowCount(); ++i) {
         QString key = ui->tableParams->item(i, 1)->data(Qt::UserRole).toString();
         if(p.contains(key)) {
-            double val = p[key];
-            ui->tableParams->item(i, 2)->setText(QString::number(val, 'g', 5));
+            // 只改动数值变化的单元格，避免整表重绘
+            QString text = QString::number(p[key], 'g', 5);
+            QTableWidgetItem* item = ui->tableParams->item(i, 2);
+            if(item->text() != text) item->setText(text);
         }
     }
     ui->tableParams->blockSignals(false);
@@ -721,7 +841,41 @@ void FittingWidget::onIterationUpdate(double err, const QMap<QString,double>& p,
     plotCurves(t, p_curve, d_curve, true);
 }
 
+void FittingWidget::postIterationUpdate(double err, const QMap<QString,double>& p, const QVector<double>& t, const QVector<double>& p_curve, const QVector<double>& d_curve) {
+    bool schedule = false;
+    {
+        // 容器为隐式共享，锁内只做引用计数赋值
+        QMutexLocker locker(&m_iterationMutex);
+        m_pendingIteration.error = err;
+        m_pendingIteration.params = p;
+        m_pendingIteration.t = t;
+        m_pendingIteration.p = p_curve;
+        m_pendingIteration.d = d_curve;
+        m_hasPendingIteration = true;
+        // 已有刷新在排队时不再投递事件，未绘制的旧状态直接被覆盖；
+        // 排队标记与待绘制状态在同一把锁下修改，刷新不会漏掉
+        schedule = !m_renderScheduled;
+        m_renderScheduled = true;
+    }
+    if(schedule)
+        QMetaObject::invokeMethod(m_renderTimer, "start", Qt::QueuedConnection);
+}
+
+void FittingWidget::flushIterationUpdate() {
+    IterationState state;
+    {
+        QMutexLocker locker(&m_iterationMutex);
+        m_renderScheduled = false;
+        if(!m_hasPendingIteration) return;
+        std::swap(state, m_pendingIteration);
+        m_hasPendingIteration = false;
+    }
+    onIterationUpdate(state.error, state.params, state.t, state.p, state.d);
+}
+
 void FittingWidget::onFitFinished() {
+    // 先画出最后一次迭代 (最终结果)
+    flushIterationUpdate();
     m_isFitting = false;
     ui->btnRunFit->setEnabled(true);
     QMessageBox::information(this, "完成", "拟合完成。");
@@ -730,29 +884,38 @@ void FittingWidget::onFitFinished() {
 void FittingWidget::plotCurves(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d, bool isModel) {
     if (!m_plot) return;
 
-    QVector<double> vt, vp, vd;
-    for(int i=0; i<t.size(); ++i) {
-        if(t[i]>1e-8 && p[i]>1e-8) {
-            vt<<t[i];
-            vp<<p[i];
-            if(i<d.size() && d[i]>1e-8) vd<<d[i]; else vd<<1e-10;
-        }
-    }
     if(isModel) {
-        m_plot->graph(2)->setData(vt, vp);
-        m_plot->graph(3)->setData(vt, vd);
+        // 直接填充 QCPGraphData，省去中间过滤数组
+        QVector<QCPGraphData> pData, dData;
+        pData.reserve(t.size());
+        dData.reserve(t.size());
+        for(int i=0; i<t.size(); ++i) {
+            if(t[i]>1e-8 && p[i]>1e-8) {
+                pData.append(QCPGraphData(t[i], p[i]));
+                dData.append(QCPGraphData(t[i], (i<d.size() && d[i]>1e-8) ? d[i] : 1e-10));
+            }
+        }
+        m_plot->graph(2)->data()->set(pData);
+        m_plot->graph(3)->data()->set(dData);
 
-        if (m_obsTime.isEmpty() && !vt.isEmpty()) {
+        if (m_obsTime.isEmpty() && !pData.isEmpty()) {
             m_plot->rescaleAxes();
             if(m_plot->xAxis->range().lower<=0) m_plot->xAxis->setRangeLower(1e-3);
             if(m_plot->yAxis->range().lower<=0) m_plot->yAxis->setRangeLower(1e-3);
+            m_plot->replot();
+        } else if (m_modelLayer) {
+            // 坐标范围不变：只重绘理论曲线层
+            m_modelLayer->replot();
+        } else {
+            m_plot->replot();
         }
-        m_plot->replot();
     }
 }
 
 void FittingWidget::on_btnExportReport_clicked()
 {
+    if (m_reportWatcher.isRunning()) return;
+
     m_paramChart->updateParamsFromTable();
     QList<FitParameter> params = m_paramChart->getParameters();
 
@@ -818,36 +981,28 @@ void FittingWidget::on_btnExportReport_clicked()
     html += "</table>";
 
     html += "<h2>5. 拟合曲线图</h2>";
-    QString imgBase64 = getPlotImageBase64();
-    if(!imgBase64.isEmpty()) {
-        html += "<div style='text-align:center;'><img src='data:image/png;base64," + imgBase64 + "' width='600' /></div>";
-    } else {
-        html += "<p>图像导出失败。</p>";
-    }
 
-    html += "</body></html>";
+    ReportDocument document;
+    document.appendHtml(html);
+    document.appendFigure(ReportWriter::captureFigure(m_plot, 800, 600, 600));
+    document.appendHtml("</body></html>");
 
-    QFile file(fileName);
-    if(file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&file);
-        out.setEncoding(QStringConverter::Utf8);
-        out << html;
-        file.close();
-        QMessageBox::information(this, "导出成功", "报告已保存至:\n" + fileName);
-    } else {
-        QMessageBox::critical(this, "错误", "无法写入文件，请检查权限或文件是否被占用。");
-    }
+    // 图像编码与写文件放到后台，界面不等待
+    ui->btnExportReport->setEnabled(false);
+    m_reportWatcher.setFuture(QtConcurrent::run([fileName, document]() {
+        return ReportWriter::write(fileName, document);
+    }));
 }
 
-QString FittingWidget::getPlotImageBase64()
+void FittingWidget::onReportWritten()
 {
-    if(!m_plot) return "";
-    QPixmap pixmap = m_plot->toPixmap(800, 600);
-    QByteArray byteArray;
-    QBuffer buffer(&byteArray);
-    buffer.open(QIODevice::WriteOnly);
-    pixmap.save(&buffer, "PNG");
-    return QString::fromLatin1(byteArray.toBase64().data());
+    ui->btnExportReport->setEnabled(true);
+    const ReportWriteResult result = m_reportWatcher.result();
+    if (result.success) {
+        QMessageBox::information(this, "导出成功", "报告已保存至:\n" + result.fileName);
+    } else {
+        QMessageBox::critical(this, "错误", result.errorMessage);
+    }
 }
 
 void FittingWidget::on_btnSaveFit_clicked()
@@ -894,6 +1049,7 @@ QJsonObject FittingWidget::getJsonState() const
     obsData["pressure"] = pressArr;
     obsData["derivative"] = derivArr;
     root["observedData"] = obsData;
+    if (!m_rateSchedule.isEmpty()) root["rateSchedule"] = m_rateSchedule.toJson();
 
     return root;
 }
@@ -955,7 +1111,7 @@ void FittingWidget::loadFittingState(const QJsonObject& root)
         for(auto v : pArr) p.append(v.toDouble());
         for(auto v : dArr) d.append(v.toDouble());
 
-        setObservedData(t, p, d);
+        setObservedData(t, p, d, RateSchedule::fromJson(root["rateSchedule"].toObject()));
     }
 
     updateModelCurve();
@@ -6,6 +6,9 @@
  * 2. 声明用于Levenberg-Marquardt非线性回归拟合的核心算法函数。
  * 3. 声明观测数据（时间、压差、导数）的管理函数。
  * 4. 集成 ChartWidget 以统一图表显示和交互体验。
+ * 5. 拟合迭代结果按帧合并刷新：只保留最新状态，理论曲线位于独立缓冲层单独重绘。
+ * 6. 报告导出在后台线程编码图像并写文件，未变化的图像复用缓存。
+ * 7. 参数表数值修改后经 CurvePreviewService 去抖并在后台计算预览曲线，先粗后细，界面不等待求解。
  */
 
 #ifndef WT_FITTINGWIDGET_H
@@ -17,11 +20,15 @@
 #include <QFutureWatcher>
 #include <QJsonObject>
 #include <QStandardItemModel>
+#include <QMutex>
+#include <QTimer>
 #include "modelmanager.h" // 包含 ModelManager 的 ModelType 定义
 #include "mousezoom.h"
 #include "chartwidget.h"  // [新增] 引入图表组件头文件
 #include "fittingparameterchart.h"
 #include "paramselectdialog.h"
+#include "reportwriter.h"
+#include "curvepreviewservice.h"
 
 namespace Ui { class FittingWidget; }
 
@@ -39,7 +46,9 @@ public:
     void setProjectDataModel(QStandardItemModel* model);
 
     // 设置观测数据
-    void setObservedData(const QVector<double>& t, const QVector<double>& deltaP, const QVector<double>& deriv);
+    // schedule: 观测段之前的产量历史 (时间以观测段起点为零点)，为空时按单一产量计算
+    void setObservedData(const QVector<double>& t, const QVector<double>& deltaP, const QVector<double>& deriv,
+                         const RateSchedule& schedule = RateSchedule());
     // 更新基础参数
     void updateBasicParameters();
 
@@ -50,8 +59,6 @@ public:
 signals:
     // 拟合完成信号
     void fittingCompleted(ModelManager::ModelType modelType, const QMap<QString, double>& parameters);
-    // 迭代更新信号
-    void sigIterationUpdated(double error, QMap<QString, double> currentParams, QVector<double> t, QVector<double> p, QVector<double> d);
     // 进度信号
     void sigProgress(int progress);
     // 请求保存信号
@@ -81,8 +88,15 @@ private slots:
 
     // 内部拟合逻辑槽函数
     void onIterationUpdate(double err, const QMap<QString,double>& p, const QVector<double>& t, const QVector<double>& p_curve, const QVector<double>& d_curve);
+    // 刷新定时器到期：取出最新的迭代状态并绘制
+    void flushIterationUpdate();
     void onFitFinished();
+    // 报告后台写出完成
+    void onReportWritten();
     void onSliderWeightChanged(int value);
+    // 参数表数值被修改：去抖后刷新预览
+    void onParamItemChanged(QTableWidgetItem* item);
+    void onPreviewReady(const QMap<QString, double>& params, const ModelCurveData& curve, bool final);
 
 private:
     Ui::FittingWidget *ui;
@@ -104,29 +118,54 @@ private:
     QVector<double> m_obsTime;
     QVector<double> m_obsDeltaP;
     QVector<double> m_obsDerivative;
+    RateSchedule m_rateSchedule;
 
     // 拟合状态控制
     bool m_isFitting;
     bool m_stopRequested;
     QFutureWatcher<void> m_watcher;
+    QFutureWatcher<ReportWriteResult> m_reportWatcher;
+
+    // 迭代结果的帧合并刷新 (拟合线程只覆盖写入最新状态，界面每帧最多绘制一次)
+    struct IterationState {
+        double error = 0.0;
+        QMap<QString, double> params;
+        QVector<double> t;
+        QVector<double> p;
+        QVector<double> d;
+    };
+    QMutex m_iterationMutex;
+    IterationState m_pendingIteration;
+    bool m_hasPendingIteration;
+    bool m_renderScheduled;         // 已投递刷新事件 (受 m_iterationMutex 保护)
+    QTimer* m_renderTimer;
+    QCPLayer* m_modelLayer; // 理论曲线所在的缓冲层
+
+    CurvePreviewService* m_preview; // 参数修改后的后台预览计算
 
     // 初始化图表设置
     void setupPlot();
     // 初始化默认模型
     void initializeDefaultModel();
-    // 更新模型曲线
+    // 更新模型曲线 (立即在后台计算，不去抖)
     void updateModelCurve();
+    // 读取参数表当前参数及预览时间轴
+    void collectPreviewInput(QMap<QString, double>& params, QVector<double>& time);
 
     // 核心拟合算法函数 (Levenberg-Marquardt)
     void runOptimizationTask(ModelManager::ModelType modelType, QList<FitParameter> fitParams, double weight);
     void runLevenbergMarquardtOptimization(ModelManager::ModelType modelType, QList<FitParameter> params, double weight);
-    QVector<double> calculateResiduals(const QMap<QString, double>& params, ModelManager::ModelType modelType, double weight);
+    // 拟合线程调用：提交一次迭代结果，不等待界面
+    void postIterationUpdate(double err, const QMap<QString,double>& p, const QVector<double>& t, const QVector<double>& p_curve, const QVector<double>& d_curve);
+    // usePreview 为 true 时按典型曲线图版快速计算 (图版初值扫描使用)
+    QVector<double> calculateResiduals(const QMap<QString, double>& params, ModelManager::ModelType modelType, double weight, bool usePreview = false);
+    // 在图版上对各拟合参数做粗扫描，为 LM 提供初值
+    QMap<QString, double> seedFromTypeCurveAtlas(const QMap<QString, double>& start, const QList<FitParameter>& params, const QVector<int>& fitIndices, ModelManager::ModelType modelType, double weight);
     QVector<QVector<double>> computeJacobian(const QMap<QString, double>& params, const QVector<double>& residuals, const QVector<int>& fitIndices, ModelManager::ModelType modelType, const QList<FitParameter>& currentFitParams, double weight);
     QVector<double> solveLinearSystem(const QVector<QVector<double>>& A, const QVector<double>& b);
     double calculateSumSquaredError(const QVector<double>& residuals);
 
     // 辅助绘图函数
-    QString getPlotImageBase64();
     void plotCurves(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d, bool isModel);
 };
 
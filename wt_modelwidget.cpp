@@ -6,6 +6,10 @@
  * 2. 响应用户操作，收集界面参数，调用 ModelSolver01_06 进行计算。
  * 3. 将计算结果绘制在 QCustomPlot 图表上。
  * 4. 实现了 UI 逻辑与数学逻辑的分离。
+ * 5. 勾选 "图版快速计算" 时各曲线按典型曲线图版插值，参数超出图版范围的曲线自动逐点求解。
+ * 6. 敏感性分析先按工况顺序建好空曲线 (图例顺序固定)，各工况算完后填入数据并合并重绘。
+ * 7. 正演计算提交到 ModelManager::solverPool()，结果经队列信号带回界面线程，按代号丢弃过期结果；
+ *    进度由定时器轮询 SolveControl 显示在按钮上。
  */
 
 #include "wt_modelwidget.h"
@@ -18,14 +22,19 @@
 #include <QFileDialog>
 #include <QTextStream>
 #include <QDateTime>
-#include <QCoreApplication>
 #include <QSplitter>
+#include <QtConcurrent>
 
 WT_ModelWidget::WT_ModelWidget(ModelType type, QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::WT_ModelWidget)
     , m_type(type)
     , m_highPrecision(true)
+    , m_atlas(nullptr)
+    , m_sensitivity(new SensitivityRunner(this))
+    , m_resultCase(-1)
+    , m_calcGeneration(0)
+    , m_progressTimer(new QTimer(this))
 {
     ui->setupUi(this);
 
@@ -33,6 +42,13 @@ WT_ModelWidget::WT_ModelWidget(ModelType type, QWidget *parent)
     m_solver = new ModelSolver01_06(m_type);
 
     m_colorList = { Qt::red, Qt::blue, QColor(0,180,0), Qt::magenta, QColor(255,140,0), Qt::cyan };
+    connect(m_sensitivity, &SensitivityRunner::caseFinished, this, &WT_ModelWidget::onSensitivityCaseFinished);
+    connect(m_sensitivity, &SensitivityRunner::finished, this, &WT_ModelWidget::onSensitivityFinished);
+
+    qRegisterMetaType<ModelCurveData>("ModelCurveData");
+    connect(this, &WT_ModelWidget::forwardCurveReady, this, &WT_ModelWidget::onForwardCurveReady, Qt::QueuedConnection);
+    m_progressTimer->setInterval(100);
+    connect(m_progressTimer, &QTimer::timeout, this, &WT_ModelWidget::onProgressTick);
 
     // [布局] 设置 Splitter 初始比例 (左 20% : 右 80%)
     QList<int> sizes;
@@ -51,6 +67,10 @@ WT_ModelWidget::WT_ModelWidget(ModelType type, QWidget *parent)
 
 WT_ModelWidget::~WT_ModelWidget()
 {
+    // 后台计算仍在使用求解器，须先结束
+    cancelForwardCalculation();
+    m_sensitivity->cancel();
+    m_sensitivity->waitForFinished();
     delete m_solver; // 清理求解器资源
     delete ui;
 }
@@ -74,6 +94,13 @@ void WT_ModelWidget::setHighPrecision(bool high)
     if (m_solver) m_solver->setHighPrecision(high);
 }
 
+void WT_ModelWidget::setTypeCurveAtlas(const TypeCurveAtlas* atlas)
+{
+    m_atlas = atlas;
+    ui->checkUseAtlas->setEnabled(atlas != nullptr);
+    ui->checkUseAtlas->setChecked(atlas != nullptr);
+}
+
 void WT_ModelWidget::initUi() {
     using MT = ModelSolver01_06::ModelType;
     if (m_type == MT::Model_1 || m_type == MT::Model_2) {
@@ -144,6 +171,15 @@ void WT_ModelWidget::setupConnections() {
 
     // [新增] 转发模型选择按钮信号
     connect(ui->btnSelectModel, &QPushButton::clicked, this, &WT_ModelWidget::requestModelSelection);
+
+    // 参数修改后，尚未完成的正演计算已过期
+    const QList<QLineEdit*> inputs = {
+        ui->phiEdit, ui->hEdit, ui->muEdit, ui->BEdit, ui->CtEdit, ui->qEdit, ui->tEdit, ui->pointsEdit,
+        ui->kfEdit, ui->kmEdit, ui->LEdit, ui->LfEdit, ui->nfEdit, ui->rmDEdit, ui->omga1Edit, ui->omga2Edit,
+        ui->remda1Edit, ui->gamaDEdit, ui->reDEdit, ui->cDEdit, ui->sEdit
+    };
+    for (QLineEdit* edit : inputs) connect(edit, &QLineEdit::textChanged, this, &WT_ModelWidget::onInputsChanged);
+    connect(ui->checkUseAtlas, &QCheckBox::toggled, this, &WT_ModelWidget::onInputsChanged);
 }
 
 QVector<double> WT_ModelWidget::parseInput(const QString& text) {
@@ -222,17 +258,29 @@ void WT_ModelWidget::onShowPointsToggled(bool checked) {
 }
 
 void WT_ModelWidget::onCalculateClicked() {
-    ui->calculateButton->setEnabled(false);
-    ui->calculateButton->setText("计算中...");
-    QCoreApplication::processEvents();
+    // 计算进行中：按钮用作取消
+    if (m_sensitivity->isRunning()) {
+        m_sensitivity->cancel();
+        ui->calculateButton->setEnabled(false);
+        ui->calculateButton->setText("正在停止...");
+        return;
+    }
+    if (m_calcControl) {
+        cancelForwardCalculation();
+        resetCalculateButton();
+        return;
+    }
+
     runCalculation();
+}
+
+void WT_ModelWidget::resetCalculateButton() {
     ui->calculateButton->setEnabled(true);
     ui->calculateButton->setText("开始计算");
 }
 
 void WT_ModelWidget::runCalculation() {
     MouseZoom* plot = ui->chartWidget->getPlot();
-    plot->clearGraphs();
 
     // 收集界面输入参数
     QMap<QString, QVector<double>> rawParams;
@@ -266,18 +314,16 @@ void WT_ModelWidget::runCalculation() {
         rawParams["S"] = {0.0};
     }
 
-    // 检查敏感性参数 (多值)
-    QString sensitivityKey = "";
-    QVector<double> sensitivityValues;
+    // 检查敏感性参数 (多值，最多取前两个)
+    QStringList sensitivityKeys;
     for(auto it = rawParams.begin(); it != rawParams.end(); ++it) {
         if(it.key() == "t") continue;
         if(it.value().size() > 1) {
-            sensitivityKey = it.key();
-            sensitivityValues = it.value();
-            break;
+            sensitivityKeys << it.key();
+            if(sensitivityKeys.size() == 2) break;
         }
     }
-    bool isSensitivity = !sensitivityKey.isEmpty();
+    bool isSensitivity = !sensitivityKeys.isEmpty();
 
     // 构建基础参数字典
     QMap<QString, double> baseParams;
@@ -298,42 +344,152 @@ void WT_ModelWidget::runCalculation() {
     // 调用 Solver 的静态方法生成时间
     QVector<double> t = ModelSolver01_06::generateLogTimeSteps(nPoints, -3.0, log10(maxTime));
 
-    int iterations = isSensitivity ? sensitivityValues.size() : 1;
-    iterations = qMin(iterations, (int)m_colorList.size());
-
-    QString resultTextHeader = QString("计算完成 (%1)\n").arg(getModelName());
-    if(isSensitivity) resultTextHeader += QString("敏感性参数: %1\n").arg(sensitivityKey);
-
-    // 循环计算曲线
-    for(int i = 0; i < iterations; ++i) {
-        QMap<QString, double> currentParams = baseParams;
-        double val = 0;
-        if (isSensitivity) {
-            val = sensitivityValues[i];
-            currentParams[sensitivityKey] = val;
-            if (sensitivityKey == "L" || sensitivityKey == "Lf") {
-                if(currentParams["L"] > 1e-9) currentParams["LfD"] = currentParams["Lf"] / currentParams["L"];
+    m_resultHeader = QString("计算完成 (%1)\n").arg(getModelName());
+    if(isSensitivity) m_resultHeader += QString("敏感性参数: %1\n").arg(sensitivityKeys.join(", "));
+
+    const TypeCurveAtlas* atlas = (m_atlas && ui->checkUseAtlas->isChecked()) ? m_atlas : nullptr;
+    if(atlas) m_resultHeader += "计算方式: 典型曲线图版插值\n";
+    m_baseParams = baseParams;
+
+    if (isSensitivity) {
+        // 后台并行计算各工况，按工况顺序预先建好曲线，结果到达后填入
+        plot->clearGraphs();
+        QVector<SensitivityCase> cases = buildSensitivityCases(baseParams, sensitivityKeys, rawParams);
+        for(int i = 0; i < cases.size(); ++i) {
+            plotCurve(ModelCurveData(), cases[i].label, caseColor(i, cases.size()), true);
+        }
+        onShowPointsToggled(ui->checkShowPoints->isChecked());
+
+        res_tD.clear(); res_pD.clear(); res_dpD.clear();
+        m_resultCase = -1;
+        m_sensitivity->start(m_solver, cases, t, atlas);
+        ui->calculateButton->setText(QString("停止计算 (0/%1)").arg(cases.size()));
+        ui->calculateButton->setEnabled(true);
+        return;
+    }
+
+    // 后台调用 Solver 计算，旧曲线保留到新结果到达
+    cancelForwardCalculation();
+    m_calcControl = std::make_shared<SolveControl>();
+    const quint64 generation = ++m_calcGeneration;
+    std::shared_ptr<SolveControl> control = m_calcControl;
+    ModelSolver01_06* solver = m_solver;
+    m_calcFuture = QtConcurrent::run(ModelManager::solverPool(), [this, solver, baseParams, t, atlas, control, generation]() {
+        ModelCurveData res = solver->calculateTheoreticalCurve(baseParams, t, RateSchedule(), atlas, control.get());
+        if (!control->cancelled) emit forwardCurveReady(generation, res);
+    });
+
+    ui->calculateButton->setText("停止计算 (0%)");
+    ui->calculateButton->setEnabled(true);
+    m_progressTimer->start();
+}
+
+void WT_ModelWidget::cancelForwardCalculation() {
+    if (m_calcControl) m_calcControl->cancelled = true;
+    m_calcFuture.waitForFinished();
+    ++m_calcGeneration; // 使已排队的结果失效
+    m_calcControl.reset();
+    m_progressTimer->stop();
+}
+
+void WT_ModelWidget::onForwardCurveReady(quint64 generation, const ModelCurveData& curve) {
+    if (generation != m_calcGeneration) return;
+    m_calcControl.reset();
+    m_progressTimer->stop();
+
+    res_tD = std::get<0>(curve);
+    res_pD = std::get<1>(curve);
+    res_dpD = std::get<2>(curve);
+    ui->chartWidget->getPlot()->clearGraphs();
+    plotCurve(curve, "理论曲线", Qt::red, false);
+
+    finishCalculation();
+    resetCalculateButton();
+}
+
+void WT_ModelWidget::onProgressTick() {
+    if (!m_calcControl) return;
+    ui->calculateButton->setText(QString("停止计算 (%1%)").arg(m_calcControl->percent()));
+}
+
+void WT_ModelWidget::onInputsChanged() {
+    if (!m_calcControl) return;
+    cancelForwardCalculation();
+    resetCalculateButton();
+}
+
+QVector<SensitivityCase> WT_ModelWidget::buildSensitivityCases(const QMap<QString, double>& baseParams, const QStringList& keys,
+                                                               const QMap<QString, QVector<double>>& rawParams) const {
+    QVector<SensitivityCase> cases;
+    const QVector<double> firstValues = rawParams.value(keys[0]);
+    const QVector<double> secondValues = keys.size() > 1 ? rawParams.value(keys[1]) : QVector<double>{ 0.0 };
+    const bool lengthChanged = keys.contains("L") || keys.contains("Lf");
+
+    for(double v1 : firstValues) {
+        for(double v2 : secondValues) {
+            SensitivityCase c;
+            c.params = baseParams;
+            c.params[keys[0]] = v1;
+            c.label = QString("%1 = %2").arg(keys[0]).arg(v1);
+            if (keys.size() > 1) {
+                c.params[keys[1]] = v2;
+                c.label += QString(", %1 = %2").arg(keys[1]).arg(v2);
             }
+            if (lengthChanged && c.params["L"] > 1e-9) c.params["LfD"] = c.params["Lf"] / c.params["L"];
+            cases.append(c);
         }
+    }
+    return cases;
+}
 
-        // 调用 Solver 计算
-        ModelCurveData res = calculateTheoreticalCurve(currentParams, t);
+QColor WT_ModelWidget::caseColor(int index, int count) const {
+    if (count <= m_colorList.size()) return m_colorList[index];
+    // 色相 0~300 度 (红到紫)，避免首尾颜色相近
+    return QColor::fromHsv(300 * index / (count - 1), 230, 210);
+}
 
-        // 缓存最后一次结果用于显示
-        res_tD = std::get<0>(res);
-        res_pD = std::get<1>(res);
-        res_dpD = std::get<2>(res);
+void WT_ModelWidget::onSensitivityCaseFinished(int index, const ModelCurveData& curve) {
+    MouseZoom* plot = ui->chartWidget->getPlot();
+    if (2 * index + 1 >= plot->graphCount()) return;
 
-        QColor curveColor = isSensitivity ? m_colorList[i] : Qt::red;
-        QString legendName;
-        if (isSensitivity) legendName = QString("%1 = %2").arg(sensitivityKey).arg(val);
-        else legendName = "理论曲线";
+    plot->graph(2 * index)->setData(std::get<0>(curve), std::get<1>(curve));
+    plot->graph(2 * index + 1)->setData(std::get<0>(curve), std::get<2>(curve));
 
-        plotCurve(res, legendName, curveColor, isSensitivity);
+    // 结果文本显示已完成的最后一个工况
+    if (index > m_resultCase) {
+        m_resultCase = index;
+        res_tD = std::get<0>(curve);
+        res_pD = std::get<1>(curve);
+        res_dpD = std::get<2>(curve);
     }
 
+    // 首条曲线到达时调整视图，之后保留用户的缩放；重绘合并到下一次事件循环
+    if (m_sensitivity->finishedCount() == 1) {
+        plot->rescaleAxes();
+        if(plot->xAxis->range().lower <= 0) plot->xAxis->setRangeLower(1e-3);
+        if(plot->yAxis->range().lower <= 0) plot->yAxis->setRangeLower(1e-3);
+    }
+    plot->replot(QCustomPlot::rpQueuedReplot);
+
+    if (ui->calculateButton->isEnabled()) {
+        ui->calculateButton->setText(QString("停止计算 (%1/%2)").arg(m_sensitivity->finishedCount()).arg(m_sensitivity->caseCount()));
+    }
+}
+
+void WT_ModelWidget::onSensitivityFinished(bool canceled) {
+    if (canceled) {
+        m_resultHeader += QString("计算已取消 (完成 %1/%2 个工况)\n")
+                              .arg(m_sensitivity->finishedCount()).arg(m_sensitivity->caseCount());
+    }
+    finishCalculation();
+    resetCalculateButton();
+}
+
+void WT_ModelWidget::finishCalculation() {
+    MouseZoom* plot = ui->chartWidget->getPlot();
+
     // 更新结果文本
-    QString resultText = resultTextHeader;
+    QString resultText = m_resultHeader;
     resultText += "t(h)\t\tDp(MPa)\t\tdDp(MPa)\n";
     for(int i=0; i<res_pD.size(); ++i) {
         resultText += QString("%1\t%2\t%3\n").arg(res_tD[i],0,'e',4).arg(res_pD[i],0,'e',4).arg(res_dpD[i],0,'e',4);
@@ -347,7 +503,7 @@ void WT_ModelWidget::runCalculation() {
     plot->replot();
 
     onShowPointsToggled(ui->checkShowPoints->isChecked());
-    emit calculationCompleted(getModelName(), baseParams);
+    emit calculationCompleted(getModelName(), m_baseParams);
 }
 
 void WT_ModelWidget::plotCurve(const ModelCurveData& data, const QString& name, QColor color, bool isSensitivity) {
@@ -5,6 +5,10 @@
  * 1. 管理用户界面，处理参数输入、按钮响应和图表展示。
  * 2. 包含 ModelSolver01_06 实例，调用其进行数学计算。
  * 3. 继承自 QWidget，不再包含复杂的数学算法实现。
+ * 4. 提供典型曲线图版时可勾选 "图版快速计算"，预览与敏感性曲线按图版插值。
+ * 5. 敏感性分析支持单参数或双参数扫描 (工况数不限)，由 SensitivityRunner 在后台并行计算，
+ *    曲线逐条显示，计算过程中按钮变为 "停止计算" 可随时取消。
+ * 6. 单条理论曲线同样在后台计算 (与拟合共用求解线程池)，按钮显示进度；参数被修改后未完成的计算自动取消。
  */
 
 #ifndef WT_MODELWIDGET_H
@@ -14,9 +18,13 @@
 #include <QMap>
 #include <QVector>
 #include <QColor>
+#include <QFuture>
+#include <QTimer>
 #include <tuple>
+#include <memory>
 #include "chartwidget.h"
 #include "modelsolver01-06.h"
+#include "sensitivityrunner.h"
 
 namespace Ui {
 class WT_ModelWidget;
@@ -37,6 +45,8 @@ public:
 
     // 设置高精度模式（转发给 Solver）
     void setHighPrecision(bool high);
+    // 设置典型曲线图版 (由 ModelManager 持有)，启用 "图版快速计算" 选项
+    void setTypeCurveAtlas(const TypeCurveAtlas* atlas);
     // 直接调用求解器计算（供外部管理器使用，非 UI 交互）
     ModelCurveData calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>());
     // 获取当前模型名称
@@ -47,6 +57,8 @@ signals:
     void calculationCompleted(const QString& modelType, const QMap<QString, double>& params);
     // 请求模型选择界面的信号
     void requestModelSelection();
+    // 后台正演计算完成 (由工作线程发出，以队列方式送达)
+    void forwardCurveReady(quint64 generation, const ModelCurveData& curve);
 
 public slots:
     void onCalculateClicked();
@@ -55,6 +67,14 @@ public slots:
     void onShowPointsToggled(bool checked);
     void onExportData();
 
+private slots:
+    void onSensitivityCaseFinished(int index, const ModelCurveData& curve);
+    void onSensitivityFinished(bool canceled);
+    void onForwardCurveReady(quint64 generation, const ModelCurveData& curve);
+    void onProgressTick();
+    // 计算参数被修改：取消尚未完成的正演计算
+    void onInputsChanged();
+
 private:
     void initUi();
     void initChart();
@@ -65,6 +85,16 @@ private:
     QVector<double> parseInput(const QString& text);
     void setInputText(QLineEdit* edit, double value);
     void plotCurve(const ModelCurveData& data, const QString& name, QColor color, bool isSensitivity);
+    // 按敏感性参数 (1~2 个) 的取值展开全部工况，双参数时取笛卡尔积
+    QVector<SensitivityCase> buildSensitivityCases(const QMap<QString, double>& baseParams, const QStringList& keys,
+                                                   const QMap<QString, QVector<double>>& rawParams) const;
+    // 工况数不超过预设颜色数时用预设颜色，否则按色相均匀取色
+    QColor caseColor(int index, int count) const;
+    // 输出结果文本、调整视图并发出完成信号
+    void finishCalculation();
+    // 取消并等待正在进行的正演计算 (求解器逐点检查取消标记，等待时间很短)
+    void cancelForwardCalculation();
+    void resetCalculateButton();
 
 private:
     Ui::WT_ModelWidget *ui;
@@ -72,8 +102,19 @@ private:
     ModelSolver01_06* m_solver; // 数学模型求解器实例
 
     bool m_highPrecision;
+    const TypeCurveAtlas* m_atlas; // 典型曲线图版，未加载时为空
     QList<QColor> m_colorList;
 
+    SensitivityRunner* m_sensitivity;
+    QString m_resultHeader;              // 结果文本表头
+    QMap<QString, double> m_baseParams;  // 本次计算的基础参数
+    int m_resultCase;                    // res_* 对应的敏感性工况下标
+
+    QFuture<void> m_calcFuture;                 // 后台正演计算
+    std::shared_ptr<SolveControl> m_calcControl;
+    quint64 m_calcGeneration;                   // 每次启动/取消加一，过期结果直接丢弃
+    QTimer* m_progressTimer;
+
     // 缓存计算结果
     QVector<double> res_tD;
     QVector<double> res_pD;
@@ -9,6 +9,10 @@
  * - 压力产量/导数分析：坐标轴标签恢复为标准默认值 ("Time", "Pressure" 等)。
  * - 新建曲线：坐标轴标签继续使用列名。
  * 4. 新建窗口修复：确保新建窗口中的图表也能正确显示线型和标签。
+ * 5. 压力/导数曲线经 CurveLod 设置数据，大数据量时按视图降采样，平移缩放保持流畅。
+ * 6. 导出选点通过绘图控件的空间索引查询最近数据点，不依赖逐点的 selectTest。
+ * 7. 曲线数据点以二进制存入 _chart.wtc，与项目缓存、LOD 金字塔隐式共享同一份数组。
+ * 8. 曲线列表只加载配置，双击显示时才读取数据点；保存时未加载的曲线临时读出后写回。
  */
 
 #include "wt_plottingwidget.h"
@@ -20,6 +24,8 @@
 #include "chartwindow.h"
 #include "modelparameter.h"
 #include "chartsetting1.h"
+#include "datafilter.h"
+#include "curvelod.h"
 
 #include <QMessageBox>
 #include <QFileDialog>
@@ -36,18 +42,15 @@
 // 辅助函数与 CurveInfo 实现
 // ============================================================================
 
-QJsonArray vectorToJson(const QVector<double>& vec) {
-    QJsonArray arr;
-    for(double v : vec) arr.append(v);
-    return arr;
-}
-
 QVector<double> jsonToVector(const QJsonArray& arr) {
     QVector<double> vec;
     for(const auto& val : arr) vec.append(val.toDouble());
     return vec;
 }
 
+// 同时保留数据点的曲线数 (不含未保存的曲线和当前显示的曲线)
+const int kMaxResidentCurves = 8;
+
 QJsonObject CurveInfo::toJson() const {
     QJsonObject obj;
     obj["name"] = name;
@@ -55,8 +58,6 @@ QJsonObject CurveInfo::toJson() const {
     obj["type"] = type;
     obj["xCol"] = xCol;
     obj["yCol"] = yCol;
-    obj["xData"] = vectorToJson(xData);
-    obj["yData"] = vectorToJson(yData);
     obj["pointShape"] = (int)pointShape;
     obj["pointColor"] = pointColor.name();
     obj["lineStyle"] = (int)lineStyle;
@@ -65,8 +66,6 @@ QJsonObject CurveInfo::toJson() const {
     if (type == 1) {
         obj["x2Col"] = x2Col;
         obj["y2Col"] = y2Col;
-        obj["x2Data"] = vectorToJson(x2Data);
-        obj["y2Data"] = vectorToJson(y2Data);
         obj["prodLegendName"] = prodLegendName;
         obj["prodGraphType"] = prodGraphType;
         obj["prodColor"] = prodColor.name();
@@ -77,7 +76,6 @@ QJsonObject CurveInfo::toJson() const {
         obj["LSpacing"] = LSpacing;
         obj["isSmooth"] = isSmooth;
         obj["smoothFactor"] = smoothFactor;
-        obj["derivData"] = vectorToJson(derivData);
         obj["derivShape"] = (int)derivShape;
         obj["derivPointColor"] = derivPointColor.name();
         obj["derivLineStyle"] = (int)derivLineStyle;
@@ -87,6 +85,46 @@ QJsonObject CurveInfo::toJson() const {
     return obj;
 }
 
+void CurveInfo::collectArrays(CurveStore::ArrayMap& arrays) const {
+    arrays.insert(CurveStore::arrayName(name, "xData"), xData);
+    arrays.insert(CurveStore::arrayName(name, "yData"), yData);
+    if (type == 1) {
+        arrays.insert(CurveStore::arrayName(name, "x2Data"), x2Data);
+        arrays.insert(CurveStore::arrayName(name, "y2Data"), y2Data);
+    }
+    else if (type == 2) {
+        arrays.insert(CurveStore::arrayName(name, "derivData"), derivData);
+    }
+}
+
+bool CurveInfo::loadArrays(const CurveStore& store) {
+    if (dataLoaded) return true;
+    const QString xName = CurveStore::arrayName(name, "xData");
+    if (!store.isOpen() || !store.contains(xName)) return false;
+
+    xData = store.array(xName);
+    yData = store.array(CurveStore::arrayName(name, "yData"));
+    if (type == 1) {
+        x2Data = store.array(CurveStore::arrayName(name, "x2Data"));
+        y2Data = store.array(CurveStore::arrayName(name, "y2Data"));
+    }
+    else if (type == 2) {
+        derivData = store.array(CurveStore::arrayName(name, "derivData"));
+    }
+    dataLoaded = true;
+    return true;
+}
+
+void CurveInfo::releaseArrays() {
+    if (!dataStored) return;
+    xData = QVector<double>();
+    yData = QVector<double>();
+    x2Data = QVector<double>();
+    y2Data = QVector<double>();
+    derivData = QVector<double>();
+    dataLoaded = false;
+}
+
 CurveInfo CurveInfo::fromJson(const QJsonObject& json) {
     CurveInfo info;
     info.name = json["name"].toString();
@@ -95,8 +133,19 @@ CurveInfo CurveInfo::fromJson(const QJsonObject& json) {
     info.xCol = json["xCol"].toInt(-1);
     info.yCol = json["yCol"].toInt(-1);
 
-    info.xData = jsonToVector(json["xData"].toArray());
-    info.yData = jsonToVector(json["yData"].toArray());
+    // 旧版项目：数组内嵌在 JSON 中，直接解析；新版：数据点在 _chart.wtc 中，显示时再读
+    if (json.contains("xData")) {
+        info.xData = jsonToVector(json["xData"].toArray());
+        info.yData = jsonToVector(json["yData"].toArray());
+        info.x2Data = jsonToVector(json["x2Data"].toArray());
+        info.y2Data = jsonToVector(json["y2Data"].toArray());
+        info.derivData = jsonToVector(json["derivData"].toArray());
+        info.dataLoaded = true;
+        info.dataStored = false;
+    } else {
+        info.dataLoaded = false;
+        info.dataStored = true;
+    }
 
     info.pointShape = (QCPScatterStyle::ScatterShape)json["pointShape"].toInt();
     info.pointColor = QColor(json["pointColor"].toString());
@@ -106,8 +155,6 @@ CurveInfo CurveInfo::fromJson(const QJsonObject& json) {
     if (info.type == 1) {
         info.x2Col = json["x2Col"].toInt(-1);
         info.y2Col = json["y2Col"].toInt(-1);
-        info.x2Data = jsonToVector(json["x2Data"].toArray());
-        info.y2Data = jsonToVector(json["y2Data"].toArray());
         info.prodLegendName = json["prodLegendName"].toString();
         info.prodGraphType = json["prodGraphType"].toInt();
         info.prodColor = QColor(json["prodColor"].toString());
@@ -117,7 +164,6 @@ CurveInfo CurveInfo::fromJson(const QJsonObject& json) {
         info.LSpacing = json["LSpacing"].toDouble();
         info.isSmooth = json["isSmooth"].toBool();
         info.smoothFactor = json["smoothFactor"].toInt();
-        info.derivData = jsonToVector(json["derivData"].toArray());
         info.derivShape = (QCPScatterStyle::ScatterShape)json["derivShape"].toInt();
         info.derivPointColor = QColor(json["derivPointColor"].toString());
         info.derivLineStyle = (Qt::PenStyle)json["derivLineStyle"].toInt();
@@ -151,7 +197,8 @@ WT_PlottingWidget::WT_PlottingWidget(QWidget *parent) :
     ui->splitter->setCollapsible(0, false);
 
     connect(ui->customPlot, &ChartWidget::exportDataTriggered, this, &WT_PlottingWidget::onExportDataTriggered);
-    connect(ui->customPlot->getPlot(), &QCustomPlot::plottableClick, this, &WT_PlottingWidget::onGraphClicked);
+    connect(ui->customPlot->getPlot(), &QCustomPlot::mousePress, this, [this](QMouseEvent* event) { m_pickPressPos = event->pos(); });
+    connect(ui->customPlot->getPlot(), &QCustomPlot::mouseRelease, this, &WT_PlottingWidget::onGraphClicked);
 
     ui->customPlot->setChartMode(ChartWidget::Mode_Single);
     ui->customPlot->setTitle("试井分析图表");
@@ -188,6 +235,7 @@ void WT_PlottingWidget::applyDialogStyle(QWidget* dialog) {
 void WT_PlottingWidget::loadProjectData()
 {
     m_curves.clear();
+    m_residentCurves.clear();
     ui->listWidget_Curves->clear();
     ui->customPlot->getPlot()->clearGraphs();
     ui->customPlot->getPlot()->replot();
@@ -196,6 +244,7 @@ void WT_PlottingWidget::loadProjectData()
     QJsonArray plots = ModelParameter::instance()->getPlottingData();
     if (plots.isEmpty()) return;
 
+    // 只加载曲线名称与配置
     for (const auto& val : plots) {
         CurveInfo info = CurveInfo::fromJson(val.toObject());
         m_curves.insert(info.name, info);
@@ -219,11 +268,44 @@ void WT_PlottingWidget::saveProjectData()
         msgBox.exec();
         return;
     }
+    // _chart.wtc 整体替换，未加载的曲线临时读出数据点 (不放入常驻列表)
+    const CurveStore& store = ModelParameter::instance()->curveStore();
     QJsonArray curvesArray;
-    for(auto it = m_curves.begin(); it != m_curves.end(); ++it) {
+    CurveStore::ArrayMap arrays;
+    QString err;
+    for(auto it = m_curves.constBegin(); it != m_curves.constEnd(); ++it) {
         curvesArray.append(it.value().toJson());
+        if (it.value().dataLoaded) {
+            it.value().collectArrays(arrays);
+        } else {
+            // 读不出的曲线若以空数组写回，原文件中的数据点将永久丢失，因此放弃本次保存
+            CurveInfo copy = it.value();
+            if (!copy.loadArrays(store)) {
+                err = QString("曲线 \"%1\" 的数据点无法从曲线数据文件读取，已取消保存以免覆盖原有数据。").arg(copy.name);
+                break;
+            }
+            copy.collectArrays(arrays);
+        }
     }
-    ModelParameter::instance()->savePlottingData(curvesArray);
+    if (!err.isEmpty() || !ModelParameter::instance()->savePlottingData(curvesArray, arrays, &err)) {
+        QMessageBox msgBox(this);
+        msgBox.setWindowTitle("错误");
+        msgBox.setText("绘图数据保存失败：" + err);
+        msgBox.setIcon(QMessageBox::Warning);
+        msgBox.setStandardButtons(QMessageBox::Ok);
+        applyDialogStyle(&msgBox);
+        msgBox.exec();
+        return;
+    }
+    arrays.clear();
+
+    // 已写入文件的曲线可以释放，纳入常驻列表统一淘汰
+    for(auto it = m_curves.begin(); it != m_curves.end(); ++it) {
+        if (!it.value().dataLoaded) continue;
+        it.value().dataStored = true;
+        if (!m_residentCurves.contains(it.key())) m_residentCurves.prepend(it.key());
+    }
+    trimResidentCurves();
 
     QMessageBox msgBox(this);
     msgBox.setWindowTitle("保存");
@@ -278,7 +360,7 @@ void WT_PlottingWidget::on_btn_NewCurve_clicked()
 
             QCPGraph* graph = cw->getPlot()->addGraph();
             graph->setName(info.legendName);
-            graph->setData(info.xData, info.yData);
+            CurveLod::setGraphData(graph, info.xData, info.yData);
             graph->setScatterStyle(QCPScatterStyle(info.pointShape, info.pointColor, info.pointColor, 6));
 
             // 【修复】尊重弹窗选择的线型
@@ -357,7 +439,7 @@ void WT_PlottingWidget::on_btn_PressureRate_clicked()
                 bottom->axis(QCPAxis::atBottom)->setLabel(timeLabel);
 
                 QCPGraph* gPress = plot->addGraph(top->axis(QCPAxis::atBottom), top->axis(QCPAxis::atLeft));
-                gPress->setData(info.xData, info.yData);
+                CurveLod::setGraphData(gPress, info.xData, info.yData);
                 gPress->setName(info.legendName);
                 gPress->setScatterStyle(QCPScatterStyle(info.pointShape, info.pointColor, info.pointColor, 6));
 
@@ -417,13 +499,22 @@ void WT_PlottingWidget::on_btn_Derivative_clicked()
         info.isSmooth = dlg.isSmoothEnabled();
         info.smoothFactor = dlg.getSmoothFactor();
 
+        // 选定流动段时只取该段，Δt 以开关井时刻为零点，关井压力取段起点压力
+        int rowBegin = 0, rowEnd = m_dataModel->rowCount();
+        double t0 = 0;
         double p_shutin = 0;
-        if(m_dataModel->rowCount() > 0) {
+        if(dlg.hasFlowPeriod()) {
+            FlowPeriod fp = dlg.getFlowPeriod();
+            rowBegin = fp.startRow;
+            rowEnd = qMin(rowEnd, fp.endRow);
+            t0 = fp.startTime;
+            p_shutin = fp.startPressure;
+        } else if(m_dataModel->rowCount() > 0) {
             p_shutin = m_dataModel->item(0, info.yCol)->text().toDouble();
         }
 
-        for(int i=0; i<m_dataModel->rowCount(); ++i) {
-            double t = m_dataModel->item(i, info.xCol)->text().toDouble();
+        for(int i=rowBegin; i<rowEnd; ++i) {
+            double t = m_dataModel->item(i, info.xCol)->text().toDouble() - t0;
             double p = m_dataModel->item(i, info.yCol)->text().toDouble();
             double dp = (info.testType == 0) ? std::abs(info.initialPressure - p) : std::abs(p - p_shutin);
             if(t > 0 && dp > 0) { info.xData.append(t); info.yData.append(dp); }
@@ -447,16 +538,7 @@ void WT_PlottingWidget::on_btn_Derivative_clicked()
         }
 
         if(info.isSmooth && info.smoothFactor > 1) {
-            QVector<double> smoothed;
-            int half = info.smoothFactor/2;
-            for (int i = 0; i < derData.size(); ++i) {
-                double sum = 0; int cnt = 0;
-                for (int j = i - half; j <= i + half; ++j) {
-                    if (j >= 0 && j < derData.size()) { sum += derData[j]; cnt++; }
-                }
-                smoothed.append(sum / cnt);
-            }
-            info.derivData = smoothed;
+            info.derivData = DataFilter::movingAverage(derData, info.smoothFactor);
         } else {
             info.derivData = derData;
         }
@@ -482,7 +564,7 @@ void WT_PlottingWidget::on_btn_Derivative_clicked()
             cw->getPlot()->yAxis->setLabel("Pressure & Derivative");
 
             QCPGraph* g1 = cw->getPlot()->addGraph();
-            g1->setData(info.xData, info.yData);
+            CurveLod::setGraphData(g1, info.xData, info.yData);
             g1->setName(info.legendName);
             g1->setScatterStyle(QCPScatterStyle(info.pointShape, info.pointColor, info.pointColor, 6));
             // 【修复】尊重弹窗线型
@@ -490,7 +572,7 @@ void WT_PlottingWidget::on_btn_Derivative_clicked()
             g1->setLineStyle(info.lineStyle == Qt::NoPen ? QCPGraph::lsNone : QCPGraph::lsLine);
 
             QCPGraph* g2 = cw->getPlot()->addGraph();
-            g2->setData(info.xData, info.derivData);
+            CurveLod::setGraphData(g2, info.xData, info.derivData);
             g2->setName(info.prodLegendName);
             g2->setScatterStyle(QCPScatterStyle(info.derivShape, info.derivPointColor, info.derivPointColor, 6));
             // 【修复】尊重弹窗线型
@@ -521,7 +603,7 @@ void WT_PlottingWidget::addCurveToPlot(const CurveInfo& info)
 
     QCPGraph* graph = plot->addGraph();
     graph->setName(info.legendName);
-    graph->setData(info.xData, info.yData);
+    CurveLod::setGraphData(graph, info.xData, info.yData);
     graph->setScatterStyle(QCPScatterStyle(info.pointShape, info.pointColor, info.pointColor, 6));
 
     // 【修复】尊重弹窗中选择的线型 (info.lineStyle)
@@ -541,7 +623,7 @@ void WT_PlottingWidget::drawStackedPlot(const CurveInfo& info)
     if (!topRect || !bottomRect) return;
 
     m_graphPress = plot->addGraph(topRect->axis(QCPAxis::atBottom), topRect->axis(QCPAxis::atLeft));
-    m_graphPress->setData(info.xData, info.yData);
+    CurveLod::setGraphData(m_graphPress, info.xData, info.yData);
     m_graphPress->setName(info.legendName);
     m_graphPress->setScatterStyle(QCPScatterStyle(info.pointShape, info.pointColor, info.pointColor, 6));
 
@@ -587,12 +669,12 @@ void WT_PlottingWidget::drawDerivativePlot(const CurveInfo& info)
 
     QCPGraph* g1 = plot->addGraph();
     g1->setName(info.legendName);
-    g1->setData(info.xData, info.yData);
+    CurveLod::setGraphData(g1, info.xData, info.yData);
     g1->setScatterStyle(QCPScatterStyle(info.pointShape, info.pointColor, info.pointColor, 6));
 
     QCPGraph* g2 = plot->addGraph();
     g2->setName(info.prodLegendName);
-    g2->setData(info.xData, info.derivData);
+    CurveLod::setGraphData(g2, info.xData, info.derivData);
     g2->setScatterStyle(QCPScatterStyle(info.derivShape, info.derivPointColor, info.derivPointColor, 6));
 
     // 【修复】尊重弹窗线型
@@ -610,8 +692,19 @@ void WT_PlottingWidget::on_listWidget_Curves_itemDoubleClicked(QListWidgetItem *
 {
     QString name = item->text();
     if(!m_curves.contains(name)) return;
+    if(!ensureCurveLoaded(name)) {
+        QMessageBox msgBox(this);
+        msgBox.setWindowTitle("错误");
+        msgBox.setText("无法读取曲线 \"" + name + "\" 的数据点。");
+        msgBox.setIcon(QMessageBox::Warning);
+        msgBox.setStandardButtons(QMessageBox::Ok);
+        applyDialogStyle(&msgBox);
+        msgBox.exec();
+        return;
+    }
     CurveInfo info = m_curves[name];
     m_currentDisplayedCurve = name;
+    trimResidentCurves();
     ui->customPlot->setTitle(name);
 
     if (info.type == 1) {
@@ -671,13 +764,15 @@ void WT_PlottingWidget::onExportDataTriggered()
     }
 }
 
-void WT_PlottingWidget::onGraphClicked(QCPAbstractPlottable *plottable, int dataIndex, QMouseEvent *event)
+void WT_PlottingWidget::onGraphClicked(QMouseEvent *event)
 {
-    Q_UNUSED(event);
-    if(!m_isSelectingForExport) return;
+    if(!m_isSelectingForExport || event->button() != Qt::LeftButton) return;
+    if((event->pos() - m_pickPressPos).manhattanLength() > 3) return; // 拖动平移，不是单击
 
-    QCPGraph* graph = qobject_cast<QCPGraph*>(plottable);
-    if(!graph) return;
+    MouseZoom* plot = ui->customPlot->getPlot();
+    QCPGraph* graph = nullptr;
+    int dataIndex = -1;
+    if(!plot->hitIndex()->pointAt(event->pos(), plot->selectionTolerance(), &graph, &dataIndex)) return;
 
     double key = graph->dataMainKey(dataIndex);
 
@@ -716,12 +811,13 @@ void WT_PlottingWidget::executeExport(bool fullRange, double start, double end)
     CurveInfo& info = m_curves[m_currentDisplayedCurve];
 
     if(ui->customPlot->getChartMode() == ChartWidget::Mode_Stacked) {
+        RateSchedule prod = getProductionSchedule(info);
         out << (fullRange ? "Time,P,Q\n" : "AdjTime,P,Q,OrigTime\n");
         for(int i=0; i<info.xData.size(); ++i) {
             double t = info.xData[i];
             if(!fullRange && (t < start || t > end)) continue;
             double p = info.yData[i];
-            double q = getProductionValueAt(t, info);
+            double q = prod.rateAt(t);
             if(fullRange) out << t << sep << p << sep << q << "\n";
             else out << (t-start) << sep << p << sep << q << sep << t << "\n";
         }
@@ -745,10 +841,40 @@ void WT_PlottingWidget::executeExport(bool fullRange, double start, double end)
     msg.exec();
 }
 
-double WT_PlottingWidget::getProductionValueAt(double t, const CurveInfo& info) {
-    if(info.y2Data.isEmpty()) return 0;
-    Q_UNUSED(t);
-    return info.y2Data.last();
+bool WT_PlottingWidget::ensureCurveLoaded(const QString& name)
+{
+    auto it = m_curves.find(name);
+    if (it == m_curves.end()) return false;
+    if (!it.value().loadArrays(ModelParameter::instance()->curveStore())) return false;
+
+    m_residentCurves.removeAll(name);
+    m_residentCurves.append(name);
+    return true;
+}
+
+void WT_PlottingWidget::trimResidentCurves()
+{
+    for (int i = 0; m_residentCurves.size() > kMaxResidentCurves && i < m_residentCurves.size(); ) {
+        const QString name = m_residentCurves[i];
+        auto it = m_curves.find(name);
+        if (it == m_curves.end()) {
+            m_residentCurves.removeAt(i);
+            continue;
+        }
+        // 未存盘的曲线释放后无处恢复；当前显示的曲线导出时仍要用到
+        if (!it.value().dataStored || name == m_currentDisplayedCurve) {
+            ++i;
+            continue;
+        }
+        it.value().releaseArrays();
+        m_residentCurves.removeAt(i);
+    }
+}
+
+RateSchedule WT_PlottingWidget::getProductionSchedule(const CurveInfo& info) const {
+    // 与 drawStackedPlot 的绘制方式一致：阶梯图的产量时间列为各段时长
+    if(info.prodGraphType == 0) return RateSchedule::fromDurations(info.x2Data, info.y2Data);
+    return RateSchedule::fromSamples(info.x2Data, info.y2Data);
 }
 
 void WT_PlottingWidget::on_btn_Manage_clicked() {
@@ -791,6 +917,9 @@ void WT_PlottingWidget::on_btn_Manage_clicked() {
         info.lineStyle = dlg.getLineStyle1(); info.lineColor = dlg.getLineColor1();
 
         if(info.type == 0) {
+            // 数据点按新列重新生成，与 _chart.wtc 不再一致
+            info.dataLoaded = true;
+            info.dataStored = false;
             info.xData.clear(); info.yData.clear();
             for(int i=0; i<m_dataModel->rowCount(); ++i) {
                 double xVal = m_dataModel->item(i, info.xCol)->text().toDouble();
@@ -831,6 +960,7 @@ void WT_PlottingWidget::on_btn_Delete_clicked() {
 
     if(msgBox.exec() == QMessageBox::Yes) {
         m_curves.remove(name);
+        m_residentCurves.removeAll(name);
         delete item;
         if(m_currentDisplayedCurve == name) {
             ui->customPlot->getPlot()->clearGraphs();
@@ -845,6 +975,7 @@ void WT_PlottingWidget::on_btn_Save_clicked() { saveProjectData(); }
 void WT_PlottingWidget::clearAllPlots()
 {
     m_curves.clear();
+    m_residentCurves.clear();
     m_currentDisplayedCurve.clear();
     ui->listWidget_Curves->clear();
     qDeleteAll(m_openedWindows);
@@ -5,6 +5,8 @@
  * 1. 管理试井分析曲线的创建、显示、修改和删除。
  * 2. 与 ChartWidget 交互，管理绘图逻辑。
  * 3. 强制黑字白底样式，优化左侧功能布局。
+ * 4. 打开项目时只加载曲线名称与配置，数据点在曲线显示时从 _chart.wtc 按需读取，
+ *    常驻内存的曲线按最近使用 (LRU) 保留，已存盘的曲线超出上限后释放数据点。
  */
 
 #ifndef WT_PLOTTINGWIDGET_H
@@ -16,6 +18,8 @@
 #include <QListWidgetItem>
 #include "chartwidget.h"
 #include "chartwindow.h"
+#include "rateschedule.h"
+#include "curvestore.h"
 
 // 曲线配置结构体
 struct CurveInfo {
@@ -49,8 +53,18 @@ struct CurveInfo {
     Qt::PenStyle derivLineStyle;
     QColor derivLineColor;
 
+    // 数据点状态：dataLoaded 为 false 时数组为空，需从 CurveStore 读取；
+    // dataStored 为 true 表示 _chart.wtc 中的数据与内存一致，可随时释放
+    bool dataLoaded = true;
+    bool dataStored = false;
+
+    // 配置写入 JSON，数据点数组单独交给 CurveStore (隐式共享，不复制)
     QJsonObject toJson() const;
+    void collectArrays(CurveStore::ArrayMap& arrays) const;
+    // 旧版项目的数据点内嵌在 JSON 中 (立即解析)，新版只记录配置，数据点留在 store 中待按需读取
     static CurveInfo fromJson(const QJsonObject& json);
+    bool loadArrays(const CurveStore& store);
+    void releaseArrays();
 };
 
 namespace Ui {
@@ -84,7 +98,8 @@ private slots:
     void on_btn_Delete_clicked();
 
     void onExportDataTriggered();
-    void onGraphClicked(QCPAbstractPlottable *plottable, int dataIndex, QMouseEvent *event);
+    // 导出选点：鼠标在绘图区单击 (按下与松开位置相同) 时取最近的数据点
+    void onGraphClicked(QMouseEvent *event);
 
 private:
     Ui::WT_PlottingWidget *ui;
@@ -93,6 +108,8 @@ private:
 
     QMap<QString, CurveInfo> m_curves;
     QString m_currentDisplayedCurve;
+    // 已加载数据点的曲线，按最近使用排序 (队尾最新)
+    QStringList m_residentCurves;
 
     QList<QWidget*> m_openedWindows;
 
@@ -100,6 +117,7 @@ private:
     int m_selectionStep;
     double m_exportStartIndex;
     double m_exportEndIndex;
+    QPoint m_pickPressPos;
 
     QCPGraph* m_graphPress;
     QCPGraph* m_graphProd;
@@ -108,8 +126,14 @@ private:
     void drawStackedPlot(const CurveInfo& info);
     void drawDerivativePlot(const CurveInfo& info);
 
+    // 确保曲线数据点已加载，并记为最近使用
+    bool ensureCurveLoaded(const QString& name);
+    // 常驻曲线超出上限时，从最久未用的开始释放已存盘且未显示的曲线
+    void trimResidentCurves();
+
     void executeExport(bool fullRange, double start = 0, double end = 0);
-    double getProductionValueAt(double t, const CurveInfo& info);
+    // 由压力产量曲线的产量数据构造产量制度 (阶梯图按时长、散点图按时刻)
+    RateSchedule getProductionSchedule(const CurveInfo& info) const;
     QListWidgetItem* getCurrentSelectedItem();
 
     void applyDialogStyle(QWidget* dialog);
@@ -6,6 +6,7 @@
  * 2. 实现"新建"、"打开"、"关闭"、"退出"的详细交互逻辑。
  * 3. 修复了双重弹窗问题：操作成功后不在此处弹窗，而是发送信号由主界面统一提示。
  * 4. 统一了所有交互弹窗的样式为白底黑字。
+ * 5. 关闭信号携带用户的选择 (保存并关闭 / 直接关闭)，由主界面决定保存或放弃修改。
  */
 
 #include "wt_projectwidget.h"
@@ -276,12 +277,12 @@ void WT_ProjectWidget::onCloseProjectClicked()
     if (msgBox.clickedButton() == saveCloseBtn) {
         // 选项1：保存并关闭
         if (saveCurrentProject()) {
-            closeProjectInternal();
+            closeProjectInternal(true);
             // [修改] 移除此处的弹窗，主界面接收到 projectClosed 信号后会统一提示
         }
     } else if (msgBox.clickedButton() == directCloseBtn) {
-        // 选项2：直接关闭
-        closeProjectInternal();
+        // 选项2：直接关闭 (放弃未保存的修改)
+        closeProjectInternal(false);
         // [修改] 移除此处的弹窗
     }
     // 选项3：取消 - 不做任何事
@@ -364,11 +365,11 @@ bool WT_ProjectWidget::saveCurrentProject()
     return true;
 }
 
-void WT_ProjectWidget::closeProjectInternal()
+void WT_ProjectWidget::closeProjectInternal(bool saveChanges)
 {
     // 重置状态
     setProjectState(false, "");
 
     // 通知主界面
-    emit projectClosed();
+    emit projectClosed(saveChanges);
 }
@@ -6,6 +6,7 @@
  * 2. 维护当前项目的打开状态 (m_isProjectOpen) 和项目路径信息。
  * 3. 声明各个按钮点击后的槽函数，实现基于状态的交互逻辑判断。
  * 4. 提供统一的弹窗样式获取函数。
+ * 5. projectClosed 信号携带用户是否选择保存，供主界面决定保存或放弃修改。
  */
 
 #ifndef WT_PROJECTWIDGET_H
@@ -41,8 +42,8 @@ signals:
     // 信号：新项目创建或打开成功 (通知主界面解锁功能)
     void projectOpened(bool isNew);
 
-    // 信号：项目已关闭 (通知主界面重置状态)
-    void projectClosed();
+    // 信号：项目已关闭 (通知主界面重置状态)；saveChanges 为 false 表示用户选择不保存
+    void projectClosed(bool saveChanges);
 
     // 信号：请求加载文件 (用于导入数据文件，保留原有功能)
     void fileLoaded(const QString& filePath, const QString& fileType);
@@ -77,7 +78,7 @@ private:
     bool saveCurrentProject();
 
     // 辅助函数：执行关闭项目的清理逻辑（不弹窗，只发信号）
-    void closeProjectInternal();
+    void closeProjectInternal(bool saveChanges);
 
     // 辅助函数：获取统一的弹窗样式表（白底黑字）
     QString getMessageBoxStyle() const;
@@ -0,0 +1,306 @@
+/*
+ * 文件名: xlsxstreamreader.cpp
+ * 文件作用: .xlsx 工作表流式读取器实现文件
+ * 功能描述:
+ * 1. 通过 QXlsx 自带的 ZipReader 取出 workbook / rels / sharedStrings / styles / sheet 各部件。
+ * 2. 使用 QXmlStreamReader 顺序扫描，不构建单元格对象，也不经过 QVariant 中转。
+ * 3. 日期样式 (内置格式及自定义 numFmt) 预先识别，日期单元格输出为 "yyyy-MM-dd hh:mm:ss"。
+ * 4. 达到 maxRows 后立即停止扫描，预览只需要前几十行。
+ * 注意: 工作表 XML 仍需整体解压到内存 (zip 条目无法随机访问)，但不再生成 DOM，峰值内存约为解压后 XML 大小。
+ */
+
+#include "xlsxstreamreader.h"
+#include "xlsxzipreader_p.h"
+
+#include <QXmlStreamReader>
+#include <QDateTime>
+#include <QDir>
+#include <QMap>
+#include <QDebug>
+
+namespace {
+
+// 将 rels 中的 Target 解析为 zip 内路径
+QString resolvePartPath(const QString& target)
+{
+    if (target.startsWith('/')) return target.mid(1);
+    return QDir::cleanPath("xl/" + target);
+}
+
+// 列引用 "AB12" -> 0 基列号
+int columnFromRef(QStringView ref)
+{
+    int col = 0;
+    for (QChar ch : ref) {
+        if (ch >= 'A' && ch <= 'Z') col = col * 26 + (ch.unicode() - 'A' + 1);
+        else break;
+    }
+    return col - 1;
+}
+
+// 判断自定义格式代码是否为日期/时间格式
+bool isDateFormatCode(const QString& code)
+{
+    bool inQuote = false;
+    bool inBracket = false;
+    for (int i = 0; i < code.size(); ++i) {
+        QChar ch = code.at(i);
+        if (inQuote) { if (ch == '"') inQuote = false; continue; }
+        if (inBracket) {
+            // [h] [mm] [ss] 为经过时间格式，其余 [Red] [$-804] 等忽略
+            if (ch == ']') inBracket = false;
+            else if (QString("hHmMsS").contains(ch)) return true;
+            continue;
+        }
+        if (ch == '"') { inQuote = true; continue; }
+        if (ch == '[') { inBracket = true; continue; }
+        if (ch == '\\' || ch == '_' || ch == '*') { ++i; continue; }
+        if (QString("yYmMdDhHsS").contains(ch)) return true;
+    }
+    return false;
+}
+
+bool isBuiltinDateFormat(int id)
+{
+    return (id >= 14 && id <= 22) || (id >= 27 && id <= 36) || (id >= 45 && id <= 47) || (id >= 50 && id <= 58);
+}
+
+// 解析共享字符串表 (只解析一次)
+QStringList parseSharedStrings(const QByteArray& xml)
+{
+    QStringList strings;
+    QXmlStreamReader r(xml);
+    QString current;
+    bool inPhonetic = false;
+    while (!r.atEnd()) {
+        QXmlStreamReader::TokenType tok = r.readNext();
+        if (tok == QXmlStreamReader::StartElement) {
+            if (r.name() == QLatin1String("si")) current.clear();
+            else if (r.name() == QLatin1String("rPh")) inPhonetic = true;
+            else if (r.name() == QLatin1String("t") && !inPhonetic) current += r.readElementText();
+        } else if (tok == QXmlStreamReader::EndElement) {
+            if (r.name() == QLatin1String("si")) strings.append(current);
+            else if (r.name() == QLatin1String("rPh")) inPhonetic = false;
+        }
+    }
+    return strings;
+}
+
+// 解析样式表，返回每个 cellXfs 索引是否为日期格式
+QVector<bool> parseDateStyles(const QByteArray& xml)
+{
+    QVector<bool> dateStyles;
+    QMap<int, bool> customFormats;
+    QXmlStreamReader r(xml);
+    bool inCellXfs = false;
+    while (!r.atEnd()) {
+        QXmlStreamReader::TokenType tok = r.readNext();
+        if (tok == QXmlStreamReader::StartElement) {
+            if (r.name() == QLatin1String("numFmt")) {
+                int id = r.attributes().value("numFmtId").toInt();
+                customFormats[id] = isDateFormatCode(r.attributes().value("formatCode").toString());
+            } else if (r.name() == QLatin1String("cellXfs")) {
+                inCellXfs = true;
+            } else if (inCellXfs && r.name() == QLatin1String("xf")) {
+                int id = r.attributes().value("numFmtId").toInt();
+                dateStyles.append(customFormats.contains(id) ? customFormats.value(id) : isBuiltinDateFormat(id));
+            }
+        } else if (tok == QXmlStreamReader::EndElement && r.name() == QLatin1String("cellXfs")) {
+            inCellXfs = false;
+        }
+    }
+    return dateStyles;
+}
+
+// 数值文本规范化：与 QVariant(double).toString() 的输出保持一致
+QString formatNumber(const QString& raw)
+{
+    if (raw.size() <= 15) {
+        bool plain = true;
+        for (QChar ch : raw) {
+            if (!(ch.isDigit() || ch == '.' || ch == '-')) { plain = false; break; }
+        }
+        if (plain) return raw;
+    }
+    double v;
+    if (!TextDataImporter::parseDouble(raw, v)) return raw;
+    return QString::number(v, 'g', QLocale::FloatingPointShortest);
+}
+
+} // namespace
+
+XlsxReadResult XlsxStreamReader::readFirstSheet(const DataImportSettings& settings, int maxRows, int maxColumns,
+                                                ImportControl* control)
+{
+    XlsxReadResult result;
+
+    QXlsx::ZipReader zip(settings.filePath);
+    if (!zip.exists()) {
+        result.errorMessage = "无法打开 .xlsx 文件: " + settings.filePath;
+        return result;
+    }
+    const QStringList parts = zip.filePaths();
+
+    // 1. 工作簿：第一个工作表的关系 ID 及 1904 日期系统标记
+    QString sheetRelId;
+    bool date1904 = false;
+    {
+        QXmlStreamReader r(zip.fileData("xl/workbook.xml"));
+        while (!r.atEnd()) {
+            if (r.readNext() != QXmlStreamReader::StartElement) continue;
+            if (r.name() == QLatin1String("workbookPr")) {
+                QStringView v = r.attributes().value("date1904");
+                date1904 = (v == QLatin1String("1") || v == QLatin1String("true"));
+            } else if (r.name() == QLatin1String("sheet")) {
+                result.sheetName = r.attributes().value("name").toString();
+                sheetRelId = r.attributes().value("r:id").toString();
+                break;
+            }
+        }
+    }
+
+    QString sheetPath = "xl/worksheets/sheet1.xml";
+    if (!sheetRelId.isEmpty()) {
+        QXmlStreamReader r(zip.fileData("xl/_rels/workbook.xml.rels"));
+        while (!r.atEnd()) {
+            if (r.readNext() != QXmlStreamReader::StartElement) continue;
+            if (r.name() == QLatin1String("Relationship") && r.attributes().value("Id") == sheetRelId) {
+                sheetPath = resolvePartPath(r.attributes().value("Target").toString());
+                break;
+            }
+        }
+    }
+    if (!parts.contains(sheetPath)) {
+        result.errorMessage = "未找到工作表数据: " + sheetPath;
+        return result;
+    }
+
+    // 2. 共享字符串与日期样式
+    const QStringList shared = parts.contains("xl/sharedStrings.xml")
+                                   ? parseSharedStrings(zip.fileData("xl/sharedStrings.xml")) : QStringList();
+    const QVector<bool> dateStyles = parts.contains("xl/styles.xml")
+                                         ? parseDateStyles(zip.fileData("xl/styles.xml")) : QVector<bool>();
+    const QDateTime epoch(date1904 ? QDate(1904, 1, 1) : QDate(1899, 12, 30), QTime(0, 0));
+
+    // 3. 扫描工作表
+    ImportedTable& table = result.table;
+    QVector<bool> seen;
+    const int headerRow = settings.useHeader ? settings.headerRow : -1;
+    int lastRow = 0;
+    bool done = false;
+
+    // 按 Excel 行号分发到表头或数据行
+    auto emitRow = [&](int rowNum, const QStringList& fields, const QVector<signed char>& kinds) {
+        if (rowNum == headerRow) { table.headers = fields; return; }
+        if (rowNum < settings.startRow) return;
+        if (maxRows >= 0 && table.rows.size() >= maxRows) return;
+        table.rows.append(fields);
+        for (int c = 0; c < kinds.size(); ++c) {
+            if (kinds[c] == 0) continue; // 空单元格
+            if (c >= seen.size()) { seen.resize(c + 1); table.numericColumns.resize(c + 1); }
+            bool isNum = (kinds[c] == 1);
+            if (!seen[c]) { seen[c] = true; table.numericColumns[c] = isNum; }
+            else if (!isNum) table.numericColumns[c] = false;
+        }
+    };
+    auto finished = [&](int rowNum) {
+        return maxRows >= 0 && table.rows.size() >= maxRows && rowNum >= headerRow;
+    };
+
+    const QByteArray sheetXml = zip.fileData(sheetPath);
+    if (control) { control->total = sheetXml.size(); control->processed = 0; }
+    QXmlStreamReader r(sheetXml);
+    QStringList fields;
+    QVector<signed char> kinds;   // 0: 空, 1: 数值, 2: 文本/日期
+    while (!r.atEnd() && !done) {
+        if (r.readNext() != QXmlStreamReader::StartElement || r.name() != QLatin1String("row")) continue;
+
+        QStringView rAttr = r.attributes().value("r");
+        int rowNum = rAttr.isEmpty() ? lastRow + 1 : rAttr.toInt();
+
+        if (control && (rowNum & 255) == 0) {
+            control->processed = r.characterOffset();
+            if (control->cancelled) {
+                result.errorMessage = "导入已取消";
+                return result;
+            }
+        }
+
+        // 缺失的中间行补空行
+        for (int gap = lastRow + 1; gap < rowNum && !done; ++gap) {
+            emitRow(gap, QStringList(), QVector<signed char>());
+            done = finished(gap);
+        }
+        if (done) break;
+        lastRow = rowNum;
+
+        fields.clear();
+        kinds.clear();
+        while (!r.atEnd()) {
+            QXmlStreamReader::TokenType tok = r.readNext();
+            if (tok == QXmlStreamReader::EndElement && r.name() == QLatin1String("row")) break;
+            if (tok != QXmlStreamReader::StartElement || r.name() != QLatin1String("c")) continue;
+
+            const QXmlStreamAttributes attrs = r.attributes();
+            QStringView ref = attrs.value("r");
+            int col = ref.isEmpty() ? int(fields.size()) : columnFromRef(ref);
+            const QString type = attrs.value("t").toString();
+            const int style = attrs.value("s").toInt();
+
+            // 读取 <v> / <is> 内容
+            QString raw;
+            while (!r.atEnd()) {
+                tok = r.readNext();
+                if (tok == QXmlStreamReader::EndElement && r.name() == QLatin1String("c")) break;
+                if (tok != QXmlStreamReader::StartElement) continue;
+                if (r.name() == QLatin1String("v")) raw = r.readElementText();
+                else if (r.name() == QLatin1String("t")) raw += r.readElementText(); // inlineStr 的 <is><t>
+            }
+            if (col < 0 || (maxColumns >= 0 && col >= maxColumns)) continue;
+
+            QString text;
+            signed char kind = 2;
+            if (type == QLatin1String("s")) {
+                int idx = raw.toInt();
+                text = (idx >= 0 && idx < shared.size()) ? shared.at(idx) : QString();
+            } else if (type == QLatin1String("b")) {
+                text = (raw == QLatin1String("1")) ? "true" : "false";
+            } else if (type == QLatin1String("str") || type == QLatin1String("inlineStr") || type == QLatin1String("e")) {
+                text = raw;
+            } else if (!raw.isEmpty()) {
+                if (style >= 0 && style < dateStyles.size() && dateStyles[style]) {
+                    double serial;
+                    if (TextDataImporter::parseDouble(raw, serial))
+                        text = epoch.addMSecs(qRound64(serial * 86400000.0)).toString("yyyy-MM-dd hh:mm:ss");
+                    else
+                        text = raw;
+                } else {
+                    text = formatNumber(raw);
+                    kind = 1;
+                }
+            }
+            if (text.isEmpty()) kind = 0;
+
+            while (fields.size() < col) { fields.append(QString()); kinds.append(0); }
+            if (col < fields.size()) { fields[col] = text; kinds[col] = kind; }
+            else { fields.append(text); kinds.append(kind); }
+        }
+
+        emitRow(rowNum, fields, kinds);
+        done = finished(rowNum);
+    }
+
+    if (r.hasError() && !done) {
+        qDebug() << "xlsx 工作表解析错误:" << r.errorString();
+    }
+
+    table.columnCount = table.headers.size();
+    for (const auto& row : table.rows) table.columnCount = qMax(table.columnCount, int(row.size()));
+    table.numericColumns.resize(table.columnCount);
+    for (int c = 0; c < table.columnCount; ++c) {
+        if (c >= seen.size() || !seen[c]) table.numericColumns[c] = false;
+    }
+
+    result.success = true;
+    return result;
+}
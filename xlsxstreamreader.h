@@ -0,0 +1,39 @@
+/*
+ * 文件名: xlsxstreamreader.h
+ * 文件作用: .xlsx 工作表流式读取器头文件
+ * 功能描述:
+ * 1. 声明 XlsxStreamReader 类，不经过 QXlsx::Document 的整表 DOM，直接以 SAX 方式扫描工作表 XML。
+ * 2. 共享字符串表 (sharedStrings.xml) 与日期样式只解析一次，单元格直接解码为文本写入 ImportedTable。
+ * 3. 支持只读取前 N 行 / 前 N 列，供导入预览提前结束。
+ */
+
+#ifndef XLSXSTREAMREADER_H
+#define XLSXSTREAMREADER_H
+
+#include <QString>
+#include "textdataimporter.h"
+
+// .xlsx 读取结果
+struct XlsxReadResult {
+    bool success = false;
+    QString errorMessage;
+    ImportedTable table;
+    QString sheetName;      // 实际读取的工作表名称
+};
+
+class XlsxStreamReader
+{
+public:
+    /**
+     * @brief 流式读取第一个工作表
+     * @param settings 导入配置 (使用 startRow / headerRow / useHeader，行号与 Excel 行号一致)
+     * @param maxRows 最多读取的数据行数 (-1 表示全部)
+     * @param maxColumns 最多读取的列数 (-1 表示全部)
+     * @param control 进度与取消控制 (可为空)，进度按工作表 XML 的扫描位置计算
+     * @return 读取结果，缺失的中间行以空行填充，与原 cellAt 逐行读取的结果保持一致
+     */
+    static XlsxReadResult readFirstSheet(const DataImportSettings& settings, int maxRows = -1, int maxColumns = -1,
+                                         ImportControl* control = nullptr);
+};
+
+#endif // XLSXSTREAMREADER_H